@@ -0,0 +1,621 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <illuminatir.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_CYCLES 1
+#else
+#define BENCH_CYCLES 0
+#endif
+
+
+#define BENCH_PACKETS_MAX 65536
+#define BENCH_UNIVERSES   16 // universe updates the plan kernels cycle through
+
+
+typedef enum {
+	BENCH_OFFSETARRAY,
+	BENCH_CHANNELVALUEPAIRS,
+	BENCH_CONFIG,
+} bench_type_t;
+
+
+// The arguments a packet of the mix was built from.
+typedef struct {
+	bench_type_t type;
+	uint8_t      offset;
+	uint8_t      data[ILLUMINATIR_CHANNELVALUEPAIRS_MAXSIZE];
+	uint8_t      data_size;
+	char         key[ILLUMINATIR_CONFIG_KEY_MAXLEN];
+	uint8_t      key_len;
+} bench_args_t;
+
+
+// A packet mix, stored raw, COBS encoded and randomized + COBS encoded.
+typedef struct {
+	size_t         count;
+	size_t         bytes; // total size of the raw packets
+	bench_args_t * args;
+	uint8_t      (*raw)[ILLUMINATIR_PACKET_MAXSIZE];
+	uint8_t      (*cobs)[ILLUMINATIR_COBS_PACKET_MAXSIZE];
+	uint8_t      (*randCobs)[ILLUMINATIR_COBS_PACKET_MAXSIZE];
+	uint8_t *      raw_size;
+	uint8_t *      cobs_size;
+	uint8_t *      randCobs_size;
+} bench_mix_t;
+
+
+typedef struct {
+	const char * name;
+	void       (*run)( const bench_mix_t * mix ); // one pass over the whole mix
+} bench_kernel_t;
+
+
+typedef struct {
+	double ns_per_packet;
+	double mb_per_s;
+	double cycles_per_byte; // negative if unavailable
+} bench_result_t;
+
+
+static volatile uint32_t bench_sink; // keeps results alive
+
+// Previous and next universes of the plan kernels, few or nearly all channels changed.
+static uint8_t bench_sparse[BENCH_UNIVERSES][2][ILLUMINATIR_CHANNELS];
+static uint8_t bench_dense[BENCH_UNIVERSES][2][ILLUMINATIR_CHANNELS];
+
+
+// xorshift32, so mixes are reproducible across platforms.
+static uint32_t bench_random( uint32_t * state )
+{
+	uint32_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return *state = x;
+}
+
+
+static illuminatir_error_t bench_build( const bench_args_t * args, uint8_t * packet, uint8_t * packet_size )
+{
+	switch( args->type ) {
+		case BENCH_OFFSETARRAY:
+			return illuminatir_build_offsetArray( packet, packet_size, args->offset, args->data, args->data_size );
+		case BENCH_CHANNELVALUEPAIRS:
+			return illuminatir_build_channelValuePairs( packet, packet_size, args->data, args->data_size );
+		default:
+			return illuminatir_build_config( packet, packet_size, args->key, args->key_len, args->data, args->data_size );
+	}
+}
+
+
+static illuminatir_error_t bench_cobs_build( const bench_args_t * args, uint8_t * packet, uint8_t * packet_size )
+{
+	switch( args->type ) {
+		case BENCH_OFFSETARRAY:
+			return illuminatir_cobs_build_offsetArray( packet, packet_size, args->offset, args->data, args->data_size );
+		case BENCH_CHANNELVALUEPAIRS:
+			return illuminatir_cobs_build_channelValuePairs( packet, packet_size, args->data, args->data_size );
+		default:
+			return illuminatir_cobs_build_config( packet, packet_size, args->key, args->key_len, args->data, args->data_size );
+	}
+}
+
+
+static illuminatir_error_t bench_rand_cobs_build( const bench_args_t * args, uint8_t * packet, uint8_t * packet_size )
+{
+	switch( args->type ) {
+		case BENCH_OFFSETARRAY:
+			return illuminatir_rand_cobs_build_offsetArray( packet, packet_size, args->offset, args->data, args->data_size );
+		case BENCH_CHANNELVALUEPAIRS:
+			return illuminatir_rand_cobs_build_channelValuePairs( packet, packet_size, args->data, args->data_size );
+		default:
+			return illuminatir_rand_cobs_build_config( packet, packet_size, args->key, args->key_len, args->data, args->data_size );
+	}
+}
+
+
+// Generates a mix resembling a transmitter's output: mostly OffsetArrays (full
+// blocks of a refresh or short runs of changed channels), some
+// ChannelValuePairs for scattered changes and a few Config commands.
+static int bench_mix_init( bench_mix_t * mix, size_t count, uint32_t seed )
+{
+	static const char * const keys[] = { "mode", "speed", "strobe", "brightness", "palette", "id" };
+	memset( mix, 0, sizeof(*mix) );
+	mix->count         = count;
+	mix->args          = calloc( count, sizeof(*mix->args) );
+	mix->raw           = calloc( count, sizeof(*mix->raw) );
+	mix->cobs          = calloc( count, sizeof(*mix->cobs) );
+	mix->randCobs      = calloc( count, sizeof(*mix->randCobs) );
+	mix->raw_size      = calloc( count, 1 );
+	mix->cobs_size     = calloc( count, 1 );
+	mix->randCobs_size = calloc( count, 1 );
+	if( !mix->args || !mix->raw || !mix->cobs || !mix->randCobs || !mix->raw_size || !mix->cobs_size || !mix->randCobs_size ) {
+		return 0;
+	}
+	uint32_t state = seed ? seed : 1;
+	for( size_t i = 0; i < count; i++ ) {
+		bench_args_t * args = &mix->args[i];
+		uint32_t kind = bench_random( &state ) % 100;
+		if( kind < 40 ) { // full block
+			args->type      = BENCH_OFFSETARRAY;
+			args->offset    = (uint8_t)((bench_random( &state ) % 16) * 16);
+			args->data_size = ILLUMINATIR_OFFSETARRAY_MAXVALUES;
+		} else if( kind < 70 ) { // short run
+			args->type      = BENCH_OFFSETARRAY;
+			args->offset    = (uint8_t)bench_random( &state );
+			args->data_size = (uint8_t)(1 + bench_random( &state ) % 8);
+		} else if( kind < 95 ) {
+			args->type      = BENCH_CHANNELVALUEPAIRS;
+			args->data_size = (uint8_t)(ILLUMINATIR_CHANNELVALUEPAIRS_MINSIZE + bench_random( &state ) % (ILLUMINATIR_CHANNELVALUEPAIRS_MAXSIZE - 1));
+		} else {
+			const char * key = keys[bench_random( &state ) % (sizeof(keys) / sizeof(keys[0]))];
+			args->type      = BENCH_CONFIG;
+			args->key_len   = (uint8_t)strlen( key );
+			memcpy( args->key, key, args->key_len );
+			args->data_size = (uint8_t)(bench_random( &state ) % 4);
+		}
+		for( uint8_t j = 0; j < args->data_size; j++ ) {
+			// Dimmed channels are common, so zeros (and thus COBS work) are frequent.
+			uint32_t r = bench_random( &state );
+			args->data[j] = (r & 0x300) ? (uint8_t)r : 0;
+		}
+
+		uint8_t size = ILLUMINATIR_PACKET_MAXSIZE;
+		if( bench_build( args, mix->raw[i], &size ) != ILLUMINATIR_ERROR_NONE ) {
+			return 0;
+		}
+		mix->raw_size[i] = size;
+		mix->bytes += size;
+		size = ILLUMINATIR_COBS_PACKET_MAXSIZE;
+		if( bench_cobs_build( args, mix->cobs[i], &size ) != ILLUMINATIR_ERROR_NONE ) {
+			return 0;
+		}
+		mix->cobs_size[i] = size;
+		size = ILLUMINATIR_COBS_PACKET_MAXSIZE;
+		if( bench_rand_cobs_build( args, mix->randCobs[i], &size ) != ILLUMINATIR_ERROR_NONE ) {
+			return 0;
+		}
+		mix->randCobs_size[i] = size;
+	}
+	return 1;
+}
+
+
+// Changes up to 16 channels of the sparse universes and all but up to 16 of the dense ones.
+static void bench_universes_init( uint32_t seed )
+{
+	uint32_t state = seed ? seed : 1;
+	for( unsigned u = 0; u < BENCH_UNIVERSES; u++ ) {
+		uint8_t * sparse = bench_sparse[u][1], * dense = bench_dense[u][1];
+		for( unsigned i = 0; i < ILLUMINATIR_CHANNELS; i++ ) {
+			uint8_t value = (uint8_t)bench_random( &state );
+			bench_sparse[u][0][i] = bench_dense[u][0][i] = value;
+			sparse[i] = value;
+			dense[i]  = (uint8_t)~value;
+		}
+		for( unsigned n = 0; n <= u; n++ ) {
+			unsigned channel = bench_random( &state ) % ILLUMINATIR_CHANNELS;
+			sparse[channel] = (uint8_t)~bench_sparse[u][0][channel];
+			dense[channel]  = bench_dense[u][0][channel];
+		}
+	}
+}
+
+
+static void bench_mix_free( bench_mix_t * mix )
+{
+	free( mix->args );
+	free( mix->raw );
+	free( mix->cobs );
+	free( mix->randCobs );
+	free( mix->raw_size );
+	free( mix->cobs_size );
+	free( mix->randCobs_size );
+}
+
+
+static void bench_setChannels( void * ctx, uint8_t first_channel, const uint8_t * values, uint8_t count )
+{
+	(void)ctx;
+	bench_sink += first_channel + values[0] + count;
+}
+
+
+static void bench_setChannelValuePairs( void * ctx, const uint8_t * pairs, uint8_t count )
+{
+	(void)ctx;
+	bench_sink += pairs[0] + count;
+}
+
+
+static void bench_setConfig( void * ctx, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size )
+{
+	(void)ctx;
+	(void)values;
+	bench_sink += (uint8_t)key[0] + key_len + values_size;
+}
+
+
+static const illuminatir_handler_t bench_handler = { NULL, bench_setChannels, bench_setChannelValuePairs, bench_setConfig };
+
+
+static void bench_run_parse( const bench_mix_t * mix )
+{
+	for( size_t i = 0; i < mix->count; i++ ) {
+		bench_sink += illuminatir_parse_handler( mix->raw[i], mix->raw_size[i], &bench_handler );
+	}
+}
+
+
+static void bench_run_build( const bench_mix_t * mix )
+{
+	uint8_t packet[ILLUMINATIR_PACKET_MAXSIZE];
+	for( size_t i = 0; i < mix->count; i++ ) {
+		uint8_t packet_size = sizeof(packet);
+		bench_sink += bench_build( &mix->args[i], packet, &packet_size ) + packet[packet_size - 1];
+	}
+}
+
+
+static void bench_run_crc8( const bench_mix_t * mix )
+{
+	for( size_t i = 0; i < mix->count; i++ ) {
+		bench_sink += illuminatir_crc8( mix->raw[i], mix->raw_size[i] - 1, ILLUMINATIR_CRC8_INITIAL_SEED );
+	}
+}
+
+
+static void bench_run_cobs_encode( const bench_mix_t * mix )
+{
+	uint8_t encoded[ILLUMINATIR_COBS_PACKET_MAXSIZE];
+	for( size_t i = 0; i < mix->count; i++ ) {
+		bench_sink += (uint32_t)illuminatir_cobs_encode( encoded, sizeof(encoded), mix->raw[i], mix->raw_size[i] ) + encoded[0];
+	}
+}
+
+
+static void bench_run_cobs_decode( const bench_mix_t * mix )
+{
+	uint8_t decoded[ILLUMINATIR_COBS_PACKET_MAXSIZE];
+	for( size_t i = 0; i < mix->count; i++ ) {
+		bench_sink += (uint32_t)illuminatir_cobs_decode( decoded, sizeof(decoded), mix->cobs[i], mix->cobs_size[i] ) + decoded[0];
+	}
+}
+
+
+static void bench_run_rand( const bench_mix_t * mix )
+{
+	uint8_t packet[ILLUMINATIR_PACKET_MAXSIZE];
+	for( size_t i = 0; i < mix->count; i++ ) {
+		memcpy( packet, mix->raw[i], mix->raw_size[i] );
+		illuminatir_rand( packet, mix->raw_size[i] );
+		bench_sink += packet[0];
+	}
+}
+
+
+static void bench_run_rand_cobs_build( const bench_mix_t * mix )
+{
+	uint8_t packet[ILLUMINATIR_COBS_PACKET_MAXSIZE];
+	for( size_t i = 0; i < mix->count; i++ ) {
+		uint8_t packet_size = sizeof(packet);
+		bench_sink += bench_rand_cobs_build( &mix->args[i], packet, &packet_size ) + packet[0];
+	}
+}
+
+
+static void bench_run_rand_cobs_parse( const bench_mix_t * mix )
+{
+	for( size_t i = 0; i < mix->count; i++ ) {
+		bench_sink += illuminatir_rand_cobs_parse_handler( mix->randCobs[i], mix->randCobs_size[i], &bench_handler );
+	}
+}
+
+
+static void bench_run_cobs_roundtrip( const bench_mix_t * mix )
+{
+	uint8_t packet[ILLUMINATIR_COBS_PACKET_MAXSIZE];
+	for( size_t i = 0; i < mix->count; i++ ) {
+		uint8_t packet_size = sizeof(packet);
+		bench_sink += bench_cobs_build( &mix->args[i], packet, &packet_size );
+		bench_sink += illuminatir_cobs_parse_handler( packet, packet_size, &bench_handler );
+	}
+}
+
+
+static void bench_run_rand_cobs_roundtrip( const bench_mix_t * mix )
+{
+	uint8_t packet[ILLUMINATIR_COBS_PACKET_MAXSIZE];
+	for( size_t i = 0; i < mix->count; i++ ) {
+		uint8_t packet_size = sizeof(packet);
+		bench_sink += bench_rand_cobs_build( &mix->args[i], packet, &packet_size );
+		bench_sink += illuminatir_rand_cobs_parse_handler( packet, packet_size, &bench_handler );
+	}
+}
+
+
+// Plans mix->count universe updates, so ns/packet is per plan.
+static void bench_plan( const bench_mix_t * mix, uint8_t (* universes)[2][ILLUMINATIR_CHANNELS] )
+{
+	uint8_t packets[ILLUMINATIR_PLAN_MAXSIZE];
+	for( size_t i = 0; i < mix->count; i++ ) {
+		size_t packets_size = sizeof(packets);
+		uint8_t (* universe)[ILLUMINATIR_CHANNELS] = universes[i % BENCH_UNIVERSES];
+		bench_sink += illuminatir_plan( packets, &packets_size, universe[0], universe[1], 0 ) + (uint32_t)packets_size;
+	}
+}
+
+
+static void bench_run_plan_sparse( const bench_mix_t * mix )
+{
+	bench_plan( mix, bench_sparse );
+}
+
+
+static void bench_run_plan_dense( const bench_mix_t * mix )
+{
+	bench_plan( mix, bench_dense );
+}
+
+
+static const bench_kernel_t bench_kernels[] = {
+	{ "parse",                bench_run_parse },
+	{ "build",                bench_run_build },
+	{ "crc8",                 bench_run_crc8 },
+	{ "cobs_encode",          bench_run_cobs_encode },
+	{ "cobs_decode",          bench_run_cobs_decode },
+	{ "rand",                 bench_run_rand },
+	{ "rand_cobs_build",      bench_run_rand_cobs_build },
+	{ "rand_cobs_parse",      bench_run_rand_cobs_parse },
+	{ "cobs_roundtrip",       bench_run_cobs_roundtrip },
+	{ "rand_cobs_roundtrip",  bench_run_rand_cobs_roundtrip },
+	{ "plan_sparse",          bench_run_plan_sparse },
+	{ "plan_dense",           bench_run_plan_dense },
+};
+#define BENCH_KERNELS (sizeof(bench_kernels) / sizeof(bench_kernels[0]))
+
+
+static uint64_t bench_now_ns( void )
+{
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+
+static uint64_t bench_cycles( void )
+{
+#if BENCH_CYCLES
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+
+// Runs passes over the mix for at least min_time_ns, repeated a number of
+// times, and keeps the fastest repetition to filter out interruptions.
+static bench_result_t bench_measure( const bench_kernel_t * kernel, const bench_mix_t * mix, uint64_t min_time_ns, unsigned repetitions )
+{
+	double best_ns = -1.0, best_cycles = -1.0;
+	kernel->run( mix ); // warm up caches and branch predictors
+	for( unsigned r = 0; r < repetitions; r++ ) {
+		uint64_t passes = 0;
+		uint64_t cycles = bench_cycles();
+		uint64_t start = bench_now_ns(), elapsed;
+		do {
+			kernel->run( mix );
+			passes++;
+			elapsed = bench_now_ns() - start;
+		} while( elapsed < min_time_ns );
+		cycles = bench_cycles() - cycles;
+		double ns = (double)elapsed / (double)passes;
+		if( best_ns < 0 || ns < best_ns ) {
+			best_ns = ns;
+			best_cycles = (double)cycles / (double)passes;
+		}
+	}
+	bench_result_t result;
+	result.ns_per_packet   = best_ns / (double)mix->count;
+	result.mb_per_s        = (double)mix->bytes / best_ns * 1000.0;
+	result.cycles_per_byte = BENCH_CYCLES ? best_cycles / (double)mix->bytes : -1.0;
+	return result;
+}
+
+
+// Reads ns_per_packet of the given kernel from a JSON report written by this program.
+static int bench_baseline_get( const char * baseline, const char * name, double * ns_per_packet )
+{
+	char pattern[64];
+	snprintf( pattern, sizeof(pattern), "\"kernel\": \"%s\"", name );
+	const char * entry = strstr( baseline, pattern );
+	if( !entry ) {
+		return 0;
+	}
+	const char * value = strstr( entry, "\"ns_per_packet\":" );
+	const char * end = strchr( entry, '}' );
+	if( !value || (end && value > end) ) {
+		return 0;
+	}
+	*ns_per_packet = strtod( value + strlen( "\"ns_per_packet\":" ), NULL );
+	return *ns_per_packet > 0;
+}
+
+
+static char * bench_readFile( const char * path )
+{
+	FILE * file = fopen( path, "rb" );
+	if( !file ) {
+		return NULL;
+	}
+	size_t size = 0, capacity = 4096;
+	char * data = malloc( capacity );
+	while( data ) {
+		size += fread( data + size, 1, capacity - size - 1, file );
+		if( size < capacity - 1 ) {
+			break;
+		}
+		capacity *= 2;
+		char * grown = realloc( data, capacity );
+		if( !grown ) {
+			free( data );
+		}
+		data = grown;
+	}
+	fclose( file );
+	if( data ) {
+		data[size] = 0;
+	}
+	return data;
+}
+
+
+static void bench_usage( const char * program )
+{
+	fprintf( stderr,
+		"Usage: %s [options]\n"
+		"  --json               Write a machine-readable report to stdout.\n"
+		"  --baseline FILE      Compare against a report written with --json and fail on regressions.\n"
+		"  --threshold PERCENT  Slowdown tolerated before a kernel counts as regressed. (default 5)\n"
+		"  --filter TEXT        Only run kernels whose name contains TEXT.\n"
+		"  --packets N          Number of packets in the mix. (default 1024)\n"
+		"  --seed N             Seed of the packet mix. (default 1)\n"
+		"  --min-time MS        Minimum duration of one repetition. (default 100)\n"
+		"  --repetitions N      Repetitions per kernel, the fastest one is reported. (default 5)\n",
+		program );
+}
+
+
+int main( int argc, char ** argv )
+{
+	int json = 0;
+	const char * baseline_path = NULL, * filter = NULL;
+	double threshold = 5.0;
+	unsigned long packets = 1024, seed = 1, min_time_ms = 100, repetitions = 5;
+
+	for( int i = 1; i < argc; i++ ) {
+		const char * arg = argv[i];
+		const char * value = i + 1 < argc ? argv[i + 1] : NULL;
+		if( !strcmp( arg, "--json" ) ) {
+			json = 1;
+			continue;
+		}
+		if( !value ) {
+			bench_usage( argv[0] );
+			return EXIT_FAILURE;
+		}
+		i++;
+		if( !strcmp( arg, "--baseline" ) ) {
+			baseline_path = value;
+		} else if( !strcmp( arg, "--threshold" ) ) {
+			threshold = strtod( value, NULL );
+		} else if( !strcmp( arg, "--filter" ) ) {
+			filter = value;
+		} else if( !strcmp( arg, "--packets" ) ) {
+			packets = strtoul( value, NULL, 0 );
+		} else if( !strcmp( arg, "--seed" ) ) {
+			seed = strtoul( value, NULL, 0 );
+		} else if( !strcmp( arg, "--min-time" ) ) {
+			min_time_ms = strtoul( value, NULL, 0 );
+		} else if( !strcmp( arg, "--repetitions" ) ) {
+			repetitions = strtoul( value, NULL, 0 );
+		} else {
+			bench_usage( argv[0] );
+			return EXIT_FAILURE;
+		}
+	}
+	if( !packets || packets > BENCH_PACKETS_MAX || !repetitions ) {
+		bench_usage( argv[0] );
+		return EXIT_FAILURE;
+	}
+
+	char * baseline = NULL;
+	if( baseline_path ) {
+		baseline = bench_readFile( baseline_path );
+		if( !baseline ) {
+			fprintf( stderr, "Cannot read baseline \"%s\"\n", baseline_path );
+			return EXIT_FAILURE;
+		}
+	}
+
+	bench_mix_t mix;
+	if( !bench_mix_init( &mix, packets, (uint32_t)seed ) ) {
+		fprintf( stderr, "Cannot create packet mix\n" );
+		bench_mix_free( &mix );
+		free( baseline );
+		return EXIT_FAILURE;
+	}
+	bench_universes_init( (uint32_t)seed );
+
+	// Reports go to stdout, comparisons to stderr when stdout is JSON.
+	FILE * text = json ? stderr : stdout;
+	if( json ) {
+		printf( "{\n\t\"mix\": { \"packets\": %zu, \"bytes\": %zu, \"seed\": %lu },\n\t\"results\": [", mix.count, mix.bytes, seed );
+	} else {
+		fprintf( text, "%zu packets, %zu bytes, seed %lu\n", mix.count, mix.bytes, seed );
+		fprintf( text, "%-22s %12s %10s %12s%s\n", "kernel", "ns/packet", "MB/s", "cycles/byte", baseline ? "   baseline" : "" );
+	}
+
+	unsigned regressions = 0, results = 0;
+	for( size_t k = 0; k < BENCH_KERNELS; k++ ) {
+		const bench_kernel_t * kernel = &bench_kernels[k];
+		if( filter && !strstr( kernel->name, filter ) ) {
+			continue;
+		}
+		bench_result_t result = bench_measure( kernel, &mix, min_time_ms * 1000000u, (unsigned)repetitions );
+
+		if( json ) {
+			printf( "%s\n\t\t{ \"kernel\": \"%s\", \"ns_per_packet\": %.3f, \"mb_per_s\": %.3f, \"cycles_per_byte\": ", results ? "," : "", kernel->name, result.ns_per_packet, result.mb_per_s );
+			if( result.cycles_per_byte < 0 ) {
+				printf( "null }" );
+			} else {
+				printf( "%.3f }", result.cycles_per_byte );
+			}
+		} else {
+			fprintf( text, "%-22s %12.2f %10.1f ", kernel->name, result.ns_per_packet, result.mb_per_s );
+			if( result.cycles_per_byte < 0 ) {
+				fprintf( text, "%12s", "-" );
+			} else {
+				fprintf( text, "%12.2f", result.cycles_per_byte );
+			}
+		}
+		results++;
+
+		if( baseline ) {
+			double reference;
+			if( !bench_baseline_get( baseline, kernel->name, &reference ) ) {
+				fprintf( text, json ? "%s: not in baseline\n" : "   (new)\n", kernel->name );
+				continue;
+			}
+			double change = (result.ns_per_packet / reference - 1.0) * 100.0;
+			int regressed = change > threshold;
+			regressions += regressed;
+			if( json ) {
+				fprintf( text, "%s: %+.1f%%%s\n", kernel->name, change, regressed ? " REGRESSION" : "" );
+			} else {
+				fprintf( text, "   %+7.1f%%%s\n", change, regressed ? " REGRESSION" : "" );
+			}
+		} else if( !json ) {
+			fprintf( text, "\n" );
+		}
+	}
+	if( json ) {
+		printf( "\n\t]\n}\n" );
+	}
+	if( regressions ) {
+		fprintf( text, "%u kernel(s) regressed by more than %.1f%%\n", regressions, threshold );
+	}
+
+	bench_mix_free( &mix );
+	free( baseline );
+	return regressions ? EXIT_FAILURE : EXIT_SUCCESS;
+}
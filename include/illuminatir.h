@@ -118,7 +118,7 @@
  *
  * \note If PayloadSize is odd, Value defaults to 0.
  *
- * \todo Implement \c illuminatir_build_channelValuePairs and \c illuminatir_cobs_build_channelValuePairs.
+ * \sa illuminatir_build_channelValuePairs, illuminatir_cobs_build_channelValuePairs
  *
  *
  * \subsection libilluminatir_payload_config_sec Payload (Type 2) - Config:
@@ -170,6 +170,10 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 
 /**
  * @defgroup IlluminatIR IlluminatIR
@@ -185,11 +189,16 @@
 #define ILLUMINATIR_OFFSETARRAY_MINVALUES 1  ///< Minimum number of channels in an OffsetArray type packet. (offset + 1 channel value)
 #define ILLUMINATIR_OFFSETARRAY_MAXVALUES 16 ///< Maximum number of channels in an OffsetArray type packet. (offset + 16 channel values)
 
+#define ILLUMINATIR_CHANNELVALUEPAIRS_MINSIZE 2  ///< Minimum size of the pairs in a ChannelValuePairs type packet. (1 pair)
+#define ILLUMINATIR_CHANNELVALUEPAIRS_MAXSIZE 17 ///< Maximum size of the pairs in a ChannelValuePairs type packet. (8 pairs + 1 channel defaulting to value 0)
+
 #define ILLUMINATIR_CONFIG_KEY_MINLEN     0  ///< Minimum number of key characters in a Config type packet. (2 value bytes)
 #define ILLUMINATIR_CONFIG_KEY_MAXLEN     17 ///< Maximum number of key characters in a Config type packet. (no value bytes, no delimiter)
 #define ILLUMINATIR_CONFIG_VALUES_MINSIZE 0  ///< Minimum number of value data in a Config type packet. (1 key character + delimiter OR 2 key characters, no delimiter)
 #define ILLUMINATIR_CONFIG_VALUES_MAXSIZE 16 ///< Maximum number of value data in a Config type packet. (delimiter + 16 value bytes)
 
+#define ILLUMINATIR_CHANNELS 256 ///< Number of channels.
+
 
 /**
  * \brief Error return codes.
@@ -248,6 +257,117 @@ typedef void (*illuminatir_parse_setConfig_t)( const char * key, uint8_t key_len
  */
 illuminatir_error_t illuminatir_parse( const uint8_t * packet, uint8_t packet_size, illuminatir_parse_setChannel_t setChannelFunc, illuminatir_parse_setConfig_t setConfigFunc );
 
+/**
+ * \brief Signature of a function that sets a contiguous range of channels.
+ *
+ * \note Ranges never wrap around. An OffsetArray crossing channel 255 is delivered as two calls.
+ * \param ctx           User context pointer from \ref illuminatir_handler_t.
+ * \param first_channel Channel number of \p values[0].
+ * \param values        New channel values.
+ * \param count         Number of channels in \p values.
+ */
+typedef void (*illuminatir_handler_setChannels_t)( void * ctx, uint8_t first_channel, const uint8_t * values, uint8_t count );
+
+/**
+ * \brief Signature of a function that sets a batch of channels given as channel/value pairs.
+ *
+ * \param ctx   User context pointer from \ref illuminatir_handler_t.
+ * \param pairs Interleaved channel and value bytes (channel 0, value 0, ..., channel N, value N).
+ * \param count Number of pairs in \p pairs.
+ */
+typedef void (*illuminatir_handler_setChannelValuePairs_t)( void * ctx, const uint8_t * pairs, uint8_t count );
+
+/**
+ * \brief Signature of a function that handles configuration key/values.
+ *
+ * \attention The \p key string is not NULL-terminated! The length is stored in \p key_len!
+ * \param ctx         User context pointer from \ref illuminatir_handler_t.
+ * \param key         Non-NULL terminated key string.
+ * \param key_len     The size of \p key in characters.
+ * \param values      The key's new value(s). This is a generic byte array of size \p values_size.
+ * \param values_size Size of \p values in bytes.
+ */
+typedef void (*illuminatir_handler_setConfig_t)( void * ctx, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size );
+
+/**
+ * \brief A set of functions receiving parsed payloads, sharing a user context pointer.
+ *
+ * Any of the functions may be NULL to ignore the respective payloads.
+ * If \c setChannelValuePairs is NULL, ChannelValuePairs are delivered to \c setChannels one pair at a time instead.
+ */
+typedef struct {
+	void *                                     ctx;                  ///< User context pointer passed to all functions.
+	illuminatir_handler_setChannels_t          setChannels;          ///< Called once per OffsetArray payload.
+	illuminatir_handler_setChannelValuePairs_t setChannelValuePairs; ///< Called once per ChannelValuePairs payload.
+	illuminatir_handler_setConfig_t            setConfig;            ///< Called once per Config payload.
+} illuminatir_handler_t;
+
+/**
+ * \brief A version of \ref illuminatir_parse calling the functions of a \ref illuminatir_handler_t.
+ *
+ * \param packets      Pointer to one or more packets.
+ * \param packets_size Size of \p packets in bytes.
+ * \param handler      Pointer to the handler receiving the payloads.
+ */
+illuminatir_error_t illuminatir_parse_handler( const uint8_t * packets, uint8_t packets_size, const illuminatir_handler_t * handler );
+
+/**
+ * \brief One bit per channel, e.g. marking channels whose value changed.
+ */
+typedef struct {
+	uint32_t bits[ILLUMINATIR_CHANNELS / 32]; ///< Bit (channel % 32) of bits[channel / 32] belongs to channel.
+} illuminatir_channelMask_t;
+
+/**
+ * \brief Clears all bits of a channel mask.
+ *
+ * \param mask Pointer to a channel mask.
+ */
+static inline void illuminatir_channelMask_clear( illuminatir_channelMask_t * mask )
+{
+	for( uint8_t i = 0; i < ILLUMINATIR_CHANNELS / 32; i++ ) {
+		mask->bits[i] = 0;
+	}
+}
+
+/**
+ * \brief Sets the bit of a single channel.
+ *
+ * \param mask    Pointer to a channel mask.
+ * \param channel Channel number.
+ */
+static inline void illuminatir_channelMask_set( illuminatir_channelMask_t * mask, uint8_t channel )
+{
+	mask->bits[channel >> 5] |= (uint32_t)1 << (channel & 31);
+}
+
+/**
+ * \brief Tests the bit of a single channel.
+ *
+ * \param mask    Pointer to a channel mask.
+ * \param channel Channel number.
+ * \returns Non-zero if the channel's bit is set.
+ */
+static inline uint32_t illuminatir_channelMask_isSet( const illuminatir_channelMask_t * mask, uint8_t channel )
+{
+	return mask->bits[channel >> 5] & ((uint32_t)1 << (channel & 31));
+}
+
+/**
+ * \brief Parses packets directly into an array of channel values.
+ *
+ * OffsetArray payloads are copied as a block and ChannelValuePairs are scattered into \p universe without any per-channel function calls.
+ * The bits of all channels whose value actually changed are set in \p dirty.
+ * Bits already set in \p dirty are kept, so it may accumulate changes over several calls until it is cleared by \ref illuminatir_channelMask_clear.
+ *
+ * \param packets       Pointer to one or more packets.
+ * \param packets_size  Size of \p packets in bytes.
+ * \param universe      Pointer to an array of \ref ILLUMINATIR_CHANNELS channel values.
+ * \param dirty         Pointer to a channel mask receiving the changed channels. May be NULL.
+ * \param setConfigFunc Pointer to a function that is called when Config type payloads are parsed. May be NULL.
+ */
+illuminatir_error_t illuminatir_parse_into( const uint8_t * packets, uint8_t packets_size, uint8_t * universe, illuminatir_channelMask_t * dirty, illuminatir_parse_setConfig_t setConfigFunc );
+
 /**
  * \brief Builds an OffsetArray packet.
  *
@@ -259,6 +379,16 @@ illuminatir_error_t illuminatir_parse( const uint8_t * packet, uint8_t packet_si
  */
 illuminatir_error_t illuminatir_build_offsetArray( uint8_t * packet, uint8_t * packet_size, uint8_t offset, const uint8_t * values, uint8_t values_size );
 
+/**
+ * \brief Builds a ChannelValuePairs packet.
+ *
+ * \param packet      Pointer to a buffer.
+ * \param packet_size Size of \p packet buffer in bytes.
+ * \param pairs       Pointer to an array of alternating channel numbers and values. If \p pairs_size is odd, the last channel is set to 0.
+ * \param pairs_size  Size of \p pairs in bytes.
+ */
+illuminatir_error_t illuminatir_build_channelValuePairs( uint8_t * packet, uint8_t * packet_size, const uint8_t * pairs, uint8_t pairs_size );
+
 /**
  * \brief Builds a Config packet.
  *
@@ -319,6 +449,22 @@ static inline uint8_t illuminatir_header_getPacketSize( uint8_t header )
  */
 uint8_t illuminatir_crc8( const uint8_t * data, size_t data_size, uint8_t crc );
 
+/**
+ * \brief Kernels for 8 bit CRC calculation.
+ *
+ * These take the same parameters and return the same result as \ref illuminatir_crc8, which picks one of them depending on \p data_size and the host CPU.
+ * As the seed semantics are identical, consecutive chunks of the same data may be processed by different kernels.
+ * \note Slicing needs 2 KiB of extra tables and is disabled on AVR (override with ILLUMINATIR_CRC8_SLICING). Kernels that are not available fall back to the next simpler one.
+ * @{
+ */
+uint8_t illuminatir_crc8_bytewise( const uint8_t * data, size_t data_size, uint8_t crc ); ///< One table lookup per byte.
+uint8_t illuminatir_crc8_slice4( const uint8_t * data, size_t data_size, uint8_t crc );   ///< Slice-by-4, processing 4 bytes per step.
+uint8_t illuminatir_crc8_slice8( const uint8_t * data, size_t data_size, uint8_t crc );   ///< Slice-by-8, processing 8 bytes per step.
+uint8_t illuminatir_crc8_clmul( const uint8_t * data, size_t data_size, uint8_t crc );    ///< Carry-less multiplication folding over 64 byte blocks (x86-64 with PCLMULQDQ, otherwise slice-by-8).
+/**
+ * @}
+ */
+
 /**
  * @}
  */
@@ -340,7 +486,9 @@ uint8_t illuminatir_crc8( const uint8_t * data, size_t data_size, uint8_t crc );
 /**
  * \brief COBS encode.
  *
- * Encodes \p src using COBS.
+ * Encodes \p src using COBS. No delimiter is appended.
+ * Works on whole blocks, so it is also suited for large buffers. On x86 zero bytes are searched using SSE2 or AVX2 (override with ILLUMINATIR_COBS_SIMD).
+ * Encoding in place is possible if \p src starts at least <tt>ILLUMINATIR_COBS_ENCODE_DST_MAXSIZE(src_size) - src_size</tt> bytes behind \p dst within the same buffer.
  * \param dst      Pointer to destination buffer. Should be at least \ref ILLUMINATIR_COBS_ENCODE_DST_MAXSIZE(src_size) bytes in size.
  * \param dst_size Size of destination buffer.
  * \param src      Pointer to source buffer.
@@ -362,11 +510,13 @@ size_t illuminatir_cobs_encode( uint8_t * dst, size_t dst_size, const uint8_t *
 size_t illuminatir_cobs_decode( uint8_t * dst, size_t dst_size, const uint8_t * src, size_t src_size );
 
 illuminatir_error_t illuminatir_cobs_parse( const uint8_t * cobsPackets, uint8_t cobsPacket_sizes, illuminatir_parse_setChannel_t setChannelFunc, illuminatir_parse_setConfig_t setConfigFunc ); ///< A version of \ref illuminatir_parse for COBS encoded packets.
+illuminatir_error_t illuminatir_cobs_parse_handler( const uint8_t * cobsPackets, uint8_t cobsPackets_size, const illuminatir_handler_t * handler ); ///< A version of \ref illuminatir_parse_handler for COBS encoded packets.
+illuminatir_error_t illuminatir_cobs_parse_into( const uint8_t * cobsPackets, uint8_t cobsPackets_size, uint8_t * universe, illuminatir_channelMask_t * dirty, illuminatir_parse_setConfig_t setConfigFunc ); ///< A version of \ref illuminatir_parse_into for COBS encoded packets.
 
 /**
  * \brief A version of \ref illuminatir_build_offsetArray building a COBS encoded packet.
  *
- * \note In contrast to \ref illuminatir_build_offsetArray, COBS encoded packets cannot be concatenated. Instead you have to concatenate them in advance and use \ref illuminatir_cobs_encode to encode them at once.
+ * \note In contrast to \ref illuminatir_build_offsetArray, COBS encoded packets cannot be concatenated. Instead you have to concatenate them in advance and use \ref illuminatir_cobs_encode to encode them at once, or use the \ref Frame builder.
  *
  * \param cobsPacket      Pointer to a buffer.
  * \param cobsPacket_size Size of \p cobsPacket buffer in bytes.
@@ -376,10 +526,22 @@ illuminatir_error_t illuminatir_cobs_parse( const uint8_t * cobsPackets, uint8_t
  */
 illuminatir_error_t illuminatir_cobs_build_offsetArray( uint8_t * cobsPacket, uint8_t * cobsPacket_size, uint8_t offset, const uint8_t * values, uint8_t values_size );
 
+/**
+ * \brief A version of \ref illuminatir_build_channelValuePairs building a COBS encoded packet.
+ *
+ * \note In contrast to \ref illuminatir_build_channelValuePairs, COBS encoded packets cannot be concatenated. Instead you have to concatenate them in advance and use \ref illuminatir_cobs_encode to encode them at once, or use the \ref Frame builder.
+ *
+ * \param cobsPacket      Pointer to a buffer.
+ * \param cobsPacket_size Size of \p cobsPacket buffer in bytes.
+ * \param pairs           Pointer to an array of alternating channel numbers and values.
+ * \param pairs_size      Size of \p pairs in bytes.
+ */
+illuminatir_error_t illuminatir_cobs_build_channelValuePairs( uint8_t * cobsPacket, uint8_t * cobsPacket_size, const uint8_t * pairs, uint8_t pairs_size );
+
 /**
  * \brief A version of \ref illuminatir_build_config building a COBS encoded packet.
  *
- * \note In contrast to \ref illuminatir_build_config, COBS encoded packets cannot be concatenated. Instead you have to concatenate them in advance and use \ref illuminatir_cobs_encode to encode them at once.
+ * \note In contrast to \ref illuminatir_build_config, COBS encoded packets cannot be concatenated. Instead you have to concatenate them in advance and use \ref illuminatir_cobs_encode to encode them at once, or use the \ref Frame builder.
  *
  * \param cobsPacket      Pointer to a buffer.
  * \param cobsPacket_size Size of \p cobsPacket buffer in bytes.
@@ -401,9 +563,17 @@ illuminatir_error_t illuminatir_cobs_build_config( uint8_t * cobsPacket, uint8_t
  *
  * Provides a linear feedback shift register for use in pseudo random number generation.
  * \note For general use cases you would not need these functions. It is however exported in case you need a known sequence of pseudo random numbers.
+ * \note \ref illuminatir_lfsr127_init and \ref illuminatir_lfsr127_uint8 share a single global state. Use \ref illuminatir_lfsr127_init_r and \ref illuminatir_lfsr127_uint8_r with an own \ref illuminatir_lfsr127_t per thread instead.
  * @{
  */
 
+/**
+ * \brief State of a LFSR.
+ */
+typedef struct {
+	uint8_t state; ///< The shift register.
+} illuminatir_lfsr127_t;
+
 /**
  * \brief Initializes the LFSR for \ref illuminatir_lfsr127_uint8.
  *
@@ -424,6 +594,9 @@ void illuminatir_lfsr127_init( uint8_t seed );
  * \return random number
  */
 uint8_t illuminatir_lfsr127_uint8( void );
+
+void illuminatir_lfsr127_init_r( illuminatir_lfsr127_t * lfsr, uint8_t seed ); ///< A reentrant version of \ref illuminatir_lfsr127_init initializing \p lfsr.
+uint8_t illuminatir_lfsr127_uint8_r( illuminatir_lfsr127_t * lfsr );           ///< A reentrant version of \ref illuminatir_lfsr127_uint8 advancing \p lfsr.
 /**
  * @}
  */
@@ -435,6 +608,7 @@ uint8_t illuminatir_lfsr127_uint8( void );
  *
  * Parse and build randomized packets with roughly even distribution of ones and zeros.
  * All bytes except header and CRC are randomized via \ref LFSR using the CRC as the seed value.
+ * The functions of this module do not touch the global \ref LFSR state and may be called from multiple threads at once.
  * @{
  */
 
@@ -443,17 +617,23 @@ uint8_t illuminatir_lfsr127_uint8( void );
  *
  * The last packet's CRC is used as seed for the pseudo random number generator.
  *
+ * \note By default the keystream is read from a precomputed table of all seeds instead of running the \ref LFSR bit by bit.
+ * Define \c ILLUMINATIR_RAND_TABLE as 0 when building the library (CMake option \c RAND_TABLE) to keep the smaller bitwise implementation for flash constrained targets.
+ * On \c avr-gcc the bitwise implementation is the default (also of the CMake option), and the table is placed in \c PROGMEM if enabled.
+ *
  * \param packets Pointer to a buffer.
  * \param size    Size of \p cobsPacket buffer in bytes.
  */
 void illuminatir_rand( uint8_t * packets, size_t size );
 
 illuminatir_error_t illuminatir_rand_cobs_parse( const uint8_t * cobsPackets, uint8_t cobsPackets_size, illuminatir_parse_setChannel_t setChannelFunc, illuminatir_parse_setConfig_t setConfigFunc ); ///< A version of \ref illuminatir_parse for COBS encoded randomized packets.
+illuminatir_error_t illuminatir_rand_cobs_parse_handler( const uint8_t * randCobsPackets, uint8_t randCobsPackets_size, const illuminatir_handler_t * handler ); ///< A version of \ref illuminatir_parse_handler for COBS encoded randomized packets.
+illuminatir_error_t illuminatir_rand_cobs_parse_into( const uint8_t * randCobsPackets, uint8_t randCobsPackets_size, uint8_t * universe, illuminatir_channelMask_t * dirty, illuminatir_parse_setConfig_t setConfigFunc ); ///< A version of \ref illuminatir_parse_into for COBS encoded randomized packets.
 
 /**
  * \brief A version of \ref illuminatir_build_offsetArray building a COBS encoded randomized packet.
  *
- * \note In contrast to \ref illuminatir_build_offsetArray, COBS encoded randomized packets cannot be concatenated. Instead you have to concatenate them in advance and use \ref illuminatir_rand then \ref illuminatir_cobs_encode to encode them at once.
+ * \note In contrast to \ref illuminatir_build_offsetArray, COBS encoded randomized packets cannot be concatenated. Instead you have to concatenate them in advance and use \ref illuminatir_rand then \ref illuminatir_cobs_encode to encode them at once, or use the \ref Frame builder.
  *
  * \param randCobsPacket      Pointer to a buffer.
  * \param randCobsPacket_size Size of \p cobsPacket buffer in bytes.
@@ -463,10 +643,22 @@ illuminatir_error_t illuminatir_rand_cobs_parse( const uint8_t * cobsPackets, ui
  */
 illuminatir_error_t illuminatir_rand_cobs_build_offsetArray( uint8_t * randCobsPacket, uint8_t * randCobsPacket_size, uint8_t offset, const uint8_t * values, uint8_t values_size );
 
+/**
+ * \brief A version of \ref illuminatir_build_channelValuePairs building a COBS encoded randomized packet.
+ *
+ * \note In contrast to \ref illuminatir_build_channelValuePairs, COBS encoded randomized packets cannot be concatenated. Instead you have to concatenate them in advance and use \ref illuminatir_rand then \ref illuminatir_cobs_encode to encode them at once, or use the \ref Frame builder.
+ *
+ * \param randCobsPacket      Pointer to a buffer.
+ * \param randCobsPacket_size Size of \p cobsPacket buffer in bytes.
+ * \param pairs               Pointer to an array of alternating channel numbers and values.
+ * \param pairs_size          Size of \p pairs in bytes.
+ */
+illuminatir_error_t illuminatir_rand_cobs_build_channelValuePairs( uint8_t * randCobsPacket, uint8_t * randCobsPacket_size, const uint8_t * pairs, uint8_t pairs_size );
+
 /**
  * \brief A version of \ref illuminatir_build_config building a COBS encoded randomized packet.
  *
- * \note In contrast to \ref illuminatir_build_config, COBS encoded randomized packets cannot be concatenated. Instead you have to concatenate them in advance and use \ref illuminatir_rand then \ref illuminatir_cobs_encode to encode them at once.
+ * \note In contrast to \ref illuminatir_build_config, COBS encoded randomized packets cannot be concatenated. Instead you have to concatenate them in advance and use \ref illuminatir_rand then \ref illuminatir_cobs_encode to encode them at once, or use the \ref Frame builder.
  *
  * \param randCobsPacket      Pointer to a buffer.
  * \param randCobsPacket_size Size of \p cobsPacket buffer in bytes.
@@ -482,4 +674,713 @@ illuminatir_error_t illuminatir_rand_cobs_build_config( uint8_t * randCobsPacket
  */
 
 
+/**
+ * @defgroup Frame Frame
+ * \brief Multi-packet frame building.
+ *
+ * Accumulates packets in a caller-owned buffer and finalizes them into a single COBS encoded frame with one delimiter.
+ * Packets are built in place behind some space reserved for the COBS overhead, so finalizing needs no additional buffer.
+ * \code{.c}
+ * uint8_t buffer[ILLUMINATIR_FRAME_BUFFER_SIZE(64)];
+ * illuminatir_frame_t frame;
+ * illuminatir_frame_init( &frame, buffer, sizeof(buffer) );
+ * illuminatir_frame_add_offsetArray( &frame, 0, values, 16 );
+ * illuminatir_frame_add_config( &frame, "W", 1, white, 3 );
+ * size_t frame_size;
+ * illuminatir_rand_cobs_frame_finalize( &frame, &frame_size ); // send buffer[0..frame_size-1]
+ * \endcode
+ * @{
+ */
+
+#define ILLUMINATIR_FRAME_BUFFER_SIZE(PACKETS_SIZE) (ILLUMINATIR_COBS_ENCODE_DST_MAXSIZE(PACKETS_SIZE) + 1U) ///< The buffer size needed for \p PACKETS_SIZE bytes of raw packets. (COBS overhead + delimiter)
+
+/**
+ * \brief State of a frame being built.
+ */
+typedef struct {
+	uint8_t * buffer;      ///< The caller-owned buffer.
+	size_t    buffer_size; ///< Size of \c buffer in bytes.
+	size_t    offset;      ///< Where raw packets start in \c buffer, leaving room for the COBS overhead.
+	size_t    size;        ///< Size of the raw packets added so far.
+} illuminatir_frame_t;
+
+/**
+ * \brief Initializes an empty frame.
+ *
+ * \param frame       Pointer to the frame state.
+ * \param buffer      Pointer to a buffer, see \ref ILLUMINATIR_FRAME_BUFFER_SIZE.
+ * \param buffer_size Size of \p buffer in bytes.
+ */
+illuminatir_error_t illuminatir_frame_init( illuminatir_frame_t * frame, uint8_t * buffer, size_t buffer_size );
+
+/**
+ * \brief Removes all packets from a frame, e.g. to reuse it after finalizing.
+ *
+ * \param frame Pointer to the frame state.
+ */
+void illuminatir_frame_reset( illuminatir_frame_t * frame );
+
+/**
+ * \brief Functions appending a packet to a frame.
+ *
+ * Take the same parameters as the corresponding \c illuminatir_build_* functions and build the packet directly into the frame's buffer.
+ * \returns \ref ILLUMINATIR_ERROR_BUFFER_OVERFLOW if the packet does not fit, leaving the frame unchanged.
+ * @{
+ */
+illuminatir_error_t illuminatir_frame_add_offsetArray( illuminatir_frame_t * frame, uint8_t offset, const uint8_t * values, uint8_t values_size ); ///< Appends an OffsetArray packet, see \ref illuminatir_build_offsetArray.
+illuminatir_error_t illuminatir_frame_add_channelValuePairs( illuminatir_frame_t * frame, const uint8_t * pairs, uint8_t pairs_size ); ///< Appends a ChannelValuePairs packet, see \ref illuminatir_build_channelValuePairs.
+illuminatir_error_t illuminatir_frame_add_config( illuminatir_frame_t * frame, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size ); ///< Appends a Config packet, see \ref illuminatir_build_config.
+illuminatir_error_t illuminatir_frame_add_packets( illuminatir_frame_t * frame, const uint8_t * packets, size_t packets_size ); ///< Appends already built raw packets, e.g. from \ref illuminatir_plan.
+/**
+ * @}
+ */
+
+/**
+ * \brief Finalizes a frame into a COBS encoded frame.
+ *
+ * Encodes all packets at once and appends a single delimiter. The encoded frame starts at the beginning of the frame's buffer.
+ * Afterwards the frame is empty again.
+ * \param frame      Pointer to the frame state.
+ * \param frame_size Set to the size of the encoded frame including its delimiter, 0 if the frame was empty.
+ */
+illuminatir_error_t illuminatir_cobs_frame_finalize( illuminatir_frame_t * frame, size_t * frame_size );
+
+illuminatir_error_t illuminatir_rand_cobs_frame_finalize( illuminatir_frame_t * frame, size_t * frame_size ); ///< A version of \ref illuminatir_cobs_frame_finalize randomizing all packets using \ref illuminatir_rand before encoding.
+
+/**
+ * @}
+ */
+
+
+/**
+ * @defgroup Batch Batch
+ * \brief Building many full OffsetArray packets at once.
+ *
+ * Transmitters refreshing many universes send the same kind of packet over and over: an OffsetArray of \ref ILLUMINATIR_OFFSETARRAY_MAXVALUES channels.
+ * These functions build a whole batch of them, taking the jobs in structure-of-arrays layout so that the same byte of consecutive packets lies next to each other.
+ * Where SSSE3 is available, headers, CRCs, randomization and COBS encoding are computed for 16 packets at once in vector lanes. Otherwise, and for the remainder of a batch, the packets are built one by one.
+ * The output is the same as from \ref illuminatir_cobs_build_offsetArray or \ref illuminatir_rand_cobs_build_offsetArray for every job.
+ * @{
+ */
+
+#define ILLUMINATIR_BATCH_PACKET_SIZE ILLUMINATIR_COBS_ENCODE_DST_MAXSIZE(ILLUMINATIR_PACKET_MAXSIZE) ///< Size of every COBS encoded packet of a batch. (no delimiter)
+
+/**
+ * \brief Builds a batch of COBS encoded OffsetArray packets of \ref ILLUMINATIR_OFFSETARRAY_MAXVALUES channels each.
+ *
+ * \param arena      Pointer to a buffer receiving the encoded packets back to back, job \c n at <tt>arena[n * ILLUMINATIR_BATCH_PACKET_SIZE]</tt>.
+ * \param arena_size Size of \p arena buffer in bytes. Set to the size of all encoded packets.
+ * \param sizes      Pointer to an array of \p count sizes, set to the size of each encoded packet. May be NULL, as all packets are \ref ILLUMINATIR_BATCH_PACKET_SIZE bytes.
+ * \param offsets    Pointer to the \p count offsets, one per job.
+ * \param values     Pointer to the values in structure-of-arrays layout: value \c i of job \c n is <tt>values[i * count + n]</tt>.
+ * \param count      Number of jobs.
+ */
+illuminatir_error_t illuminatir_cobs_build_offsetArrays( uint8_t * arena, size_t * arena_size, uint8_t * sizes, const uint8_t * offsets, const uint8_t * values, size_t count );
+
+illuminatir_error_t illuminatir_rand_cobs_build_offsetArrays( uint8_t * arena, size_t * arena_size, uint8_t * sizes, const uint8_t * offsets, const uint8_t * values, size_t count ); ///< A version of \ref illuminatir_cobs_build_offsetArrays randomizing the packets as \ref illuminatir_rand_cobs_build_offsetArray does.
+
+/**
+ * @}
+ */
+
+
+/**
+ * @defgroup Plan Plan
+ * \brief Delta packet planning.
+ *
+ * Finds the packets to send for a change from one universe of channel values to the next, using close to the least number of bytes.
+ * Changed channels are sent either as OffsetArray runs of up to \ref ILLUMINATIR_OFFSETARRAY_MAXVALUES values, which may wrap around from channel 255 to 0 and include unchanged channels in between, or as ChannelValuePairs for sparse changes.
+ * Header, CRC and framing bytes are accounted for per packet.
+ *
+ * The search is exact for OffsetArrays and full ChannelValuePairs.
+ * Channels changing to 0 are moved to trailing half pairs afterwards where that saves bytes, so changes to 0 may take a few bytes more than the optimum.
+ * @{
+ */
+
+#define ILLUMINATIR_PLAN_OVERHEAD_RAW  0 ///< Per packet framing overhead for raw packets or for packets concatenated into a single frame.
+#define ILLUMINATIR_PLAN_OVERHEAD_COBS 2 ///< Per packet framing overhead for individually COBS encoded packets. (code byte + delimiter)
+#define ILLUMINATIR_PLAN_MAXSIZE ((ILLUMINATIR_CHANNELS / ILLUMINATIR_OFFSETARRAY_MAXVALUES) * ILLUMINATIR_PACKET_MAXSIZE) ///< Maximum size of planned packets. (all channels changed)
+
+/**
+ * \brief Plans the packets for a change of channel values.
+ *
+ * The planned packets are written concatenated into \p packets and set the channels of \p previous to \p next when parsed.
+ * They may be encoded one by one using \ref illuminatir_cobs_encode, or all at once as a single frame.
+ * \note This uses about 16 KiB of stack and is intended for transmitters, not for small microcontrollers.
+ *
+ * \param packets         Pointer to a buffer. \ref ILLUMINATIR_PLAN_MAXSIZE bytes are always sufficient.
+ * \param packets_size    Size of \p packets buffer in bytes. Set to the size of the planned packets, 0 if no channel changed.
+ * \param previous        Pointer to the \ref ILLUMINATIR_CHANNELS values known to the receiver. May be NULL to send all channels.
+ * \param next            Pointer to the \ref ILLUMINATIR_CHANNELS values to send.
+ * \param packet_overhead Framing bytes added to every packet, e.g. \ref ILLUMINATIR_PLAN_OVERHEAD_COBS.
+ */
+illuminatir_error_t illuminatir_plan( uint8_t * packets, size_t * packets_size, const uint8_t * previous, const uint8_t * next, uint8_t packet_overhead );
+
+/**
+ * @}
+ */
+
+
+/**
+ * @defgroup Schedule Schedule
+ * \brief Deadline driven transmit scheduling.
+ *
+ * IR links are unidirectional and lossy, so receivers that miss a packet or are switched on late only converge through periodic refreshes.
+ * The scheduler sends the universe as \ref ILLUMINATIR_SCHEDULE_BLOCKS OffsetArray packets of \ref ILLUMINATIR_OFFSETARRAY_MAXVALUES channels each, plus pending Config packets.
+ * Packets are picked earliest deadline first:
+ * - Blocks with changed channels are due \c latency_us after the change was noticed.
+ * - Unchanged blocks are due \c refresh_us after they were sent last. As the scheduler keeps the link busy, they are refreshed round-robin in any leftover airtime.
+ * - Config packets are released when scheduled and then every \c interval_us while repeated, and are due \c latency_us after their release.
+ *
+ * The link is paced with a token bucket from the bit rate, holding at most one packet.
+ * \ref illuminatir_schedule_getStaleness gives the worst case time from a change until the channel was sent.
+ * @{
+ */
+
+#define ILLUMINATIR_SCHEDULE_BLOCKS  (ILLUMINATIR_CHANNELS / ILLUMINATIR_OFFSETARRAY_MAXVALUES) ///< Number of OffsetArray blocks the universe is sent in.
+#define ILLUMINATIR_SCHEDULE_CONFIGS 8 ///< Number of Config packets that may be pending at once.
+
+/**
+ * \brief A pending Config packet.
+ */
+typedef struct {
+	uint8_t  packet[ILLUMINATIR_PACKET_MAXSIZE]; ///< The built packet.
+	uint8_t  packet_size;                        ///< Size of \c packet, 0 if this slot is unused.
+	uint8_t  key_len;                            ///< Length of the key, which starts at <tt>packet[1]</tt>.
+	uint16_t repeats;                            ///< Remaining repetitions, 0 to repeat forever.
+	uint32_t interval_us;                        ///< Time between repetitions.
+	uint32_t deadline_us;                        ///< When the packet is due next.
+} illuminatir_schedule_config_t;
+
+/**
+ * \brief State of the transmit scheduler.
+ *
+ * The first five members may be adjusted after \ref illuminatir_schedule_init.
+ */
+typedef struct {
+	uint32_t                      bitrate;                                  ///< Link budget in bits per second.
+	uint8_t                       byte_bits;                                ///< Bits on air per byte, 10 by default for an 8N1 UART.
+	uint8_t                       packet_overhead;                          ///< Framing bytes per packet, \ref ILLUMINATIR_PLAN_OVERHEAD_COBS by default.
+	uint32_t                      latency_us;                               ///< Deadline for changed channels, 0 by default. Should not exceed \c refresh_us.
+	uint32_t                      refresh_us;                               ///< Deadline for refreshing unchanged blocks, one second by default.
+	const uint8_t *               universe;                                 ///< The caller-owned channel values to send.
+	uint8_t                       sent[ILLUMINATIR_CHANNELS];               ///< The channel values sent last.
+	uint32_t                      deadline_us[ILLUMINATIR_SCHEDULE_BLOCKS]; ///< When each block is due next.
+	uint16_t                      dirty;                                    ///< Blocks with changes that have not been sent yet.
+	illuminatir_schedule_config_t configs[ILLUMINATIR_SCHEDULE_CONFIGS];    ///< Pending Config packets.
+	uint32_t                      tokens;                                   ///< Bits that may be sent right now.
+	uint32_t                      last_us;                                  ///< Time up to which \c tokens were accounted.
+} illuminatir_schedule_t;
+
+/**
+ * \brief Initializes a transmit scheduler.
+ *
+ * All blocks are due immediately. Timestamps are in microseconds from any monotonic clock and may wrap around.
+ * \param sched    Pointer to the scheduler state.
+ * \param universe Pointer to the \ref ILLUMINATIR_CHANNELS channel values to send. Changes are noticed on the next call to \ref illuminatir_schedule_next.
+ * \param bitrate  Link budget in bits per second.
+ * \param now_us   The current time.
+ */
+illuminatir_error_t illuminatir_schedule_init( illuminatir_schedule_t * sched, const uint8_t * universe, uint32_t bitrate, uint32_t now_us );
+
+/**
+ * \brief Schedules a Config packet.
+ *
+ * Replaces a pending Config packet with the same key, compared case-insensitively.
+ * \param sched       Pointer to the scheduler state.
+ * \param key         Key string.
+ * \param key_len     The length of \p key in characters (NULL character excluded).
+ * \param values      The key's value(s).
+ * \param values_size Size of \p values in bytes.
+ * \param repeats     How often to send the packet, 0 to repeat it forever.
+ * \param interval_us Time between repetitions. Must not be 0 if \p repeats is 0.
+ * \param now_us      The current time.
+ * \returns \ref ILLUMINATIR_ERROR_BUFFER_OVERFLOW if all \ref ILLUMINATIR_SCHEDULE_CONFIGS slots are in use.
+ */
+illuminatir_error_t illuminatir_schedule_config( illuminatir_schedule_t * sched, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size, uint16_t repeats, uint32_t interval_us, uint32_t now_us );
+
+/**
+ * \brief Gets the next packet to send.
+ *
+ * Call this whenever the link is able to send. Nothing is returned while the bit rate budget is used up.
+ * \param sched       Pointer to the scheduler state.
+ * \param now_us      The current time.
+ * \param packet      Pointer to a buffer of at least \ref ILLUMINATIR_PACKET_MAXSIZE bytes.
+ * \param packet_size Size of \p packet buffer in bytes. Set to the size of the raw packet to send, 0 if nothing should be sent now.
+ */
+illuminatir_error_t illuminatir_schedule_next( illuminatir_schedule_t * sched, uint32_t now_us, uint8_t * packet, uint8_t * packet_size );
+
+/**
+ * \brief Gets the worst case staleness of a channel.
+ *
+ * This is the longest time from a change being noticed until the channel was sent, given that \ref illuminatir_schedule_next is called whenever possible.
+ * It accounts for the packet on air, all other blocks and all repetitions of pending Config packets in that time.
+ * A receiver that lost a packet is updated at the latest \c refresh_us plus this time later.
+ * \param sched Pointer to the scheduler state.
+ * \returns The staleness in microseconds, UINT32_MAX if repeated Config packets use up the link.
+ */
+uint32_t illuminatir_schedule_getStaleness( const illuminatir_schedule_t * sched );
+
+/**
+ * @}
+ */
+
+
+/**
+ * @defgroup Fade Fade
+ * \brief Fixed-point crossfades for transmitters.
+ *
+ * Interpolates all channels from a start to a target universe over a duration, shaped by a curve.
+ * Each tick computes the channel values for the current time in 8.8 fixed-point and marks only the channels whose value changed since the last tick, so airtime follows the visible change and not the length of the fade.
+ * The values may be passed directly to \ref illuminatir_schedule_init or \ref illuminatir_plan. Fades are independent of each other, one per universe.
+ * \code{.c}
+ * illuminatir_fade_t fade;
+ * illuminatir_fade_init( &fade, previous, next, 2000000, ILLUMINATIR_FADE_SMOOTH, now_us );
+ * while( !fade.done ) {
+ *     illuminatir_channelMask_t changed;
+ *     illuminatir_channelMask_clear( &changed );
+ *     illuminatir_fade_tick( &fade, now_us, &changed ); // send the changed channels of fade.values
+ * }
+ * \endcode
+ * @{
+ */
+
+/**
+ * \brief The shape of a fade over time.
+ */
+typedef enum {
+	ILLUMINATIR_FADE_LINEAR,   ///< Constant speed.
+	ILLUMINATIR_FADE_EASE_IN,  ///< Starts slow, quadratic.
+	ILLUMINATIR_FADE_EASE_OUT, ///< Ends slow, quadratic.
+	ILLUMINATIR_FADE_SMOOTH,   ///< Starts and ends slow, smoothstep.
+} illuminatir_fade_curve_t;
+
+/**
+ * \brief State of a fade.
+ */
+typedef struct {
+	uint8_t  start[ILLUMINATIR_CHANNELS];  ///< The channel values at the beginning.
+	uint8_t  target[ILLUMINATIR_CHANNELS]; ///< The channel values at the end.
+	uint8_t  values[ILLUMINATIR_CHANNELS]; ///< The channel values of the last tick.
+	uint32_t start_us;                     ///< When the fade began.
+	uint32_t duration_us;                  ///< How long the fade takes.
+	uint8_t  curve;                        ///< The \ref illuminatir_fade_curve_t.
+	uint8_t  done;                         ///< Non-zero once \c values reached \c target.
+} illuminatir_fade_t;
+
+/**
+ * \brief Begins a fade.
+ *
+ * Timestamps are in microseconds from any monotonic clock and may wrap around.
+ * \param fade        Pointer to the fade state.
+ * \param start       Pointer to the \ref ILLUMINATIR_CHANNELS channel values to begin with. May be NULL to continue from the values of the last tick, e.g. to fade to another target from within a running fade.
+ * \param target      Pointer to the \ref ILLUMINATIR_CHANNELS channel values to end with.
+ * \param duration_us How long the fade takes, up to about 71 minutes. 0 reaches the target on the first tick.
+ * \param curve       The shape of the fade.
+ * \param now_us      The current time.
+ */
+illuminatir_error_t illuminatir_fade_init( illuminatir_fade_t * fade, const uint8_t * start, const uint8_t * target, uint32_t duration_us, illuminatir_fade_curve_t curve, uint32_t now_us );
+
+/**
+ * \brief Computes the channel values for the current time.
+ *
+ * \param fade    Pointer to the fade state.
+ * \param now_us  The current time.
+ * \param changed Pointer to a channel mask, or NULL. The bits of all channels whose value changed since the last tick are set, other bits are kept.
+ */
+illuminatir_error_t illuminatir_fade_tick( illuminatir_fade_t * fade, uint32_t now_us, illuminatir_channelMask_t * changed );
+
+/**
+ * @}
+ */
+
+
+/**
+ * @defgroup Cache Cache
+ * \brief Encoded frame cache.
+ *
+ * Shows tend to send the same looks and Config packets over and over. The cache keeps their finished wire bytes, built, randomized and COBS encoded including the delimiter, keyed by their logical content.
+ * Sending them again is then a lookup and a copy instead of building, checksumming, randomizing and encoding them again.
+ *
+ * The entries are caller-owned, so the memory footprint is fixed. When all entries are in use, the least recently used one is evicted.
+ * Entries are found through hash chains, using the entries array as buckets as well.
+ * \code{.c}
+ * illuminatir_cache_entry_t entries[16];
+ * illuminatir_cache_t cache;
+ * illuminatir_cache_init( &cache, entries, 16 );
+ * const uint8_t * frame;
+ * size_t frame_size;
+ * illuminatir_rand_cobs_cache_config( &cache, "Base", 4, NULL, 0, &frame, &frame_size ); // send frame[0..frame_size-1]
+ * \endcode
+ * @{
+ */
+
+#if !defined(ILLUMINATIR_CACHE_KEY_MAXSIZE)
+#	define ILLUMINATIR_CACHE_KEY_MAXSIZE ILLUMINATIR_CHANNELS ///< Maximum size of keys in bytes. Must be the same for the library and its users.
+#endif
+#if !defined(ILLUMINATIR_CACHE_FRAME_MAXSIZE)
+#	define ILLUMINATIR_CACHE_FRAME_MAXSIZE ILLUMINATIR_FRAME_BUFFER_SIZE(ILLUMINATIR_PLAN_MAXSIZE) ///< Maximum size of cached frames in bytes, enough for a whole universe. Must be the same for the library and its users.
+#endif
+
+/**
+ * \brief A cache entry.
+ */
+typedef struct {
+	uint32_t hash;                                   ///< Hash of \c kind and \c key.
+	uint16_t head;                                   ///< First entry of the hash bucket with this entry's index.
+	uint16_t chain;                                  ///< Next entry in the same hash bucket.
+	uint16_t older;                                  ///< Next less recently used entry.
+	uint16_t newer;                                  ///< Next more recently used entry.
+	uint8_t  kind;                                   ///< What the key describes, keeping keys of different functions apart.
+	uint16_t key_size;                               ///< Size of \c key in bytes.
+	uint16_t frame_size;                             ///< Size of \c frame in bytes.
+	uint8_t  key[ILLUMINATIR_CACHE_KEY_MAXSIZE];     ///< The logical content.
+	uint8_t  frame[ILLUMINATIR_CACHE_FRAME_MAXSIZE]; ///< The wire bytes.
+} illuminatir_cache_entry_t;
+
+/**
+ * \brief State of a cache.
+ */
+typedef struct {
+	illuminatir_cache_entry_t * entries;       ///< The caller-owned entries.
+	uint16_t                    entries_count; ///< Number of \c entries.
+	uint16_t                    used;          ///< Number of entries in use.
+	uint16_t                    newest;        ///< The most recently used entry.
+	uint16_t                    oldest;        ///< The least recently used entry.
+	uint32_t                    hits;          ///< Lookups that found an entry.
+	uint32_t                    misses;        ///< Lookups that did not find an entry.
+	uint32_t                    evictions;     ///< Entries replaced to make room for others.
+} illuminatir_cache_t;
+
+/**
+ * \brief Initializes an empty cache.
+ *
+ * \param cache         Pointer to the cache state.
+ * \param entries       Pointer to an array of entries.
+ * \param entries_count Number of \p entries, at least 1 and less than 0xffff.
+ */
+illuminatir_error_t illuminatir_cache_init( illuminatir_cache_t * cache, illuminatir_cache_entry_t * entries, uint16_t entries_count );
+
+/**
+ * \brief Looks up a frame stored with \ref illuminatir_cache_put.
+ *
+ * \param cache      Pointer to the cache state.
+ * \param key        The logical content of the frame.
+ * \param key_size   Size of \p key in bytes.
+ * \param frame_size Set to the size of the frame, 0 if it was not found.
+ * \returns Pointer to the cached frame, valid until the next change of the cache. NULL if it was not found.
+ */
+const uint8_t * illuminatir_cache_get( illuminatir_cache_t * cache, const uint8_t * key, uint16_t key_size, size_t * frame_size );
+
+/**
+ * \brief Stores a frame, replacing any frame with the same key.
+ *
+ * \param cache      Pointer to the cache state.
+ * \param key        The logical content of the frame.
+ * \param key_size   Size of \p key in bytes, at most \ref ILLUMINATIR_CACHE_KEY_MAXSIZE.
+ * \param frame      The wire bytes.
+ * \param frame_size Size of \p frame in bytes, at most \ref ILLUMINATIR_CACHE_FRAME_MAXSIZE.
+ */
+illuminatir_error_t illuminatir_cache_put( illuminatir_cache_t * cache, const uint8_t * key, uint16_t key_size, const uint8_t * frame, size_t frame_size );
+
+/**
+ * \brief Gets a frame holding a single COBS encoded Config packet, building it if it was not cached.
+ *
+ * The parameters are the same as for \ref illuminatir_build_config.
+ * \param cache      Pointer to the cache state.
+ * \param frame      Set to the cached frame including its delimiter, valid until the next change of the cache.
+ * \param frame_size Set to the size of the frame.
+ */
+illuminatir_error_t illuminatir_cobs_cache_config( illuminatir_cache_t * cache, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size, const uint8_t ** frame, size_t * frame_size );
+
+illuminatir_error_t illuminatir_rand_cobs_cache_config( illuminatir_cache_t * cache, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size, const uint8_t ** frame, size_t * frame_size ); ///< A version of \ref illuminatir_cobs_cache_config randomizing the packet using \ref illuminatir_rand before encoding.
+
+/**
+ * \brief Gets a frame setting all channels, building it if it was not cached.
+ *
+ * The frame holds \ref ILLUMINATIR_SCHEDULE_BLOCKS OffsetArray packets, encoded at once as by \ref illuminatir_cobs_frame_finalize.
+ * \param cache      Pointer to the cache state.
+ * \param universe   Pointer to the \ref ILLUMINATIR_CHANNELS channel values.
+ * \param frame      Set to the cached frame including its delimiter, valid until the next change of the cache.
+ * \param frame_size Set to the size of the frame.
+ */
+illuminatir_error_t illuminatir_cobs_cache_universe( illuminatir_cache_t * cache, const uint8_t * universe, const uint8_t ** frame, size_t * frame_size );
+
+illuminatir_error_t illuminatir_rand_cobs_cache_universe( illuminatir_cache_t * cache, const uint8_t * universe, const uint8_t ** frame, size_t * frame_size ); ///< A version of \ref illuminatir_cobs_cache_universe randomizing all packets as by \ref illuminatir_rand_cobs_frame_finalize.
+
+/**
+ * @}
+ */
+
+
+/**
+ * @defgroup ConfigTable ConfigTable
+ * \brief Dispatching Config packets to handlers by their key.
+ *
+ * A device declares the keys it knows once, each with a handler for the type of its values.
+ * When the table is initialized a seed is searched that hashes every key to a slot of its own, a perfect hash.
+ * Dispatching a key then takes one hash over its characters and a single comparison against the key in that slot, which is needed to reject unknown keys.
+ * Keys are case insensitive, as the protocol defines, for ASCII letters.
+ * \code{.c}
+ * static const illuminatir_configKey_t keys[] = {
+ * 	{ "Base",        ILLUMINATIR_CONFIGKEY_UINT8, { .uint8 = setBase } },
+ * 	{ "MakeDefault", ILLUMINATIR_CONFIGKEY_VOID,  { .none = makeDefault } },
+ * };
+ * illuminatir_configTable_t table;
+ * illuminatir_configTable_init( &table, keys, 2, device );
+ * illuminatir_handler_t handler = illuminatir_configTable_handler( &table );
+ * \endcode
+ * @{
+ */
+
+#if !defined(ILLUMINATIR_CONFIGTABLE_SLOTS)
+#	define ILLUMINATIR_CONFIGTABLE_SLOTS 32 ///< Maximum number of slots of a table, a power of two. Tables hold up to half as many keys.
+#endif
+
+/**
+ * \brief Types of values a key's handler takes.
+ */
+typedef enum {
+	ILLUMINATIR_CONFIGKEY_VOID,  ///< No values, e.g. a command like "MakeDefault".
+	ILLUMINATIR_CONFIGKEY_UINT8, ///< A single byte, e.g. "Base".
+	ILLUMINATIR_CONFIGKEY_BYTES, ///< Any number of bytes, passed on as they are.
+} illuminatir_configKey_type_t;
+
+/**
+ * \brief A key and its handler.
+ */
+typedef struct {
+	const char *                 key;  ///< NULL-terminated key of 1 to \ref ILLUMINATIR_CONFIG_KEY_MAXLEN characters.
+	illuminatir_configKey_type_t type; ///< Selects the member of \c handler.
+	union {
+		void (*none)( void * ctx );                                                 ///< For \ref ILLUMINATIR_CONFIGKEY_VOID.
+		void (*uint8)( void * ctx, uint8_t value );                                 ///< For \ref ILLUMINATIR_CONFIGKEY_UINT8.
+		void (*bytes)( void * ctx, const uint8_t * values, uint8_t values_size ); ///< For \ref ILLUMINATIR_CONFIGKEY_BYTES.
+	} handler;                         ///< Called with the table's context pointer for Config packets with this key.
+} illuminatir_configKey_t;
+
+/**
+ * \brief A perfect hash table of keys.
+ *
+ * All members are private, use the functions of this module.
+ */
+typedef struct {
+	const illuminatir_configKey_t * keys;                                    ///< The caller-owned keys.
+	void *                          ctx;                                     ///< Passed to all handlers.
+	uint32_t                        seed;                                    ///< Seed of the hash, found by \ref illuminatir_configTable_init.
+	uint8_t                         mask;                                    ///< Number of slots used minus one.
+	uint8_t                         slots[ILLUMINATIR_CONFIGTABLE_SLOTS];    ///< Index of the key in each slot plus one, 0 for an empty slot.
+	uint8_t                         key_lens[ILLUMINATIR_CONFIGTABLE_SLOTS]; ///< Length of the key in each slot.
+} illuminatir_configTable_t;
+
+/**
+ * \brief Builds the perfect hash of a set of keys.
+ *
+ * \param table      Pointer to the table.
+ * \param keys       The keys, which must outlive the table.
+ * \param keys_count Number of keys, at most half of \ref ILLUMINATIR_CONFIGTABLE_SLOTS.
+ * \param ctx        User context pointer passed to all handlers.
+ * \returns \ref ILLUMINATIR_ERROR_INVALID_SIZE for too many keys, keys that are too long or empty, \ref ILLUMINATIR_ERROR_UNKNOWN for keys that only differ in case.
+ */
+illuminatir_error_t illuminatir_configTable_init( illuminatir_configTable_t * table, const illuminatir_configKey_t * keys, uint8_t keys_count, void * ctx );
+
+/**
+ * \brief Calls the handler of a key.
+ *
+ * Takes the parameters of \ref illuminatir_parse_setConfig_t.
+ * \param table Pointer to the table.
+ * \returns \ref ILLUMINATIR_ERROR_UNSUPPORTED_FORMAT for unknown keys, \ref ILLUMINATIR_ERROR_INVALID_SIZE if the values do not match the key's type. No handler is called then.
+ */
+illuminatir_error_t illuminatir_configTable_dispatch( const illuminatir_configTable_t * table, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size );
+
+/**
+ * \brief Returns a handler dispatching parsed Config packets to a table.
+ *
+ * The handler's \c setChannels and \c setChannelValuePairs are NULL. They may be set by the caller and then receive \p table as their context.
+ * \param table Pointer to the table, which must outlive the handler.
+ */
+illuminatir_handler_t illuminatir_configTable_handler( illuminatir_configTable_t * table );
+
+/**
+ * @}
+ */
+
+
+/**
+ * @defgroup Stream Stream
+ * \brief Streaming decoder.
+ *
+ * Decodes a stream of COBS encoded (and optionally randomized) packets as it is received, one byte or one chunk at a time.
+ * Frames are delimited by a \c 0x00 byte.
+ * COBS unstuffing, CRC calculation and dispatching to the parse functions or \ref illuminatir_handler_t happen while the bytes arrive, so there is no need to collect and decode whole frames in advance.
+ * After an error all bytes up to the next delimiter are discarded.
+ * @{
+ */
+
+/**
+ * \brief State of a streaming decoder.
+ *
+ * \attention The members are private. Use \ref illuminatir_stream_init or \ref illuminatir_rand_stream_init to initialize it.
+ */
+typedef struct {
+	illuminatir_handler_t          handler;                            ///< Receives the parsed payloads.
+	illuminatir_parse_setChannel_t setChannelFunc;                     ///< Called instead of \c handler if initialized by \ref illuminatir_stream_init.
+	illuminatir_parse_setConfig_t  setConfigFunc;                      ///< Called instead of \c handler if initialized by \ref illuminatir_stream_init.
+	uint8_t *                      frame;                              ///< Buffer for a whole decoded frame. Only used by randomized streams.
+	size_t                         frame_size;                         ///< Size of \c frame in bytes.
+	size_t                         frame_len;                          ///< Number of bytes currently in \c frame.
+	uint8_t                        packet[ILLUMINATIR_PACKET_MAXSIZE]; ///< The packet currently being received.
+	uint8_t                        packet_len;                         ///< Number of bytes currently in \c packet.
+	uint8_t                        packet_size;                        ///< Size of the current packet according to its header.
+	uint8_t                        crc;                                ///< CRC of the current packet up to \c packet_len.
+	uint8_t                        code;                               ///< The current COBS code.
+	uint8_t                        block;                              ///< Remaining data bytes of the current COBS block.
+	uint8_t                        flags;                              ///< Internal state flags.
+} illuminatir_stream_t;
+
+/**
+ * \brief Initializes a streaming decoder for COBS encoded packets.
+ *
+ * \param stream         Pointer to the decoder state.
+ * \param setChannelFunc Pointer to a function that is called when OffsetArray or ChannelValuePairs type payloads are parsed.
+ * \param setConfigFunc  Pointer to a function that is called when Config type payloads are parsed.
+ */
+void illuminatir_stream_init( illuminatir_stream_t * stream, illuminatir_parse_setChannel_t setChannelFunc, illuminatir_parse_setConfig_t setConfigFunc );
+
+/**
+ * \brief Initializes a streaming decoder for COBS encoded randomized packets.
+ *
+ * As the randomization seed is the last byte of a frame, randomized frames are collected in \p frame and dispatched once the delimiter arrives.
+ * Frames larger than \p frame_size are discarded with \ref ILLUMINATIR_ERROR_BUFFER_OVERFLOW.
+ *
+ * \param stream         Pointer to the decoder state.
+ * \param frame          Pointer to a buffer holding one decoded frame. At least \ref ILLUMINATIR_PACKET_MAXSIZE bytes to receive single packet frames.
+ * \param frame_size     Size of \p frame in bytes.
+ * \param setChannelFunc Pointer to a function that is called when OffsetArray or ChannelValuePairs type payloads are parsed.
+ * \param setConfigFunc  Pointer to a function that is called when Config type payloads are parsed.
+ */
+void illuminatir_rand_stream_init( illuminatir_stream_t * stream, uint8_t * frame, size_t frame_size, illuminatir_parse_setChannel_t setChannelFunc, illuminatir_parse_setConfig_t setConfigFunc );
+
+void illuminatir_stream_init_handler( illuminatir_stream_t * stream, const illuminatir_handler_t * handler ); ///< A version of \ref illuminatir_stream_init dispatching to a copy of \p handler.
+void illuminatir_rand_stream_init_handler( illuminatir_stream_t * stream, uint8_t * frame, size_t frame_size, const illuminatir_handler_t * handler ); ///< A version of \ref illuminatir_rand_stream_init dispatching to a copy of \p handler.
+
+/**
+ * \brief Feeds a single received byte to the decoder.
+ *
+ * \param stream Pointer to the decoder state.
+ * \param byte   The received byte.
+ * \return \ref ILLUMINATIR_ERROR_NONE unless this byte completed an invalid packet or frame.
+ */
+illuminatir_error_t illuminatir_stream_feedByte( illuminatir_stream_t * stream, uint8_t byte );
+
+/**
+ * \brief Feeds a chunk of received bytes to the decoder.
+ *
+ * The chunk does not need to be aligned to frame boundaries. Decoding continues after errors.
+ *
+ * \param stream    Pointer to the decoder state.
+ * \param data      Pointer to the received bytes.
+ * \param data_size Size of \p data in bytes.
+ * \return The first error encountered within this chunk or \ref ILLUMINATIR_ERROR_NONE.
+ */
+illuminatir_error_t illuminatir_stream_feed( illuminatir_stream_t * stream, const uint8_t * data, size_t data_size );
+
+/**
+ * @}
+ */
+
+
+/**
+ * @defgroup Stats Stats
+ * \brief Instrumentation counters and histograms.
+ *
+ * If the library is compiled with \c ILLUMINATIR_STATS set to 1, the parse functions and streaming decoders count packets, bytes and errors into the \ref illuminatir_stats_t selected for the calling thread.
+ * Otherwise all counting code is compiled out, and \ref illuminatir_stats_select does nothing.
+ *
+ * Histograms are always available. They collect values like latencies in buckets of powers of two, e.g. the time from a frame's first byte until its packets were dispatched.
+ * @{
+ */
+
+#if !defined(ILLUMINATIR_STATS)
+#	define ILLUMINATIR_STATS 0
+#endif
+
+#define ILLUMINATIR_ERROR_COUNT (ILLUMINATIR_ERROR_INVALID_CRC + 1) ///< Number of \ref illuminatir_error_t codes.
+
+/**
+ * \brief Receiver counters.
+ *
+ * The counters are not atomic. Threads parsing concurrently should select a block of their own.
+ */
+typedef struct {
+	uint32_t packets[4];                      ///< Packets with a valid CRC, indexed by payload type (OffsetArray, ChannelValuePairs, Config, reserved).
+	uint32_t bytes;                           ///< Bytes of decoded packets examined.
+	uint32_t errors[ILLUMINATIR_ERROR_COUNT]; ///< Errors caused by received data, indexed by \ref illuminatir_error_t.
+	uint32_t cobs_errors;                     ///< Malformed COBS data. These also count as \ref ILLUMINATIR_ERROR_INVALID_SIZE.
+	uint32_t resyncs;                         ///< Times a streaming decoder discarded data up to the next delimiter.
+} illuminatir_stats_t;
+
+/**
+ * \brief Selects the counters of the calling thread.
+ *
+ * \param stats Pointer to the counters to use from now on, or NULL to stop counting. Not cleared by this function.
+ * \returns The previously selected counters, NULL if there were none or the library was compiled without \c ILLUMINATIR_STATS.
+ */
+illuminatir_stats_t * illuminatir_stats_select( illuminatir_stats_t * stats );
+
+/**
+ * \brief Clears all counters.
+ *
+ * \param stats Pointer to the counters.
+ */
+void illuminatir_stats_clear( illuminatir_stats_t * stats );
+
+#define ILLUMINATIR_HISTOGRAM_BUCKETS 32 ///< Number of histogram buckets.
+
+/**
+ * \brief A histogram with buckets of powers of two.
+ *
+ * Bucket 0 counts the value 0 and bucket \c i counts values from <tt>2^(i-1)</tt> to <tt>2^i - 1</tt>. The last bucket also counts all larger values.
+ */
+typedef struct {
+	uint32_t buckets[ILLUMINATIR_HISTOGRAM_BUCKETS]; ///< Number of values per bucket.
+	uint32_t count;                                  ///< Number of values recorded.
+	uint32_t max;                                    ///< Largest value recorded.
+	uint64_t sum;                                    ///< Sum of all values recorded.
+} illuminatir_histogram_t;
+
+/**
+ * \brief Clears a histogram.
+ *
+ * \param histogram Pointer to the histogram.
+ */
+void illuminatir_histogram_clear( illuminatir_histogram_t * histogram );
+
+/**
+ * \brief Records a value.
+ *
+ * \param histogram Pointer to the histogram.
+ * \param value     The value, e.g. a latency in microseconds.
+ */
+void illuminatir_histogram_record( illuminatir_histogram_t * histogram, uint32_t value );
+
+/**
+ * \brief Estimates a percentile.
+ *
+ * \param histogram Pointer to the histogram.
+ * \param percent   The percentile from 0 to 100.
+ * \returns The upper bound of the bucket holding the percentile, limited to the largest value recorded. 0 if the histogram is empty.
+ */
+uint32_t illuminatir_histogram_getPercentile( const illuminatir_histogram_t * histogram, uint8_t percent );
+
+/**
+ * @}
+ */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
 #endif
@@ -0,0 +1,572 @@
+/*
+ * IlluminatIR
+ * Copyright (C) 2021  zwostein
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * \brief A header-only C++20 front end of libIlluminatIR.
+ **/
+
+
+#ifndef ILLUMINATIR_HPP_INCLUDED
+#define ILLUMINATIR_HPP_INCLUDED
+
+#include "illuminatir.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+
+/**
+ * @defgroup Cpp C++
+ * \brief Parsing into inlined handlers, building into spans and building at compile time, for C++20.
+ *
+ * The parse functions are templates taking any handler object, usually lambdas combined by \ref illuminatir::overloaded.
+ * The handler is called with a \ref illuminatir::channels_t, \ref illuminatir::channelValuePairs_t or \ref illuminatir::config_t for each payload.
+ * As the packet loop is instantiated for the handler, the compiler can inline it, and lambdas may capture whatever state they need.
+ * Payloads the handler cannot be called with are ignored, like NULL functions of an \ref illuminatir_handler_t.
+ * ChannelValuePairs are delivered as single channels if the handler only takes \ref illuminatir::channels_t.
+ *
+ * Apart from that the functions behave exactly like \ref illuminatir_parse_handler, \ref illuminatir_cobs_parse_handler and \ref illuminatir_rand_cobs_parse_handler, including the \ref Stats counters.
+ * Spans longer than 255 bytes are parsed as a whole, where the C functions take a \c uint8_t size.
+ * \code{.cpp}
+ * uint8_t universe[256];
+ * auto lowerEquals = []( char a, char b ) { return std::tolower( (unsigned char)a ) == b; }; // Config keys are case insensitive
+ * illuminatir_error_t err = illuminatir::cobs_parse( received, illuminatir::overloaded{
+ * 	[&]( illuminatir::channels_t c ) { std::copy( c.values.begin(), c.values.end(), universe + c.first_channel ); },
+ * 	[&]( illuminatir::config_t c ) { if( std::ranges::equal( c.key, std::string_view( "base" ), lowerEquals ) ) base = c.values[0]; },
+ * } );
+ * \endcode
+ * @{
+ */
+
+namespace illuminatir {
+
+/**
+ * \brief A contiguous range of channels of an OffsetArray payload. It never wraps around.
+ */
+struct channels_t {
+	uint8_t                  first_channel; ///< Channel number of \c values[0].
+	std::span<const uint8_t> values;        ///< New channel values.
+};
+
+/**
+ * \brief The channel/value pairs of a ChannelValuePairs payload.
+ */
+struct channelValuePairs_t {
+	std::span<const uint8_t> pairs; ///< Interleaved channel and value bytes, always an even number.
+
+	size_t  count() const { return pairs.size() / 2; }              ///< Number of pairs.
+	uint8_t channel( size_t i ) const { return pairs[2 * i]; }     ///< Channel of pair \p i.
+	uint8_t value( size_t i ) const { return pairs[2 * i + 1]; }   ///< Value of pair \p i.
+};
+
+/**
+ * \brief The key and values of a Config payload.
+ */
+struct config_t {
+	std::string_view         key;    ///< The key, compare case insensitively.
+	std::span<const uint8_t> values; ///< The key's values.
+};
+
+/**
+ * \brief Combines several lambdas into one handler.
+ */
+template< class... Fs >
+struct overloaded : Fs... {
+	using Fs::operator()...;
+};
+template< class... Fs > overloaded( Fs... ) -> overloaded< Fs... >;
+
+/**
+ * \brief The result of a builder.
+ */
+struct built_t {
+	illuminatir_error_t error;  ///< As returned by the C builder.
+	std::span<uint8_t>  packet; ///< The bytes written, empty on errors.
+
+	explicit operator bool() const { return error == ILLUMINATIR_ERROR_NONE; } ///< Whether the packet was built.
+};
+
+
+namespace detail {
+
+// Counts into the Stats selected by the calling thread, like the private macros of the C library.
+struct stats {
+#if ILLUMINATIR_STATS
+	illuminatir_stats_t * current = illuminatir_stats_select( nullptr );
+	stats() { illuminatir_stats_select( current ); }
+	void bytes( size_t n ) { if( current ) current->bytes += (uint32_t)n; }
+	void packet( uint8_t format ) { if( current ) current->packets[format]++; }
+	void cobs() { if( current ) current->cobs_errors++; }
+	illuminatir_error_t error( illuminatir_error_t err ) { if( current ) current->errors[err]++; return err; }
+#else
+	void bytes( size_t ) {}
+	void packet( uint8_t ) {}
+	void cobs() {}
+	illuminatir_error_t error( illuminatir_error_t err ) { return err; }
+#endif
+};
+
+// See illuminatir_dispatch.
+template< class Handler >
+inline illuminatir_error_t dispatch( const uint8_t * packet, Handler & handler, stats & counters )
+{
+	uint8_t format = (packet[0] & 0b00110000) >> 4;
+	counters.packet( format );
+	uint8_t payload_size = illuminatir_header_getPayloadSize( packet[0] );
+	const uint8_t * payload = packet + 1;
+	switch( format ) {
+		case 0: { // OffsetArray - offset + values
+			if constexpr( std::is_invocable_v< Handler &, channels_t > ) {
+				uint8_t offset = *payload++;
+				uint8_t count = payload_size - 1;
+				if( offset + count > 256 ) { // split at the wraparound
+					uint8_t first_count = 256 - offset;
+					handler( channels_t{ offset, { payload, first_count } } );
+					handler( channels_t{ 0, { payload + first_count, (size_t)(count - first_count) } } );
+				} else {
+					handler( channels_t{ offset, { payload, count } } );
+				}
+			}
+			break;
+		}
+		case 1: { // ChannelValuePairs
+			uint8_t pairs = payload_size / 2;
+			uint8_t halfpair = payload_size % 2;
+			uint8_t padded[ILLUMINATIR_PACKET_MAXSIZE - 1];
+			if( halfpair ) { // value of the last pair defaults to 0
+				std::memcpy( padded, payload, payload_size );
+				padded[payload_size] = 0;
+				payload = padded;
+				pairs++;
+			}
+			if constexpr( std::is_invocable_v< Handler &, channelValuePairs_t > ) {
+				handler( channelValuePairs_t{ { payload, (size_t)pairs * 2 } } );
+			} else if constexpr( std::is_invocable_v< Handler &, channels_t > ) {
+				for( ; pairs; pairs--, payload += 2 ) {
+					handler( channels_t{ payload[0], { payload + 1, 1 } } );
+				}
+			}
+			break;
+		}
+		case 2: { // Config - key/value pair
+			if constexpr( std::is_invocable_v< Handler &, config_t > ) {
+				const char * key = (const char *)payload;
+				uint8_t key_len = strnlen( key, payload_size );
+				uint8_t values_size = payload_size - key_len;
+				if( values_size > 0 ) {
+					values_size--;
+				}
+				const uint8_t * values = payload + payload_size - values_size;
+				handler( config_t{ { key, key_len }, { values, values_size } } );
+			}
+			break;
+		}
+		default: {
+			return ILLUMINATIR_ERROR_UNSUPPORTED_FORMAT;
+		}
+	}
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+// See illuminatir_parse_handler.
+template< class Handler >
+inline illuminatir_error_t parse( const uint8_t * packets, size_t packets_size, Handler & handler, stats & counters )
+{
+	if( !packets ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	counters.bytes( packets_size );
+	while( packets_size ) {
+		if( packets_size < ILLUMINATIR_PACKET_MINSIZE ) {
+			return counters.error( ILLUMINATIR_ERROR_PACKET_TOO_SHORT );
+		}
+		uint8_t version = packets[0] >> 6;
+		if( version != 0 ) {
+			return counters.error( ILLUMINATIR_ERROR_UNSUPPORTED_VERSION );
+		}
+		uint8_t packet_size = illuminatir_header_getPacketSize( packets[0] );
+		if( packet_size > packets_size ) {
+			return counters.error( ILLUMINATIR_ERROR_INVALID_SIZE );
+		}
+		if( packets[packet_size - 1] != illuminatir_crc8( packets, packet_size - 1, ILLUMINATIR_CRC8_INITIAL_SEED ) ) {
+			return counters.error( ILLUMINATIR_ERROR_INVALID_CRC );
+		}
+		illuminatir_error_t err = dispatch( packets, handler, counters );
+		if( err != ILLUMINATIR_ERROR_NONE ) {
+			return counters.error( err );
+		}
+		packets += packet_size;
+		packets_size -= packet_size;
+	}
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+// See illuminatir_cobs_parse_handler and illuminatir_rand_cobs_parse_handler.
+template< class Handler >
+inline illuminatir_error_t cobs_parse( std::span<const uint8_t> cobsPackets, Handler & handler, bool randomized )
+{
+	stats counters;
+	uint8_t packets[ILLUMINATIR_PACKET_MAXSIZE];
+	size_t packets_size = illuminatir_cobs_decode( packets, sizeof(packets), cobsPackets.data(), cobsPackets.size() );
+	if( packets_size == 0 ) {
+		counters.cobs();
+		return counters.error( ILLUMINATIR_ERROR_INVALID_SIZE );
+	}
+	if( randomized ) {
+		illuminatir_rand( packets, packets_size );
+	}
+	return parse( packets, packets_size, handler, counters );
+}
+
+// Calls a C builder with the span's size, limited to what fits into a uint8_t.
+template< class Build, class... Args >
+inline built_t build( Build buildFunc, std::span<uint8_t> packet, Args... args )
+{
+	uint8_t packet_size = packet.size() < 0xff ? (uint8_t)packet.size() : 0xff;
+	illuminatir_error_t err = buildFunc( packet.data(), &packet_size, args... );
+	if( err != ILLUMINATIR_ERROR_NONE ) {
+		return { err, {} };
+	}
+	return { err, packet.first( packet_size ) };
+}
+
+} // namespace detail
+
+
+/**
+ * \brief Parses packets, calling \p handler for each payload. See \ref illuminatir_parse_handler.
+ *
+ * \param packets Raw packets.
+ * \param handler An object callable with some of \ref channels_t, \ref channelValuePairs_t and \ref config_t.
+ */
+template< class Handler >
+inline illuminatir_error_t parse( std::span<const uint8_t> packets, Handler && handler )
+{
+	detail::stats counters;
+	return detail::parse( packets.data(), packets.size(), handler, counters );
+}
+
+/**
+ * \brief Parses COBS encoded packets. See \ref illuminatir_cobs_parse_handler.
+ */
+template< class Handler >
+inline illuminatir_error_t cobs_parse( std::span<const uint8_t> cobsPackets, Handler && handler )
+{
+	return detail::cobs_parse( cobsPackets, handler, false );
+}
+
+/**
+ * \brief Parses COBS encoded randomized packets. See \ref illuminatir_rand_cobs_parse_handler.
+ */
+template< class Handler >
+inline illuminatir_error_t rand_cobs_parse( std::span<const uint8_t> randCobsPackets, Handler && handler )
+{
+	return detail::cobs_parse( randCobsPackets, handler, true );
+}
+
+/**
+ * \brief Builders writing into a caller-owned span.
+ *
+ * Take the same parameters as the corresponding C functions, with spans instead of pointer and size.
+ * Values longer than 255 bytes are rejected with \ref ILLUMINATIR_ERROR_INVALID_SIZE, as no packet can hold them.
+ * @{
+ */
+inline built_t build_offsetArray( std::span<uint8_t> packet, uint8_t offset, std::span<const uint8_t> values )
+{
+	if( values.size() > 0xff ) {
+		return { ILLUMINATIR_ERROR_INVALID_SIZE, {} };
+	}
+	return detail::build( illuminatir_build_offsetArray, packet, offset, values.data(), (uint8_t)values.size() );
+}
+
+inline built_t build_channelValuePairs( std::span<uint8_t> packet, std::span<const uint8_t> pairs )
+{
+	if( pairs.size() > 0xff ) {
+		return { ILLUMINATIR_ERROR_INVALID_SIZE, {} };
+	}
+	return detail::build( illuminatir_build_channelValuePairs, packet, pairs.data(), (uint8_t)pairs.size() );
+}
+
+inline built_t build_config( std::span<uint8_t> packet, std::string_view key, std::span<const uint8_t> values = {} )
+{
+	if( key.size() > 0xff || values.size() > 0xff ) {
+		return { ILLUMINATIR_ERROR_INVALID_SIZE, {} };
+	}
+	return detail::build( illuminatir_build_config, packet, key.data(), (uint8_t)key.size(), values.data(), (uint8_t)values.size() );
+}
+
+inline built_t cobs_build_offsetArray( std::span<uint8_t> packet, uint8_t offset, std::span<const uint8_t> values )
+{
+	if( values.size() > 0xff ) {
+		return { ILLUMINATIR_ERROR_INVALID_SIZE, {} };
+	}
+	return detail::build( illuminatir_cobs_build_offsetArray, packet, offset, values.data(), (uint8_t)values.size() );
+}
+
+inline built_t cobs_build_channelValuePairs( std::span<uint8_t> packet, std::span<const uint8_t> pairs )
+{
+	if( pairs.size() > 0xff ) {
+		return { ILLUMINATIR_ERROR_INVALID_SIZE, {} };
+	}
+	return detail::build( illuminatir_cobs_build_channelValuePairs, packet, pairs.data(), (uint8_t)pairs.size() );
+}
+
+inline built_t cobs_build_config( std::span<uint8_t> packet, std::string_view key, std::span<const uint8_t> values = {} )
+{
+	if( key.size() > 0xff || values.size() > 0xff ) {
+		return { ILLUMINATIR_ERROR_INVALID_SIZE, {} };
+	}
+	return detail::build( illuminatir_cobs_build_config, packet, key.data(), (uint8_t)key.size(), values.data(), (uint8_t)values.size() );
+}
+
+inline built_t rand_cobs_build_offsetArray( std::span<uint8_t> packet, uint8_t offset, std::span<const uint8_t> values )
+{
+	if( values.size() > 0xff ) {
+		return { ILLUMINATIR_ERROR_INVALID_SIZE, {} };
+	}
+	return detail::build( illuminatir_rand_cobs_build_offsetArray, packet, offset, values.data(), (uint8_t)values.size() );
+}
+
+inline built_t rand_cobs_build_channelValuePairs( std::span<uint8_t> packet, std::span<const uint8_t> pairs )
+{
+	if( pairs.size() > 0xff ) {
+		return { ILLUMINATIR_ERROR_INVALID_SIZE, {} };
+	}
+	return detail::build( illuminatir_rand_cobs_build_channelValuePairs, packet, pairs.data(), (uint8_t)pairs.size() );
+}
+
+inline built_t rand_cobs_build_config( std::span<uint8_t> packet, std::string_view key, std::span<const uint8_t> values = {} )
+{
+	if( key.size() > 0xff || values.size() > 0xff ) {
+		return { ILLUMINATIR_ERROR_INVALID_SIZE, {} };
+	}
+	return detail::build( illuminatir_rand_cobs_build_config, packet, key.data(), (uint8_t)key.size(), values.data(), (uint8_t)values.size() );
+}
+/**
+ * @}
+ */
+
+/**
+ * \brief Constant expressions building packets and frames at compile time.
+ *
+ * Produce the same bytes as the corresponding C functions, so fixed Config commands and test patterns can be \c constexpr variables placed in read-only data instead of being built on every send.
+ * Sizes are template parameters, so invalid sizes fail to compile instead of returning errors.
+ * \code{.cpp}
+ * static constexpr auto makeDefault = illuminatir::make_rand_frame( illuminatir::make_config( "MakeDefault" ) );
+ * static constexpr auto white = illuminatir::make_rand_frame( illuminatir::make_offsetArray( 0, {255,255,255} ), illuminatir::make_config( "W", {255} ) );
+ * write( fd, white.data(), white.size() );
+ * \endcode
+ * @{
+ */
+
+/**
+ * \brief A bitwise version of \ref illuminatir_crc8 usable in constant expressions.
+ */
+constexpr uint8_t crc8( std::span<const uint8_t> data, uint8_t crc = ILLUMINATIR_CRC8_INITIAL_SEED )
+{
+	crc ^= 0xff; // see the description of the CRC in crc8.c
+	for( uint8_t byte : data ) {
+		crc ^= byte;
+		for( int bit = 0; bit < 8; bit++ ) {
+			crc = (crc & 1) ? (uint8_t)((crc >> 1) ^ 0xb2) : (uint8_t)(crc >> 1);
+		}
+	}
+	return crc ^ 0xff;
+}
+
+/**
+ * \brief A version of \ref illuminatir_rand usable in constant expressions, running the \ref LFSR bit by bit.
+ */
+constexpr void rand( std::span<uint8_t> packets )
+{
+	if( packets.size() < 3 ) {
+		return;
+	}
+	uint8_t state = packets.back() ? packets.back() : 1; // see illuminatir_lfsr127_init_r
+	for( size_t i = 1; i < packets.size() - 1; i++ ) {
+		uint8_t out = 0;
+		for( int bit = 0; bit < 8; bit++ ) {
+			uint8_t feedback = (state >> 0) ^ (state >> 1);
+			state = (uint8_t)((state >> 1) | ((feedback & 1) << 6));
+			out = (uint8_t)((out << 1) | (state & 1));
+		}
+		packets[i] ^= out;
+	}
+}
+
+/**
+ * \brief A version of \ref illuminatir_cobs_encode usable in constant expressions.
+ *
+ * \returns The encoded size, 0 if \p src is empty or \p dst too small.
+ */
+constexpr size_t cobs_encode( std::span<uint8_t> dst, std::span<const uint8_t> src )
+{
+	if( src.empty() || dst.size() < ILLUMINATIR_COBS_ENCODE_DST_MAXSIZE(src.size()) ) {
+		return 0;
+	}
+	size_t encode = 0;
+	for( ;; ) {
+		size_t limit = src.size() < 254 ? src.size() : 254;
+		size_t run = 0;
+		while( run < limit && src[run] ) {
+			run++;
+		}
+		size_t code = encode++;
+		for( size_t i = 0; i < run; i++ ) {
+			dst[encode++] = src[i];
+		}
+		dst[code] = (uint8_t)(run + 1);
+		src = src.subspan( run );
+		if( run < limit ) {
+			src = src.subspan( 1 );
+		} else if( run < 254 || src.empty() ) {
+			break;
+		}
+	}
+	return encode;
+}
+
+/**
+ * \brief Builds an OffsetArray packet like \ref illuminatir_build_offsetArray.
+ */
+template< size_t N >
+constexpr std::array<uint8_t, N + 3> make_offsetArray( uint8_t offset, const uint8_t (&values)[N] )
+{
+	static_assert( N >= ILLUMINATIR_OFFSETARRAY_MINVALUES && N <= ILLUMINATIR_OFFSETARRAY_MAXVALUES, "Invalid number of values" );
+	std::array<uint8_t, N + 3> packet{};
+	packet[0] = (uint8_t)(N - 1);
+	packet[1] = offset;
+	for( size_t i = 0; i < N; i++ ) {
+		packet[2 + i] = values[i];
+	}
+	packet[N + 2] = crc8( std::span( packet ).first( N + 2 ) );
+	return packet;
+}
+
+/**
+ * \brief Builds a ChannelValuePairs packet like \ref illuminatir_build_channelValuePairs.
+ */
+template< size_t N >
+constexpr std::array<uint8_t, N + 2> make_channelValuePairs( const uint8_t (&pairs)[N] )
+{
+	static_assert( N >= ILLUMINATIR_CHANNELVALUEPAIRS_MINSIZE && N <= ILLUMINATIR_CHANNELVALUEPAIRS_MAXSIZE, "Invalid size of pairs" );
+	std::array<uint8_t, N + 2> packet{};
+	packet[0] = (uint8_t)((0b01 << 4) | (N - 2));
+	for( size_t i = 0; i < N; i++ ) {
+		packet[1 + i] = pairs[i];
+	}
+	packet[N + 1] = crc8( std::span( packet ).first( N + 1 ) );
+	return packet;
+}
+
+/**
+ * \brief Builds a Config packet like \ref illuminatir_build_config.
+ *
+ * \param key    A string literal. Its terminating zero becomes the delimiter in front of the values.
+ * \param values The key's values.
+ */
+template< size_t K, size_t N >
+constexpr std::array<uint8_t, K + N + 2> make_config( const char (&key)[K], const uint8_t (&values)[N] )
+{
+	static_assert( K + N >= 2 && K + N <= 15 + 2, "Invalid size of key and values" );
+	std::array<uint8_t, K + N + 2> packet{};
+	packet[0] = (uint8_t)((0b10 << 4) | (K + N - 2));
+	for( size_t i = 0; i + 1 < K; i++ ) {
+		packet[1 + i] = (uint8_t)key[i];
+	}
+	for( size_t i = 0; i < N; i++ ) {
+		packet[1 + K + i] = values[i];
+	}
+	packet[K + N + 1] = crc8( std::span( packet ).first( K + N + 1 ) );
+	return packet;
+}
+
+/**
+ * \brief Builds a Config packet without values like \ref illuminatir_build_config.
+ */
+template< size_t K >
+constexpr std::array<uint8_t, K + 2> make_config( const char (&key)[K] )
+{
+	static_assert( K >= 2 && K <= 15 + 2, "Invalid size of key" );
+	std::array<uint8_t, K + 2> packet{};
+	packet[0] = (uint8_t)((0b10 << 4) | (K - 2));
+	for( size_t i = 0; i + 1 < K; i++ ) {
+		packet[1 + i] = (uint8_t)key[i];
+	}
+	packet[K + 1] = crc8( std::span( packet ).first( K + 1 ) );
+	return packet;
+}
+
+namespace detail {
+
+template< bool Randomize, size_t... N >
+constexpr std::array<uint8_t, (N + ...) + 2> make_frame( const std::array<uint8_t, N> &... packets )
+{
+	// Up to 254 bytes fit into a single COBS block, so the encoded size is known.
+	static_assert( (N + ...) <= 254, "Frames built at compile time must not exceed 254 bytes of packets" );
+	std::array<uint8_t, (N + ...)> raw{};
+	size_t raw_size = 0;
+	( ( std::copy( packets.begin(), packets.end(), raw.begin() + raw_size ), raw_size += N ), ... );
+	if constexpr( Randomize ) {
+		rand( raw );
+	}
+	std::array<uint8_t, (N + ...) + 2> frame{};
+	cobs_encode( frame, raw );
+	frame.back() = 0; // delimiter
+	return frame;
+}
+
+} // namespace detail
+
+/**
+ * \brief Concatenates packets into a COBS encoded frame including the delimiter, like \ref illuminatir_cobs_frame_finalize.
+ */
+template< size_t... N >
+constexpr std::array<uint8_t, (N + ...) + 2> make_frame( const std::array<uint8_t, N> &... packets )
+{
+	return detail::make_frame<false>( packets... );
+}
+
+/**
+ * \brief Concatenates packets into a randomized COBS encoded frame including the delimiter, like \ref illuminatir_rand_cobs_frame_finalize.
+ */
+template< size_t... N >
+constexpr std::array<uint8_t, (N + ...) + 2> make_rand_frame( const std::array<uint8_t, N> &... packets )
+{
+	return detail::make_frame<true>( packets... );
+}
+
+/**
+ * @}
+ */
+
+} // namespace illuminatir
+
+/**
+ * @}
+ */
+
+
+#endif
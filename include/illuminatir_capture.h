@@ -0,0 +1,237 @@
+/*
+ * IlluminatIR
+ * Copyright (C) 2021  zwostein
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * \brief Recording and replaying wire bytes.
+ **/
+
+
+#ifndef ILLUMINATIR_CAPTURE_INCLUDED
+#define ILLUMINATIR_CAPTURE_INCLUDED
+
+#include "illuminatir.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @defgroup Capture Capture
+ * \brief Capture files of timestamped wire bytes, e.g. the frames a transmitter sent or the bytes a receiver heard.
+ *
+ * A capture is a sequence of records, each holding the wire bytes of one write or read together with a monotonic timestamp and the number of the port they went through.
+ * The writer buffers records and appends them to the capture file in chunks, so a capture that was not closed properly just loses its last incomplete chunk.
+ * For each record it also appends an \ref illuminatir_capture_indexEntry_t to a sidecar index file, named like the capture with \c .idx appended.
+ *
+ * The reader maps both files into memory. Records point right into the mapping, so nothing is copied.
+ * Seeking to a timestamp is a binary search of the index. Without an index, or for records behind its end, the reader seeks by walking the records.
+ * \code{.c}
+ * uint8_t frame[ILLUMINATIR_CAPTURE_RECORD_MAXSIZE];
+ * illuminatir_stream_t stream;
+ * illuminatir_rand_stream_init( &stream, frame, sizeof(frame), setChannel, setConfig );
+ * illuminatir_capture_reader_t reader;
+ * illuminatir_capture_reader_open( &reader, "tx.cap" );
+ * illuminatir_capture_seek( &reader, 60 * 1000000000ull ); // a minute after the capture started
+ * illuminatir_capture_record_t record;
+ * while( illuminatir_capture_next( &reader, &record ) ) {
+ * 	illuminatir_stream_feed( &stream, record.data, record.size );
+ * }
+ * illuminatir_capture_reader_close( &reader );
+ * \endcode
+ * A \ref Stream decodes frames of several packets as well as records of received bytes ending in the middle of a frame.
+ *
+ * All integers in the files are little endian, with the records aligned to 8 bytes.
+ * \note This module needs POSIX files and \c mmap and is not available on \c avr-gcc.
+ * @{
+ */
+
+#if !defined(ILLUMINATIR_CAPTURE_CHUNK_SIZE)
+#	define ILLUMINATIR_CAPTURE_CHUNK_SIZE 65536 ///< Maximum size of the records a writer buffers before appending them as a chunk.
+#endif
+
+#define ILLUMINATIR_CAPTURE_VERSION        1    ///< Version of the file format.
+#define ILLUMINATIR_CAPTURE_RECORD_MAXSIZE 4096 ///< Maximum number of wire bytes of a record.
+#define ILLUMINATIR_CAPTURE_INDEX_SUFFIX   ".idx" ///< Appended to the name of a capture for the name of its index.
+
+/**
+ * \brief Header at the start of a capture and its index.
+ */
+typedef struct {
+	char     magic[8]; ///< \c "IRcaptur" for captures, \c "IRcapidx" for indexes.
+	uint32_t version;  ///< \ref ILLUMINATIR_CAPTURE_VERSION.
+	uint32_t reserved; ///< Zero.
+} illuminatir_capture_fileHeader_t;
+
+/**
+ * \brief Header in front of each chunk of records.
+ */
+typedef struct {
+	uint32_t magic; ///< \c "IRch".
+	uint32_t size;  ///< Size of the records following the header, including their padding.
+} illuminatir_capture_chunkHeader_t;
+
+/**
+ * \brief Header in front of each record's wire bytes, which are padded to a multiple of 8 bytes.
+ */
+typedef struct {
+	uint64_t timestamp; ///< Nanoseconds on a monotonic clock, never decreasing.
+	uint16_t port;      ///< The port the bytes went through.
+	uint16_t size;      ///< Number of wire bytes.
+	uint32_t reserved;  ///< Zero.
+} illuminatir_capture_recordHeader_t;
+
+/**
+ * \brief An entry of the index. The index holds one for each record, in the order of the records.
+ */
+typedef struct {
+	uint64_t timestamp; ///< Timestamp of the record.
+	uint64_t offset;    ///< Offset of the record's header in the capture.
+	uint64_t chunk_end; ///< Offset behind the chunk containing the record.
+} illuminatir_capture_indexEntry_t;
+
+/**
+ * \brief A record returned by the reader.
+ */
+typedef struct {
+	uint64_t        timestamp; ///< Nanoseconds on a monotonic clock.
+	uint16_t        port;      ///< The port the bytes went through.
+	uint16_t        size;      ///< Number of wire bytes.
+	const uint8_t * data;      ///< The wire bytes, valid until the reader is closed.
+} illuminatir_capture_record_t;
+
+/**
+ * \brief A capture being written.
+ *
+ * All members are private, use the functions of this module.
+ */
+typedef struct {
+	int                              fd;             ///< The capture file.
+	int                              index_fd;       ///< The index file.
+	uint64_t                         offset;         ///< Size of the capture written so far.
+	uint64_t                         last_timestamp; ///< Timestamp of the last record.
+	size_t                           chunk_size;     ///< Size of the records buffered in \c chunk.
+	size_t                           entries_count;  ///< Number of index entries buffered in \c entries.
+	uint64_t                         chunk[(sizeof(illuminatir_capture_chunkHeader_t) + ILLUMINATIR_CAPTURE_CHUNK_SIZE) / 8]; ///< The chunk being filled, aligned like the records.
+	illuminatir_capture_indexEntry_t entries[ILLUMINATIR_CAPTURE_CHUNK_SIZE / (sizeof(illuminatir_capture_recordHeader_t) + 8)]; ///< Index entries of the records in \c chunk.
+} illuminatir_capture_writer_t;
+
+/**
+ * \brief A capture being read.
+ *
+ * All members are private, use the functions of this module.
+ */
+typedef struct {
+	const uint8_t *                          capture;       ///< The mapped capture.
+	size_t                                   capture_size;  ///< Size of the capture up to the end of its last complete chunk.
+	const illuminatir_capture_indexEntry_t * index;         ///< The mapped index entries, NULL without an index.
+	size_t                                   index_count;   ///< Number of index entries of complete chunks.
+	const void *                             index_mapping; ///< The mapped index file.
+	size_t                                   index_size;    ///< Size of the index file.
+	size_t                                   mapping_size;  ///< Size of the capture file.
+	size_t                                   position;      ///< Offset of the next record or chunk.
+	size_t                                   chunk_end;     ///< Offset behind the current chunk.
+} illuminatir_capture_reader_t;
+
+/**
+ * \brief Creates a capture and its index, replacing existing files.
+ *
+ * \param writer Pointer to the writer.
+ * \param path   Name of the capture file.
+ * \returns \ref ILLUMINATIR_ERROR_UNKNOWN if the files could not be created, see \c errno.
+ */
+illuminatir_error_t illuminatir_capture_writer_open( illuminatir_capture_writer_t * writer, const char * path );
+
+/**
+ * \brief Adds a record to a capture.
+ *
+ * The record is buffered and appended to the files with its chunk.
+ * \param writer    Pointer to the writer.
+ * \param timestamp Nanoseconds on a monotonic clock, at least the timestamp of the previous record.
+ * \param port      The port the bytes went through.
+ * \param data      The wire bytes.
+ * \param size      Number of wire bytes, 1 to \ref ILLUMINATIR_CAPTURE_RECORD_MAXSIZE.
+ * \returns \ref ILLUMINATIR_ERROR_INVALID_SIZE for an invalid size or a timestamp older than the previous one, \ref ILLUMINATIR_ERROR_UNKNOWN if a full chunk could not be written.
+ */
+illuminatir_error_t illuminatir_capture_write( illuminatir_capture_writer_t * writer, uint64_t timestamp, uint16_t port, const uint8_t * data, size_t size );
+
+/**
+ * \brief Appends the buffered records to the capture as a chunk and their entries to the index.
+ *
+ * \param writer Pointer to the writer.
+ * \returns \ref ILLUMINATIR_ERROR_UNKNOWN if the files could not be written, see \c errno.
+ */
+illuminatir_error_t illuminatir_capture_flush( illuminatir_capture_writer_t * writer );
+
+/**
+ * \brief Flushes and closes a capture.
+ *
+ * \param writer Pointer to the writer.
+ * \returns \ref ILLUMINATIR_ERROR_UNKNOWN if the files could not be written, see \c errno. The files are closed anyway.
+ */
+illuminatir_error_t illuminatir_capture_writer_close( illuminatir_capture_writer_t * writer );
+
+/**
+ * \brief Maps a capture and its index if there is one, positioned at the first record.
+ *
+ * \param reader Pointer to the reader.
+ * \param path   Name of the capture file.
+ * \returns \ref ILLUMINATIR_ERROR_UNSUPPORTED_FORMAT if the file is no capture, \ref ILLUMINATIR_ERROR_UNSUPPORTED_VERSION for captures of other versions, \ref ILLUMINATIR_ERROR_INVALID_SIZE if an index entry points outside the capture, \ref ILLUMINATIR_ERROR_UNKNOWN if the file could not be mapped, see \c errno.
+ */
+illuminatir_error_t illuminatir_capture_reader_open( illuminatir_capture_reader_t * reader, const char * path );
+
+/**
+ * \brief Unmaps a capture. Records returned by the reader become invalid.
+ *
+ * \param reader Pointer to the reader.
+ */
+void illuminatir_capture_reader_close( illuminatir_capture_reader_t * reader );
+
+/**
+ * \brief Returns the next record.
+ *
+ * \param reader Pointer to the reader.
+ * \param record Set to the record.
+ * \returns 1 for a record, 0 at the end of the capture.
+ */
+uint8_t illuminatir_capture_next( illuminatir_capture_reader_t * reader, illuminatir_capture_record_t * record );
+
+/**
+ * \brief Positions a reader at the first record not older than a timestamp.
+ *
+ * Takes O(log n) with an index. Seeking to 0 starts over.
+ * \param reader    Pointer to the reader.
+ * \param timestamp Nanoseconds on the capture's clock.
+ */
+void illuminatir_capture_seek( illuminatir_capture_reader_t * reader, uint64_t timestamp );
+
+/**
+ * @}
+ */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
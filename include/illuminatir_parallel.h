@@ -0,0 +1,168 @@
+/*
+ * IlluminatIR
+ * Copyright (C) 2021  zwostein
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * \brief Encoding many universes on several threads.
+ **/
+
+
+#ifndef ILLUMINATIR_PARALLEL_INCLUDED
+#define ILLUMINATIR_PARALLEL_INCLUDED
+
+#include "illuminatir.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @defgroup Parallel Parallel
+ * \brief A pool of threads planning and encoding the frames of many universes at once.
+ *
+ * Every job is a universe to send to one of several transmitters, e.g. serial ports.
+ * Its packets are planned by \ref illuminatir_plan and encoded into a single frame like \ref illuminatir_cobs_frame_finalize does.
+ * The frames of all jobs for a transmitter end up concatenated in the transmitter's buffer, in the order of the jobs.
+ * So the output only depends on the jobs, not on the number of threads or how the work got distributed.
+ *
+ * Each thread starts with an equal share of the jobs in its own deque and takes them from the back.
+ * Threads running out of work steal jobs from the front of the other threads' deques, so a few expensive universes do not leave the other threads idle.
+ * The calling thread works along, so a pool without threads encodes everything on the calling thread.
+ * \code{.c}
+ * illuminatir_parallel_t pool;
+ * illuminatir_parallel_init( &pool, 3 );
+ * // every tick:
+ * illuminatir_rand_cobs_parallel_encode( &pool, jobs, jobs_count, outputs, outputs_count ); // write outputs[t].buffer[0..outputs[t].size-1] to transmitter t
+ * // at exit:
+ * illuminatir_parallel_destroy( &pool );
+ * \endcode
+ * \attention A pool encodes one batch at a time. Concurrent calls for the same pool have to be serialized by the caller.
+ * \note This module needs POSIX threads and C11 atomics and is not available on \c avr-gcc.
+ * @{
+ */
+
+#if !defined(ILLUMINATIR_PARALLEL_MAXTHREADS)
+#	define ILLUMINATIR_PARALLEL_MAXTHREADS 16 ///< Maximum number of threads of a pool, besides the calling thread.
+#endif
+
+#define ILLUMINATIR_PARALLEL_FRAME_MAXSIZE ILLUMINATIR_FRAME_BUFFER_SIZE(ILLUMINATIR_PLAN_MAXSIZE) ///< Maximum size of the frame of a single job.
+#define ILLUMINATIR_PARALLEL_BUFFER_SIZE(JOBS) ((size_t)(JOBS) * ILLUMINATIR_PARALLEL_FRAME_MAXSIZE) ///< The buffer size always sufficient for a transmitter receiving \p JOBS jobs.
+
+/**
+ * \brief A universe to encode.
+ */
+typedef struct {
+	const uint8_t * previous;     ///< The \ref ILLUMINATIR_CHANNELS values known to the transmitter's receivers. May be NULL to send all channels.
+	const uint8_t * next;         ///< The \ref ILLUMINATIR_CHANNELS values to send.
+	uint16_t        transmitter;  ///< Index of the transmitter's output.
+	size_t          frame_offset; ///< Set to where the job's frame starts in the transmitter's buffer.
+	size_t          frame_size;   ///< Set to the size of the job's frame, 0 if no channel changed.
+} illuminatir_parallel_job_t;
+
+/**
+ * \brief The frames for a transmitter.
+ */
+typedef struct {
+	uint8_t * buffer;      ///< The caller-owned buffer, see \ref ILLUMINATIR_PARALLEL_BUFFER_SIZE.
+	size_t    buffer_size; ///< Size of \c buffer in bytes.
+	size_t    size;        ///< Set to the size of all frames in \c buffer.
+} illuminatir_parallel_output_t;
+
+struct illuminatir_parallel;
+
+/**
+ * \brief A thread of a pool and its deque of jobs.
+ *
+ * All members are private. Each worker gets a cache line of its own, as the deques are hammered on by all threads.
+ */
+typedef struct {
+	_Alignas(64) _Atomic int64_t  top;    ///< Index of the first job left, advanced by thieves.
+	_Atomic int64_t               bottom; ///< Index behind the last job left, taken back by the owner.
+	struct illuminatir_parallel * pool;   ///< The pool the worker belongs to.
+	pthread_t                     thread; ///< The worker's thread. (unused for the calling thread)
+} illuminatir_parallel_worker_t;
+
+/**
+ * \brief A pool of threads.
+ *
+ * All members are private, use the functions of this module.
+ */
+typedef struct illuminatir_parallel {
+	illuminatir_parallel_worker_t workers[ILLUMINATIR_PARALLEL_MAXTHREADS + 1]; ///< The calling thread, then the pool's threads.
+	uint8_t                       threads_count; ///< Number of threads besides the calling thread.
+	pthread_mutex_t               mutex;         ///< Protects the members below.
+	pthread_cond_t                started;       ///< Signaled for a new batch or to stop.
+	pthread_cond_t                finished;      ///< Signaled when the last thread finished a batch.
+	uint32_t                      batch;         ///< Incremented for every batch.
+	uint8_t                       busy;          ///< Number of threads still working on the batch.
+	uint8_t                       stop;          ///< Set to make the threads exit.
+	illuminatir_parallel_job_t *  jobs;          ///< Jobs of the running batch.
+	illuminatir_parallel_output_t * outputs;     ///< Outputs of the running batch.
+	uint8_t                       randomize;     ///< Whether the running batch randomizes packets.
+	_Atomic int                   error;         ///< The first error of the running batch.
+} illuminatir_parallel_t;
+
+/**
+ * \brief Starts the threads of a pool.
+ *
+ * \param pool          Pointer to the pool, which must stay at the same address until \ref illuminatir_parallel_destroy.
+ * \param threads_count Number of threads to start besides the calling thread, at most \ref ILLUMINATIR_PARALLEL_MAXTHREADS. Usually the number of cores minus one.
+ * \returns \ref ILLUMINATIR_ERROR_INVALID_SIZE for too many threads, \ref ILLUMINATIR_ERROR_UNKNOWN if threads could not be created.
+ */
+illuminatir_error_t illuminatir_parallel_init( illuminatir_parallel_t * pool, uint8_t threads_count );
+
+/**
+ * \brief Stops and joins the threads of a pool.
+ *
+ * \param pool Pointer to the pool.
+ */
+void illuminatir_parallel_destroy( illuminatir_parallel_t * pool );
+
+/**
+ * \brief Plans and encodes the frames of all jobs using all threads of a pool.
+ *
+ * Blocks until all jobs are done. Sets each job's \c frame_offset and \c frame_size and each output's \c size.
+ * Each job first gets \ref ILLUMINATIR_PARALLEL_FRAME_MAXSIZE bytes of its transmitter's buffer, which is compacted afterwards.
+ * \param pool          Pointer to the pool.
+ * \param jobs          The jobs, in the order their frames should be sent.
+ * \param jobs_count    Number of jobs.
+ * \param outputs       One output per transmitter.
+ * \param outputs_count Number of transmitters.
+ * \returns \ref ILLUMINATIR_ERROR_BUFFER_OVERFLOW if a transmitter's buffer is too small for its jobs, \ref ILLUMINATIR_ERROR_INVALID_SIZE if a job's transmitter has no output. Nothing is encoded then.
+ */
+illuminatir_error_t illuminatir_cobs_parallel_encode( illuminatir_parallel_t * pool, illuminatir_parallel_job_t * jobs, size_t jobs_count, illuminatir_parallel_output_t * outputs, uint16_t outputs_count );
+
+illuminatir_error_t illuminatir_rand_cobs_parallel_encode( illuminatir_parallel_t * pool, illuminatir_parallel_job_t * jobs, size_t jobs_count, illuminatir_parallel_output_t * outputs, uint16_t outputs_count ); ///< A version of \ref illuminatir_cobs_parallel_encode randomizing all packets as by \ref illuminatir_rand_cobs_frame_finalize.
+
+/**
+ * @}
+ */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
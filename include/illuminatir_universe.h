@@ -0,0 +1,157 @@
+/*
+ * IlluminatIR
+ * Copyright (C) 2021  zwostein
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * \brief Channel state shared between threads.
+ **/
+
+
+#ifndef ILLUMINATIR_UNIVERSE_INCLUDED
+#define ILLUMINATIR_UNIVERSE_INCLUDED
+
+#include "illuminatir.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @defgroup Universe Universe
+ * \brief Channel values shared between a parsing thread and any number of output threads.
+ *
+ * The universe is a seqlock: the writer makes the sequence counter odd while it updates channels, and readers copy the channels without taking a lock, retrying if the counter changed meanwhile.
+ * Readers never block the writer, so the parse hot path is not serialized against output ticks.
+ *
+ * Every update that actually changes a channel value increments the universe's generation and tags the changed channels with it.
+ * Readers remember the generation of their last snapshot and ask which channels changed since.
+ * Updates that do not change any value (like periodic refreshes) leave the universe untouched and cause no retries.
+ *
+ * \attention There must be only one writer at a time, e.g. the thread parsing received packets. Concurrent writers have to be serialized by the caller.
+ * \note This module needs C11 atomics and is not available on \c avr-gcc.
+ * @{
+ */
+
+/**
+ * \brief Channel values with generation counters.
+ *
+ * All members are private, use the functions of this module.
+ */
+typedef struct {
+	_Atomic uint32_t sequence;                                ///< Odd while the writer updates channels.
+	_Atomic uint32_t generation;                              ///< Incremented by every update changing channel values.
+	_Atomic uint32_t values[ILLUMINATIR_CHANNELS / 4];        ///< Channel values, packed four per word.
+	_Atomic uint32_t channel_generation[ILLUMINATIR_CHANNELS]; ///< The generation each channel was changed in last.
+} illuminatir_universe_t;
+
+/**
+ * \brief Initializes a universe at generation 0.
+ *
+ * \param universe Pointer to the universe.
+ * \param values   Pointer to \ref ILLUMINATIR_CHANNELS initial channel values. May be NULL to start with all channels at 0.
+ */
+void illuminatir_universe_init( illuminatir_universe_t * universe, const uint8_t * values );
+
+/**
+ * \brief Sets a contiguous range of channels as a single update.
+ *
+ * The range wraps around after channel 255.
+ * \param universe      Pointer to the universe.
+ * \param first_channel Channel number of \p values[0].
+ * \param values        New channel values.
+ * \param count         Number of channels in \p values.
+ */
+void illuminatir_universe_setChannels( illuminatir_universe_t * universe, uint8_t first_channel, const uint8_t * values, uint16_t count );
+
+/**
+ * \brief Sets a batch of channels given as channel/value pairs as a single update.
+ *
+ * \param universe Pointer to the universe.
+ * \param pairs    Interleaved channel and value bytes (channel 0, value 0, ..., channel N, value N).
+ * \param count    Number of pairs in \p pairs.
+ */
+void illuminatir_universe_setChannelValuePairs( illuminatir_universe_t * universe, const uint8_t * pairs, uint8_t count );
+
+/**
+ * \brief Returns a handler writing parsed channels into a universe.
+ *
+ * Each OffsetArray and ChannelValuePairs payload becomes a single update, so readers never see half of a packet.
+ * The handler's \c setConfig is NULL. It may be set by the caller and then receives \p universe as its context.
+ * \param universe Pointer to the universe, which must outlive the handler.
+ */
+illuminatir_handler_t illuminatir_universe_handler( illuminatir_universe_t * universe );
+
+/**
+ * \brief Takes a consistent snapshot of all channels.
+ *
+ * \param universe Pointer to the universe.
+ * \param values   Pointer to an array of \ref ILLUMINATIR_CHANNELS channel values receiving the snapshot.
+ * \returns The generation of the snapshot.
+ */
+uint32_t illuminatir_universe_read( const illuminatir_universe_t * universe, uint8_t * values );
+
+/**
+ * \brief Takes a consistent snapshot of all channels and the channels changed since a generation.
+ *
+ * Pass the generation returned by the previous read to get the channels changed in between.
+ * Generations wrap around, so \p since should not lag more than 2^31 updates behind.
+ * \param universe Pointer to the universe.
+ * \param values   Pointer to an array of \ref ILLUMINATIR_CHANNELS channel values receiving the snapshot. May be NULL.
+ * \param since    A generation returned by an earlier read.
+ * \param changed  Pointer to a channel mask. It is cleared, then the bits of all channels changed after generation \p since are set.
+ * \returns The generation of the snapshot.
+ */
+uint32_t illuminatir_universe_readChanged( const illuminatir_universe_t * universe, uint8_t * values, uint32_t since, illuminatir_channelMask_t * changed );
+
+/**
+ * \brief Returns the current generation, to cheaply poll for changes.
+ *
+ * \param universe Pointer to the universe.
+ */
+static inline uint32_t illuminatir_universe_getGeneration( const illuminatir_universe_t * universe )
+{
+	return atomic_load_explicit( &universe->generation, memory_order_acquire );
+}
+
+/**
+ * \brief Returns the value of a single channel.
+ *
+ * A single channel is always consistent, so this does not need to retry.
+ * \param universe Pointer to the universe.
+ * \param channel  Channel number.
+ */
+static inline uint8_t illuminatir_universe_getChannel( const illuminatir_universe_t * universe, uint8_t channel )
+{
+	return (uint8_t)(atomic_load_explicit( &universe->values[channel >> 2], memory_order_relaxed ) >> ((channel & 3) * 8));
+}
+
+/**
+ * @}
+ */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
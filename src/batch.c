@@ -0,0 +1,190 @@
+#include "illuminatir.h"
+#include "illuminatir_private.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+
+#if !defined(ILLUMINATIR_BATCH_SIMD)
+#	if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#		define ILLUMINATIR_BATCH_SIMD 1
+#	else
+#		define ILLUMINATIR_BATCH_SIMD 0
+#	endif
+#endif
+
+#if ILLUMINATIR_BATCH_SIMD
+#	include <immintrin.h>
+#endif
+
+
+#define BATCH_VALUES      ILLUMINATIR_OFFSETARRAY_MAXVALUES
+#define BATCH_RAW_SIZE    (1 + 1 + BATCH_VALUES + 1) // header + offset + values + crc
+#define BATCH_HEADER      (BATCH_VALUES - 1)         // OffsetArray with BATCH_VALUES values
+#define BATCH_LANES       16
+
+
+// Builds a single job, gathering its values from the structure-of-arrays layout.
+static illuminatir_error_t batch_build_scalar( uint8_t * packet, const uint8_t * offsets, const uint8_t * values, size_t count, size_t job, int randomize )
+{
+	uint8_t jobValues[BATCH_VALUES];
+	for( uint8_t i = 0; i < BATCH_VALUES; i++ ) {
+		jobValues[i] = values[i * count + job];
+	}
+	uint8_t packet_size = ILLUMINATIR_BATCH_PACKET_SIZE;
+	if( randomize ) {
+		return illuminatir_rand_cobs_build_offsetArray( packet, &packet_size, offsets[job], jobValues, BATCH_VALUES );
+	}
+	return illuminatir_cobs_build_offsetArray( packet, &packet_size, offsets[job], jobValues, BATCH_VALUES );
+}
+
+
+#if ILLUMINATIR_BATCH_SIMD
+
+// Transposes 16 vectors of 16 bytes: byte j of m[i] becomes byte i of m[j].
+// Four rounds of interleaving each vector with the one 8 further away do the trick.
+__attribute__((target("ssse3")))
+static inline void batch_transpose( __m128i m[16] )
+{
+	for( unsigned round = 0; round < 4; round++ ) {
+		__m128i t[16];
+		for( unsigned i = 0; i < 8; i++ ) {
+			t[2 * i]     = _mm_unpacklo_epi8( m[i], m[i + 8] );
+			t[2 * i + 1] = _mm_unpackhi_epi8( m[i], m[i + 8] );
+		}
+		for( unsigned i = 0; i < 16; i++ ) {
+			m[i] = t[i];
+		}
+	}
+}
+
+
+// Builds BATCH_LANES jobs, lane n of every vector belonging to job n.
+//
+// The CRC works on the raw register r = crc ^ 0xff, updated by r = R[r ^ byte] where R is linear (see
+// crc8.c). So R[x] = R[x & 0x0f] ^ R[x & 0xf0], and both halves are 16 entry tables for pshufb.
+// COBS is computed backwards from the end of the packets, as the code of every zero is the distance
+// to the next zero or the end of the packet.
+__attribute__((target("ssse3")))
+static void batch_build_ssse3( uint8_t * arena, const uint8_t * offsets, const uint8_t * values, size_t count, int randomize )
+{
+	const __m128i crcLow  = _mm_setr_epi8( 0x00, 0x3e, 0x7c, 0x42, (char)0xf8, (char)0xc6, (char)0x84, (char)0xba, (char)0x95, (char)0xab, (char)0xe9, (char)0xd7, 0x6d, 0x53, 0x11, 0x2f );
+	const __m128i crcHigh = _mm_setr_epi8( 0x00, 0x4f, (char)0x9e, (char)0xd1, 0x59, 0x16, (char)0xc7, (char)0x88, (char)0xb2, (char)0xfd, 0x2c, 0x63, (char)0xeb, (char)0xa4, 0x75, 0x3a );
+	const __m128i nibble  = _mm_set1_epi8( 0x0f );
+	const __m128i ones    = _mm_set1_epi8( (char)0xff );
+	const __m128i zero    = _mm_setzero_si128();
+
+	__m128i raw[BATCH_RAW_SIZE];
+	raw[0] = _mm_set1_epi8( BATCH_HEADER );
+	raw[1] = _mm_loadu_si128( (const __m128i *)offsets );
+	for( unsigned i = 0; i < BATCH_VALUES; i++ ) {
+		raw[2 + i] = _mm_loadu_si128( (const __m128i *)(values + i * count) );
+	}
+
+	__m128i r = ones;
+	for( unsigned i = 0; i < BATCH_RAW_SIZE - 1; i++ ) {
+		__m128i x = _mm_xor_si128( r, raw[i] );
+		r = _mm_xor_si128(
+			_mm_shuffle_epi8( crcLow, _mm_and_si128( x, nibble ) ),
+			_mm_shuffle_epi8( crcHigh, _mm_and_si128( _mm_srli_epi16( x, 4 ), nibble ) ) );
+	}
+	raw[BATCH_RAW_SIZE - 1] = _mm_xor_si128( r, ones );
+
+#if ILLUMINATIR_RAND_TABLE
+	if( randomize ) {
+		// The keystream rows of all lanes, transposed so that vector i holds keystream byte i of every lane.
+		uint8_t seeds[BATCH_LANES];
+		_mm_storeu_si128( (__m128i *)seeds, raw[BATCH_RAW_SIZE - 1] );
+		__m128i keystream[16];
+		uint8_t last[BATCH_LANES];
+		for( unsigned lane = 0; lane < BATCH_LANES; lane++ ) {
+			const uint8_t * row = illuminatir_rand_keystream[seeds[lane]];
+			keystream[lane] = _mm_loadu_si128( (const __m128i *)row );
+			last[lane] = row[16];
+		}
+		batch_transpose( keystream );
+		for( unsigned i = 0; i < 16; i++ ) {
+			raw[1 + i] = _mm_xor_si128( raw[1 + i], keystream[i] );
+		}
+		raw[1 + 16] = _mm_xor_si128( raw[1 + 16], _mm_loadu_si128( (const __m128i *)last ) );
+	}
+#else
+	(void)randomize; // not reached, see batch_build
+#endif
+
+	__m128i encoded[BATCH_RAW_SIZE + 1];
+	__m128i distance = _mm_set1_epi8( 1 );
+	for( unsigned i = BATCH_RAW_SIZE; i-- > 0; ) {
+		__m128i isZero = _mm_cmpeq_epi8( raw[i], zero );
+		encoded[i + 1] = _mm_or_si128( _mm_and_si128( isZero, distance ), _mm_andnot_si128( isZero, raw[i] ) );
+		distance = _mm_sub_epi8( distance, ones ); // + 1
+		distance = _mm_or_si128( _mm_and_si128( isZero, _mm_set1_epi8( 1 ) ), _mm_andnot_si128( isZero, distance ) );
+	}
+	encoded[0] = distance;
+
+	// Back to one packet per vector: bytes 0 to 15, then bytes 16 to 19.
+	batch_transpose( encoded );
+	__m128i tail[16];
+	for( unsigned i = 0; i < 4; i++ ) {
+		tail[i] = encoded[16 + i];
+	}
+	for( unsigned i = 4; i < 16; i++ ) {
+		tail[i] = zero;
+	}
+	batch_transpose( tail );
+	for( unsigned lane = 0; lane < BATCH_LANES; lane++ ) {
+		uint8_t * packet = arena + lane * ILLUMINATIR_BATCH_PACKET_SIZE;
+		_mm_storeu_si128( (__m128i *)packet, encoded[lane] );
+		uint32_t last4 = (uint32_t)_mm_cvtsi128_si32( tail[lane] );
+		memcpy( packet + 16, &last4, sizeof(last4) );
+	}
+}
+
+#	define BATCH_SSSE3_SUPPORTED() __builtin_cpu_supports( "ssse3" )
+
+#endif // ILLUMINATIR_BATCH_SIMD
+
+
+static illuminatir_error_t batch_build( uint8_t * arena, size_t * arena_size, uint8_t * sizes, const uint8_t * offsets, const uint8_t * values, size_t count, int randomize )
+{
+	if( !arena_size || (count && (!arena || !offsets || !values)) ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	if( *arena_size / ILLUMINATIR_BATCH_PACKET_SIZE < count ) {
+		return ILLUMINATIR_ERROR_BUFFER_OVERFLOW;
+	}
+	size_t job = 0;
+#if ILLUMINATIR_BATCH_SIMD
+	if( (!randomize || ILLUMINATIR_RAND_TABLE) && BATCH_SSSE3_SUPPORTED() ) {
+		for( ; job + BATCH_LANES <= count; job += BATCH_LANES ) {
+			batch_build_ssse3( arena + job * ILLUMINATIR_BATCH_PACKET_SIZE, offsets + job, values + job, count, randomize );
+		}
+	}
+#endif
+	for( ; job < count; job++ ) {
+		illuminatir_error_t err = batch_build_scalar( arena + job * ILLUMINATIR_BATCH_PACKET_SIZE, offsets, values, count, job, randomize );
+		if( err != ILLUMINATIR_ERROR_NONE ) {
+			return err;
+		}
+	}
+	if( sizes ) {
+		for( job = 0; job < count; job++ ) {
+			sizes[job] = ILLUMINATIR_BATCH_PACKET_SIZE;
+		}
+	}
+	*arena_size = count * ILLUMINATIR_BATCH_PACKET_SIZE;
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+illuminatir_error_t illuminatir_cobs_build_offsetArrays( uint8_t * arena, size_t * arena_size, uint8_t * sizes, const uint8_t * offsets, const uint8_t * values, size_t count )
+{
+	return batch_build( arena, arena_size, sizes, offsets, values, count, 0 );
+}
+
+
+illuminatir_error_t illuminatir_rand_cobs_build_offsetArrays( uint8_t * arena, size_t * arena_size, uint8_t * sizes, const uint8_t * offsets, const uint8_t * values, size_t count )
+{
+	return batch_build( arena, arena_size, sizes, offsets, values, count, 1 );
+}
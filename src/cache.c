@@ -0,0 +1,296 @@
+#include "illuminatir.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+
+#define CACHE_NONE 0xffff
+
+#define CACHE_KIND_FRAME    0
+#define CACHE_KIND_CONFIG   1
+#define CACHE_KIND_UNIVERSE 2
+#define CACHE_KIND_RAND     0x80
+
+
+// FNV-1a over kind and key.
+static uint32_t cache_hash( uint8_t kind, const uint8_t * key, uint16_t key_size )
+{
+	uint32_t hash = (2166136261u ^ kind) * 16777619u;
+	for( uint16_t i = 0; i < key_size; i++ ) {
+		hash = (hash ^ key[i]) * 16777619u;
+	}
+	return hash;
+}
+
+
+static inline uint16_t * cache_bucket( illuminatir_cache_t * cache, uint32_t hash )
+{
+	return &cache->entries[hash % cache->entries_count].head;
+}
+
+
+static uint16_t cache_find( illuminatir_cache_t * cache, uint8_t kind, uint32_t hash, const uint8_t * key, uint16_t key_size )
+{
+	for( uint16_t index = *cache_bucket( cache, hash ); index != CACHE_NONE; index = cache->entries[index].chain ) {
+		const illuminatir_cache_entry_t * entry = &cache->entries[index];
+		if( entry->hash == hash && entry->kind == kind && entry->key_size == key_size && !memcmp( entry->key, key, key_size ) ) {
+			return index;
+		}
+	}
+	return CACHE_NONE;
+}
+
+
+static void cache_unlinkChain( illuminatir_cache_t * cache, uint16_t index )
+{
+	uint16_t * link = cache_bucket( cache, cache->entries[index].hash );
+	while( *link != index ) {
+		link = &cache->entries[*link].chain;
+	}
+	*link = cache->entries[index].chain;
+}
+
+
+static void cache_unlinkLru( illuminatir_cache_t * cache, uint16_t index )
+{
+	illuminatir_cache_entry_t * entry = &cache->entries[index];
+	if( entry->older != CACHE_NONE ) {
+		cache->entries[entry->older].newer = entry->newer;
+	} else {
+		cache->oldest = entry->newer;
+	}
+	if( entry->newer != CACHE_NONE ) {
+		cache->entries[entry->newer].older = entry->older;
+	} else {
+		cache->newest = entry->older;
+	}
+}
+
+
+static void cache_pushNewest( illuminatir_cache_t * cache, uint16_t index )
+{
+	illuminatir_cache_entry_t * entry = &cache->entries[index];
+	entry->older = cache->newest;
+	entry->newer = CACHE_NONE;
+	if( cache->newest != CACHE_NONE ) {
+		cache->entries[cache->newest].newer = index;
+	} else {
+		cache->oldest = index;
+	}
+	cache->newest = index;
+}
+
+
+// Looks up an entry, making it the most recently used one.
+static illuminatir_cache_entry_t * cache_lookup( illuminatir_cache_t * cache, uint8_t kind, uint32_t hash, const uint8_t * key, uint16_t key_size )
+{
+	uint16_t index = cache_find( cache, kind, hash, key, key_size );
+	if( index == CACHE_NONE ) {
+		cache->misses++;
+		return NULL;
+	}
+	cache->hits++;
+	if( index != cache->newest ) {
+		cache_unlinkLru( cache, index );
+		cache_pushNewest( cache, index );
+	}
+	return &cache->entries[index];
+}
+
+
+// Takes an unused or the least recently used entry for a key that is not cached yet.
+static illuminatir_cache_entry_t * cache_claim( illuminatir_cache_t * cache, uint8_t kind, uint32_t hash, const uint8_t * key, uint16_t key_size )
+{
+	uint16_t index;
+	if( cache->used < cache->entries_count ) {
+		index = cache->used++;
+	} else {
+		index = cache->oldest;
+		cache_unlinkChain( cache, index );
+		cache_unlinkLru( cache, index );
+		cache->evictions++;
+	}
+	illuminatir_cache_entry_t * entry = &cache->entries[index];
+	entry->hash       = hash;
+	entry->kind       = kind;
+	entry->key_size   = key_size;
+	entry->frame_size = 0;
+	memcpy( entry->key, key, key_size );
+	uint16_t * bucket = cache_bucket( cache, hash );
+	entry->chain = *bucket;
+	*bucket      = index;
+	cache_pushNewest( cache, index );
+	return entry;
+}
+
+
+illuminatir_error_t illuminatir_cache_init( illuminatir_cache_t * cache, illuminatir_cache_entry_t * entries, uint16_t entries_count )
+{
+	if( !cache || !entries ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	if( !entries_count || entries_count == CACHE_NONE ) {
+		return ILLUMINATIR_ERROR_INVALID_SIZE;
+	}
+	for( uint16_t i = 0; i < entries_count; i++ ) {
+		entries[i].head = CACHE_NONE;
+	}
+	cache->entries       = entries;
+	cache->entries_count = entries_count;
+	cache->used          = 0;
+	cache->newest        = CACHE_NONE;
+	cache->oldest        = CACHE_NONE;
+	cache->hits          = 0;
+	cache->misses        = 0;
+	cache->evictions     = 0;
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+const uint8_t * illuminatir_cache_get( illuminatir_cache_t * cache, const uint8_t * key, uint16_t key_size, size_t * frame_size )
+{
+	if( frame_size ) {
+		*frame_size = 0;
+	}
+	if( !cache || (!key && key_size) || !frame_size ) {
+		return NULL;
+	}
+	const illuminatir_cache_entry_t * entry = cache_lookup( cache, CACHE_KIND_FRAME, cache_hash( CACHE_KIND_FRAME, key, key_size ), key, key_size );
+	if( !entry ) {
+		return NULL;
+	}
+	*frame_size = entry->frame_size;
+	return entry->frame;
+}
+
+
+illuminatir_error_t illuminatir_cache_put( illuminatir_cache_t * cache, const uint8_t * key, uint16_t key_size, const uint8_t * frame, size_t frame_size )
+{
+	if( !cache || (!key && key_size) || !frame ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	if( key_size > ILLUMINATIR_CACHE_KEY_MAXSIZE || frame_size > ILLUMINATIR_CACHE_FRAME_MAXSIZE ) {
+		return ILLUMINATIR_ERROR_BUFFER_OVERFLOW;
+	}
+	uint32_t hash = cache_hash( CACHE_KIND_FRAME, key, key_size );
+	uint16_t index = cache_find( cache, CACHE_KIND_FRAME, hash, key, key_size );
+	illuminatir_cache_entry_t * entry;
+	if( index != CACHE_NONE ) {
+		entry = &cache->entries[index];
+		if( index != cache->newest ) {
+			cache_unlinkLru( cache, index );
+			cache_pushNewest( cache, index );
+		}
+	} else {
+		entry = cache_claim( cache, CACHE_KIND_FRAME, hash, key, key_size );
+	}
+	memcpy( entry->frame, frame, frame_size );
+	entry->frame_size = (uint16_t)frame_size;
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+// Encodes raw packets into an entry claimed for them.
+static void cache_finalize( illuminatir_cache_entry_t * entry, illuminatir_frame_t * frame, uint8_t kind )
+{
+	size_t frame_size = 0;
+	if( kind & CACHE_KIND_RAND ) {
+		illuminatir_rand_cobs_frame_finalize( frame, &frame_size );
+	} else {
+		illuminatir_cobs_frame_finalize( frame, &frame_size );
+	}
+	entry->frame_size = (uint16_t)frame_size;
+}
+
+
+static illuminatir_error_t cache_config( illuminatir_cache_t * cache, uint8_t kind, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size, const uint8_t ** frame, size_t * frame_size )
+{
+	if( !cache || !frame || !frame_size || (!key && key_len) || (!values && values_size) ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	if( key_len > ILLUMINATIR_CONFIG_KEY_MAXLEN || values_size > ILLUMINATIR_CONFIG_VALUES_MAXSIZE ||
+	    1 + key_len + values_size > ILLUMINATIR_CACHE_KEY_MAXSIZE ||
+	    ILLUMINATIR_FRAME_BUFFER_SIZE(ILLUMINATIR_PACKET_MAXSIZE) > ILLUMINATIR_CACHE_FRAME_MAXSIZE ) { // entries too small
+		return ILLUMINATIR_ERROR_BUFFER_OVERFLOW;
+	}
+	// The key length keeps apart keys and values split differently.
+	uint8_t content[1 + ILLUMINATIR_CONFIG_KEY_MAXLEN + ILLUMINATIR_CONFIG_VALUES_MAXSIZE];
+	uint16_t content_size = (uint16_t)(1 + key_len + values_size);
+	content[0] = key_len;
+	if( key_len ) {
+		memcpy( content + 1, key, key_len );
+	}
+	if( values_size ) {
+		memcpy( content + 1 + key_len, values, values_size );
+	}
+
+	uint32_t hash = cache_hash( kind, content, content_size );
+	illuminatir_cache_entry_t * entry = cache_lookup( cache, kind, hash, content, content_size );
+	if( !entry ) {
+		// Build first, so that invalid Config packets do not evict anything.
+		uint8_t packet[ILLUMINATIR_PACKET_MAXSIZE];
+		uint8_t packet_size = sizeof(packet);
+		illuminatir_error_t err = illuminatir_build_config( packet, &packet_size, key, key_len, values, values_size );
+		if( err != ILLUMINATIR_ERROR_NONE ) {
+			return err;
+		}
+		entry = cache_claim( cache, kind, hash, content, content_size );
+		illuminatir_frame_t packetFrame;
+		illuminatir_frame_init( &packetFrame, entry->frame, sizeof(entry->frame) );
+		illuminatir_frame_add_packets( &packetFrame, packet, packet_size );
+		cache_finalize( entry, &packetFrame, kind );
+	}
+	*frame      = entry->frame;
+	*frame_size = entry->frame_size;
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+illuminatir_error_t illuminatir_cobs_cache_config( illuminatir_cache_t * cache, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size, const uint8_t ** frame, size_t * frame_size )
+{
+	return cache_config( cache, CACHE_KIND_CONFIG, key, key_len, values, values_size, frame, frame_size );
+}
+
+
+illuminatir_error_t illuminatir_rand_cobs_cache_config( illuminatir_cache_t * cache, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size, const uint8_t ** frame, size_t * frame_size )
+{
+	return cache_config( cache, CACHE_KIND_CONFIG | CACHE_KIND_RAND, key, key_len, values, values_size, frame, frame_size );
+}
+
+
+static illuminatir_error_t cache_universe( illuminatir_cache_t * cache, uint8_t kind, const uint8_t * universe, const uint8_t ** frame, size_t * frame_size )
+{
+	if( !cache || !universe || !frame || !frame_size ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	if( ILLUMINATIR_CHANNELS > ILLUMINATIR_CACHE_KEY_MAXSIZE || ILLUMINATIR_FRAME_BUFFER_SIZE(ILLUMINATIR_PLAN_MAXSIZE) > ILLUMINATIR_CACHE_FRAME_MAXSIZE ) { // entries too small
+		return ILLUMINATIR_ERROR_BUFFER_OVERFLOW;
+	}
+	uint32_t hash = cache_hash( kind, universe, ILLUMINATIR_CHANNELS );
+	illuminatir_cache_entry_t * entry = cache_lookup( cache, kind, hash, universe, ILLUMINATIR_CHANNELS );
+	if( !entry ) {
+		entry = cache_claim( cache, kind, hash, universe, ILLUMINATIR_CHANNELS );
+		illuminatir_frame_t universeFrame;
+		illuminatir_frame_init( &universeFrame, entry->frame, sizeof(entry->frame) );
+		for( unsigned channel = 0; channel < ILLUMINATIR_CHANNELS; channel += ILLUMINATIR_OFFSETARRAY_MAXVALUES ) {
+			illuminatir_frame_add_offsetArray( &universeFrame, (uint8_t)channel, universe + channel, ILLUMINATIR_OFFSETARRAY_MAXVALUES );
+		}
+		cache_finalize( entry, &universeFrame, kind );
+	}
+	*frame      = entry->frame;
+	*frame_size = entry->frame_size;
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+illuminatir_error_t illuminatir_cobs_cache_universe( illuminatir_cache_t * cache, const uint8_t * universe, const uint8_t ** frame, size_t * frame_size )
+{
+	return cache_universe( cache, CACHE_KIND_UNIVERSE, universe, frame, frame_size );
+}
+
+
+illuminatir_error_t illuminatir_rand_cobs_cache_universe( illuminatir_cache_t * cache, const uint8_t * universe, const uint8_t ** frame, size_t * frame_size )
+{
+	return cache_universe( cache, CACHE_KIND_UNIVERSE | CACHE_KIND_RAND, universe, frame, frame_size );
+}
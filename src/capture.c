@@ -0,0 +1,373 @@
+#include "illuminatir.h"
+#include "illuminatir_capture.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#	error "The capture files are little endian and written as in memory"
+#endif
+
+static_assert( sizeof(illuminatir_capture_fileHeader_t) == 16, "Unexpected padding in the file header" );
+static_assert( sizeof(illuminatir_capture_chunkHeader_t) == 8, "Unexpected padding in the chunk header" );
+static_assert( sizeof(illuminatir_capture_recordHeader_t) == 16, "Unexpected padding in the record header" );
+static_assert( sizeof(illuminatir_capture_indexEntry_t) == 24, "Unexpected padding in the index entry" );
+static_assert( ILLUMINATIR_CAPTURE_CHUNK_SIZE % 8 == 0, "Chunks must keep the records aligned" );
+static_assert( ILLUMINATIR_CAPTURE_RECORD_MAXSIZE + sizeof(illuminatir_capture_recordHeader_t) <= ILLUMINATIR_CAPTURE_CHUNK_SIZE, "The largest record must fit into a chunk" );
+
+#define CAPTURE_MAGIC       "IRcaptur"
+#define CAPTURE_INDEX_MAGIC "IRcapidx"
+#define CAPTURE_CHUNK_MAGIC 0x68635249u // "IRch"
+#define CAPTURE_PATH_MAXLEN 4096
+
+
+// Size of a record including its header and padding.
+static inline size_t capture_recordSize( size_t size )
+{
+	return sizeof(illuminatir_capture_recordHeader_t) + ((size + 7) & ~(size_t)7);
+}
+
+
+// Writes all of data, retrying on interrupts and partial writes.
+static int capture_writeAll( int fd, const void * data, size_t size )
+{
+	const uint8_t * p = data;
+	while( size ) {
+		ssize_t written = write( fd, p, size );
+		if( written < 0 ) {
+			if( errno == EINTR ) {
+				continue;
+			}
+			return 0;
+		}
+		p += written;
+		size -= (size_t)written;
+	}
+	return 1;
+}
+
+
+static int capture_indexPath( char * index_path, const char * path )
+{
+	int len = snprintf( index_path, CAPTURE_PATH_MAXLEN, "%s" ILLUMINATIR_CAPTURE_INDEX_SUFFIX, path );
+	return len > 0 && len < CAPTURE_PATH_MAXLEN;
+}
+
+
+illuminatir_error_t illuminatir_capture_writer_open( illuminatir_capture_writer_t * writer, const char * path )
+{
+	if( !writer || !path ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	char index_path[CAPTURE_PATH_MAXLEN];
+	if( !capture_indexPath( index_path, path ) ) {
+		return ILLUMINATIR_ERROR_INVALID_SIZE;
+	}
+	writer->fd = open( path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 );
+	if( writer->fd < 0 ) {
+		return ILLUMINATIR_ERROR_UNKNOWN;
+	}
+	writer->index_fd = open( index_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 );
+	if( writer->index_fd < 0 ) {
+		close( writer->fd );
+		return ILLUMINATIR_ERROR_UNKNOWN;
+	}
+	illuminatir_capture_fileHeader_t header = { CAPTURE_MAGIC, ILLUMINATIR_CAPTURE_VERSION, 0 };
+	illuminatir_capture_fileHeader_t index_header = { CAPTURE_INDEX_MAGIC, ILLUMINATIR_CAPTURE_VERSION, 0 };
+	if( !capture_writeAll( writer->fd, &header, sizeof(header) ) || !capture_writeAll( writer->index_fd, &index_header, sizeof(index_header) ) ) {
+		close( writer->fd );
+		close( writer->index_fd );
+		return ILLUMINATIR_ERROR_UNKNOWN;
+	}
+	writer->offset         = sizeof(header);
+	writer->last_timestamp = 0;
+	writer->chunk_size     = 0;
+	writer->entries_count  = 0;
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+illuminatir_error_t illuminatir_capture_write( illuminatir_capture_writer_t * writer, uint64_t timestamp, uint16_t port, const uint8_t * data, size_t size )
+{
+	if( !writer || !data ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	if( size < 1 || size > ILLUMINATIR_CAPTURE_RECORD_MAXSIZE || timestamp < writer->last_timestamp ) {
+		return ILLUMINATIR_ERROR_INVALID_SIZE;
+	}
+	size_t record_size = capture_recordSize( size );
+	if( writer->chunk_size + record_size > ILLUMINATIR_CAPTURE_CHUNK_SIZE ) {
+		illuminatir_error_t err = illuminatir_capture_flush( writer );
+		if( err != ILLUMINATIR_ERROR_NONE ) {
+			return err;
+		}
+	}
+	uint8_t * chunk = (uint8_t *)writer->chunk + sizeof(illuminatir_capture_chunkHeader_t);
+	uint8_t * p = chunk + writer->chunk_size;
+	illuminatir_capture_recordHeader_t header = { timestamp, port, (uint16_t)size, 0 };
+	memcpy( p, &header, sizeof(header) );
+	memcpy( p + sizeof(header), data, size );
+	memset( p + sizeof(header) + size, 0, record_size - sizeof(header) - size );
+
+	// The chunk's end is only known when it is flushed.
+	writer->entries[writer->entries_count++] = (illuminatir_capture_indexEntry_t){
+		.timestamp = timestamp,
+		.offset    = writer->offset + sizeof(illuminatir_capture_chunkHeader_t) + writer->chunk_size,
+	};
+	writer->chunk_size += record_size;
+	writer->last_timestamp = timestamp;
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+illuminatir_error_t illuminatir_capture_flush( illuminatir_capture_writer_t * writer )
+{
+	if( !writer ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	if( !writer->chunk_size ) {
+		return ILLUMINATIR_ERROR_NONE;
+	}
+	illuminatir_capture_chunkHeader_t header = { CAPTURE_CHUNK_MAGIC, (uint32_t)writer->chunk_size };
+	memcpy( writer->chunk, &header, sizeof(header) );
+	size_t size = sizeof(header) + writer->chunk_size;
+	uint64_t chunk_end = writer->offset + size;
+	for( size_t i = 0; i < writer->entries_count; i++ ) {
+		writer->entries[i].chunk_end = chunk_end;
+	}
+	// The index is written after the chunk, so its entries never point behind the capture.
+	if( !capture_writeAll( writer->fd, writer->chunk, size ) ||
+	    !capture_writeAll( writer->index_fd, writer->entries, writer->entries_count * sizeof(writer->entries[0]) ) ) {
+		return ILLUMINATIR_ERROR_UNKNOWN;
+	}
+	writer->offset = chunk_end;
+	writer->chunk_size = 0;
+	writer->entries_count = 0;
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+illuminatir_error_t illuminatir_capture_writer_close( illuminatir_capture_writer_t * writer )
+{
+	if( !writer ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	illuminatir_error_t err = illuminatir_capture_flush( writer );
+	if( close( writer->fd ) < 0 || close( writer->index_fd ) < 0 ) {
+		err = ILLUMINATIR_ERROR_UNKNOWN;
+	}
+	writer->fd = -1;
+	writer->index_fd = -1;
+	return err;
+}
+
+
+// Maps a whole file read-only. Empty files are not mapped and return NULL with a size of 0.
+static illuminatir_error_t capture_map( const char * path, const void ** mapping, size_t * size )
+{
+	*mapping = NULL;
+	*size = 0;
+	int fd = open( path, O_RDONLY | O_CLOEXEC );
+	if( fd < 0 ) {
+		return ILLUMINATIR_ERROR_UNKNOWN;
+	}
+	struct stat st;
+	if( fstat( fd, &st ) < 0 ) {
+		close( fd );
+		return ILLUMINATIR_ERROR_UNKNOWN;
+	}
+	if( st.st_size > 0 ) {
+		void * p = mmap( NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+		if( p == MAP_FAILED ) {
+			close( fd );
+			return ILLUMINATIR_ERROR_UNKNOWN;
+		}
+		*mapping = p;
+		*size = (size_t)st.st_size;
+	}
+	close( fd ); // the mapping stays valid
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+static illuminatir_error_t capture_checkHeader( const void * mapping, size_t size, const char * magic )
+{
+	illuminatir_capture_fileHeader_t header;
+	if( size < sizeof(header) ) {
+		return ILLUMINATIR_ERROR_UNSUPPORTED_FORMAT;
+	}
+	memcpy( &header, mapping, sizeof(header) );
+	if( memcmp( header.magic, magic, sizeof(header.magic) ) ) {
+		return ILLUMINATIR_ERROR_UNSUPPORTED_FORMAT;
+	}
+	if( header.version != ILLUMINATIR_CAPTURE_VERSION ) {
+		return ILLUMINATIR_ERROR_UNSUPPORTED_VERSION;
+	}
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+// Returns the end of the complete chunk at offset, or 0 if there is none.
+static size_t capture_chunkEnd( const uint8_t * capture, size_t capture_size, size_t offset )
+{
+	illuminatir_capture_chunkHeader_t header;
+	if( capture_size - offset < sizeof(header) ) {
+		return 0;
+	}
+	memcpy( &header, capture + offset, sizeof(header) );
+	if( header.magic != CAPTURE_CHUNK_MAGIC || header.size % 8 || header.size > capture_size - offset - sizeof(header) ) {
+		return 0;
+	}
+	return offset + sizeof(header) + header.size;
+}
+
+
+illuminatir_error_t illuminatir_capture_reader_open( illuminatir_capture_reader_t * reader, const char * path )
+{
+	if( !reader || !path ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	char index_path[CAPTURE_PATH_MAXLEN];
+	if( !capture_indexPath( index_path, path ) ) {
+		return ILLUMINATIR_ERROR_INVALID_SIZE;
+	}
+	const void * mapping;
+	illuminatir_error_t err = capture_map( path, &mapping, &reader->mapping_size );
+	if( err != ILLUMINATIR_ERROR_NONE ) {
+		return err;
+	}
+	err = capture_checkHeader( mapping, reader->mapping_size, CAPTURE_MAGIC );
+	if( err != ILLUMINATIR_ERROR_NONE ) {
+		if( mapping ) {
+			munmap( (void *)mapping, reader->mapping_size );
+		}
+		return err;
+	}
+	reader->capture = mapping;
+
+	// Cut off an incomplete last chunk, e.g. of a writer that crashed.
+	size_t end = sizeof(illuminatir_capture_fileHeader_t);
+	for( size_t next; (next = capture_chunkEnd( reader->capture, reader->mapping_size, end )); ) {
+		end = next;
+	}
+	reader->capture_size = end;
+
+	// The index is optional. Entries of chunks missing in the capture are ignored.
+	reader->index = NULL;
+	reader->index_count = 0;
+	if( capture_map( index_path, &reader->index_mapping, &reader->index_size ) != ILLUMINATIR_ERROR_NONE ) {
+		reader->index_mapping = NULL;
+		reader->index_size = 0;
+	} else if( capture_checkHeader( reader->index_mapping, reader->index_size, CAPTURE_INDEX_MAGIC ) == ILLUMINATIR_ERROR_NONE ) {
+		reader->index = (const illuminatir_capture_indexEntry_t *)((const uint8_t *)reader->index_mapping + sizeof(illuminatir_capture_fileHeader_t));
+		reader->index_count = (reader->index_size - sizeof(illuminatir_capture_fileHeader_t)) / sizeof(illuminatir_capture_indexEntry_t);
+		while( reader->index_count && reader->index[reader->index_count - 1].chunk_end > reader->capture_size ) {
+			reader->index_count--;
+		}
+		// The reader starts reading at the entries, so they must point into the capture.
+		for( size_t i = 0; i < reader->index_count; i++ ) {
+			const illuminatir_capture_indexEntry_t * entry = &reader->index[i];
+			if( entry->offset < sizeof(illuminatir_capture_fileHeader_t) || entry->offset % 8 ||
+			    entry->offset >= entry->chunk_end || entry->chunk_end > reader->capture_size ) {
+				illuminatir_capture_reader_close( reader );
+				return ILLUMINATIR_ERROR_INVALID_SIZE;
+			}
+		}
+	}
+
+	reader->position = sizeof(illuminatir_capture_fileHeader_t);
+	reader->chunk_end = reader->position;
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+void illuminatir_capture_reader_close( illuminatir_capture_reader_t * reader )
+{
+	if( !reader ) {
+		return;
+	}
+	if( reader->capture ) {
+		munmap( (void *)reader->capture, reader->mapping_size );
+	}
+	if( reader->index_mapping ) {
+		munmap( (void *)reader->index_mapping, reader->index_size );
+	}
+	reader->capture = NULL;
+	reader->index_mapping = NULL;
+	reader->index = NULL;
+}
+
+
+uint8_t illuminatir_capture_next( illuminatir_capture_reader_t * reader, illuminatir_capture_record_t * record )
+{
+	if( !reader || !record ) {
+		return 0;
+	}
+	while( reader->position == reader->chunk_end ) { // start the next chunk, skipping empty ones
+		size_t chunk_end = capture_chunkEnd( reader->capture, reader->capture_size, reader->position );
+		if( !chunk_end ) {
+			return 0;
+		}
+		reader->position += sizeof(illuminatir_capture_chunkHeader_t);
+		reader->chunk_end = chunk_end;
+	}
+	const illuminatir_capture_recordHeader_t * header = (const illuminatir_capture_recordHeader_t *)(reader->capture + reader->position);
+	if( reader->chunk_end - reader->position < sizeof(*header) ||
+	    reader->chunk_end - reader->position < capture_recordSize( header->size ) ) {
+		return 0; // damaged chunk
+	}
+	record->timestamp = header->timestamp;
+	record->port      = header->port;
+	record->size      = header->size;
+	record->data      = (const uint8_t *)(header + 1);
+	reader->position += capture_recordSize( header->size );
+	return 1;
+}
+
+
+void illuminatir_capture_seek( illuminatir_capture_reader_t * reader, uint64_t timestamp )
+{
+	if( !reader ) {
+		return;
+	}
+	reader->position = sizeof(illuminatir_capture_fileHeader_t);
+	reader->chunk_end = reader->position;
+	if( reader->index_count ) {
+		// Binary search for the first entry not older than timestamp.
+		size_t lo = 0, hi = reader->index_count;
+		while( lo < hi ) {
+			size_t mid = lo + (hi - lo) / 2;
+			if( reader->index[mid].timestamp < timestamp ) {
+				lo = mid + 1;
+			} else {
+				hi = mid;
+			}
+		}
+		// Behind the index, walk on from its last record.
+		const illuminatir_capture_indexEntry_t * entry = &reader->index[lo < reader->index_count ? lo : lo - 1];
+		reader->position  = entry->offset;
+		reader->chunk_end = entry->chunk_end;
+		if( lo < reader->index_count ) {
+			return;
+		}
+	}
+	for( ;; ) {
+		size_t position = reader->position;
+		size_t chunk_end = reader->chunk_end;
+		illuminatir_capture_record_t record;
+		if( !illuminatir_capture_next( reader, &record ) || record.timestamp >= timestamp ) {
+			reader->position = position;
+			reader->chunk_end = chunk_end;
+			return;
+		}
+	}
+}
@@ -1,11 +1,84 @@
 #include "illuminatir.h"
+#include "illuminatir_private.h"
 
 #include <stddef.h>
 #include <stdint.h>
 #include <assert.h>
 
 
+#if !defined(ILLUMINATIR_COBS_SIMD)
+#	if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#		define ILLUMINATIR_COBS_SIMD 1
+#	else
+#		define ILLUMINATIR_COBS_SIMD 0
+#	endif
+#endif
+
+#if ILLUMINATIR_COBS_SIMD
+#	include <immintrin.h>
+#endif
+
+#include <string.h>
+
+
 // Based on https://en.wikipedia.org/wiki/Consistent_Overhead_Byte_Stuffing
+//
+// Both directions work on whole blocks: the encoder searches the next zero
+// within at most 254 bytes and copies the run in front of it, the decoder
+// copies each block as given by its code byte.
+
+
+// Returns the index of the first zero in data[0..data_size-1], or data_size if there is none.
+static size_t cobs_findZero_scalar( const uint8_t * data, size_t data_size )
+{
+	size_t i = 0;
+	while( i < data_size && data[i] ) {
+		i++;
+	}
+	return i;
+}
+
+
+#if ILLUMINATIR_COBS_SIMD
+
+static size_t cobs_findZero_sse2( const uint8_t * data, size_t data_size )
+{
+	const __m128i zero = _mm_setzero_si128();
+	size_t i = 0;
+	for( ; i + 16 <= data_size; i += 16 ) {
+		unsigned mask = (unsigned)_mm_movemask_epi8( _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i *)(data + i) ), zero ) );
+		if( mask ) {
+			return i + (size_t)__builtin_ctz( mask );
+		}
+	}
+	return i + cobs_findZero_scalar( data + i, data_size - i );
+}
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("avx2")))
+static size_t cobs_findZero_avx2( const uint8_t * data, size_t data_size )
+{
+	const __m256i zero = _mm256_setzero_si256();
+	size_t i = 0;
+	for( ; i + 32 <= data_size; i += 32 ) {
+		unsigned mask = (unsigned)_mm256_movemask_epi8( _mm256_cmpeq_epi8( _mm256_loadu_si256( (const __m256i *)(data + i) ), zero ) );
+		if( mask ) {
+			return i + (size_t)__builtin_ctz( mask );
+		}
+	}
+	return i + cobs_findZero_sse2( data + i, data_size - i );
+}
+
+#	define COBS_AVX2_SUPPORTED() __builtin_cpu_supports( "avx2" )
+#else
+#	define cobs_findZero_avx2 cobs_findZero_sse2
+#	define COBS_AVX2_SUPPORTED() 0
+#endif
+
+#endif // ILLUMINATIR_COBS_SIMD
+
 
 size_t illuminatir_cobs_encode( uint8_t * dst, size_t dst_size, const uint8_t * src, size_t src_size )
 {
@@ -15,21 +88,30 @@ size_t illuminatir_cobs_encode( uint8_t * dst, size_t dst_size, const uint8_t *
 		return 0;
 	}
 
-	uint8_t * encode = dst;      // Encoded byte pointer
-	uint8_t * codep  = encode++; // Output code pointer
-	uint8_t code     = 1;        // Code value
-	for( const uint8_t * byte = src; src_size--; ++byte ) {
-		if( *byte ) { // Byte not zero, write it
-			*encode++ = *byte, ++code;
-		}
-		if( !*byte || code == 0xff ) { // Input is zero or block completed, restart
-			*codep = code, code = 1, codep = encode;
-			if( !*byte || src_size ) {
-				++encode;
-			}
+	size_t (*findZero)( const uint8_t *, size_t ) = cobs_findZero_scalar;
+#if ILLUMINATIR_COBS_SIMD
+	findZero = COBS_AVX2_SUPPORTED() ? cobs_findZero_avx2 : cobs_findZero_sse2;
+#endif
+
+	uint8_t * encode = dst; // Encoded byte pointer
+	for(;;) {
+		size_t limit = src_size < 254 ? src_size : 254;
+		size_t run   = findZero( src, limit ); // Non-zero bytes in front of the next zero
+		uint8_t * codep = encode++;             // Output code pointer
+		memmove( encode, src, run ); // may overlap when encoding in place
+		encode   += run;
+		src      += run;
+		src_size -= run;
+		*codep    = (uint8_t)(run + 1);
+		if( run < limit ) { // Input is zero, skip it and start the next block
+			src++;
+			src_size--;
+		} else if( run < 254 || !src_size ) { // End of input
+			// A completed block at the very end of input is not followed by
+			// another code byte, just like in the byte-wise algorithm.
+			break;
 		}
 	}
-	*codep = code; // Write final code value
 	return (size_t)(encode - dst);
 }
 
@@ -42,32 +124,57 @@ size_t illuminatir_cobs_decode( uint8_t * dst, size_t dst_size, const uint8_t *
 	}
 
 	const uint8_t * byte   = src; // Encoded input byte pointer
+	const uint8_t * end    = src + src_size;
 	uint8_t *       decode = dst; // Decoded output byte pointer
-	for( uint8_t code = 0xff, block = 0; byte < src + src_size; --block ) {
-		if( block ) { // Decode block byte
-			*decode++ = *byte++;
-		} else {
-			if( code != 0xff ) { // Encoded zero, write it
-				*decode++ = 0;
-			}
-			block = code = *byte++; // Next block length
-			if( !code ) { // Delimiter code found
-				break;
-			}
+	for( uint8_t code = 0xff; byte < end; ) {
+		if( code != 0xff ) { // Encoded zero, write it
+			*decode++ = 0;
+		}
+		code = *byte++; // Next block length
+		if( !code ) { // Delimiter code found
+			break;
 		}
+		size_t block = (size_t)(code - 1);
+		if( block > (size_t)(end - byte) ) { // Truncated block
+			block = (size_t)(end - byte);
+		}
+		memcpy( decode, byte, block );
+		decode += block;
+		byte   += block;
 	}
 	return (size_t)(decode - (uint8_t *)dst);
 }
 
 
 illuminatir_error_t illuminatir_cobs_parse( const uint8_t * cobsPackets, uint8_t cobsPackets_size, illuminatir_parse_setChannel_t setChannelFunc, illuminatir_parse_setConfig_t setConfigFunc )
+{
+	illuminatir_callbacks_t callbacks = { setChannelFunc, setConfigFunc };
+	illuminatir_handler_t handler = illuminatir_callbacks_handler( &callbacks );
+	return illuminatir_cobs_parse_handler( cobsPackets, cobsPackets_size, &handler );
+}
+
+
+illuminatir_error_t illuminatir_cobs_parse_handler( const uint8_t * cobsPackets, uint8_t cobsPackets_size, const illuminatir_handler_t * handler )
 {
 	uint8_t packets[ILLUMINATIR_PACKET_MAXSIZE];  // TODO: maybe use a larger buffer for multiple packets
 	size_t packets_size = illuminatir_cobs_decode( packets, sizeof(packets), cobsPackets, cobsPackets_size );
 	if( packets_size == 0 ) {
+		ILLUMINATIR_STATS_ADD( cobs_errors, 1 );
+		ILLUMINATIR_STATS_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE );
 		return ILLUMINATIR_ERROR_INVALID_SIZE;
 	}
-	return illuminatir_parse( packets, packets_size, setChannelFunc, setConfigFunc );
+	return illuminatir_parse_handler( packets, packets_size, handler );
+}
+
+
+illuminatir_error_t illuminatir_cobs_parse_into( const uint8_t * cobsPackets, uint8_t cobsPackets_size, uint8_t * universe, illuminatir_channelMask_t * dirty, illuminatir_parse_setConfig_t setConfigFunc )
+{
+	if( !universe ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	illuminatir_into_t into = { universe, dirty, setConfigFunc };
+	illuminatir_handler_t handler = illuminatir_into_handler( &into );
+	return illuminatir_cobs_parse_handler( cobsPackets, cobsPackets_size, &handler );
 }
 
 
@@ -90,6 +197,25 @@ illuminatir_error_t illuminatir_cobs_build_offsetArray( uint8_t * cobsPacket, ui
 }
 
 
+illuminatir_error_t illuminatir_cobs_build_channelValuePairs( uint8_t * cobsPacket, uint8_t * cobsPacket_size, const uint8_t * pairs, uint8_t pairs_size )
+{
+	if( !cobsPacket_size ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	uint8_t packet[ILLUMINATIR_PACKET_MAXSIZE] = { 0 };
+	uint8_t packet_size = sizeof(packet);
+	illuminatir_error_t err = illuminatir_build_channelValuePairs( packet, &packet_size, pairs, pairs_size );
+	if( err != ILLUMINATIR_ERROR_NONE ) {
+		return err;
+	}
+	*cobsPacket_size = illuminatir_cobs_encode( cobsPacket, *cobsPacket_size, packet, packet_size );
+	if( *cobsPacket_size == 0 ) {
+		return ILLUMINATIR_ERROR_INVALID_SIZE;
+	}
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
 illuminatir_error_t illuminatir_cobs_build_config( uint8_t * cobsPacket, uint8_t * cobsPacket_size, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size )
 {
 	if( !cobsPacket_size ) {
@@ -0,0 +1,153 @@
+#include "illuminatir.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+
+#define CONFIG_SEED_TRIES 4096 // with at most half of the slots used, about 1 in 100 seeds is perfect in the worst case
+
+
+static inline char config_lower( char c )
+{
+	return (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+}
+
+
+// FNV-1a with a seed, over the keys folded to lower case like config_keysEqual() does, so keys
+// differing in case always hash alike.
+static inline uint32_t config_hash( const char * key, uint8_t key_len, uint32_t seed )
+{
+	uint32_t hash = seed;
+	for( uint8_t i = 0; i < key_len; i++ ) {
+		hash = (hash ^ (uint8_t)config_lower( key[i] )) * 0x01000193u;
+	}
+	return hash ^ (hash >> 16);
+}
+
+
+static int config_keysEqual( const char * a, const char * b, uint8_t len )
+{
+	for( uint8_t i = 0; i < len; i++ ) {
+		if( config_lower( a[i] ) != config_lower( b[i] ) ) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+
+// Tries to place all keys into distinct slots with the given seed.
+static int config_place( illuminatir_configTable_t * table, uint8_t keys_count, uint32_t seed )
+{
+	memset( table->slots, 0, sizeof(table->slots) );
+	for( uint8_t i = 0; i < keys_count; i++ ) {
+		uint8_t key_len = (uint8_t)strlen( table->keys[i].key );
+		uint8_t slot = config_hash( table->keys[i].key, key_len, seed ) & table->mask;
+		if( table->slots[slot] ) {
+			return 0;
+		}
+		table->slots[slot]    = i + 1;
+		table->key_lens[slot] = key_len;
+	}
+	table->seed = seed;
+	return 1;
+}
+
+
+illuminatir_error_t illuminatir_configTable_init( illuminatir_configTable_t * table, const illuminatir_configKey_t * keys, uint8_t keys_count, void * ctx )
+{
+	if( !table || (keys_count && !keys) ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	if( keys_count > ILLUMINATIR_CONFIGTABLE_SLOTS / 2 ) {
+		return ILLUMINATIR_ERROR_INVALID_SIZE;
+	}
+	for( uint8_t i = 0; i < keys_count; i++ ) {
+		if( !keys[i].key ) {
+			return ILLUMINATIR_ERROR_NULL_POINTER;
+		}
+		size_t key_len = strlen( keys[i].key );
+		if( key_len < 1 || key_len > ILLUMINATIR_CONFIG_KEY_MAXLEN ) {
+			return ILLUMINATIR_ERROR_INVALID_SIZE;
+		}
+		// Such keys would never get slots of their own.
+		for( uint8_t j = 0; j < i; j++ ) {
+			if( strlen( keys[j].key ) == key_len && config_keysEqual( keys[i].key, keys[j].key, (uint8_t)key_len ) ) {
+				return ILLUMINATIR_ERROR_UNKNOWN;
+			}
+		}
+	}
+	table->keys = keys;
+	table->ctx  = ctx;
+	table->mask = 0;
+	while( table->mask + 1 < 2 * keys_count ) {
+		table->mask = (uint8_t)(table->mask * 2 + 1);
+	}
+	// Larger tables make perfect seeds more likely, so grow if a size takes too long.
+	for( ;; ) {
+		for( uint32_t seed = 0x811c9dc5u; seed < 0x811c9dc5u + CONFIG_SEED_TRIES; seed++ ) {
+			if( config_place( table, keys_count, seed ) ) {
+				return ILLUMINATIR_ERROR_NONE;
+			}
+		}
+		if( table->mask + 1 >= ILLUMINATIR_CONFIGTABLE_SLOTS ) {
+			return ILLUMINATIR_ERROR_UNKNOWN;
+		}
+		table->mask = (uint8_t)(table->mask * 2 + 1);
+	}
+}
+
+
+illuminatir_error_t illuminatir_configTable_dispatch( const illuminatir_configTable_t * table, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size )
+{
+	if( !table || !key ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	uint8_t slot = config_hash( key, key_len, table->seed ) & table->mask;
+	uint8_t index = table->slots[slot];
+	if( !index || table->key_lens[slot] != key_len || !config_keysEqual( table->keys[index - 1].key, key, key_len ) ) {
+		return ILLUMINATIR_ERROR_UNSUPPORTED_FORMAT;
+	}
+	const illuminatir_configKey_t * entry = &table->keys[index - 1];
+	switch( entry->type ) {
+		case ILLUMINATIR_CONFIGKEY_VOID:
+			if( values_size ) {
+				return ILLUMINATIR_ERROR_INVALID_SIZE;
+			}
+			if( entry->handler.none ) {
+				entry->handler.none( table->ctx );
+			}
+			break;
+		case ILLUMINATIR_CONFIGKEY_UINT8:
+			if( values_size != 1 ) {
+				return ILLUMINATIR_ERROR_INVALID_SIZE;
+			}
+			if( entry->handler.uint8 ) {
+				entry->handler.uint8( table->ctx, values[0] );
+			}
+			break;
+		default:
+			if( entry->handler.bytes ) {
+				entry->handler.bytes( table->ctx, values, values_size );
+			}
+			break;
+	}
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+static void config_setConfig( void * ctx, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size )
+{
+	illuminatir_configTable_dispatch( (const illuminatir_configTable_t *)ctx, key, key_len, values, values_size );
+}
+
+
+illuminatir_handler_t illuminatir_configTable_handler( illuminatir_configTable_t * table )
+{
+	illuminatir_handler_t handler = {
+		.ctx       = table,
+		.setConfig = config_setConfig,
+	};
+	return handler;
+}
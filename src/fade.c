@@ -0,0 +1,78 @@
+#include "illuminatir.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+
+#define FADE_ONE 256 // 1.0 in 8.8 fixed-point
+
+
+// Shapes the elapsed fraction of the fade, both in 8.8 fixed-point from 0 to FADE_ONE.
+static uint16_t fade_curve( uint8_t curve, uint32_t progress )
+{
+	switch( curve ) {
+		case ILLUMINATIR_FADE_EASE_IN:
+			return (uint16_t)((progress * progress) >> 8);
+		case ILLUMINATIR_FADE_EASE_OUT:
+			return (uint16_t)(FADE_ONE - (((FADE_ONE - progress) * (FADE_ONE - progress)) >> 8));
+		case ILLUMINATIR_FADE_SMOOTH: // 3p^2 - 2p^3
+			return (uint16_t)((progress * progress * (3 * FADE_ONE - 2 * progress)) >> 16);
+		default:
+			return (uint16_t)progress;
+	}
+}
+
+
+illuminatir_error_t illuminatir_fade_init( illuminatir_fade_t * fade, const uint8_t * start, const uint8_t * target, uint32_t duration_us, illuminatir_fade_curve_t curve, uint32_t now_us )
+{
+	if( !fade || !target ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	if( start ) {
+		memcpy( fade->values, start, ILLUMINATIR_CHANNELS );
+	}
+	memcpy( fade->start, fade->values, ILLUMINATIR_CHANNELS );
+	memcpy( fade->target, target, ILLUMINATIR_CHANNELS );
+	fade->start_us    = now_us;
+	fade->duration_us = duration_us;
+	fade->curve       = (uint8_t)curve;
+	fade->done        = 0;
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+illuminatir_error_t illuminatir_fade_tick( illuminatir_fade_t * fade, uint32_t now_us, illuminatir_channelMask_t * changed )
+{
+	if( !fade ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	if( fade->done ) {
+		return ILLUMINATIR_ERROR_NONE;
+	}
+	uint32_t elapsed = now_us - fade->start_us; // modulo 2^32 like the timestamps, so durations may take all 32 bits
+	uint32_t progress = FADE_ONE;
+	if( elapsed < fade->duration_us ) {
+		progress = (uint32_t)(((uint64_t)elapsed * FADE_ONE) / fade->duration_us);
+	}
+	uint16_t to   = fade_curve( fade->curve, progress );
+	uint16_t from = (uint16_t)(FADE_ONE - to);
+
+	// Plain 16 bit arithmetic over all channels, which compilers vectorize. (255 * 256 + 128 fits)
+	uint8_t next[ILLUMINATIR_CHANNELS];
+	for( unsigned channel = 0; channel < ILLUMINATIR_CHANNELS; channel++ ) {
+		next[channel] = (uint8_t)((uint16_t)(fade->start[channel] * from + fade->target[channel] * to + 128) >> 8);
+	}
+	if( changed ) {
+		for( unsigned word = 0; word < ILLUMINATIR_CHANNELS / 32; word++ ) {
+			uint32_t bits = 0;
+			for( unsigned bit = 0; bit < 32; bit++ ) {
+				bits |= (uint32_t)(next[word * 32 + bit] != fade->values[word * 32 + bit]) << bit;
+			}
+			changed->bits[word] |= bits;
+		}
+	}
+	memcpy( fade->values, next, ILLUMINATIR_CHANNELS );
+	fade->done = progress >= FADE_ONE;
+	return ILLUMINATIR_ERROR_NONE;
+}
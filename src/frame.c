@@ -0,0 +1,152 @@
+#include "illuminatir.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+
+// Returns the largest size of raw packets that fits into buffer_size once encoded.
+static size_t frame_capacity( size_t buffer_size )
+{
+	if( buffer_size < ILLUMINATIR_FRAME_BUFFER_SIZE(1) ) {
+		return 0;
+	}
+	size_t capacity = buffer_size - 1 - (buffer_size - 1 + 254) / 255;
+	while( ILLUMINATIR_FRAME_BUFFER_SIZE(capacity + 1) <= buffer_size ) {
+		capacity++;
+	}
+	while( ILLUMINATIR_FRAME_BUFFER_SIZE(capacity) > buffer_size ) {
+		capacity--;
+	}
+	return capacity;
+}
+
+
+// Returns the space left for the next packet, limited to the size of one packet.
+static uint8_t frame_available( const illuminatir_frame_t * frame )
+{
+	size_t available = frame->buffer_size - frame->offset - frame->size;
+	return available < ILLUMINATIR_PACKET_MAXSIZE ? (uint8_t)available : ILLUMINATIR_PACKET_MAXSIZE;
+}
+
+
+illuminatir_error_t illuminatir_frame_init( illuminatir_frame_t * frame, uint8_t * buffer, size_t buffer_size )
+{
+	if( !frame || !buffer ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	size_t capacity = frame_capacity( buffer_size );
+	if( capacity < ILLUMINATIR_PACKET_MINSIZE ) {
+		return ILLUMINATIR_ERROR_INVALID_SIZE;
+	}
+	frame->buffer      = buffer;
+	frame->buffer_size = buffer_size;
+	frame->offset      = buffer_size - capacity;
+	frame->size        = 0;
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+void illuminatir_frame_reset( illuminatir_frame_t * frame )
+{
+	if( !frame ) {
+		return;
+	}
+	frame->size = 0;
+}
+
+
+illuminatir_error_t illuminatir_frame_add_offsetArray( illuminatir_frame_t * frame, uint8_t offset, const uint8_t * values, uint8_t values_size )
+{
+	if( !frame ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	uint8_t packet_size = frame_available( frame );
+	illuminatir_error_t err = illuminatir_build_offsetArray( frame->buffer + frame->offset + frame->size, &packet_size, offset, values, values_size );
+	if( err != ILLUMINATIR_ERROR_NONE ) {
+		return err;
+	}
+	frame->size += packet_size;
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+illuminatir_error_t illuminatir_frame_add_channelValuePairs( illuminatir_frame_t * frame, const uint8_t * pairs, uint8_t pairs_size )
+{
+	if( !frame ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	uint8_t packet_size = frame_available( frame );
+	illuminatir_error_t err = illuminatir_build_channelValuePairs( frame->buffer + frame->offset + frame->size, &packet_size, pairs, pairs_size );
+	if( err != ILLUMINATIR_ERROR_NONE ) {
+		return err;
+	}
+	frame->size += packet_size;
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+illuminatir_error_t illuminatir_frame_add_config( illuminatir_frame_t * frame, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size )
+{
+	if( !frame ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	uint8_t packet_size = frame_available( frame );
+	illuminatir_error_t err = illuminatir_build_config( frame->buffer + frame->offset + frame->size, &packet_size, key, key_len, values, values_size );
+	if( err != ILLUMINATIR_ERROR_NONE ) {
+		return err;
+	}
+	frame->size += packet_size;
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+illuminatir_error_t illuminatir_frame_add_packets( illuminatir_frame_t * frame, const uint8_t * packets, size_t packets_size )
+{
+	if( !frame || !packets ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	if( packets_size > frame->buffer_size - frame->offset - frame->size ) {
+		return ILLUMINATIR_ERROR_BUFFER_OVERFLOW;
+	}
+	memcpy( frame->buffer + frame->offset + frame->size, packets, packets_size );
+	frame->size += packets_size;
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+static illuminatir_error_t frame_finalize( illuminatir_frame_t * frame, size_t * frame_size, int randomize )
+{
+	if( !frame || !frame_size ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	*frame_size = 0;
+	if( !frame->size ) {
+		return ILLUMINATIR_ERROR_NONE;
+	}
+	uint8_t * packets = frame->buffer + frame->offset;
+	if( randomize ) {
+		illuminatir_rand( packets, frame->size );
+	}
+	// The packets start far enough behind the buffer's beginning to be encoded in place.
+	size_t encoded_size = illuminatir_cobs_encode( frame->buffer, frame->buffer_size - 1, packets, frame->size );
+	frame->size = 0;
+	if( encoded_size == 0 ) {
+		return ILLUMINATIR_ERROR_UNKNOWN;
+	}
+	frame->buffer[encoded_size++] = 0; // delimiter
+	*frame_size = encoded_size;
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+illuminatir_error_t illuminatir_cobs_frame_finalize( illuminatir_frame_t * frame, size_t * frame_size )
+{
+	return frame_finalize( frame, frame_size, 0 );
+}
+
+
+illuminatir_error_t illuminatir_rand_cobs_frame_finalize( illuminatir_frame_t * frame, size_t * frame_size )
+{
+	return frame_finalize( frame, frame_size, 1 );
+}
@@ -17,6 +17,7 @@
  */
 
 #include "illuminatir.h"
+#include "illuminatir_private.h"
 
 #include <stdint.h>
 #include <string.h>
@@ -46,79 +47,200 @@ const char * illuminatir_error_toString( illuminatir_error_t err )
 }
 
 
+static void callbacks_setChannels( void * ctx, uint8_t first_channel, const uint8_t * values, uint8_t count )
+{
+	const illuminatir_callbacks_t * callbacks = ctx;
+	for( uint8_t i = 0; i < count; i++ ) {
+		callbacks->setChannelFunc( first_channel + i, values[i] );
+	}
+}
+
+
+static void callbacks_setChannelValuePairs( void * ctx, const uint8_t * pairs, uint8_t count )
+{
+	const illuminatir_callbacks_t * callbacks = ctx;
+	while( count-- ) {
+		callbacks->setChannelFunc( pairs[0], pairs[1] );
+		pairs += 2;
+	}
+}
+
+
+static void callbacks_setConfig( void * ctx, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size )
+{
+	const illuminatir_callbacks_t * callbacks = ctx;
+	callbacks->setConfigFunc( key, key_len, values, values_size );
+}
+
+
+illuminatir_handler_t illuminatir_callbacks_handler( illuminatir_callbacks_t * callbacks )
+{
+	illuminatir_handler_t handler = {
+		.ctx                  = callbacks,
+		.setChannels          = callbacks->setChannelFunc ? callbacks_setChannels : NULL,
+		.setChannelValuePairs = callbacks->setChannelFunc ? callbacks_setChannelValuePairs : NULL,
+		.setConfig            = callbacks->setConfigFunc ? callbacks_setConfig : NULL,
+	};
+	return handler;
+}
+
+
+static void into_setChannels( void * ctx, uint8_t first_channel, const uint8_t * values, uint8_t count )
+{
+	const illuminatir_into_t * into = ctx;
+	uint8_t * universe = into->universe + first_channel;
+	if( into->dirty ) {
+		for( uint8_t i = 0; i < count; i++ ) {
+			if( universe[i] != values[i] ) {
+				illuminatir_channelMask_set( into->dirty, first_channel + i );
+			}
+		}
+	}
+	memcpy( universe, values, count );
+}
+
+
+static void into_setChannelValuePairs( void * ctx, const uint8_t * pairs, uint8_t count )
+{
+	const illuminatir_into_t * into = ctx;
+	uint8_t * universe = into->universe;
+	for( ; count; count--, pairs += 2 ) {
+		uint8_t channel = pairs[0];
+		uint8_t value = pairs[1];
+		if( into->dirty && universe[channel] != value ) {
+			illuminatir_channelMask_set( into->dirty, channel );
+		}
+		universe[channel] = value;
+	}
+}
+
+
+static void into_setConfig( void * ctx, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size )
+{
+	const illuminatir_into_t * into = ctx;
+	into->setConfigFunc( key, key_len, values, values_size );
+}
+
+
+illuminatir_handler_t illuminatir_into_handler( illuminatir_into_t * into )
+{
+	illuminatir_handler_t handler = {
+		.ctx                  = into,
+		.setChannels          = into_setChannels,
+		.setChannelValuePairs = into_setChannelValuePairs,
+		.setConfig            = into->setConfigFunc ? into_setConfig : NULL,
+	};
+	return handler;
+}
+
+
+illuminatir_error_t illuminatir_dispatch( const uint8_t * packet, const illuminatir_handler_t * handler )
+{
+	uint8_t format = (packet[0] & 0b00110000) >> 4;
+	ILLUMINATIR_STATS_ADD( packets[format], 1 );
+	uint8_t payload_size = illuminatir_header_getPayloadSize( packet[0] );
+	const uint8_t * payload = packet + 1;
+	switch( format ) {
+		case 0: { // OffsetArray - offset + values
+			if( !handler->setChannels ) {
+				break;
+			}
+			uint8_t offset = *payload++;
+			uint8_t count = payload_size - 1;
+			if( offset + count > 256 ) { // split at the wraparound
+				uint8_t first_count = 256 - offset;
+				handler->setChannels( handler->ctx, offset, payload, first_count );
+				handler->setChannels( handler->ctx, 0, payload + first_count, count - first_count );
+			} else {
+				handler->setChannels( handler->ctx, offset, payload, count );
+			}
+			break;
+		}
+		case 1: { // ChannelValuePairs
+			uint8_t pairs = payload_size / 2;
+			uint8_t halfpair = payload_size % 2;
+			uint8_t padded[ILLUMINATIR_PACKET_MAXSIZE - 1];
+			if( halfpair ) { // value of the last pair defaults to 0
+				memcpy( padded, payload, payload_size );
+				padded[payload_size] = 0;
+				payload = padded;
+				pairs++;
+			}
+			if( handler->setChannelValuePairs ) {
+				handler->setChannelValuePairs( handler->ctx, payload, pairs );
+			} else if( handler->setChannels ) {
+				for( ; pairs; pairs--, payload += 2 ) {
+					handler->setChannels( handler->ctx, payload[0], payload + 1, 1 );
+				}
+			}
+			break;
+		}
+		case 2: { // Config - key/value pair
+			if( !handler->setConfig ) {
+				break;
+			}
+			const char * key = (const char *)payload;
+			uint8_t key_len = strnlen( key, payload_size );
+			uint8_t values_size = payload_size - key_len;
+			if( values_size > 0 ) {
+				values_size--;
+			}
+			const uint8_t * values = payload + payload_size - values_size;
+			handler->setConfig( handler->ctx, key, key_len, values, values_size );
+			break;
+		}
+		default: {
+			return ILLUMINATIR_ERROR_UNSUPPORTED_FORMAT;
+		}
+	}
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
 illuminatir_error_t illuminatir_parse( const uint8_t * packets, uint8_t packets_size, illuminatir_parse_setChannel_t setChannelFunc, illuminatir_parse_setConfig_t setConfigFunc )
 {
-	if( !packets ) {
+	illuminatir_callbacks_t callbacks = { setChannelFunc, setConfigFunc };
+	illuminatir_handler_t handler = illuminatir_callbacks_handler( &callbacks );
+	return illuminatir_parse_handler( packets, packets_size, &handler );
+}
+
+
+// Counts an error caused by the data being parsed.
+static inline illuminatir_error_t parse_error( illuminatir_error_t err )
+{
+	ILLUMINATIR_STATS_ERROR( err );
+	return err;
+}
+
+
+illuminatir_error_t illuminatir_parse_handler( const uint8_t * packets, uint8_t packets_size, const illuminatir_handler_t * handler )
+{
+	if( !packets || !handler ) {
 		return ILLUMINATIR_ERROR_NULL_POINTER;
 	}
+	ILLUMINATIR_STATS_ADD( bytes, packets_size );
 	while( packets_size ) {
 		if( packets_size < ILLUMINATIR_PACKET_MINSIZE ) {
-			return ILLUMINATIR_ERROR_PACKET_TOO_SHORT;
+			return parse_error( ILLUMINATIR_ERROR_PACKET_TOO_SHORT );
 		}
 		uint8_t version = packets[0] >> 6;
 		if( version != 0 ) {
-			return ILLUMINATIR_ERROR_UNSUPPORTED_VERSION;
+			return parse_error( ILLUMINATIR_ERROR_UNSUPPORTED_VERSION );
 		}
-		uint8_t format = (packets[0] & 0b00110000) >> 4;
 		uint8_t payload_size = (packets[0] & 0b00001111) + 2;
 		uint8_t packet_size = 1 + payload_size + 1;
 		if( packet_size > packets_size ) {
-			return ILLUMINATIR_ERROR_INVALID_SIZE;
+			return parse_error( ILLUMINATIR_ERROR_INVALID_SIZE );
 		}
-		const uint8_t * payload = packets + 1;
 		uint8_t crc_received = packets[packet_size - 1];
 		uint8_t crc_calculated = illuminatir_crc8( packets, packet_size - 1, ILLUMINATIR_CRC8_INITIAL_SEED );
 		if( crc_received != crc_calculated ) {
-			return ILLUMINATIR_ERROR_INVALID_CRC;
+			return parse_error( ILLUMINATIR_ERROR_INVALID_CRC );
 		}
 		
-		switch( format ) {
-			case 0: { // OffsetArray - offset + values
-				if( !setChannelFunc ) {
-					break;
-				}
-				uint8_t offset = *payload++;
-				for( uint8_t i = 0; i < payload_size - 1; i++ ) {
-					uint8_t channel = i+offset;
-					setChannelFunc( channel, *payload++ );
-				}
-				break;
-			}
-			case 1: { // ChannelValuePairs
-				if( !setChannelFunc ) {
-					break;
-				}
-				uint8_t pairs = payload_size / 2;
-				uint8_t halfpair = payload_size % 2;
-				while( pairs ) {
-					uint8_t channel = *payload++;
-					uint8_t value = *payload++;
-					setChannelFunc( channel, value );
-					pairs--;
-				}
-				if( halfpair ) {
-					uint8_t channel = *payload++;
-					setChannelFunc( channel, 0 );
-				}
-				break;
-			}
-			case 2: { // Config - key/value pair
-				if( !setConfigFunc ) {
-					break;
-				}
-				const char * key = (const char *)payload;
-				uint8_t key_len = strnlen( key, payload_size );
-				uint8_t values_size = payload_size - key_len;
-				if( values_size > 0 ) {
-					values_size--;
-				}
-				const uint8_t * values = payload + payload_size - values_size;
-				setConfigFunc( key, key_len, values, values_size );
-				break;
-			}
-			default: {
-				return ILLUMINATIR_ERROR_UNSUPPORTED_FORMAT;
-			}
+		illuminatir_error_t err = illuminatir_dispatch( packets, handler );
+		if( err != ILLUMINATIR_ERROR_NONE ) {
+			return parse_error( err );
 		}
 		packets += packet_size;
 		packets_size -= packet_size;
@@ -127,6 +249,17 @@ illuminatir_error_t illuminatir_parse( const uint8_t * packets, uint8_t packets_
 }
 
 
+illuminatir_error_t illuminatir_parse_into( const uint8_t * packets, uint8_t packets_size, uint8_t * universe, illuminatir_channelMask_t * dirty, illuminatir_parse_setConfig_t setConfigFunc )
+{
+	if( !universe ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	illuminatir_into_t into = { universe, dirty, setConfigFunc };
+	illuminatir_handler_t handler = illuminatir_into_handler( &into );
+	return illuminatir_parse_handler( packets, packets_size, &handler );
+}
+
+
 illuminatir_error_t illuminatir_build_offsetArray( uint8_t * packet, uint8_t * packet_size, uint8_t offset, const uint8_t * values, uint8_t values_size )
 {
 	if( !packet_size ) {
@@ -156,6 +289,34 @@ illuminatir_error_t illuminatir_build_offsetArray( uint8_t * packet, uint8_t * p
 }
 
 
+illuminatir_error_t illuminatir_build_channelValuePairs( uint8_t * packet, uint8_t * packet_size, const uint8_t * pairs, uint8_t pairs_size )
+{
+	if( !packet_size ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	if( pairs_size < ILLUMINATIR_CHANNELVALUEPAIRS_MINSIZE ) {
+		return ILLUMINATIR_ERROR_INVALID_SIZE;
+	}
+	if( pairs_size > ILLUMINATIR_CHANNELVALUEPAIRS_MAXSIZE ) {
+		return ILLUMINATIR_ERROR_INVALID_SIZE;
+	}
+	uint8_t packet_size_available = *packet_size;
+	*packet_size = 1 + pairs_size + 1;
+	if( packet_size_available < *packet_size ) {
+		return ILLUMINATIR_ERROR_BUFFER_OVERFLOW;
+	}
+	uint8_t * p = packet;
+	*p++ = 0
+	     | (0b01 << 4)
+	     | (pairs_size - 2)
+	     ;
+	memcpy( p, pairs, pairs_size );
+	p += pairs_size;
+	*p++ = illuminatir_crc8( packet, (*packet_size)-1, ILLUMINATIR_CRC8_INITIAL_SEED );
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
 illuminatir_error_t illuminatir_build_config( uint8_t * packet, uint8_t * packet_size, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size )
 {
 	if( !packet_size ) {
@@ -181,8 +342,10 @@ illuminatir_error_t illuminatir_build_config( uint8_t * packet, uint8_t * packet
 	memcpy( p, key, key_len );
 	p += key_len;
 	*p++ = 0;
-	memcpy( p, values, values_size );
-	p += values_size;
+	if( values_size ) { // values may be NULL then
+		memcpy( p, values, values_size );
+		p += values_size;
+	}
 	*p++ = illuminatir_crc8( packet, (*packet_size)-1, ILLUMINATIR_CRC8_INITIAL_SEED );
 	return ILLUMINATIR_ERROR_NONE;
 }
@@ -0,0 +1,65 @@
+#ifndef ILLUMINATIR_PRIVATE_INCLUDED
+#define ILLUMINATIR_PRIVATE_INCLUDED
+
+#include "illuminatir.h"
+
+#include <stdint.h>
+
+
+// Internal helpers shared between the library's translation units. Not part of the public API.
+
+
+// The plain setChannel/setConfig functions, wrapped by illuminatir_callbacks_handler.
+typedef struct {
+	illuminatir_parse_setChannel_t setChannelFunc;
+	illuminatir_parse_setConfig_t  setConfigFunc;
+} illuminatir_callbacks_t;
+
+// Returns a handler calling the functions in callbacks, which must outlive the handler.
+illuminatir_handler_t illuminatir_callbacks_handler( illuminatir_callbacks_t * callbacks );
+
+// The target of the illuminatir_*parse_into functions, wrapped by illuminatir_into_handler.
+typedef struct {
+	uint8_t *                     universe;
+	illuminatir_channelMask_t *   dirty;
+	illuminatir_parse_setConfig_t setConfigFunc;
+} illuminatir_into_t;
+
+// Returns a handler writing into the universe of into, which must outlive the handler.
+illuminatir_handler_t illuminatir_into_handler( illuminatir_into_t * into );
+
+// Calls the handler's functions for a single packet whose header, size and CRC have already been validated.
+illuminatir_error_t illuminatir_dispatch( const uint8_t * packet, const illuminatir_handler_t * handler );
+
+
+#if !defined(ILLUMINATIR_RAND_TABLE)
+#	if defined(__AVR)
+#		define ILLUMINATIR_RAND_TABLE 0 // flash is scarce, use the bitwise LFSR unless requested otherwise
+#	else
+#		define ILLUMINATIR_RAND_TABLE 1
+#	endif
+#endif
+
+#define ILLUMINATIR_RAND_KEYSTREAM_SIZE (ILLUMINATIR_PACKET_MAXSIZE - 2) // randomized bytes of the largest packet
+
+// The precomputed keystream of illuminatir_rand, see rand.c. (In PROGMEM on AVR)
+#if ILLUMINATIR_RAND_TABLE && !defined(__AVR)
+extern const uint8_t illuminatir_rand_keystream[256][ILLUMINATIR_RAND_KEYSTREAM_SIZE + 1];
+#endif
+
+
+// The counters selected by the calling thread, see illuminatir_stats_select.
+#if ILLUMINATIR_STATS
+#	if defined(__AVR)
+extern illuminatir_stats_t * illuminatir_stats_current;
+#	else
+extern _Thread_local illuminatir_stats_t * illuminatir_stats_current;
+#	endif
+#	define ILLUMINATIR_STATS_ADD(FIELD,N) do { if( illuminatir_stats_current ) { illuminatir_stats_current->FIELD += (N); } } while(0)
+#else
+#	define ILLUMINATIR_STATS_ADD(FIELD,N) do { } while(0)
+#endif
+#define ILLUMINATIR_STATS_ERROR(ERR) ILLUMINATIR_STATS_ADD(errors[(ERR)], 1)
+
+
+#endif
@@ -13,24 +13,36 @@
  * Period:              127
  */
 
-static uint8_t lfsr127 = 1;
+static illuminatir_lfsr127_t lfsr127 = { 1 };
 
-void illuminatir_lfsr127_init( uint8_t seed )
+void illuminatir_lfsr127_init_r( illuminatir_lfsr127_t * lfsr, uint8_t seed )
 {
 	// seed must be nonzero
 	if( !seed ) {
 		seed = 1;
 	}
-	lfsr127 = seed;
+	lfsr->state = seed;
 }
 
-uint8_t illuminatir_lfsr127_uint8( void )
+uint8_t illuminatir_lfsr127_uint8_r( illuminatir_lfsr127_t * lfsr )
 {
+	uint8_t state = lfsr->state;
 	uint8_t out = 0;
 	for( uint8_t i = 0; i < 8; i++ ) {
-		uint8_t feedback = (lfsr127 >> 0) ^ (lfsr127 >> 1);
-		lfsr127 = (lfsr127 >> 1) | (feedback << 6);
-		out = (out << 1) | (lfsr127 & 1);
+		uint8_t feedback = (state >> 0) ^ (state >> 1);
+		state = (state >> 1) | (feedback << 6);
+		out = (out << 1) | (state & 1);
 	}
+	lfsr->state = state;
 	return out;
 }
+
+void illuminatir_lfsr127_init( uint8_t seed )
+{
+	illuminatir_lfsr127_init_r( &lfsr127, seed );
+}
+
+uint8_t illuminatir_lfsr127_uint8( void )
+{
+	return illuminatir_lfsr127_uint8_r( &lfsr127 );
+}
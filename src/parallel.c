@@ -0,0 +1,254 @@
+#include "illuminatir_parallel.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+
+// The deques are Chase-Lev deques (https://doi.org/10.1145/1073970.1073974) without pushes: all jobs are
+// handed out before the threads start, so a deque is just the range of job indices [top, bottom).
+// The owner pops from the bottom, thieves steal from the top, and they only race for the last job.
+
+
+// Takes a job from the back of the thread's own deque. Returns 0 if it is empty.
+static int parallel_pop( illuminatir_parallel_worker_t * worker, int64_t * job )
+{
+	int64_t bottom = atomic_load_explicit( &worker->bottom, memory_order_relaxed ) - 1;
+	atomic_store_explicit( &worker->bottom, bottom, memory_order_relaxed );
+	// Publishes the smaller bottom before looking at top, thieves do the opposite.
+	atomic_thread_fence( memory_order_seq_cst );
+	int64_t top = atomic_load_explicit( &worker->top, memory_order_relaxed );
+	if( top > bottom ) {
+		atomic_store_explicit( &worker->bottom, bottom + 1, memory_order_relaxed );
+		return 0;
+	}
+	*job = bottom;
+	if( top < bottom ) {
+		return 1;
+	}
+	// The last job, which a thief may be taking right now.
+	int won = atomic_compare_exchange_strong_explicit( &worker->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed );
+	atomic_store_explicit( &worker->bottom, bottom + 1, memory_order_relaxed );
+	return won;
+}
+
+
+// Takes a job from the front of another thread's deque.
+// Returns 1 with a job, 0 if the deque is empty, -1 if another thread took the job first.
+static int parallel_steal( illuminatir_parallel_worker_t * victim, int64_t * job )
+{
+	int64_t top = atomic_load_explicit( &victim->top, memory_order_acquire );
+	atomic_thread_fence( memory_order_seq_cst );
+	int64_t bottom = atomic_load_explicit( &victim->bottom, memory_order_acquire );
+	if( top >= bottom ) {
+		return 0;
+	}
+	*job = top;
+	if( !atomic_compare_exchange_strong_explicit( &victim->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed ) ) {
+		return -1;
+	}
+	return 1;
+}
+
+
+// Plans and encodes a job into its slot of the transmitter's buffer.
+static void parallel_encodeJob( illuminatir_parallel_t * pool, illuminatir_parallel_job_t * job )
+{
+	illuminatir_parallel_output_t * output = &pool->outputs[job->transmitter];
+	uint8_t packets[ILLUMINATIR_PLAN_MAXSIZE];
+	size_t packets_size = sizeof(packets);
+	illuminatir_frame_t frame;
+	illuminatir_error_t err = illuminatir_plan( packets, &packets_size, job->previous, job->next, ILLUMINATIR_PLAN_OVERHEAD_RAW );
+	if( err == ILLUMINATIR_ERROR_NONE ) {
+		err = illuminatir_frame_init( &frame, output->buffer + job->frame_offset, ILLUMINATIR_PARALLEL_FRAME_MAXSIZE );
+	}
+	if( err == ILLUMINATIR_ERROR_NONE ) {
+		err = illuminatir_frame_add_packets( &frame, packets, packets_size );
+	}
+	if( err == ILLUMINATIR_ERROR_NONE ) {
+		if( pool->randomize ) {
+			err = illuminatir_rand_cobs_frame_finalize( &frame, &job->frame_size );
+		} else {
+			err = illuminatir_cobs_frame_finalize( &frame, &job->frame_size );
+		}
+	}
+	if( err != ILLUMINATIR_ERROR_NONE ) {
+		job->frame_size = 0;
+		int expected = ILLUMINATIR_ERROR_NONE;
+		atomic_compare_exchange_strong( &pool->error, &expected, (int)err );
+	}
+}
+
+
+// Works on the thread's own jobs, then on other threads' jobs until there are none left.
+static void parallel_work( illuminatir_parallel_t * pool, uint8_t self )
+{
+	const uint8_t workers_count = pool->threads_count + 1;
+	int64_t job;
+	while( parallel_pop( &pool->workers[self], &job ) ) {
+		parallel_encodeJob( pool, &pool->jobs[job] );
+	}
+	// Nothing is pushed during a batch, so a deque found empty stays empty.
+	for( uint8_t i = 1; i < workers_count; i++ ) {
+		illuminatir_parallel_worker_t * victim = &pool->workers[(self + i) % workers_count];
+		int stolen;
+		while( (stolen = parallel_steal( victim, &job )) != 0 ) {
+			if( stolen > 0 ) {
+				parallel_encodeJob( pool, &pool->jobs[job] );
+			}
+		}
+	}
+}
+
+
+static void * parallel_thread( void * arg )
+{
+	illuminatir_parallel_worker_t * worker = arg;
+	illuminatir_parallel_t * pool = worker->pool;
+	const uint8_t self = (uint8_t)(worker - pool->workers);
+	uint32_t batch = 0;
+	pthread_mutex_lock( &pool->mutex );
+	for( ;; ) {
+		while( !pool->stop && pool->batch == batch ) {
+			pthread_cond_wait( &pool->started, &pool->mutex );
+		}
+		if( pool->stop ) {
+			break;
+		}
+		batch = pool->batch;
+		pthread_mutex_unlock( &pool->mutex );
+		parallel_work( pool, self );
+		pthread_mutex_lock( &pool->mutex );
+		if( --pool->busy == 0 ) {
+			pthread_cond_signal( &pool->finished );
+		}
+	}
+	pthread_mutex_unlock( &pool->mutex );
+	return NULL;
+}
+
+
+illuminatir_error_t illuminatir_parallel_init( illuminatir_parallel_t * pool, uint8_t threads_count )
+{
+	if( !pool ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	if( threads_count > ILLUMINATIR_PARALLEL_MAXTHREADS ) {
+		return ILLUMINATIR_ERROR_INVALID_SIZE;
+	}
+	memset( pool, 0, sizeof(*pool) );
+	pthread_mutex_init( &pool->mutex, NULL );
+	pthread_cond_init( &pool->started, NULL );
+	pthread_cond_init( &pool->finished, NULL );
+	atomic_init( &pool->error, ILLUMINATIR_ERROR_NONE );
+	for( uint8_t i = 0; i <= ILLUMINATIR_PARALLEL_MAXTHREADS; i++ ) {
+		atomic_init( &pool->workers[i].top, 0 );
+		atomic_init( &pool->workers[i].bottom, 0 );
+		pool->workers[i].pool = pool;
+	}
+	for( ; pool->threads_count < threads_count; pool->threads_count++ ) {
+		illuminatir_parallel_worker_t * worker = &pool->workers[pool->threads_count + 1];
+		if( pthread_create( &worker->thread, NULL, parallel_thread, worker ) ) {
+			illuminatir_parallel_destroy( pool );
+			return ILLUMINATIR_ERROR_UNKNOWN;
+		}
+	}
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+void illuminatir_parallel_destroy( illuminatir_parallel_t * pool )
+{
+	if( !pool ) {
+		return;
+	}
+	pthread_mutex_lock( &pool->mutex );
+	pool->stop = 1;
+	pthread_cond_broadcast( &pool->started );
+	pthread_mutex_unlock( &pool->mutex );
+	for( uint8_t i = 1; i <= pool->threads_count; i++ ) {
+		pthread_join( pool->workers[i].thread, NULL );
+	}
+	pool->threads_count = 0;
+	pthread_cond_destroy( &pool->finished );
+	pthread_cond_destroy( &pool->started );
+	pthread_mutex_destroy( &pool->mutex );
+}
+
+
+static illuminatir_error_t parallel_encode( illuminatir_parallel_t * pool, illuminatir_parallel_job_t * jobs, size_t jobs_count, illuminatir_parallel_output_t * outputs, uint16_t outputs_count, uint8_t randomize )
+{
+	if( !pool || (jobs_count && !jobs) || (outputs_count && !outputs) ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+
+	// Every job gets a slot of the maximum frame size in its transmitter's buffer, in the order of the jobs.
+	for( uint16_t t = 0; t < outputs_count; t++ ) {
+		outputs[t].size = 0;
+	}
+	for( size_t i = 0; i < jobs_count; i++ ) {
+		if( jobs[i].transmitter >= outputs_count ) {
+			return ILLUMINATIR_ERROR_INVALID_SIZE;
+		}
+		illuminatir_parallel_output_t * output = &outputs[jobs[i].transmitter];
+		if( !jobs[i].next || !output->buffer ) {
+			return ILLUMINATIR_ERROR_NULL_POINTER;
+		}
+		if( output->buffer_size - output->size < ILLUMINATIR_PARALLEL_FRAME_MAXSIZE || output->size > output->buffer_size ) {
+			return ILLUMINATIR_ERROR_BUFFER_OVERFLOW;
+		}
+		jobs[i].frame_offset = output->size;
+		jobs[i].frame_size   = 0;
+		output->size += ILLUMINATIR_PARALLEL_FRAME_MAXSIZE;
+	}
+
+	// Equal shares of consecutive jobs, so neighbouring jobs usually end up on the same thread.
+	const uint8_t workers_count = pool->threads_count + 1;
+	for( uint8_t w = 0; w < workers_count; w++ ) {
+		atomic_store_explicit( &pool->workers[w].top, (int64_t)(jobs_count * w / workers_count), memory_order_relaxed );
+		atomic_store_explicit( &pool->workers[w].bottom, (int64_t)(jobs_count * (w + 1) / workers_count), memory_order_relaxed );
+	}
+	pthread_mutex_lock( &pool->mutex );
+	pool->jobs      = jobs;
+	pool->outputs   = outputs;
+	pool->randomize = randomize;
+	atomic_store( &pool->error, ILLUMINATIR_ERROR_NONE );
+	pool->busy = pool->threads_count;
+	pool->batch++;
+	pthread_cond_broadcast( &pool->started );
+	pthread_mutex_unlock( &pool->mutex );
+
+	parallel_work( pool, 0 );
+
+	pthread_mutex_lock( &pool->mutex );
+	while( pool->busy ) {
+		pthread_cond_wait( &pool->finished, &pool->mutex );
+	}
+	pthread_mutex_unlock( &pool->mutex );
+
+	// Closes the gaps between the frames. Every frame moves towards the start, never over a later slot.
+	for( uint16_t t = 0; t < outputs_count; t++ ) {
+		outputs[t].size = 0;
+	}
+	for( size_t i = 0; i < jobs_count; i++ ) {
+		illuminatir_parallel_output_t * output = &outputs[jobs[i].transmitter];
+		memmove( output->buffer + output->size, output->buffer + jobs[i].frame_offset, jobs[i].frame_size );
+		jobs[i].frame_offset = output->size;
+		output->size += jobs[i].frame_size;
+	}
+	return (illuminatir_error_t)atomic_load( &pool->error );
+}
+
+
+illuminatir_error_t illuminatir_cobs_parallel_encode( illuminatir_parallel_t * pool, illuminatir_parallel_job_t * jobs, size_t jobs_count, illuminatir_parallel_output_t * outputs, uint16_t outputs_count )
+{
+	return parallel_encode( pool, jobs, jobs_count, outputs, outputs_count, 0 );
+}
+
+
+illuminatir_error_t illuminatir_rand_cobs_parallel_encode( illuminatir_parallel_t * pool, illuminatir_parallel_job_t * jobs, size_t jobs_count, illuminatir_parallel_output_t * outputs, uint16_t outputs_count )
+{
+	return parallel_encode( pool, jobs, jobs_count, outputs, outputs_count, 1 );
+}
@@ -0,0 +1,497 @@
+#include "illuminatir.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+
+#define PLAN_OFFSETARRAY_OVERHEAD       3 // header + offset + crc
+#define PLAN_CHANNELVALUEPAIRS_OVERHEAD 2 // header + crc
+#define PLAN_PAIRS                      8 // full pairs per ChannelValuePairs packet
+
+#define PLAN_CHOICE_SKIP 0                                     // channel unchanged
+#define PLAN_CHOICE_PAIR (ILLUMINATIR_OFFSETARRAY_MAXVALUES + 1) // channel sent as a ChannelValuePair
+                                                               // 1..16: channel ends an OffsetArray run of that length
+
+#define PLAN_INFINITE 0x7fff // unreachable, with room for adding a packet without overflowing
+
+#define PLAN_KEY_NONE UINT32_MAX // packed run start of an empty window
+
+#define PLAN_WRAP_OFFSETS (ILLUMINATIR_OFFSETARRAY_MAXVALUES - 1) // offsets of OffsetArrays that may wrap around
+#define PLAN_STARTS       ILLUMINATIR_OFFSETARRAY_MAXVALUES       // arc starts searched at once, 0 and those behind a wrapping OffsetArray
+
+#define PLAN_DIFFERENCE_NONE (PLAN_INFINITE + ILLUMINATIR_CHANNELS) // cost less run start of an empty window
+
+
+typedef struct {
+	uint8_t         overhead;
+	uint8_t         changed[ILLUMINATIR_CHANNELS / 8];
+	// Cheapest cost of the first j channels of an arc, by the number of
+	// ChannelValuePairs modulo PLAN_PAIRS so far. A pair sent while this is 0
+	// has to open a new packet.
+	uint16_t        cost[ILLUMINATIR_CHANNELS + 1][PLAN_PAIRS];
+	uint8_t         choice[ILLUMINATIR_CHANNELS + 1][PLAN_PAIRS];
+} plan_t;
+
+
+typedef struct {
+	uint8_t offset;
+	uint8_t length; // 0 if moved over to ChannelValuePairs
+} plan_run_t;
+
+
+static inline int plan_isChanged( const plan_t * plan, uint8_t channel )
+{
+	return plan->changed[channel >> 3] & (1 << (channel & 7));
+}
+
+
+// Returns the cheapest cost of the first j channels of the last planned arc.
+static uint16_t plan_best( const plan_t * plan, uint16_t j )
+{
+	uint16_t best = PLAN_INFINITE;
+	for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+		if( plan->cost[j][r] < best ) {
+			best = plan->cost[j][r];
+		}
+	}
+	return best;
+}
+
+
+// Finds the cheapest packets for the channels [first, first+count), which
+// must not wrap around. Returns the cost, the decisions are left in plan->choice.
+//
+// An OffsetArray ending at j costs cost[i] + (j - i) plus overhead for the
+// run start i among the last 16 channels with the lowest cost[i] - i. Each
+// start is packed into a key holding that difference and i, so ties pick the
+// shortest run. The window minimum comes from aligned blocks of 16 starts: a
+// running minimum of the current block and suffix minima of the previous one.
+// The loops over the pair states have no branches, so compilers vectorize them.
+static uint16_t plan_arc( plan_t * plan, uint16_t first, uint16_t count )
+{
+	uint32_t block[ILLUMINATIR_OFFSETARRAY_MAXVALUES][PLAN_PAIRS];  // keys of the current block
+	uint32_t suffix[ILLUMINATIR_OFFSETARRAY_MAXVALUES][PLAN_PAIRS]; // suffix minima of the previous block
+	uint32_t prefix[PLAN_PAIRS];                                     // minimum of the current block so far
+	for( uint8_t k = 0; k < ILLUMINATIR_OFFSETARRAY_MAXVALUES; k++ ) {
+		for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+			suffix[k][r] = PLAN_KEY_NONE;
+		}
+	}
+	for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+		prefix[r] = PLAN_KEY_NONE;
+		plan->cost[0][r] = PLAN_INFINITE;
+	}
+	plan->cost[0][0] = 0;
+
+	for( uint16_t j = 1; j <= count; j++ ) {
+		const uint16_t start = j - 1; // the run start entering the window
+		const uint8_t k = start % ILLUMINATIR_OFFSETARRAY_MAXVALUES;
+		const uint16_t * previous = plan->cost[start];
+		const int changed = plan_isChanged( plan, first + start );
+		uint32_t window[PLAN_PAIRS];
+		if( changed ) {
+			for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+				block[k][r] = (uint32_t)(previous[r] + ILLUMINATIR_CHANNELS - start) << 8 | (uint8_t)~start;
+			}
+		} else { // runs starting at unchanged channels can be trimmed
+			for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+				block[k][r] = PLAN_KEY_NONE;
+			}
+		}
+		if( !k ) {
+			for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+				prefix[r] = block[k][r];
+			}
+		}
+		for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+			prefix[r] = prefix[r] < block[k][r] ? prefix[r] : block[k][r];
+		}
+		if( k == ILLUMINATIR_OFFSETARRAY_MAXVALUES - 1 ) { // the window is just this block
+			for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+				window[r] = prefix[r];
+				suffix[k][r] = block[k][r];
+			}
+			for( uint8_t n = k; n--; ) {
+				for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+					suffix[n][r] = block[n][r] < suffix[n + 1][r] ? block[n][r] : suffix[n + 1][r];
+				}
+			}
+		} else {
+			for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+				window[r] = prefix[r] < suffix[k + 1][r] ? prefix[r] : suffix[k + 1][r];
+			}
+		}
+
+		uint16_t * cost = plan->cost[j];
+		uint8_t * choice = plan->choice[j];
+		if( !changed ) {
+			for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+				cost[r] = previous[r];
+				choice[r] = PLAN_CHOICE_SKIP;
+			}
+		} else {
+			// Local copies, so the loops need no alias checks.
+			uint32_t best[PLAN_PAIRS], taken[PLAN_PAIRS];
+			best[0] = previous[PLAN_PAIRS - 1] + 2u;
+			for( unsigned r = 1; r < PLAN_PAIRS; r++ ) {
+				best[r] = previous[r - 1] + 2u;
+			}
+			best[1] += PLAN_CHANNELVALUEPAIRS_OVERHEAD + plan->overhead; // a ChannelValuePair opening a packet
+			const uint32_t add = j + PLAN_OFFSETARRAY_OVERHEAD + plan->overhead - ILLUMINATIR_CHANNELS;
+			const uint32_t length = j - UINT8_MAX;
+			for( unsigned r = 0; r < PLAN_PAIRS; r++ ) { // OffsetArray ending here
+				uint32_t c = (window[r] >> 8) + add;
+				taken[r] = c < best[r] ? length + (window[r] & 0xff) : PLAN_CHOICE_PAIR;
+				best[r]  = c < best[r] ? c : best[r];
+			}
+			for( unsigned r = 0; r < PLAN_PAIRS; r++ ) {
+				cost[r] = (uint16_t)(best[r] < PLAN_INFINITE ? best[r] : PLAN_INFINITE);
+			}
+			for( unsigned r = 0; r < PLAN_PAIRS; r++ ) {
+				choice[r] = (uint8_t)taken[r];
+			}
+		}
+	}
+	return plan_best( plan, count );
+}
+
+
+// Finds the cheapest costs of the arcs starting at each of the first 16
+// channels in one pass, with one group of pair states per start. Returns the
+// cost of all channels from start 0, and leaves those of the arcs ending at
+// the offsets of wrapping OffsetArrays in ends. Only costs are searched, so the
+// window holds plain differences cost[i] - i and no decisions.
+static uint16_t plan_circle( const plan_t * plan, uint16_t ends[PLAN_WRAP_OFFSETS][PLAN_STARTS] )
+{
+	uint16_t row[PLAN_STARTS][PLAN_PAIRS];
+	uint16_t block[ILLUMINATIR_OFFSETARRAY_MAXVALUES][PLAN_STARTS][PLAN_PAIRS];
+	uint16_t suffix[ILLUMINATIR_OFFSETARRAY_MAXVALUES][PLAN_STARTS][PLAN_PAIRS];
+	uint16_t prefix[PLAN_STARTS][PLAN_PAIRS];
+	uint16_t open[PLAN_PAIRS] = { 0 }; // overhead of a ChannelValuePair opening a packet
+	open[1] = PLAN_CHANNELVALUEPAIRS_OVERHEAD + plan->overhead;
+	for( uint8_t k = 0; k < ILLUMINATIR_OFFSETARRAY_MAXVALUES; k++ ) {
+		for( uint8_t s = 0; s < PLAN_STARTS; s++ ) {
+			for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+				suffix[k][s][r] = PLAN_DIFFERENCE_NONE;
+			}
+		}
+	}
+	for( uint8_t s = 0; s < PLAN_STARTS; s++ ) {
+		for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+			row[s][r] = PLAN_INFINITE;
+		}
+	}
+	row[0][0] = 0;
+
+	for( uint16_t j = 1; j <= ILLUMINATIR_CHANNELS; j++ ) {
+		const uint16_t start = j - 1;
+		const uint8_t k = start % ILLUMINATIR_OFFSETARRAY_MAXVALUES;
+		const int changed = plan_isChanged( plan, start );
+		for( uint8_t s = 0; s < PLAN_STARTS; s++ ) {
+			for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+				block[k][s][r] = row[s][r] + ILLUMINATIR_CHANNELS - start;
+			}
+		}
+		if( !changed ) { // runs starting at unchanged channels can be trimmed
+			for( uint8_t s = 0; s < PLAN_STARTS; s++ ) {
+				for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+					block[k][s][r] = PLAN_DIFFERENCE_NONE;
+				}
+			}
+		}
+		if( !k ) {
+			memcpy( prefix, block[k], sizeof(prefix) );
+		}
+		for( uint8_t s = 0; s < PLAN_STARTS; s++ ) {
+			for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+				prefix[s][r] = prefix[s][r] < block[k][s][r] ? prefix[s][r] : block[k][s][r];
+			}
+		}
+		const uint16_t (* window)[PLAN_PAIRS] = prefix;
+		uint16_t merged[PLAN_STARTS][PLAN_PAIRS];
+		if( k == ILLUMINATIR_OFFSETARRAY_MAXVALUES - 1 ) {
+			memcpy( suffix[k], block[k], sizeof(suffix[k]) );
+			for( uint8_t n = k; n--; ) {
+				for( uint8_t s = 0; s < PLAN_STARTS; s++ ) {
+					for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+						suffix[n][s][r] = block[n][s][r] < suffix[n + 1][s][r] ? block[n][s][r] : suffix[n + 1][s][r];
+					}
+				}
+			}
+		} else {
+			for( uint8_t s = 0; s < PLAN_STARTS; s++ ) {
+				for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+					merged[s][r] = prefix[s][r] < suffix[k + 1][s][r] ? prefix[s][r] : suffix[k + 1][s][r];
+				}
+			}
+			window = merged;
+		}
+
+		if( changed ) {
+			// Wraps around for small j, but the sums don't.
+			const uint16_t add = j + PLAN_OFFSETARRAY_OVERHEAD + plan->overhead - ILLUMINATIR_CHANNELS;
+			uint16_t previous[PLAN_STARTS][PLAN_PAIRS]; // by the state after another pair
+			memcpy( &previous[0][1], &row[0][0], sizeof(row) - sizeof(row[0][0]) );
+			for( uint8_t s = 0; s < PLAN_STARTS; s++ ) {
+				previous[s][0] = row[s][PLAN_PAIRS - 1];
+			}
+			for( uint8_t s = 0; s < PLAN_STARTS; s++ ) {
+				for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+					uint16_t pair  = previous[s][r] + 2 + open[r];
+					uint16_t array = window[s][r] + add;
+					uint16_t cost  = pair < array ? pair : array;
+					row[s][r] = cost < PLAN_INFINITE ? cost : PLAN_INFINITE;
+				}
+			}
+		}
+		if( j < PLAN_STARTS ) { // the arc starting here
+			for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+				row[j][r] = PLAN_INFINITE;
+			}
+			row[j][0] = 0;
+		}
+		if( j >= ILLUMINATIR_CHANNELS - PLAN_WRAP_OFFSETS && j < ILLUMINATIR_CHANNELS ) {
+			for( uint8_t s = 0; s < PLAN_STARTS; s++ ) {
+				uint16_t best = PLAN_INFINITE;
+				for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+					best = row[s][r] < best ? row[s][r] : best;
+				}
+				ends[j - (ILLUMINATIR_CHANNELS - PLAN_WRAP_OFFSETS)][s] = best;
+			}
+		}
+	}
+	uint16_t best = PLAN_INFINITE;
+	for( uint8_t r = 0; r < PLAN_PAIRS; r++ ) {
+		best = row[0][r] < best ? row[0][r] : best;
+	}
+	return best;
+}
+
+
+static illuminatir_error_t plan_emitOffsetArray( uint8_t ** p, const uint8_t * end, const uint8_t * next, uint8_t offset, uint8_t length )
+{
+	uint8_t values[ILLUMINATIR_OFFSETARRAY_MAXVALUES];
+	for( uint8_t i = 0; i < length; i++ ) {
+		values[i] = next[(uint8_t)(offset + i)];
+	}
+	uint8_t packet_size = (end - *p) < ILLUMINATIR_PACKET_MAXSIZE ? (uint8_t)(end - *p) : ILLUMINATIR_PACKET_MAXSIZE;
+	illuminatir_error_t err = illuminatir_build_offsetArray( *p, &packet_size, offset, values, length );
+	if( err != ILLUMINATIR_ERROR_NONE ) {
+		return err;
+	}
+	*p += packet_size;
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+// Returns the cost of sending count channels as ChannelValuePairs, of which
+// zeros change to 0. Those may be sent as a trailing half pair, one per packet.
+static uint16_t plan_pairsCost( uint16_t count, uint16_t zeros, uint8_t overhead, uint16_t * packets, uint16_t * halves )
+{
+	uint16_t best = count ? PLAN_INFINITE : 0;
+	*packets = 0;
+	*halves  = 0;
+	for( uint16_t n = (count + PLAN_PAIRS) / (PLAN_PAIRS + 1); count && n <= (count + PLAN_PAIRS - 1) / PLAN_PAIRS; n++ ) {
+		uint16_t h = n;
+		if( h > zeros ) {
+			h = zeros;
+		}
+		if( h > count - n ) { // every packet needs at least one full pair
+			h = count - n;
+		}
+		if( count - h > n * PLAN_PAIRS ) {
+			continue;
+		}
+		uint16_t cost = 2 * count - h + n * (PLAN_CHANNELVALUEPAIRS_OVERHEAD + overhead);
+		if( cost < best ) {
+			best    = cost;
+			*packets = n;
+			*halves  = h;
+		}
+	}
+	return best;
+}
+
+
+static illuminatir_error_t plan_emitChannelValuePairs( uint8_t ** p, const uint8_t * end, const uint8_t * next, const uint8_t * channels, uint16_t count, uint8_t overhead )
+{
+	uint16_t zeros = 0;
+	for( uint16_t i = 0; i < count; i++ ) {
+		zeros += !next[channels[i]];
+	}
+	uint16_t packets, halves;
+	plan_pairsCost( count, zeros, overhead, &packets, &halves );
+
+	// Split channels into full pairs and half pairs, keeping the channel order.
+	uint8_t full[ILLUMINATIR_CHANNELS];
+	uint8_t half[ILLUMINATIR_CHANNELS];
+	uint16_t full_count = 0, half_count = 0;
+	for( uint16_t i = count; i--; ) {
+		if( half_count < halves && !next[channels[i]] ) {
+			half[halves - 1 - half_count++] = channels[i];
+		} else {
+			full[count - halves - 1 - full_count++] = channels[i];
+		}
+	}
+
+	const uint8_t * f = full;
+	for( uint16_t n = 0; n < packets; n++ ) {
+		uint8_t pairs[ILLUMINATIR_CHANNELVALUEPAIRS_MAXSIZE];
+		uint8_t pairs_size = 0;
+		uint16_t pairs_count = full_count / packets + (n < full_count % packets);
+		while( pairs_count-- ) {
+			pairs[pairs_size++] = *f;
+			pairs[pairs_size++] = next[*f++];
+		}
+		if( n < halves ) {
+			pairs[pairs_size++] = half[n];
+		}
+		uint8_t packet_size = (end - *p) < ILLUMINATIR_PACKET_MAXSIZE ? (uint8_t)(end - *p) : ILLUMINATIR_PACKET_MAXSIZE;
+		illuminatir_error_t err = illuminatir_build_channelValuePairs( *p, &packet_size, pairs, pairs_size );
+		if( err != ILLUMINATIR_ERROR_NONE ) {
+			return err;
+		}
+		*p += packet_size;
+	}
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+illuminatir_error_t illuminatir_plan( uint8_t * packets, size_t * packets_size, const uint8_t * previous, const uint8_t * next, uint8_t packet_overhead )
+{
+	if( !packets || !packets_size || !next ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+
+	plan_t plan;
+	plan.overhead = packet_overhead;
+	memset( plan.changed, 0, sizeof(plan.changed) );
+	uint16_t changed = 0;
+	for( uint16_t channel = 0; channel < ILLUMINATIR_CHANNELS; channel++ ) {
+		if( !previous || previous[channel] != next[channel] ) {
+			plan.changed[channel >> 3] |= 1 << (channel & 7);
+			changed++;
+		}
+	}
+	if( !changed ) {
+		*packets_size = 0;
+		return ILLUMINATIR_ERROR_NONE;
+	}
+
+	// Either no OffsetArray crosses the wraparound, or exactly one does. In the
+	// latter case it is fixed and the remaining channels form an arc behind
+	// it, starting at one of the first channels. One pass searches all of them.
+	uint16_t wrap_offset = 0, wrap_length = 0;
+	int head = 0, tail = 0; // whether a wrapping OffsetArray could start and end at changed channels
+	for( uint16_t i = 0; i < PLAN_WRAP_OFFSETS; i++ ) {
+		head |= plan_isChanged( &plan, i );
+		tail |= plan_isChanged( &plan, ILLUMINATIR_CHANNELS - 1 - i );
+	}
+	if( head && tail ) {
+		uint16_t ends[PLAN_WRAP_OFFSETS][PLAN_STARTS];
+		uint16_t best = plan_circle( &plan, ends );
+		for( uint16_t offset = ILLUMINATIR_CHANNELS - PLAN_WRAP_OFFSETS; offset < ILLUMINATIR_CHANNELS; offset++ ) {
+			for( uint16_t wrapped = 1; wrapped <= PLAN_WRAP_OFFSETS; wrapped++ ) {
+				uint16_t length = ILLUMINATIR_CHANNELS - offset + wrapped;
+				if( length > ILLUMINATIR_OFFSETARRAY_MAXVALUES || !plan_isChanged( &plan, offset ) || !plan_isChanged( &plan, wrapped - 1 ) ) {
+					continue;
+				}
+				uint16_t cost = length + PLAN_OFFSETARRAY_OVERHEAD + packet_overhead + ends[offset - (ILLUMINATIR_CHANNELS - PLAN_WRAP_OFFSETS)][wrapped];
+				if( cost < best ) {
+					best        = cost;
+					wrap_offset = offset;
+					wrap_length = length;
+				}
+			}
+		}
+	}
+	uint16_t first = 0, count = ILLUMINATIR_CHANNELS;
+	if( wrap_length ) {
+		first = wrap_offset + wrap_length - ILLUMINATIR_CHANNELS;
+		count = wrap_offset - first;
+	}
+	plan_arc( &plan, first, count );
+
+	// Walk the decisions backwards, from the cheapest final state.
+	plan_run_t runs[ILLUMINATIR_CHANNELS];
+	uint16_t runs_count = 0;
+	if( wrap_length ) {
+		runs[runs_count++] = (plan_run_t){ wrap_offset, wrap_length };
+	}
+	uint8_t pooled[ILLUMINATIR_CHANNELS / 8] = { 0 }; // channels sent as ChannelValuePairs
+	uint16_t pool_count = 0, pool_zeros = 0;
+	uint8_t r = 0;
+	for( uint8_t i = 1; i < PLAN_PAIRS; i++ ) {
+		if( plan.cost[count][i] < plan.cost[count][r] ) {
+			r = i;
+		}
+	}
+	for( uint16_t j = count; j > 0; ) {
+		uint8_t choice = plan.choice[j][r];
+		if( choice == PLAN_CHOICE_SKIP ) {
+			j--;
+		} else if( choice == PLAN_CHOICE_PAIR ) {
+			j--;
+			pooled[(first + j) >> 3] |= 1 << ((first + j) & 7);
+			pool_count++;
+			pool_zeros += !next[first + j];
+			r = (r + PLAN_PAIRS - 1) % PLAN_PAIRS;
+		} else {
+			j -= choice;
+			runs[runs_count++] = (plan_run_t){ first + j, choice };
+		}
+	}
+
+	// The search above counts full pairs only. Move OffsetArray runs over to
+	// the pairs where half pairs make that cheaper.
+	uint16_t packets_dummy, halves_dummy;
+	uint16_t pool_cost = plan_pairsCost( pool_count, pool_zeros, packet_overhead, &packets_dummy, &halves_dummy );
+	for( uint16_t i = 0; i < runs_count; i++ ) {
+		uint16_t run_count = 0, run_zeros = 0;
+		for( uint8_t n = 0; n < runs[i].length; n++ ) {
+			uint8_t channel = runs[i].offset + n;
+			if( plan_isChanged( &plan, channel ) ) {
+				run_count++;
+				run_zeros += !next[channel];
+			}
+		}
+		uint16_t cost = plan_pairsCost( pool_count + run_count, pool_zeros + run_zeros, packet_overhead, &packets_dummy, &halves_dummy );
+		if( cost < pool_cost + runs[i].length + PLAN_OFFSETARRAY_OVERHEAD + packet_overhead ) {
+			for( uint8_t n = 0; n < runs[i].length; n++ ) {
+				uint8_t channel = runs[i].offset + n;
+				if( plan_isChanged( &plan, channel ) ) {
+					pooled[channel >> 3] |= 1 << (channel & 7);
+				}
+			}
+			pool_count += run_count;
+			pool_zeros += run_zeros;
+			pool_cost   = cost;
+			runs[i].length = 0;
+		}
+	}
+
+	uint8_t * p = packets;
+	const uint8_t * end = packets + *packets_size;
+	for( uint16_t i = runs_count; i--; ) { // ascending, apart from a wrapping run
+		if( runs[i].length ) {
+			illuminatir_error_t err = plan_emitOffsetArray( &p, end, next, runs[i].offset, runs[i].length );
+			if( err != ILLUMINATIR_ERROR_NONE ) {
+				return err;
+			}
+		}
+	}
+	uint8_t pairs[ILLUMINATIR_CHANNELS];
+	uint16_t pairs_count = 0;
+	for( uint16_t channel = 0; channel < ILLUMINATIR_CHANNELS; channel++ ) {
+		if( pooled[channel >> 3] & (1 << (channel & 7)) ) {
+			pairs[pairs_count++] = channel;
+		}
+	}
+	illuminatir_error_t err = plan_emitChannelValuePairs( &p, end, next, pairs, pairs_count, packet_overhead );
+	if( err != ILLUMINATIR_ERROR_NONE ) {
+		return err;
+	}
+	*packets_size = (size_t)(p - packets);
+	return ILLUMINATIR_ERROR_NONE;
+}
@@ -1,69 +1,484 @@
 #include "illuminatir.h"
+#include "illuminatir_private.h"
 
 #include <stddef.h>
 #include <stdint.h>
 #include <assert.h>
+#include <string.h>
 
 
+#if ILLUMINATIR_RAND_TABLE
+
+#if defined(__AVR)
+#	include <avr/pgmspace.h>
+#else
+#	define PROGMEM
+#	define pgm_read_byte(x) (*(x))
+#endif
+
+#define RAND_KEYSTREAM_SIZE ILLUMINATIR_RAND_KEYSTREAM_SIZE
+
+// Precomputed keystream for every possible seed.
+//
+// Row [seed] holds the first RAND_KEYSTREAM_SIZE bytes returned by illuminatir_lfsr127_uint8_r
+// after illuminatir_lfsr127_init_r(seed), followed by the LFSR state afterwards. The keystream of
+// longer buffers (multiple packets) continues with the row of that state.
+const uint8_t illuminatir_rand_keystream[256][RAND_KEYSTREAM_SIZE + 1] PROGMEM = {
+	{ 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x30 },
+	{ 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x30 },
+	{ 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x50 },
+	{ 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x60 },
+	{ 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0xa1 },
+	{ 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x91 },
+	{ 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0xf1 },
+	{ 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0xc1 },
+	{ 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x43 },
+	{ 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x73 },
+	{ 0xa3, 0xc8, 0xb3, 0xa9, 0xf4, 0x38, 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x13 },
+	{ 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x23 },
+	{ 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0xe2 },
+	{ 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0xd2 },
+	{ 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0xb2 },
+	{ 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x82 },
+	{ 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0x86 },
+	{ 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xb6 },
+	{ 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6 },
+	{ 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xe6 },
+	{ 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xe6, 0x55, 0xfc, 0x08, 0x30, 0xa3, 0x27 },
+	{ 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0x17 },
+	{ 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0x77 },
+	{ 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0x47 },
+	{ 0x30, 0xa3, 0xc8, 0xb3, 0xa9, 0xf4, 0x38, 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0xc5 },
+	{ 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0xf5 },
+	{ 0xb3, 0xa9, 0xf4, 0x38, 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x95 },
+	{ 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0xa5 },
+	{ 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x64 },
+	{ 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xe6, 0x54 },
+	{ 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x34 },
+	{ 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x04 },
+	{ 0x08, 0x30, 0xa3, 0xc8, 0xb3, 0xa9, 0xf4, 0x38, 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x0c },
+	{ 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x3c },
+	{ 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x5c },
+	{ 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6c },
+	{ 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xe6, 0x55, 0xfc, 0x08, 0x30, 0xa3, 0xc8, 0xb3, 0xa9, 0xf4, 0x38, 0x93, 0xad },
+	{ 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x9d },
+	{ 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0xfd },
+	{ 0xc8, 0xb3, 0xa9, 0xf4, 0x38, 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0xcd },
+	{ 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0x4f },
+	{ 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xe6, 0x55, 0x7f },
+	{ 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0x1f },
+	{ 0xa9, 0xf4, 0x38, 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0x2f },
+	{ 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee },
+	{ 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xde },
+	{ 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xbe },
+	{ 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0x8e },
+	{ 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xe6, 0x55, 0xfc, 0x08, 0x30, 0x8a },
+	{ 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xba },
+	{ 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xda },
+	{ 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xea },
+	{ 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xe6, 0x55, 0xfc, 0x08, 0x30, 0xa3, 0xc8, 0xb3, 0x2b },
+	{ 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0x1b },
+	{ 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0x7b },
+	{ 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0x4b },
+	{ 0x38, 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0xc9 },
+	{ 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0xf9 },
+	{ 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x99 },
+	{ 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0xa9 },
+	{ 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x68 },
+	{ 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x58 },
+	{ 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xe6, 0x55, 0xfc, 0x08, 0x30, 0xa3, 0xc8, 0xb3, 0xa9, 0xf4, 0x38 },
+	{ 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x08 },
+	{ 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xe6, 0x55, 0xfc, 0x08, 0x18 },
+	{ 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28 },
+	{ 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x48 },
+	{ 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x78 },
+	{ 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0xb9 },
+	{ 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x89 },
+	{ 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0xe9 },
+	{ 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0xd9 },
+	{ 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0x5b },
+	{ 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0x6b },
+	{ 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0x0b },
+	{ 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0x3b },
+	{ 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xfa },
+	{ 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xca },
+	{ 0xe6, 0x55, 0xfc, 0x08, 0x30, 0xa3, 0xc8, 0xb3, 0xa9, 0xf4, 0x38, 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xaa },
+	{ 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xe6, 0x55, 0xfc, 0x08, 0x30, 0xa3, 0xc8, 0x9a },
+	{ 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0x9e },
+	{ 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xae },
+	{ 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xce },
+	{ 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe },
+	{ 0x55, 0xfc, 0x08, 0x30, 0xa3, 0xc8, 0xb3, 0xa9, 0xf4, 0x38, 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0x3f },
+	{ 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0x0f },
+	{ 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0x6f },
+	{ 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xe6, 0x55, 0xfc, 0x08, 0x30, 0xa3, 0xc8, 0xb3, 0xa9, 0x5f },
+	{ 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0xdd },
+	{ 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0xed },
+	{ 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x8d },
+	{ 0xb5, 0xbd, 0x8d, 0x2e, 0xe6, 0x55, 0xfc, 0x08, 0x30, 0xa3, 0xc8, 0xb3, 0xa9, 0xf4, 0x38, 0x93, 0x6b, 0xbd },
+	{ 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7c },
+	{ 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x4c },
+	{ 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x2c },
+	{ 0xf4, 0x38, 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x1c },
+	{ 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x14 },
+	{ 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x24 },
+	{ 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x44 },
+	{ 0x8d, 0x2e, 0xe6, 0x55, 0xfc, 0x08, 0x30, 0xa3, 0xc8, 0xb3, 0xa9, 0xf4, 0x38, 0x93, 0x6b, 0x7b, 0x1a, 0x74 },
+	{ 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0x9b, 0xb5 },
+	{ 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x85 },
+	{ 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0xe5 },
+	{ 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0xd5 },
+	{ 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0x57 },
+	{ 0x2e, 0xe6, 0x55, 0xfc, 0x08, 0x30, 0xa3, 0xc8, 0xb3, 0xa9, 0xf4, 0x38, 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0x67 },
+	{ 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0x07 },
+	{ 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0x37 },
+	{ 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xf6 },
+	{ 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6 },
+	{ 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xa6 },
+	{ 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0x96 },
+	{ 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xe6, 0x55, 0xfc, 0x08, 0x30, 0xa3, 0xc8, 0xb3, 0xa9, 0xf4, 0x38, 0x92 },
+	{ 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0xa2 },
+	{ 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0xc2 },
+	{ 0x9d, 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0xf2 },
+	{ 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x33 },
+	{ 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x03 },
+	{ 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x63 },
+	{ 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x53 },
+	{ 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0xd1 },
+	{ 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0xe1 },
+	{ 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x81 },
+	{ 0xbd, 0x8d, 0x2e, 0xe6, 0x55, 0xfc, 0x08, 0x30, 0xa3, 0xc8, 0xb3, 0xa9, 0xf4, 0x38, 0x93, 0x6b, 0x7b, 0xb1 },
+	{ 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x70 },
+	{ 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x40 },
+	{ 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xe6, 0x55, 0xfc, 0x20 },
+	{ 0xfc, 0x08, 0x30, 0xa3, 0xc8, 0xb3, 0xa9, 0xf4, 0x38, 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10 },
+	{ 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x30 },
+	{ 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x30 },
+	{ 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x50 },
+	{ 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x50 },
+	{ 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x91 },
+	{ 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x91 },
+	{ 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0xf1 },
+	{ 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0xf1 },
+	{ 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x73 },
+	{ 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x73 },
+	{ 0xa3, 0xc8, 0xb3, 0xa9, 0xf4, 0x38, 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x13 },
+	{ 0xa3, 0xc8, 0xb3, 0xa9, 0xf4, 0x38, 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x13 },
+	{ 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0xd2 },
+	{ 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0xd2 },
+	{ 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0xb2 },
+	{ 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0xb2 },
+	{ 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xb6 },
+	{ 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xb6 },
+	{ 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6 },
+	{ 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6 },
+	{ 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0x17 },
+	{ 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0x17 },
+	{ 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0x77 },
+	{ 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0x77 },
+	{ 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0xf5 },
+	{ 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0xf5 },
+	{ 0xb3, 0xa9, 0xf4, 0x38, 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x95 },
+	{ 0xb3, 0xa9, 0xf4, 0x38, 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x95 },
+	{ 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xe6, 0x54 },
+	{ 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xe6, 0x54 },
+	{ 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x34 },
+	{ 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x34 },
+	{ 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x3c },
+	{ 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x3c },
+	{ 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x5c },
+	{ 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x5c },
+	{ 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x9d },
+	{ 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x9d },
+	{ 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0xfd },
+	{ 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0xfd },
+	{ 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xe6, 0x55, 0x7f },
+	{ 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xe6, 0x55, 0x7f },
+	{ 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0x1f },
+	{ 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0x1f },
+	{ 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xde },
+	{ 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xde },
+	{ 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xbe },
+	{ 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xbe },
+	{ 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xba },
+	{ 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xba },
+	{ 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xda },
+	{ 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xda },
+	{ 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0x1b },
+	{ 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0x1b },
+	{ 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0x7b },
+	{ 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0x7b },
+	{ 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0xf9 },
+	{ 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0xf9 },
+	{ 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x99 },
+	{ 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x99 },
+	{ 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x58 },
+	{ 0x7b, 0x1a, 0x5d, 0xcc, 0xab, 0xf8, 0x10, 0x61, 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x58 },
+	{ 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xe6, 0x55, 0xfc, 0x08, 0x30, 0xa3, 0xc8, 0xb3, 0xa9, 0xf4, 0x38 },
+	{ 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xe6, 0x55, 0xfc, 0x08, 0x30, 0xa3, 0xc8, 0xb3, 0xa9, 0xf4, 0x38 },
+	{ 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28 },
+	{ 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28 },
+	{ 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x48 },
+	{ 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x48 },
+	{ 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x89 },
+	{ 0x47, 0x91, 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x89 },
+	{ 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0xe9 },
+	{ 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0xe9 },
+	{ 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0x6b },
+	{ 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0x6b },
+	{ 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0x0b },
+	{ 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0x0b },
+	{ 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xca },
+	{ 0x67, 0x53, 0xe8, 0x71, 0x26, 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xca },
+	{ 0xe6, 0x55, 0xfc, 0x08, 0x30, 0xa3, 0xc8, 0xb3, 0xa9, 0xf4, 0x38, 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xaa },
+	{ 0xe6, 0x55, 0xfc, 0x08, 0x30, 0xa3, 0xc8, 0xb3, 0xa9, 0xf4, 0x38, 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0xcc, 0xaa },
+	{ 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xae },
+	{ 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xae },
+	{ 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xce },
+	{ 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xce },
+	{ 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0x0f },
+	{ 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0x0f },
+	{ 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0x6f },
+	{ 0xd6, 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0x6f },
+	{ 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0xed },
+	{ 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0xed },
+	{ 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x8d },
+	{ 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x8d },
+	{ 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x4c },
+	{ 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x4c },
+	{ 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x2c },
+	{ 0xf6, 0x34, 0xbb, 0x99, 0x57, 0xf0, 0x20, 0xc2, 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x2c },
+	{ 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x24 },
+	{ 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x24 },
+	{ 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x44 },
+	{ 0x8f, 0x22, 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x44 },
+	{ 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x85 },
+	{ 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x85 },
+	{ 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0xe5 },
+	{ 0xce, 0xa7, 0xd0, 0xe2, 0x4d, 0xad, 0xec, 0x69, 0x77, 0x32, 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0xe5 },
+	{ 0x2e, 0xe6, 0x55, 0xfc, 0x08, 0x30, 0xa3, 0xc8, 0xb3, 0xa9, 0xf4, 0x38, 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0x67 },
+	{ 0x2e, 0xe6, 0x55, 0xfc, 0x08, 0x30, 0xa3, 0xc8, 0xb3, 0xa9, 0xf4, 0x38, 0x93, 0x6b, 0x7b, 0x1a, 0x5d, 0x67 },
+	{ 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0x07 },
+	{ 0xaf, 0xe0, 0x41, 0x85, 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0x07 },
+	{ 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6 },
+	{ 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6 },
+	{ 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xa6 },
+	{ 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xa6 },
+	{ 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0xa2 },
+	{ 0x1e, 0x45, 0x9d, 0x4f, 0xa1, 0xc4, 0x9b, 0x5b, 0xd8, 0xd2, 0xee, 0x65, 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0xa2 },
+	{ 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0xc2 },
+	{ 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0xc2 },
+	{ 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x03 },
+	{ 0x5f, 0xc0, 0x83, 0x0a, 0x3c, 0x8b, 0x3a, 0x9f, 0x43, 0x89, 0x36, 0xb7, 0xb1, 0xa5, 0xdc, 0xca, 0xbf, 0x03 },
+	{ 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x63 },
+	{ 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x63 },
+	{ 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0xe1 },
+	{ 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0xe1 },
+	{ 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x81 },
+	{ 0xbf, 0x81, 0x06, 0x14, 0x79, 0x16, 0x75, 0x3e, 0x87, 0x12, 0x6d, 0x6f, 0x63, 0x4b, 0xb9, 0x95, 0x7f, 0x81 },
+	{ 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x40 },
+	{ 0x7f, 0x02, 0x0c, 0x28, 0xf2, 0x2c, 0xea, 0x7d, 0x0e, 0x24, 0xda, 0xde, 0xc6, 0x97, 0x73, 0x2a, 0xfe, 0x40 },
+	{ 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xe6, 0x55, 0xfc, 0x20 },
+	{ 0xfe, 0x04, 0x18, 0x51, 0xe4, 0x59, 0xd4, 0xfa, 0x1c, 0x49, 0xb5, 0xbd, 0x8d, 0x2e, 0xe6, 0x55, 0xfc, 0x20 }
+};
+
+static inline void rand_xor( uint8_t * data, const uint8_t * keystream, uint8_t size )
+{
+#if defined(__AVR)
+	while( size-- ) {
+		*data++ ^= pgm_read_byte(keystream++);
+	}
+#else
+	for( ; size >= sizeof(uint64_t); size -= sizeof(uint64_t) ) { // word-wide, vectorized by the compiler where possible
+		uint64_t d, k;
+		memcpy( &d, data, sizeof(d) );
+		memcpy( &k, keystream, sizeof(k) );
+		d ^= k;
+		memcpy( data, &d, sizeof(d) );
+		data += sizeof(uint64_t);
+		keystream += sizeof(uint64_t);
+	}
+	while( size-- ) {
+		*data++ ^= *keystream++;
+	}
+#endif
+}
+
 void illuminatir_rand( uint8_t * packets, size_t size )
 {
 	if( !packets || size < 3 ) {
 		return;
 	}
-	illuminatir_lfsr127_init( packets[size-1] ); // using the packet's CRC as seed for the randomizer
-	for( size_t i = 1; i < size-1; i++ ) {       // randomize everything between header and CRC
-		packets[i] ^= illuminatir_lfsr127_uint8();
+	uint8_t seed = packets[size-1]; // using the packet's CRC as seed for the randomizer
+	uint8_t * data = packets + 1;   // randomize everything between header and CRC
+	size_t data_size = size - 2;
+	while( data_size ) {
+		const uint8_t * row = illuminatir_rand_keystream[seed];
+		uint8_t chunk = data_size < RAND_KEYSTREAM_SIZE ? data_size : RAND_KEYSTREAM_SIZE;
+		rand_xor( data, row, chunk );
+		data += chunk;
+		data_size -= chunk;
+		seed = pgm_read_byte(&row[RAND_KEYSTREAM_SIZE]);
+	}
+}
+
+#else
+
+void illuminatir_rand( uint8_t * packets, size_t size )
+{
+	if( !packets || size < 3 ) {
+		return;
+	}
+	illuminatir_lfsr127_t lfsr;                           // local state keeps this reentrant
+	illuminatir_lfsr127_init_r( &lfsr, packets[size-1] ); // using the packet's CRC as seed for the randomizer
+	for( size_t i = 1; i < size-1; i++ ) {                // randomize everything between header and CRC
+		packets[i] ^= illuminatir_lfsr127_uint8_r( &lfsr );
+	}
+}
+
+#endif
+
+
+// A packet's plaintext, given as its header and the parts its payload is gathered from.
+typedef struct {
+	uint8_t         header;
+	uint8_t         parts_count;
+	const uint8_t * parts[3];
+	uint8_t         part_sizes[3];
+} rand_packet_t;
+
+
+// Writes the final wire bytes of a packet gathered straight from its parts.
+// The CRC over the plaintext seeds the randomizer, so the packet is gathered and checksummed first and
+// randomized word-wide in place. A single pass then copies it to the destination and COBS encodes it on
+// the way: packets are far shorter than a COBS block, so every zero is just replaced by the distance to
+// the next one. (Encoding in place within the destination measured much slower, as the byte-wise scan
+// stalls on the word-wide stores of the randomizer.)
+static illuminatir_error_t rand_cobs_encodePacket( uint8_t * randCobsPacket, uint8_t * randCobsPacket_size, const rand_packet_t * packet )
+{
+	uint8_t payload_size = 0;
+	for( uint8_t i = 0; i < packet->parts_count; i++ ) {
+		payload_size += packet->part_sizes[i];
+	}
+	uint8_t packet_size = payload_size + 2;
+	static_assert( ILLUMINATIR_PACKET_MAXSIZE < 0xfe, "Packets must fit into a single COBS block" );
+	if( !randCobsPacket || *randCobsPacket_size < ILLUMINATIR_COBS_ENCODE_DST_MAXSIZE(packet_size) ) {
+		*randCobsPacket_size = 0;
+		return ILLUMINATIR_ERROR_UNKNOWN;
+	}
+
+	uint8_t raw[ILLUMINATIR_PACKET_MAXSIZE];
+	uint8_t * p = raw;
+	*p++ = packet->header;
+	for( uint8_t i = 0; i < packet->parts_count; i++ ) {
+		if( !packet->part_sizes[i] ) { // may be NULL, like the values of a Config without any
+			continue;
+		}
+		memcpy( p, packet->parts[i], packet->part_sizes[i] );
+		p += packet->part_sizes[i];
+	}
+	*p = illuminatir_crc8( raw, packet_size - 1, ILLUMINATIR_CRC8_INITIAL_SEED );
+	illuminatir_rand( raw, packet_size );
+
+	uint8_t code = 0; // where the length of the current COBS block goes
+	for( uint8_t i = 0; i < packet_size; i++ ) {
+		uint8_t byte = raw[i];
+		randCobsPacket[i + 1] = byte;
+		if( !byte ) {
+			randCobsPacket[code] = i + 1 - code;
+			code = i + 1;
+		}
 	}
+	randCobsPacket[code] = packet_size + 1 - code;
+	*randCobsPacket_size = packet_size + 1;
+	return ILLUMINATIR_ERROR_NONE;
 }
 
 
 illuminatir_error_t illuminatir_rand_cobs_parse( const uint8_t * randCobsPackets, uint8_t randCobsPackets_size, illuminatir_parse_setChannel_t setChannelFunc, illuminatir_parse_setConfig_t setConfigFunc )
+{
+	illuminatir_callbacks_t callbacks = { setChannelFunc, setConfigFunc };
+	illuminatir_handler_t handler = illuminatir_callbacks_handler( &callbacks );
+	return illuminatir_rand_cobs_parse_handler( randCobsPackets, randCobsPackets_size, &handler );
+}
+
+
+illuminatir_error_t illuminatir_rand_cobs_parse_handler( const uint8_t * randCobsPackets, uint8_t randCobsPackets_size, const illuminatir_handler_t * handler )
 {
 	uint8_t packets[ILLUMINATIR_PACKET_MAXSIZE]; // TODO: maybe use a larger buffer for multiple packets
 	size_t packets_size = illuminatir_cobs_decode( packets, sizeof(packets), randCobsPackets, randCobsPackets_size );
 	if( packets_size == 0 ) {
+		ILLUMINATIR_STATS_ADD( cobs_errors, 1 );
+		ILLUMINATIR_STATS_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE );
 		return ILLUMINATIR_ERROR_INVALID_SIZE;
 	}
 	illuminatir_rand( packets, packets_size );
-	return illuminatir_parse( packets, packets_size, setChannelFunc, setConfigFunc );
+	return illuminatir_parse_handler( packets, packets_size, handler );
+}
+
+
+illuminatir_error_t illuminatir_rand_cobs_parse_into( const uint8_t * randCobsPackets, uint8_t randCobsPackets_size, uint8_t * universe, illuminatir_channelMask_t * dirty, illuminatir_parse_setConfig_t setConfigFunc )
+{
+	if( !universe ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	illuminatir_into_t into = { universe, dirty, setConfigFunc };
+	illuminatir_handler_t handler = illuminatir_into_handler( &into );
+	return illuminatir_rand_cobs_parse_handler( randCobsPackets, randCobsPackets_size, &handler );
 }
 
 
 illuminatir_error_t illuminatir_rand_cobs_build_offsetArray( uint8_t * randCobsPacket, uint8_t * randCobsPacket_size, uint8_t offset, const uint8_t * values, uint8_t values_size )
 {
-	if( !randCobsPacket_size ) {
+	if( !randCobsPacket_size || (!values && values_size) ) {
 		return ILLUMINATIR_ERROR_NULL_POINTER;
 	}
-	uint8_t packet[ILLUMINATIR_PACKET_MAXSIZE] = { 0 };
-	uint8_t packet_size = sizeof(packet);
-	illuminatir_error_t err = illuminatir_build_offsetArray( packet, &packet_size, offset, values, values_size );
-	if( err != ILLUMINATIR_ERROR_NONE ) {
-		return err;
+	if( values_size < ILLUMINATIR_OFFSETARRAY_MINVALUES || values_size > ILLUMINATIR_OFFSETARRAY_MAXVALUES ) {
+		return ILLUMINATIR_ERROR_INVALID_SIZE;
 	}
-	illuminatir_rand( packet, packet_size );
-	*randCobsPacket_size = illuminatir_cobs_encode( randCobsPacket, *randCobsPacket_size, packet, packet_size );
-	if( *randCobsPacket_size == 0 ) {
-		return ILLUMINATIR_ERROR_UNKNOWN;
+	const rand_packet_t packet = {
+		.header      = (uint8_t)(values_size - 1),
+		.parts_count = 2,
+		.parts       = { &offset, values },
+		.part_sizes  = { 1, values_size },
+	};
+	return rand_cobs_encodePacket( randCobsPacket, randCobsPacket_size, &packet );
+}
+
+
+illuminatir_error_t illuminatir_rand_cobs_build_channelValuePairs( uint8_t * randCobsPacket, uint8_t * randCobsPacket_size, const uint8_t * pairs, uint8_t pairs_size )
+{
+	if( !randCobsPacket_size || (!pairs && pairs_size) ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
 	}
-	return ILLUMINATIR_ERROR_NONE;
+	if( pairs_size < ILLUMINATIR_CHANNELVALUEPAIRS_MINSIZE || pairs_size > ILLUMINATIR_CHANNELVALUEPAIRS_MAXSIZE ) {
+		return ILLUMINATIR_ERROR_INVALID_SIZE;
+	}
+	const rand_packet_t packet = {
+		.header      = (uint8_t)((0b01 << 4) | (pairs_size - 2)),
+		.parts_count = 1,
+		.parts       = { pairs },
+		.part_sizes  = { pairs_size },
+	};
+	return rand_cobs_encodePacket( randCobsPacket, randCobsPacket_size, &packet );
 }
 
 
 illuminatir_error_t illuminatir_rand_cobs_build_config( uint8_t * randCobsPacket, uint8_t * randCobsPacket_size, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size )
 {
-	if( !randCobsPacket_size ) {
+	if( !randCobsPacket_size || (!key && key_len) || (!values && values_size) ) {
 		return ILLUMINATIR_ERROR_NULL_POINTER;
 	}
-	uint8_t packet[ILLUMINATIR_PACKET_MAXSIZE] = { 0 };
-	uint8_t packet_size = sizeof(packet);
-	illuminatir_error_t err = illuminatir_build_config( packet, &packet_size, key, key_len, values, values_size );
-	if( err != ILLUMINATIR_ERROR_NONE ) {
-		return err;
-	}
-	illuminatir_rand( packet, packet_size );
-	*randCobsPacket_size = illuminatir_cobs_encode( randCobsPacket, *randCobsPacket_size, packet, packet_size );
-	if( *randCobsPacket_size == 0 ) {
-		return ILLUMINATIR_ERROR_UNKNOWN;
+	uint16_t payload_size = (uint16_t)(key_len + 1 + values_size);
+	if( payload_size < 2 || payload_size > 15 + 2 ) {
+		return ILLUMINATIR_ERROR_INVALID_SIZE;
 	}
-	return ILLUMINATIR_ERROR_NONE;
+	static const uint8_t delimiter = 0;
+	const rand_packet_t packet = {
+		.header      = (uint8_t)((0b10 << 4) | (payload_size - 2)),
+		.parts_count = 3,
+		.parts       = { (const uint8_t *)key, &delimiter, values },
+		.part_sizes  = { key_len, 1, values_size },
+	};
+	return rand_cobs_encodePacket( randCobsPacket, randCobsPacket_size, &packet );
 }
@@ -0,0 +1,236 @@
+#include "illuminatir.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+
+#define SCHEDULE_BLOCK_SIZE ILLUMINATIR_OFFSETARRAY_MAXVALUES
+#define SCHEDULE_NONE       0xff
+
+
+// Compares timestamps that may wrap around.
+static inline int schedule_before( uint32_t a, uint32_t b )
+{
+	return (int32_t)(a - b) < 0;
+}
+
+
+// Config keys are case-insensitive, see config.c.
+static int schedule_keysEqual( const char * a, const char * b, uint8_t len )
+{
+	for( uint8_t i = 0; i < len; i++ ) {
+		char ca = (a[i] >= 'A' && a[i] <= 'Z') ? (char)(a[i] + ('a' - 'A')) : a[i];
+		char cb = (b[i] >= 'A' && b[i] <= 'Z') ? (char)(b[i] + ('a' - 'A')) : b[i];
+		if( ca != cb ) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+
+static inline uint32_t schedule_bits( const illuminatir_schedule_t * sched, uint8_t packet_size )
+{
+	return (uint32_t)(packet_size + sched->packet_overhead) * sched->byte_bits;
+}
+
+
+static void schedule_refill( illuminatir_schedule_t * sched, uint32_t now_us )
+{
+	if( !sched->bitrate ) {
+		return;
+	}
+	uint32_t burst = schedule_bits( sched, ILLUMINATIR_PACKET_MAXSIZE );
+	uint64_t bits = (uint64_t)(uint32_t)(now_us - sched->last_us) * sched->bitrate / 1000000;
+	if( sched->tokens + bits >= burst ) {
+		sched->tokens  = burst;
+		sched->last_us = now_us;
+		return;
+	}
+	// Only advance by the time the whole bits took, keeping the fraction for later.
+	sched->tokens  += (uint32_t)bits;
+	sched->last_us += (uint32_t)(bits * 1000000 / sched->bitrate);
+}
+
+
+illuminatir_error_t illuminatir_schedule_init( illuminatir_schedule_t * sched, const uint8_t * universe, uint32_t bitrate, uint32_t now_us )
+{
+	if( !sched || !universe ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	memset( sched, 0, sizeof(*sched) );
+	sched->universe        = universe;
+	sched->bitrate         = bitrate;
+	sched->byte_bits       = 10;
+	sched->packet_overhead = ILLUMINATIR_PLAN_OVERHEAD_COBS;
+	sched->latency_us      = 0;
+	sched->refresh_us      = 1000000;
+	// Nothing is known to have been received yet, so every block is due at once.
+	for( uint8_t block = 0; block < ILLUMINATIR_SCHEDULE_BLOCKS; block++ ) {
+		sched->deadline_us[block] = now_us;
+	}
+	sched->dirty   = 0xffff;
+	sched->last_us = now_us;
+	sched->tokens  = schedule_bits( sched, ILLUMINATIR_PACKET_MAXSIZE );
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+illuminatir_error_t illuminatir_schedule_config( illuminatir_schedule_t * sched, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size, uint16_t repeats, uint32_t interval_us, uint32_t now_us )
+{
+	if( !sched ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	if( !repeats && !interval_us ) { // would use up all airtime
+		return ILLUMINATIR_ERROR_INVALID_SIZE;
+	}
+	// A command replaces a pending one with the same key.
+	illuminatir_schedule_config_t * slot = NULL;
+	for( uint8_t i = 0; i < ILLUMINATIR_SCHEDULE_CONFIGS; i++ ) {
+		illuminatir_schedule_config_t * config = &sched->configs[i];
+		if( config->packet_size && config->key_len == key_len && schedule_keysEqual( (const char *)config->packet + 1, key, key_len ) ) {
+			slot = config;
+			break;
+		}
+		if( !config->packet_size && !slot ) {
+			slot = config;
+		}
+	}
+	if( !slot ) {
+		return ILLUMINATIR_ERROR_BUFFER_OVERFLOW;
+	}
+	uint8_t packet_size = sizeof(slot->packet);
+	illuminatir_error_t err = illuminatir_build_config( slot->packet, &packet_size, key, key_len, values, values_size );
+	if( err != ILLUMINATIR_ERROR_NONE ) {
+		return err;
+	}
+	slot->packet_size = packet_size;
+	slot->key_len     = key_len;
+	slot->repeats     = repeats;
+	slot->interval_us = interval_us;
+	slot->deadline_us = now_us + sched->latency_us;
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+illuminatir_error_t illuminatir_schedule_next( illuminatir_schedule_t * sched, uint32_t now_us, uint8_t * packet, uint8_t * packet_size )
+{
+	if( !sched || !packet || !packet_size ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	uint8_t packet_size_available = *packet_size;
+	*packet_size = 0;
+	schedule_refill( sched, now_us );
+
+	// Changed blocks get the tight deadline, unless they are pending already.
+	for( uint8_t block = 0; block < ILLUMINATIR_SCHEDULE_BLOCKS; block++ ) {
+		if( sched->dirty & (1 << block) ) {
+			continue;
+		}
+		if( memcmp( sched->universe + block * SCHEDULE_BLOCK_SIZE, sched->sent + block * SCHEDULE_BLOCK_SIZE, SCHEDULE_BLOCK_SIZE ) ) {
+			sched->dirty |= 1 << block;
+			uint32_t deadline = now_us + sched->latency_us;
+			if( schedule_before( deadline, sched->deadline_us[block] ) ) {
+				sched->deadline_us[block] = deadline;
+			}
+		}
+	}
+
+	// Earliest deadline first. Blocks that are not due yet keep the link busy
+	// with refreshes in round-robin order, repetitions of Config packets wait
+	// for their interval.
+	uint8_t block = SCHEDULE_NONE, config = SCHEDULE_NONE;
+	uint32_t deadline = 0;
+	for( uint8_t i = 0; i < ILLUMINATIR_SCHEDULE_BLOCKS; i++ ) {
+		if( block == SCHEDULE_NONE || schedule_before( sched->deadline_us[i], deadline ) ) {
+			block = i;
+			deadline = sched->deadline_us[i];
+		}
+	}
+	for( uint8_t i = 0; i < ILLUMINATIR_SCHEDULE_CONFIGS; i++ ) {
+		const illuminatir_schedule_config_t * slot = &sched->configs[i];
+		if( !slot->packet_size || schedule_before( now_us, slot->deadline_us - sched->latency_us ) ) { // unused or not released yet
+			continue;
+		}
+		if( schedule_before( slot->deadline_us, deadline ) ) {
+			config = i;
+			deadline = sched->configs[i].deadline_us;
+		}
+	}
+
+	if( config != SCHEDULE_NONE ) {
+		illuminatir_schedule_config_t * slot = &sched->configs[config];
+		uint32_t bits = schedule_bits( sched, slot->packet_size );
+		if( sched->tokens < bits ) {
+			return ILLUMINATIR_ERROR_NONE;
+		}
+		if( packet_size_available < slot->packet_size ) {
+			return ILLUMINATIR_ERROR_BUFFER_OVERFLOW;
+		}
+		memcpy( packet, slot->packet, slot->packet_size );
+		*packet_size = slot->packet_size;
+		sched->tokens -= bits;
+		slot->deadline_us = now_us + slot->interval_us + sched->latency_us;
+		if( slot->repeats == 1 ) { // last repetition
+			slot->packet_size = 0;
+		} else if( slot->repeats ) {
+			slot->repeats--;
+		}
+		return ILLUMINATIR_ERROR_NONE;
+	}
+
+	uint32_t bits = schedule_bits( sched, 1 + 1 + SCHEDULE_BLOCK_SIZE + 1 );
+	if( sched->tokens < bits ) {
+		return ILLUMINATIR_ERROR_NONE;
+	}
+	const uint8_t * values = sched->universe + block * SCHEDULE_BLOCK_SIZE;
+	*packet_size = packet_size_available;
+	illuminatir_error_t err = illuminatir_build_offsetArray( packet, packet_size, block * SCHEDULE_BLOCK_SIZE, values, SCHEDULE_BLOCK_SIZE );
+	if( err != ILLUMINATIR_ERROR_NONE ) {
+		*packet_size = 0;
+		return err;
+	}
+	memcpy( sched->sent + block * SCHEDULE_BLOCK_SIZE, values, SCHEDULE_BLOCK_SIZE );
+	sched->tokens -= bits;
+	sched->dirty &= ~(1 << block);
+	sched->deadline_us[block] = now_us + sched->refresh_us;
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+uint32_t illuminatir_schedule_getStaleness( const illuminatir_schedule_t * sched )
+{
+	if( !sched || !sched->bitrate ) {
+		return UINT32_MAX;
+	}
+	// Response time analysis: a changed block waits for the packet currently
+	// on air, every other block at most once (their next deadlines lie behind
+	// its own as long as latency_us <= refresh_us) and every repetition of the
+	// config packets falling into that time, then is sent itself.
+	uint64_t fixed_bits = (uint64_t)(ILLUMINATIR_SCHEDULE_BLOCKS + 1) * schedule_bits( sched, ILLUMINATIR_PACKET_MAXSIZE );
+	uint64_t staleness = fixed_bits * 1000000 / sched->bitrate;
+	for( unsigned iteration = 0; iteration < 64; iteration++ ) {
+		uint64_t bits = fixed_bits;
+		for( uint8_t i = 0; i < ILLUMINATIR_SCHEDULE_CONFIGS; i++ ) {
+			const illuminatir_schedule_config_t * config = &sched->configs[i];
+			if( !config->packet_size ) {
+				continue;
+			}
+			uint64_t count = config->interval_us ? (staleness + config->interval_us - 1) / config->interval_us + 1 : config->repeats;
+			if( config->repeats && count > config->repeats ) {
+				count = config->repeats;
+			}
+			bits += count * schedule_bits( sched, config->packet_size );
+		}
+		uint64_t next = bits * 1000000 / sched->bitrate;
+		if( next >= UINT32_MAX ) {
+			return UINT32_MAX;
+		}
+		if( next == staleness ) {
+			return (uint32_t)staleness;
+		}
+		staleness = next;
+	}
+	return UINT32_MAX; // repeated configs use up the link
+}
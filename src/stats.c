@@ -0,0 +1,105 @@
+#include "illuminatir.h"
+#include "illuminatir_private.h"
+
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+
+#if ILLUMINATIR_STATS
+#	if defined(__AVR)
+illuminatir_stats_t * illuminatir_stats_current = NULL;
+#	else
+_Thread_local illuminatir_stats_t * illuminatir_stats_current = NULL;
+#	endif
+#endif
+
+
+illuminatir_stats_t * illuminatir_stats_select( illuminatir_stats_t * stats )
+{
+#if ILLUMINATIR_STATS
+	illuminatir_stats_t * previous = illuminatir_stats_current;
+	illuminatir_stats_current = stats;
+	return previous;
+#else
+	(void)stats;
+	return NULL;
+#endif
+}
+
+
+void illuminatir_stats_clear( illuminatir_stats_t * stats )
+{
+	if( stats ) {
+		memset( stats, 0, sizeof(*stats) );
+	}
+}
+
+
+void illuminatir_histogram_clear( illuminatir_histogram_t * histogram )
+{
+	if( histogram ) {
+		memset( histogram, 0, sizeof(*histogram) );
+	}
+}
+
+
+// Returns the bucket of a value, which is its bit length.
+static uint8_t histogram_bucket( uint32_t value )
+{
+	if( !value ) {
+		return 0;
+	}
+#if defined(__GNUC__) && UINT_MAX >= 0xffffffff
+	uint8_t bits = (uint8_t)(sizeof(unsigned) * CHAR_BIT - (unsigned)__builtin_clz( value ));
+#else
+	uint8_t bits = 0;
+	for( ; value; value >>= 1 ) {
+		bits++;
+	}
+#endif
+	return bits < ILLUMINATIR_HISTOGRAM_BUCKETS ? bits : ILLUMINATIR_HISTOGRAM_BUCKETS - 1;
+}
+
+
+void illuminatir_histogram_record( illuminatir_histogram_t * histogram, uint32_t value )
+{
+	if( !histogram ) {
+		return;
+	}
+	histogram->buckets[histogram_bucket( value )]++;
+	histogram->count++;
+	histogram->sum += value;
+	if( value > histogram->max ) {
+		histogram->max = value;
+	}
+}
+
+
+uint32_t illuminatir_histogram_getPercentile( const illuminatir_histogram_t * histogram, uint8_t percent )
+{
+	if( !histogram || !histogram->count ) {
+		return 0;
+	}
+	if( percent > 100 ) {
+		percent = 100;
+	}
+	// The rank of the percentile, rounded up so that percent 0 is the smallest value.
+	uint64_t rank = ((uint64_t)histogram->count * percent + 99) / 100;
+	if( !rank ) {
+		rank = 1;
+	}
+	uint64_t seen = 0;
+	for( uint8_t bucket = 0; bucket < ILLUMINATIR_HISTOGRAM_BUCKETS; bucket++ ) {
+		seen += histogram->buckets[bucket];
+		if( seen >= rank ) {
+			uint32_t upper = bucket ? (uint32_t)(((uint64_t)1 << bucket) - 1) : 0;
+			if( bucket == ILLUMINATIR_HISTOGRAM_BUCKETS - 1 || upper > histogram->max ) {
+				upper = histogram->max;
+			}
+			return upper;
+		}
+	}
+	return histogram->max;
+}
@@ -0,0 +1,216 @@
+#include "illuminatir.h"
+#include "illuminatir_private.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+#define STREAM_FLAG_RAND    (1 << 0) // Frames are randomized and collected in the frame buffer
+#define STREAM_FLAG_STARTED (1 << 1) // Bytes were received since the last delimiter
+#define STREAM_FLAG_ZERO    (1 << 2) // An encoded zero is pending, unless the frame ends
+#define STREAM_FLAG_RESYNC  (1 << 3) // Discarding bytes until the next delimiter
+
+
+static void stream_reset( illuminatir_stream_t * stream )
+{
+	stream->frame_len  = 0;
+	stream->packet_len = 0;
+	stream->code       = 0xff;
+	stream->block      = 0;
+	stream->flags     &= STREAM_FLAG_RAND;
+}
+
+
+static illuminatir_error_t stream_error( illuminatir_stream_t * stream, illuminatir_error_t err )
+{
+	ILLUMINATIR_STATS_ERROR( err );
+	ILLUMINATIR_STATS_ADD( resyncs, 1 );
+	stream->flags |= STREAM_FLAG_RESYNC;
+	return err;
+}
+
+
+static illuminatir_error_t stream_dispatch( illuminatir_stream_t * stream )
+{
+	if( stream->setChannelFunc || stream->setConfigFunc ) {
+		illuminatir_callbacks_t callbacks = { stream->setChannelFunc, stream->setConfigFunc };
+		illuminatir_handler_t handler = illuminatir_callbacks_handler( &callbacks );
+		return illuminatir_dispatch( stream->packet, &handler );
+	}
+	return illuminatir_dispatch( stream->packet, &stream->handler );
+}
+
+
+// Handles a single decoded byte of a raw (not randomized) packet.
+static illuminatir_error_t stream_packetByte( illuminatir_stream_t * stream, uint8_t byte )
+{
+	if( stream->packet_len == 0 ) { // header
+		if( (byte >> 6) != 0 ) {
+			return ILLUMINATIR_ERROR_UNSUPPORTED_VERSION;
+		}
+		stream->packet_size = illuminatir_header_getPacketSize( byte );
+		stream->crc = ILLUMINATIR_CRC8_INITIAL_SEED;
+	}
+	stream->packet[stream->packet_len++] = byte;
+	ILLUMINATIR_STATS_ADD( bytes, 1 );
+	if( stream->packet_len < stream->packet_size ) {
+		stream->crc = illuminatir_crc8( &byte, 1, stream->crc );
+		return ILLUMINATIR_ERROR_NONE;
+	}
+	stream->packet_len = 0;
+	if( byte != stream->crc ) {
+		return ILLUMINATIR_ERROR_INVALID_CRC;
+	}
+	return stream_dispatch( stream );
+}
+
+
+// Handles a single decoded byte of a frame.
+static illuminatir_error_t stream_frameByte( illuminatir_stream_t * stream, uint8_t byte )
+{
+	if( !(stream->flags & STREAM_FLAG_RAND) ) {
+		return stream_packetByte( stream, byte );
+	}
+	if( stream->frame_len >= stream->frame_size ) {
+		return ILLUMINATIR_ERROR_BUFFER_OVERFLOW;
+	}
+	stream->frame[stream->frame_len++] = byte;
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+// Handles the end of a frame.
+static illuminatir_error_t stream_frameEnd( illuminatir_stream_t * stream )
+{
+	if( stream->block ) { // delimiter within a COBS block
+		ILLUMINATIR_STATS_ADD( cobs_errors, 1 );
+		return ILLUMINATIR_ERROR_INVALID_SIZE;
+	}
+	if( stream->flags & STREAM_FLAG_RAND ) {
+		illuminatir_rand( stream->frame, stream->frame_len );
+		for( size_t i = 0; i < stream->frame_len; i++ ) {
+			illuminatir_error_t err = stream_packetByte( stream, stream->frame[i] );
+			if( err != ILLUMINATIR_ERROR_NONE ) {
+				return err;
+			}
+		}
+	}
+	if( stream->packet_len ) { // frame ended within a packet
+		if( stream->packet_len < ILLUMINATIR_PACKET_MINSIZE ) {
+			return ILLUMINATIR_ERROR_PACKET_TOO_SHORT;
+		}
+		return ILLUMINATIR_ERROR_INVALID_SIZE;
+	}
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+void illuminatir_stream_init( illuminatir_stream_t * stream, illuminatir_parse_setChannel_t setChannelFunc, illuminatir_parse_setConfig_t setConfigFunc )
+{
+	illuminatir_stream_init_handler( stream, NULL );
+	if( !stream ) {
+		return;
+	}
+	stream->setChannelFunc = setChannelFunc;
+	stream->setConfigFunc  = setConfigFunc;
+}
+
+
+void illuminatir_stream_init_handler( illuminatir_stream_t * stream, const illuminatir_handler_t * handler )
+{
+	if( !stream ) {
+		return;
+	}
+	static const illuminatir_handler_t no_handler = { 0 };
+	stream->handler        = handler ? *handler : no_handler;
+	stream->setChannelFunc = NULL;
+	stream->setConfigFunc  = NULL;
+	stream->frame          = NULL;
+	stream->frame_size     = 0;
+	stream->flags          = 0;
+	stream_reset( stream );
+}
+
+
+void illuminatir_rand_stream_init( illuminatir_stream_t * stream, uint8_t * frame, size_t frame_size, illuminatir_parse_setChannel_t setChannelFunc, illuminatir_parse_setConfig_t setConfigFunc )
+{
+	if( !stream ) {
+		return;
+	}
+	illuminatir_stream_init( stream, setChannelFunc, setConfigFunc );
+	stream->frame      = frame;
+	stream->frame_size = frame ? frame_size : 0;
+	stream->flags      = STREAM_FLAG_RAND;
+}
+
+
+void illuminatir_rand_stream_init_handler( illuminatir_stream_t * stream, uint8_t * frame, size_t frame_size, const illuminatir_handler_t * handler )
+{
+	if( !stream ) {
+		return;
+	}
+	illuminatir_stream_init_handler( stream, handler );
+	stream->frame      = frame;
+	stream->frame_size = frame ? frame_size : 0;
+	stream->flags      = STREAM_FLAG_RAND;
+}
+
+
+illuminatir_error_t illuminatir_stream_feedByte( illuminatir_stream_t * stream, uint8_t byte )
+{
+	if( !stream ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	if( !byte ) { // Delimiter, end of frame
+		illuminatir_error_t err = ILLUMINATIR_ERROR_NONE;
+		if( (stream->flags & (STREAM_FLAG_STARTED|STREAM_FLAG_RESYNC)) == STREAM_FLAG_STARTED ) {
+			err = stream_frameEnd( stream );
+		}
+		if( err != ILLUMINATIR_ERROR_NONE ) {
+			ILLUMINATIR_STATS_ERROR( err );
+		}
+		stream_reset( stream );
+		return err;
+	}
+	if( stream->flags & STREAM_FLAG_RESYNC ) {
+		return ILLUMINATIR_ERROR_NONE;
+	}
+	stream->flags |= STREAM_FLAG_STARTED;
+
+	illuminatir_error_t err = ILLUMINATIR_ERROR_NONE;
+	if( stream->block ) { // Block byte
+		stream->block--;
+		err = stream_frameByte( stream, byte );
+	} else { // Next block's code
+		if( stream->flags & STREAM_FLAG_ZERO ) { // Encoded zero
+			err = stream_frameByte( stream, 0 );
+		}
+		stream->code  = byte;
+		stream->block = byte - 1;
+	}
+	if( !stream->block && stream->code != 0xff ) {
+		stream->flags |= STREAM_FLAG_ZERO;
+	} else {
+		stream->flags &= ~STREAM_FLAG_ZERO;
+	}
+	if( err != ILLUMINATIR_ERROR_NONE ) {
+		return stream_error( stream, err );
+	}
+	return ILLUMINATIR_ERROR_NONE;
+}
+
+
+illuminatir_error_t illuminatir_stream_feed( illuminatir_stream_t * stream, const uint8_t * data, size_t data_size )
+{
+	if( !stream || !data ) {
+		return ILLUMINATIR_ERROR_NULL_POINTER;
+	}
+	illuminatir_error_t first = ILLUMINATIR_ERROR_NONE;
+	while( data_size-- ) {
+		illuminatir_error_t err = illuminatir_stream_feedByte( stream, *data++ );
+		if( first == ILLUMINATIR_ERROR_NONE ) {
+			first = err;
+		}
+	}
+	return first;
+}
@@ -0,0 +1,169 @@
+#include "illuminatir_universe.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+
+#define UNIVERSE_WORDS (ILLUMINATIR_CHANNELS / 4)
+
+
+// Starts an update, returning its generation. Readers retry until universe_end.
+static uint32_t universe_begin( illuminatir_universe_t * universe )
+{
+	uint32_t sequence = atomic_load_explicit( &universe->sequence, memory_order_relaxed );
+	atomic_store_explicit( &universe->sequence, sequence + 1, memory_order_relaxed );
+	// Keeps the channel stores below from becoming visible before the odd sequence.
+	atomic_thread_fence( memory_order_release );
+	return atomic_load_explicit( &universe->generation, memory_order_relaxed ) + 1;
+}
+
+
+static void universe_end( illuminatir_universe_t * universe, uint32_t generation )
+{
+	atomic_store_explicit( &universe->generation, generation, memory_order_release );
+	uint32_t sequence = atomic_load_explicit( &universe->sequence, memory_order_relaxed );
+	atomic_store_explicit( &universe->sequence, sequence + 1, memory_order_release );
+}
+
+
+// Stores a channel and tags it with the generation of the running update.
+static void universe_store( illuminatir_universe_t * universe, uint8_t channel, uint8_t value, uint32_t generation )
+{
+	_Atomic uint32_t * word = &universe->values[channel >> 2];
+	unsigned shift = (channel & 3) * 8;
+	uint32_t packed = atomic_load_explicit( word, memory_order_relaxed );
+	packed = (packed & ~((uint32_t)0xff << shift)) | ((uint32_t)value << shift);
+	atomic_store_explicit( word, packed, memory_order_relaxed );
+	atomic_store_explicit( &universe->channel_generation[channel], generation, memory_order_relaxed );
+}
+
+
+void illuminatir_universe_init( illuminatir_universe_t * universe, const uint8_t * values )
+{
+	if( !universe ) {
+		return;
+	}
+	atomic_init( &universe->sequence, 0 );
+	atomic_init( &universe->generation, 0 );
+	for( uint16_t word = 0; word < UNIVERSE_WORDS; word++ ) {
+		uint32_t packed = 0;
+		if( values ) {
+			const uint8_t * v = values + word * 4;
+			packed = (uint32_t)v[0] | ((uint32_t)v[1] << 8) | ((uint32_t)v[2] << 16) | ((uint32_t)v[3] << 24);
+		}
+		atomic_init( &universe->values[word], packed );
+	}
+	for( uint16_t channel = 0; channel < ILLUMINATIR_CHANNELS; channel++ ) {
+		atomic_init( &universe->channel_generation[channel], 0 );
+	}
+}
+
+
+void illuminatir_universe_setChannels( illuminatir_universe_t * universe, uint8_t first_channel, const uint8_t * values, uint16_t count )
+{
+	if( !universe || !values ) {
+		return;
+	}
+	// Only the writer stores channels, so it can look for changes without the seqlock.
+	uint16_t i = 0;
+	while( i < count && illuminatir_universe_getChannel( universe, (uint8_t)(first_channel + i) ) == values[i] ) {
+		i++;
+	}
+	if( i == count ) {
+		return;
+	}
+	uint32_t generation = universe_begin( universe );
+	for( ; i < count; i++ ) {
+		uint8_t channel = (uint8_t)(first_channel + i);
+		if( illuminatir_universe_getChannel( universe, channel ) != values[i] ) {
+			universe_store( universe, channel, values[i], generation );
+		}
+	}
+	universe_end( universe, generation );
+}
+
+
+void illuminatir_universe_setChannelValuePairs( illuminatir_universe_t * universe, const uint8_t * pairs, uint8_t count )
+{
+	if( !universe || !pairs ) {
+		return;
+	}
+	uint8_t i = 0;
+	while( i < count && illuminatir_universe_getChannel( universe, pairs[i * 2] ) == pairs[i * 2 + 1] ) {
+		i++;
+	}
+	if( i == count ) {
+		return;
+	}
+	uint32_t generation = universe_begin( universe );
+	for( ; i < count; i++ ) {
+		if( illuminatir_universe_getChannel( universe, pairs[i * 2] ) != pairs[i * 2 + 1] ) {
+			universe_store( universe, pairs[i * 2], pairs[i * 2 + 1], generation );
+		}
+	}
+	universe_end( universe, generation );
+}
+
+
+static void universe_handler_setChannels( void * ctx, uint8_t first_channel, const uint8_t * values, uint8_t count )
+{
+	illuminatir_universe_setChannels( ctx, first_channel, values, count );
+}
+
+
+static void universe_handler_setChannelValuePairs( void * ctx, const uint8_t * pairs, uint8_t count )
+{
+	illuminatir_universe_setChannelValuePairs( ctx, pairs, count );
+}
+
+
+illuminatir_handler_t illuminatir_universe_handler( illuminatir_universe_t * universe )
+{
+	illuminatir_handler_t handler = { universe, universe_handler_setChannels, universe_handler_setChannelValuePairs, NULL };
+	return handler;
+}
+
+
+uint32_t illuminatir_universe_read( const illuminatir_universe_t * universe, uint8_t * values )
+{
+	return illuminatir_universe_readChanged( universe, values, 0, NULL );
+}
+
+
+uint32_t illuminatir_universe_readChanged( const illuminatir_universe_t * universe, uint8_t * values, uint32_t since, illuminatir_channelMask_t * changed )
+{
+	if( !universe ) {
+		return 0;
+	}
+	for( ;; ) {
+		uint32_t sequence = atomic_load_explicit( &universe->sequence, memory_order_acquire );
+		if( sequence & 1 ) { // writer busy
+			continue;
+		}
+		uint32_t generation = atomic_load_explicit( &universe->generation, memory_order_relaxed );
+		if( values ) {
+			for( uint16_t word = 0; word < UNIVERSE_WORDS; word++ ) {
+				uint32_t packed = atomic_load_explicit( &universe->values[word], memory_order_relaxed );
+				values[word * 4 + 0] = (uint8_t)packed;
+				values[word * 4 + 1] = (uint8_t)(packed >> 8);
+				values[word * 4 + 2] = (uint8_t)(packed >> 16);
+				values[word * 4 + 3] = (uint8_t)(packed >> 24);
+			}
+		}
+		if( changed ) {
+			illuminatir_channelMask_clear( changed );
+			for( uint16_t channel = 0; channel < ILLUMINATIR_CHANNELS; channel++ ) {
+				uint32_t channel_generation = atomic_load_explicit( &universe->channel_generation[channel], memory_order_relaxed );
+				if( (int32_t)(channel_generation - since) > 0 ) {
+					illuminatir_channelMask_set( changed, (uint8_t)channel );
+				}
+			}
+		}
+		// Keeps the loads above from moving behind the check of the sequence.
+		atomic_thread_fence( memory_order_acquire );
+		if( atomic_load_explicit( &universe->sequence, memory_order_relaxed ) == sequence ) {
+			return generation;
+		}
+	}
+}
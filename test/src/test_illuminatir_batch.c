@@ -0,0 +1,117 @@
+#include <illuminatir.h>
+#include <unity.h>
+#include <string.h>
+#include "common.h"
+
+
+#define JOBS_MAX 100
+
+
+static uint8_t offsets[JOBS_MAX];
+static uint8_t values[ILLUMINATIR_OFFSETARRAY_MAXVALUES * JOBS_MAX];
+static uint8_t arena[ILLUMINATIR_BATCH_PACKET_SIZE * JOBS_MAX];
+static uint8_t sizes[JOBS_MAX];
+
+
+void setUp(void) {
+	// Includes zeros in every position, so both packets with and without COBS runs are covered.
+	uint32_t state = 0x12345678;
+	for( unsigned i = 0; i < sizeof(values); i++ ) {
+		state = state * 1103515245u + 12345u;
+		values[i] = (state >> 24) % 5 ? (uint8_t)(state >> 16) : 0;
+	}
+	for( unsigned i = 0; i < JOBS_MAX; i++ ) {
+		offsets[i] = (uint8_t)(i * 37);
+	}
+	memset( arena, 0xaa, sizeof(arena) );
+}
+
+
+void tearDown(void) {
+	// clean stuff up here
+}
+
+
+static void checkBatch( size_t count, int randomize )
+{
+	size_t arena_size = sizeof(arena);
+	memset( sizes, 0, sizeof(sizes) );
+	if( randomize ) {
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_build_offsetArrays( arena, &arena_size, sizes, offsets, values, count ) );
+	} else {
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_build_offsetArrays( arena, &arena_size, sizes, offsets, values, count ) );
+	}
+	TEST_ASSERT_EQUAL_UINT( count * ILLUMINATIR_BATCH_PACKET_SIZE, arena_size );
+
+	for( size_t job = 0; job < count; job++ ) {
+		uint8_t jobValues[ILLUMINATIR_OFFSETARRAY_MAXVALUES];
+		for( unsigned i = 0; i < ILLUMINATIR_OFFSETARRAY_MAXVALUES; i++ ) {
+			jobValues[i] = values[i * count + job];
+		}
+		uint8_t expected[ILLUMINATIR_BATCH_PACKET_SIZE];
+		uint8_t expected_size = sizeof(expected);
+		if( randomize ) {
+			TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_build_offsetArray( expected, &expected_size, offsets[job], jobValues, sizeof(jobValues) ) );
+		} else {
+			TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_build_offsetArray( expected, &expected_size, offsets[job], jobValues, sizeof(jobValues) ) );
+		}
+		TEST_ASSERT_EQUAL_UINT8( expected_size, sizes[job] );
+		TEST_ASSERT_EQUAL_UINT8_ARRAY( expected, arena + job * ILLUMINATIR_BATCH_PACKET_SIZE, expected_size );
+	}
+}
+
+
+void test_illuminatir_batch_cobs( void )
+{
+	const size_t counts[] = { 1, 15, 16, 17, 33, JOBS_MAX };
+	for( unsigned i = 0; i < sizeof(counts) / sizeof(counts[0]); i++ ) {
+		checkBatch( counts[i], 0 );
+	}
+}
+
+
+void test_illuminatir_batch_rand_cobs( void )
+{
+	const size_t counts[] = { 1, 15, 16, 17, 33, JOBS_MAX };
+	for( unsigned i = 0; i < sizeof(counts) / sizeof(counts[0]); i++ ) {
+		checkBatch( counts[i], 1 );
+	}
+}
+
+
+void test_illuminatir_batch_zeros( void )
+{
+	// All zero values are the longest COBS chain of single byte blocks.
+	memset( values, 0, sizeof(values) );
+	memset( offsets, 0, sizeof(offsets) );
+	checkBatch( 32, 0 );
+	checkBatch( 32, 1 );
+}
+
+
+void test_illuminatir_batch_errors( void )
+{
+	size_t arena_size = ILLUMINATIR_BATCH_PACKET_SIZE * 16 - 1;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_BUFFER_OVERFLOW, illuminatir_cobs_build_offsetArrays( arena, &arena_size, sizes, offsets, values, 16 ) );
+	TEST_ASSERT_EQUAL_UINT8( 0xaa, arena[0] );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NULL_POINTER, illuminatir_rand_cobs_build_offsetArrays( arena, NULL, sizes, offsets, values, 16 ) );
+	arena_size = sizeof(arena);
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NULL_POINTER, illuminatir_cobs_build_offsetArrays( arena, &arena_size, sizes, NULL, values, 16 ) );
+
+	// Nothing to do is fine, also without sizes.
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_build_offsetArrays( NULL, &arena_size, NULL, NULL, NULL, 0 ) );
+	TEST_ASSERT_EQUAL_UINT( 0, arena_size );
+	arena_size = sizeof(arena);
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_build_offsetArrays( arena, &arena_size, NULL, offsets, values, 20 ) );
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_illuminatir_batch_cobs);
+	RUN_TEST(test_illuminatir_batch_rand_cobs);
+	RUN_TEST(test_illuminatir_batch_zeros);
+	RUN_TEST(test_illuminatir_batch_errors);
+	return UNITY_END();
+}
@@ -43,10 +43,32 @@ void test_illuminatir_build_config( void )
 }
 
 
+void test_illuminatir_build_channelValuePairs( void )
+{
+	uint8_t packet[ILLUMINATIR_PACKET_MAXSIZE];
+	uint8_t pairs[] = {10,1,200,2,7};
+	uint8_t packet_size = sizeof(packet);
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_build_channelValuePairs( packet, &packet_size, pairs, sizeof(pairs) ) );
+
+	uint8_t expected[] = {0x13,10,1,200,2,7,0x00};
+	expected[sizeof(expected)-1] = illuminatir_crc8( expected, sizeof(expected)-1, ILLUMINATIR_CRC8_INITIAL_SEED );
+	TEST_ASSERT_EQUAL_UINT8( sizeof(expected), packet_size );
+	TEST_ASSERT_EQUAL_HEX8_ARRAY( expected, packet, packet_size );
+
+	packet_size = sizeof(packet);
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, illuminatir_build_channelValuePairs( packet, &packet_size, pairs, 1 ) );
+	uint8_t tooMany[ILLUMINATIR_CHANNELVALUEPAIRS_MAXSIZE + 1] = {0};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, illuminatir_build_channelValuePairs( packet, &packet_size, tooMany, sizeof(tooMany) ) );
+	packet_size = 4;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_BUFFER_OVERFLOW, illuminatir_build_channelValuePairs( packet, &packet_size, pairs, sizeof(pairs) ) );
+}
+
+
 int main( void )
 {
 	UNITY_BEGIN();
 	RUN_TEST(test_illuminatir_build_offsetArray);
 	RUN_TEST(test_illuminatir_build_config);
+	RUN_TEST(test_illuminatir_build_channelValuePairs);
 	return UNITY_END();
 }
@@ -0,0 +1,175 @@
+#include <illuminatir.h>
+#include <unity.h>
+#include <string.h>
+#include "common.h"
+
+
+#define ENTRIES 3
+
+
+static illuminatir_cache_entry_t entries[ENTRIES];
+static illuminatir_cache_t       cache;
+
+static uint8_t channels[ILLUMINATIR_CHANNELS];
+
+
+void setUp(void) {
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cache_init( &cache, entries, ENTRIES ) );
+}
+
+
+void tearDown(void) {
+	// clean stuff up here
+}
+
+
+static void setChannel( uint8_t channel, uint8_t value )
+{
+	channels[channel] = value;
+}
+
+
+void test_illuminatir_cache_config( void )
+{
+	uint8_t expected[ILLUMINATIR_COBS_PACKET_MAXSIZE + 1];
+	uint8_t expected_size = ILLUMINATIR_COBS_PACKET_MAXSIZE;
+	const uint8_t values[] = {1,2,3};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_build_config( expected, &expected_size, "Base", 4, values, sizeof(values) ) );
+	expected[expected_size++] = 0;
+
+	const uint8_t * frame;
+	size_t frame_size;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_cache_config( &cache, "Base", 4, values, sizeof(values), &frame, &frame_size ) );
+	TEST_ASSERT_EQUAL_UINT( expected_size, frame_size );
+	TEST_ASSERT_EQUAL_UINT8_ARRAY( expected, frame, expected_size );
+	TEST_ASSERT_EQUAL_UINT32( 0, cache.hits );
+	TEST_ASSERT_EQUAL_UINT32( 1, cache.misses );
+
+	const uint8_t * again;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_cache_config( &cache, "Base", 4, values, sizeof(values), &again, &frame_size ) );
+	TEST_ASSERT_EQUAL_PTR( frame, again );
+	TEST_ASSERT_EQUAL_UINT32( 1, cache.hits );
+
+	// Without randomization, or split into key and values differently, it is another frame.
+	expected_size = ILLUMINATIR_COBS_PACKET_MAXSIZE;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_build_config( expected, &expected_size, "Base", 4, values, sizeof(values) ) );
+	expected[expected_size++] = 0;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_cache_config( &cache, "Base", 4, values, sizeof(values), &frame, &frame_size ) );
+	TEST_ASSERT_EQUAL_UINT( expected_size, frame_size );
+	TEST_ASSERT_EQUAL_UINT8_ARRAY( expected, frame, expected_size );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_cache_config( &cache, "Base\x01", 5, values + 1, sizeof(values) - 1, &frame, &frame_size ) );
+	TEST_ASSERT_EQUAL_UINT32( 1, cache.hits );
+	TEST_ASSERT_EQUAL_UINT32( 3, cache.misses );
+
+	// Invalid packets evict nothing.
+	const uint8_t large[ILLUMINATIR_CONFIG_VALUES_MAXSIZE] = {0};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, illuminatir_rand_cobs_cache_config( &cache, "MakeDefault", 11, large, sizeof(large), &frame, &frame_size ) );
+	TEST_ASSERT_EQUAL_UINT16( ENTRIES, cache.used );
+	TEST_ASSERT_EQUAL_UINT32( 0, cache.evictions );
+}
+
+
+void test_illuminatir_cache_universe( void )
+{
+	uint8_t universe[ILLUMINATIR_CHANNELS];
+	for( unsigned i = 0; i < sizeof(universe); i++ ) {
+		universe[i] = (uint8_t)(i * 7);
+	}
+	uint8_t expected[ILLUMINATIR_FRAME_BUFFER_SIZE(ILLUMINATIR_PLAN_MAXSIZE)];
+	illuminatir_frame_t expectedFrame;
+	size_t expected_size;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_init( &expectedFrame, expected, sizeof(expected) ) );
+	for( unsigned i = 0; i < ILLUMINATIR_CHANNELS; i += ILLUMINATIR_OFFSETARRAY_MAXVALUES ) {
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_add_offsetArray( &expectedFrame, (uint8_t)i, universe + i, ILLUMINATIR_OFFSETARRAY_MAXVALUES ) );
+	}
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_frame_finalize( &expectedFrame, &expected_size ) );
+
+	const uint8_t * frame;
+	size_t frame_size;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_cache_universe( &cache, universe, &frame, &frame_size ) );
+	TEST_ASSERT_EQUAL_UINT( expected_size, frame_size );
+	TEST_ASSERT_EQUAL_UINT8_ARRAY( expected, frame, expected_size );
+
+	// A changed look is another frame.
+	universe[3]++;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_cache_universe( &cache, universe, &frame, &frame_size ) );
+	illuminatir_stream_t stream;
+	illuminatir_stream_init( &stream, setChannel, NULL );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_stream_feed( &stream, frame, frame_size ) );
+	TEST_ASSERT_EQUAL_UINT8_ARRAY( universe, channels, ILLUMINATIR_CHANNELS );
+	TEST_ASSERT_EQUAL_UINT32( 2, cache.misses );
+}
+
+
+void test_illuminatir_cache_lru( void )
+{
+	const uint8_t keys[ENTRIES + 1] = {'a','b','c','d'};
+	const uint8_t data[ENTRIES + 1] = {10,11,12,13};
+	size_t frame_size;
+	for( unsigned i = 0; i < ENTRIES; i++ ) {
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cache_put( &cache, &keys[i], 1, &data[i], 1 ) );
+	}
+	TEST_ASSERT_NOT_NULL( illuminatir_cache_get( &cache, &keys[0], 1, &frame_size ) ); // 'b' is the oldest now
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cache_put( &cache, &keys[3], 1, &data[3], 1 ) );
+	TEST_ASSERT_EQUAL_UINT32( 1, cache.evictions );
+	TEST_ASSERT_NULL( illuminatir_cache_get( &cache, &keys[1], 1, &frame_size ) );
+	TEST_ASSERT_EQUAL_UINT( 0, frame_size );
+	for( unsigned i = 0; i < ENTRIES + 1; i++ ) {
+		if( i == 1 ) {
+			continue;
+		}
+		const uint8_t * frame = illuminatir_cache_get( &cache, &keys[i], 1, &frame_size );
+		TEST_ASSERT_NOT_NULL( frame );
+		TEST_ASSERT_EQUAL_UINT( 1, frame_size );
+		TEST_ASSERT_EQUAL_UINT8( data[i], frame[0] );
+	}
+
+	// Replacing keeps the entry.
+	const uint8_t replaced[] = {1,2};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cache_put( &cache, &keys[0], 1, replaced, sizeof(replaced) ) );
+	TEST_ASSERT_EQUAL_UINT32( 1, cache.evictions );
+	TEST_ASSERT_EQUAL_UINT8_ARRAY( replaced, illuminatir_cache_get( &cache, &keys[0], 1, &frame_size ), sizeof(replaced) );
+}
+
+
+void test_illuminatir_cache_collisions( void )
+{
+	// A single entry puts every key into the same bucket.
+	illuminatir_cache_entry_t entry;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cache_init( &cache, &entry, 1 ) );
+	const uint8_t * frame;
+	size_t frame_size;
+	for( unsigned i = 0; i < 4; i++ ) {
+		const uint8_t value = (uint8_t)i;
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_cache_config( &cache, "W", 1, &value, 1, &frame, &frame_size ) );
+	}
+	TEST_ASSERT_EQUAL_UINT32( 3, cache.evictions );
+	const uint8_t value = 3;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_cache_config( &cache, "W", 1, &value, 1, &frame, &frame_size ) );
+	TEST_ASSERT_EQUAL_UINT32( 1, cache.hits );
+}
+
+
+void test_illuminatir_cache_errors( void )
+{
+	const uint8_t * frame;
+	size_t frame_size;
+	uint8_t key[ILLUMINATIR_CACHE_KEY_MAXSIZE + 1] = {0};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, illuminatir_cache_init( &cache, entries, 0 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NULL_POINTER, illuminatir_cache_init( &cache, NULL, 1 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_BUFFER_OVERFLOW, illuminatir_cache_put( &cache, key, sizeof(key), key, 1 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NULL_POINTER, illuminatir_cobs_cache_universe( &cache, NULL, &frame, &frame_size ) );
+	TEST_ASSERT_NULL( illuminatir_cache_get( &cache, key, 1, NULL ) );
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_illuminatir_cache_config);
+	RUN_TEST(test_illuminatir_cache_universe);
+	RUN_TEST(test_illuminatir_cache_lru);
+	RUN_TEST(test_illuminatir_cache_collisions);
+	RUN_TEST(test_illuminatir_cache_errors);
+	return UNITY_END();
+}
@@ -0,0 +1,267 @@
+#include <illuminatir_capture.h>
+#include <unity.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "common.h"
+
+
+#define CAPTURE       "test_illuminatir_capture.cap"
+#define CAPTURE_INDEX CAPTURE ILLUMINATIR_CAPTURE_INDEX_SUFFIX
+#define RECORDS       5000 // several chunks
+
+static illuminatir_capture_writer_t writer;
+static illuminatir_capture_reader_t reader;
+static uint64_t                     timestamps[RECORDS];
+static uint8_t                      data[RECORDS][64];
+static uint8_t                      sizes[RECORDS];
+
+
+void setUp(void) {
+	uint32_t state = 0xcafe;
+	uint64_t timestamp = 1000;
+	for( unsigned i = 0; i < RECORDS; i++ ) {
+		state = state * 1103515245u + 12345u;
+		timestamp += (state >> 16) % 4 ? (state >> 8) % 100000 : 0; // some records at the same time
+		timestamps[i] = timestamp;
+		sizes[i] = 1 + (state >> 4) % sizeof(data[i]);
+		for( unsigned j = 0; j < sizes[i]; j++ ) {
+			data[i][j] = (uint8_t)(i + j);
+		}
+	}
+}
+
+
+void tearDown(void) {
+	unlink( CAPTURE );
+	unlink( CAPTURE_INDEX );
+}
+
+
+static void writeCapture( void )
+{
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_writer_open( &writer, CAPTURE ) );
+	for( unsigned i = 0; i < RECORDS; i++ ) {
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_write( &writer, timestamps[i], (uint16_t)(i % 3), data[i], sizes[i] ) );
+	}
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_writer_close( &writer ) );
+}
+
+
+// Checks that the reader returns the records from first up to, but not including, end.
+static void checkRecords( unsigned first, unsigned end )
+{
+	illuminatir_capture_record_t record;
+	for( unsigned i = first; i < end; i++ ) {
+		TEST_ASSERT_EQUAL_UINT8( 1, illuminatir_capture_next( &reader, &record ) );
+		TEST_ASSERT_EQUAL_UINT64( timestamps[i], record.timestamp );
+		TEST_ASSERT_EQUAL_UINT16( i % 3, record.port );
+		TEST_ASSERT_EQUAL_UINT16( sizes[i], record.size );
+		TEST_ASSERT_EQUAL_UINT8_ARRAY( data[i], record.data, sizes[i] );
+	}
+	TEST_ASSERT_EQUAL_UINT8( 0, illuminatir_capture_next( &reader, &record ) );
+}
+
+
+// Returns the index of the first record not older than timestamp.
+static unsigned firstRecord( uint64_t timestamp )
+{
+	unsigned i = 0;
+	while( i < RECORDS && timestamps[i] < timestamp ) {
+		i++;
+	}
+	return i;
+}
+
+
+static void checkSeeks( unsigned end )
+{
+	uint64_t targets[] = { 0, timestamps[0], timestamps[1] + 1, timestamps[RECORDS / 2], timestamps[RECORDS - 1], timestamps[RECORDS - 1] + 1 };
+	for( unsigned t = 0; t < sizeof(targets) / sizeof(targets[0]); t++ ) {
+		illuminatir_capture_seek( &reader, targets[t] );
+		unsigned first = firstRecord( targets[t] );
+		checkRecords( first < end ? first : end, end );
+	}
+	for( unsigned i = 0; i < 200; i++ ) {
+		uint64_t target = timestamps[(i * 7919) % RECORDS] + (i % 2);
+		illuminatir_capture_seek( &reader, target );
+		unsigned first = firstRecord( target );
+		illuminatir_capture_record_t record;
+		if( first < end ) {
+			TEST_ASSERT_EQUAL_UINT8( 1, illuminatir_capture_next( &reader, &record ) );
+			TEST_ASSERT_EQUAL_UINT64( timestamps[first], record.timestamp );
+			TEST_ASSERT_EQUAL_UINT8_ARRAY( data[first], record.data, sizes[first] );
+		} else {
+			TEST_ASSERT_EQUAL_UINT8( 0, illuminatir_capture_next( &reader, &record ) );
+		}
+	}
+}
+
+
+void test_illuminatir_capture_roundTrip( void )
+{
+	writeCapture();
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_reader_open( &reader, CAPTURE ) );
+	TEST_ASSERT_EQUAL_UINT( RECORDS, reader.index_count );
+	illuminatir_capture_record_t record;
+	TEST_ASSERT_EQUAL_UINT8( 1, illuminatir_capture_next( &reader, &record ) );
+	TEST_ASSERT_TRUE( record.data > reader.capture && record.data < reader.capture + reader.capture_size ); // not copied
+	TEST_ASSERT_EQUAL_UINT( 0, (uintptr_t)record.data % 8 );
+	illuminatir_capture_seek( &reader, 0 );
+	checkRecords( 0, RECORDS );
+	illuminatir_capture_reader_close( &reader );
+}
+
+
+void test_illuminatir_capture_seek( void )
+{
+	writeCapture();
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_reader_open( &reader, CAPTURE ) );
+	checkSeeks( RECORDS );
+	illuminatir_capture_reader_close( &reader );
+
+	// Without an index the reader walks the records.
+	unlink( CAPTURE_INDEX );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_reader_open( &reader, CAPTURE ) );
+	TEST_ASSERT_NULL( reader.index );
+	checkSeeks( RECORDS );
+	illuminatir_capture_reader_close( &reader );
+}
+
+
+void test_illuminatir_capture_incomplete( void )
+{
+	// A writer that crashed leaves the records of its last chunk unwritten or partially written.
+	writeCapture();
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_reader_open( &reader, CAPTURE ) );
+	size_t capture_size = reader.capture_size;
+	size_t last_chunk = 0;
+	for( size_t i = 0; i < reader.index_count; i++ ) {
+		if( reader.index[i].chunk_end < capture_size ) {
+			last_chunk = i + 1;
+		}
+	}
+	illuminatir_capture_reader_close( &reader );
+	TEST_ASSERT_EQUAL_INT( 0, truncate( CAPTURE, (off_t)(capture_size - 100) ) );
+
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_reader_open( &reader, CAPTURE ) );
+	TEST_ASSERT_EQUAL_UINT( last_chunk, reader.index_count );
+	checkRecords( 0, last_chunk );
+	checkSeeks( last_chunk );
+	illuminatir_capture_reader_close( &reader );
+
+	// An index shorter than the capture is completed by walking the records.
+	writeCapture();
+	TEST_ASSERT_EQUAL_INT( 0, truncate( CAPTURE_INDEX, (off_t)(sizeof(illuminatir_capture_fileHeader_t) + 100 * sizeof(illuminatir_capture_indexEntry_t) + 5) ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_reader_open( &reader, CAPTURE ) );
+	TEST_ASSERT_EQUAL_UINT( 100, reader.index_count );
+	checkSeeks( RECORDS );
+	illuminatir_capture_reader_close( &reader );
+}
+
+
+// Overwrites a field of an index entry.
+static void damageIndex( size_t entry, size_t field, uint64_t value )
+{
+	FILE * f = fopen( CAPTURE_INDEX, "r+b" );
+	TEST_ASSERT_NOT_NULL( f );
+	TEST_ASSERT_EQUAL_INT( 0, fseek( f, (long)(sizeof(illuminatir_capture_fileHeader_t) + entry * sizeof(illuminatir_capture_indexEntry_t) + field), SEEK_SET ) );
+	TEST_ASSERT_EQUAL_size_t( 1, fwrite( &value, sizeof(value), 1, f ) );
+	fclose( f );
+}
+
+
+void test_illuminatir_capture_damagedIndex( void )
+{
+	// Entries amid the index pointing outside the capture are rejected.
+	const struct {
+		size_t   field;
+		uint64_t value;
+	} damages[] = {
+		{ offsetof(illuminatir_capture_indexEntry_t, offset),    0 },
+		{ offsetof(illuminatir_capture_indexEntry_t, offset),    1000001 },
+		{ offsetof(illuminatir_capture_indexEntry_t, offset),    UINT64_MAX - 7 },
+		{ offsetof(illuminatir_capture_indexEntry_t, chunk_end), 16 },
+		{ offsetof(illuminatir_capture_indexEntry_t, chunk_end), UINT64_MAX },
+	};
+	for( unsigned i = 0; i < sizeof(damages) / sizeof(damages[0]); i++ ) {
+		writeCapture();
+		damageIndex( RECORDS / 2, damages[i].field, damages[i].value );
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, illuminatir_capture_reader_open( &reader, CAPTURE ) );
+	}
+
+	// Without the index the capture reads fine.
+	unlink( CAPTURE_INDEX );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_reader_open( &reader, CAPTURE ) );
+	checkRecords( 0, RECORDS );
+	illuminatir_capture_reader_close( &reader );
+}
+
+
+void test_illuminatir_capture_parse( void )
+{
+	// Records holding frames go straight to the parser.
+	uint8_t universe[256] = {0};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_writer_open( &writer, CAPTURE ) );
+	for( unsigned i = 0; i < 16; i++ ) {
+		uint8_t values[ILLUMINATIR_OFFSETARRAY_MAXVALUES];
+		memset( values, i + 1, sizeof(values) );
+		uint8_t frame[ILLUMINATIR_COBS_PACKET_MAXSIZE + 1];
+		uint8_t frame_size = ILLUMINATIR_COBS_PACKET_MAXSIZE;
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_build_offsetArray( frame, &frame_size, i * 16, values, sizeof(values) ) );
+		frame[frame_size++] = 0;
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_write( &writer, i * 1000, 0, frame, frame_size ) );
+	}
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_writer_close( &writer ) );
+
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_reader_open( &reader, CAPTURE ) );
+	illuminatir_capture_record_t record;
+	while( illuminatir_capture_next( &reader, &record ) ) {
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_parse_into( record.data, (uint8_t)(record.size - 1), universe, NULL, NULL ) );
+	}
+	illuminatir_capture_reader_close( &reader );
+	for( unsigned c = 0; c < 256; c++ ) {
+		TEST_ASSERT_EQUAL_UINT8( c / 16 + 1, universe[c] );
+	}
+}
+
+
+void test_illuminatir_capture_errors( void )
+{
+	uint8_t byte = 0;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_writer_open( &writer, CAPTURE ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, illuminatir_capture_write( &writer, 0, 0, &byte, 0 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, illuminatir_capture_write( &writer, 0, 0, &byte, ILLUMINATIR_CAPTURE_RECORD_MAXSIZE + 1 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_write( &writer, 10, 0, &byte, 1 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, illuminatir_capture_write( &writer, 9, 0, &byte, 1 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NULL_POINTER, illuminatir_capture_write( &writer, 10, 0, NULL, 1 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_writer_close( &writer ) );
+
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_UNKNOWN, illuminatir_capture_reader_open( &reader, "does/not/exist.cap" ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_UNKNOWN, illuminatir_capture_writer_open( &writer, "does/not/exist.cap" ) );
+	// An index is no capture.
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_UNSUPPORTED_FORMAT, illuminatir_capture_reader_open( &reader, CAPTURE_INDEX ) );
+	FILE * f = fopen( CAPTURE, "wb" );
+	TEST_ASSERT_NOT_NULL( f );
+	fclose( f );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_UNSUPPORTED_FORMAT, illuminatir_capture_reader_open( &reader, CAPTURE ) );
+	f = fopen( CAPTURE, "wb" );
+	illuminatir_capture_fileHeader_t header = { "IRcaptur", ILLUMINATIR_CAPTURE_VERSION + 1, 0 };
+	fwrite( &header, sizeof(header), 1, f );
+	fclose( f );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_UNSUPPORTED_VERSION, illuminatir_capture_reader_open( &reader, CAPTURE ) );
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_illuminatir_capture_roundTrip);
+	RUN_TEST(test_illuminatir_capture_seek);
+	RUN_TEST(test_illuminatir_capture_incomplete);
+	RUN_TEST(test_illuminatir_capture_damagedIndex);
+	RUN_TEST(test_illuminatir_capture_parse);
+	RUN_TEST(test_illuminatir_capture_errors);
+	return UNITY_END();
+}
@@ -171,6 +171,87 @@ void test_illuminatir_cobs_decode_encode_examplesFromWikipedia( void )
 }
 
 
+// Byte-wise reference encoder, the bulk encoder must produce identical output.
+static size_t reference_encode( uint8_t * dst, const uint8_t * src, size_t src_size )
+{
+	uint8_t * encode = dst;
+	uint8_t * codep  = encode++;
+	uint8_t code     = 1;
+	for( const uint8_t * byte = src; src_size--; ++byte ) {
+		if( *byte ) {
+			*encode++ = *byte, ++code;
+		}
+		if( !*byte || code == 0xff ) {
+			*codep = code, code = 1, codep = encode;
+			if( !*byte || src_size ) {
+				++encode;
+			}
+		}
+	}
+	if( codep < encode ) {
+		*codep = code;
+	}
+	return (size_t)(encode - dst);
+}
+
+
+void test_illuminatir_cobs_decode_encode_bulk( void )
+{
+	static const size_t sizes[] = { 1, 15, 16, 17, 31, 32, 33, 253, 254, 255, 256, 507, 508, 509, 1000, 4096 };
+	static const unsigned zeroEvery[] = { 0, 1, 3, 40, 253, 254, 255, 1000 }; // 0: random bytes
+	static uint8_t decoded[4096];
+	static uint8_t encoded[ILLUMINATIR_COBS_ENCODE_DST_MAXSIZE(4096) + 1];
+	static uint8_t expected[ILLUMINATIR_COBS_ENCODE_DST_MAXSIZE(4096) + 1];
+	static uint8_t roundtrip[ILLUMINATIR_COBS_ENCODE_DST_MAXSIZE(4096)];
+	uint32_t x = 0x12345678;
+	for( size_t s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++ ) {
+		for( size_t z = 0; z < sizeof(zeroEvery)/sizeof(zeroEvery[0]); z++ ) {
+			size_t size = sizes[s];
+			for( size_t i = 0; i < size; i++ ) {
+				x ^= x << 13;
+				x ^= x >> 17;
+				x ^= x << 5;
+				if( zeroEvery[z] ) {
+					decoded[i] = ((i + 1) % zeroEvery[z]) ? (uint8_t)(x | 1) : 0;
+				} else {
+					decoded[i] = (uint8_t)x;
+				}
+			}
+			size_t maxsize = ILLUMINATIR_COBS_ENCODE_DST_MAXSIZE(size);
+			size_t expected_size = reference_encode( expected, decoded, size );
+			TEST_ASSERT_LESS_OR_EQUAL_UINT( maxsize, expected_size );
+
+			encoded[maxsize] = 0xa5; // canary right behind the contract size
+			size_t encoded_size = illuminatir_cobs_encode( encoded, maxsize, decoded, size );
+			TEST_ASSERT_EQUAL_UINT( expected_size, encoded_size );
+			TEST_ASSERT_EQUAL_HEX8_ARRAY( expected, encoded, expected_size );
+			TEST_ASSERT_EQUAL_HEX8( 0xa5, encoded[maxsize] );
+
+			size_t decoded_maxsize = ILLUMINATIR_COBS_DECODE_DST_MAXSIZE(encoded_size);
+			roundtrip[decoded_maxsize] = 0x5a;
+			TEST_ASSERT_EQUAL_UINT( size, illuminatir_cobs_decode( roundtrip, decoded_maxsize, encoded, encoded_size ) );
+			TEST_ASSERT_EQUAL_HEX8_ARRAY( decoded, roundtrip, size );
+			TEST_ASSERT_EQUAL_HEX8( 0x5a, roundtrip[decoded_maxsize] );
+		}
+	}
+}
+
+
+void test_illuminatir_cobs_decode_truncatedAndDelimited( void )
+{
+	const uint8_t truncated[] = { 0x05, 0x11, 0x22 };
+	uint8_t decoded[8];
+	TEST_ASSERT_EQUAL_UINT( 2, illuminatir_cobs_decode( decoded, sizeof(decoded), truncated, sizeof(truncated) ) );
+	TEST_ASSERT_EQUAL_HEX8( 0x11, decoded[0] );
+	TEST_ASSERT_EQUAL_HEX8( 0x22, decoded[1] );
+
+	const uint8_t delimited[] = { 0x02, 0x11, 0x00, 0x02, 0x22 };
+	TEST_ASSERT_EQUAL_UINT( 2, illuminatir_cobs_decode( decoded, sizeof(decoded), delimited, sizeof(delimited) ) );
+	TEST_ASSERT_EQUAL_HEX8( 0x11, decoded[0] );
+	TEST_ASSERT_EQUAL_HEX8( 0x00, decoded[1] );
+}
+
+
 void test_illuminatir_cobs_build_parse_offsetValues( void )
 {
 	uint8_t cobsPacket[ILLUMINATIR_COBS_PACKET_MAXSIZE];
@@ -200,6 +281,24 @@ void test_illuminatir_cobs_build_parse_offsetValues( void )
 }
 
 
+void test_illuminatir_cobs_build_parse_channelValuePairs( void )
+{
+	uint8_t cobsPacket[ILLUMINATIR_COBS_PACKET_MAXSIZE];
+	uint8_t cobsPacket_size = sizeof(cobsPacket);
+	const uint8_t pairs[] = {4,1,0,2,255,3,9};
+	channels[9] = 0x55;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_build_channelValuePairs( cobsPacket, &cobsPacket_size, pairs, sizeof(pairs) ) );
+	TEST_ASSERT_LESS_OR_EQUAL_UINT( sizeof(cobsPacket), cobsPacket_size );
+
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_parse( cobsPacket, cobsPacket_size, setChannel, setConfig ) );
+	TEST_ASSERT_EQUAL_UINT( 4, setChannel_called );
+	TEST_ASSERT_EQUAL_UINT8( 1, channels[  4] );
+	TEST_ASSERT_EQUAL_UINT8( 2, channels[  0] );
+	TEST_ASSERT_EQUAL_UINT8( 3, channels[255] );
+	TEST_ASSERT_EQUAL_UINT8( 0, channels[  9] );
+}
+
+
 void test_illuminatir_cobs_build_parse_config( void )
 {
 	uint8_t cobsPacket[ILLUMINATIR_COBS_PACKET_MAXSIZE];
@@ -229,7 +328,10 @@ int main( void )
 	UNITY_BEGIN();
 	RUN_TEST(test_illuminatir_cobs_decode_encode_examplesFromWikipedia);
 	RUN_TEST(test_illuminatir_cobs_decode_encode_edgeCases);
+	RUN_TEST(test_illuminatir_cobs_decode_encode_bulk);
+	RUN_TEST(test_illuminatir_cobs_decode_truncatedAndDelimited);
 	RUN_TEST(test_illuminatir_cobs_build_parse_offsetValues);
+	RUN_TEST(test_illuminatir_cobs_build_parse_channelValuePairs);
 	RUN_TEST(test_illuminatir_cobs_build_parse_config);
 	return UNITY_END();
 }
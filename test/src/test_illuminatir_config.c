@@ -0,0 +1,193 @@
+#include <illuminatir.h>
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "common.h"
+
+
+typedef struct {
+	uint8_t base;
+	uint8_t makeDefault;
+	uint8_t color[3];
+	uint8_t color_size;
+	uint8_t channels;
+} device_t;
+
+static device_t                  device;
+static illuminatir_configTable_t table;
+
+
+static void setBase( void * ctx, uint8_t value )
+{
+	((device_t *)ctx)->base = value;
+}
+
+
+static void makeDefault( void * ctx )
+{
+	((device_t *)ctx)->makeDefault++;
+}
+
+
+static void setColor( void * ctx, const uint8_t * values, uint8_t values_size )
+{
+	device_t * d = ctx;
+	d->color_size = values_size;
+	memcpy( d->color, values, values_size < sizeof(d->color) ? values_size : sizeof(d->color) );
+}
+
+
+static void setChannels( void * ctx, uint8_t first_channel, const uint8_t * values, uint8_t count )
+{
+	(void)first_channel;
+	(void)values;
+	((device_t *)((illuminatir_configTable_t *)ctx)->ctx)->channels += count;
+}
+
+
+static const illuminatir_configKey_t keys[] = {
+	{ "Base",        ILLUMINATIR_CONFIGKEY_UINT8, { .uint8 = setBase } },
+	{ "MakeDefault", ILLUMINATIR_CONFIGKEY_VOID,  { .none = makeDefault } },
+	{ "Color",       ILLUMINATIR_CONFIGKEY_BYTES, { .bytes = setColor } },
+};
+
+
+void setUp(void) {
+	memset( &device, 0, sizeof(device) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_configTable_init( &table, keys, sizeof(keys) / sizeof(keys[0]), &device ) );
+}
+
+
+void tearDown(void) {
+	// clean stuff up here
+}
+
+
+void test_illuminatir_configTable_dispatch( void )
+{
+	const uint8_t base = 42;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_configTable_dispatch( &table, "bASE", 4, &base, 1 ) );
+	TEST_ASSERT_EQUAL_UINT8( 42, device.base );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_configTable_dispatch( &table, "makedefault", 11, NULL, 0 ) );
+	TEST_ASSERT_EQUAL_UINT8( 1, device.makeDefault );
+	const uint8_t rgb[] = {1,2,3};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_configTable_dispatch( &table, "COLOR", 5, rgb, sizeof(rgb) ) );
+	TEST_ASSERT_EQUAL_UINT8( 3, device.color_size );
+	TEST_ASSERT_EQUAL_UINT8_ARRAY( rgb, device.color, 3 );
+
+	// Values not matching the key's type.
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, illuminatir_configTable_dispatch( &table, "Base", 4, rgb, 2 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, illuminatir_configTable_dispatch( &table, "MakeDefault", 11, rgb, 1 ) );
+	TEST_ASSERT_EQUAL_UINT8( 42, device.base );
+	TEST_ASSERT_EQUAL_UINT8( 1, device.makeDefault );
+}
+
+
+void test_illuminatir_configTable_unknown( void )
+{
+	const char * unknown[] = { "Bas", "Bases", "Bose", "Base\x01", "B@se", "Color!", "", "MakeDefaulT_" };
+	for( unsigned i = 0; i < sizeof(unknown) / sizeof(unknown[0]); i++ ) {
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_UNSUPPORTED_FORMAT, illuminatir_configTable_dispatch( &table, unknown[i], (uint8_t)strlen( unknown[i] ), NULL, 0 ) );
+	}
+	// Only the given length of the key counts.
+	const uint8_t base = 7;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_configTable_dispatch( &table, "Basement", 4, &base, 1 ) );
+	TEST_ASSERT_EQUAL_UINT8( 7, device.base );
+}
+
+
+void test_illuminatir_configTable_handler( void )
+{
+	illuminatir_handler_t handler = illuminatir_configTable_handler( &table );
+	handler.setChannels = setChannels;
+	uint8_t packets[2 * ILLUMINATIR_PACKET_MAXSIZE];
+	uint8_t size = ILLUMINATIR_PACKET_MAXSIZE;
+	const uint8_t base = 9;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_build_config( packets, &size, "BASE", 4, &base, 1 ) );
+	uint8_t packets_size = size;
+	size = ILLUMINATIR_PACKET_MAXSIZE;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_build_offsetArray( packets + packets_size, &size, 0, (const uint8_t *)"abc", 3 ) );
+	packets_size += size;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_parse_handler( packets, packets_size, &handler ) );
+	TEST_ASSERT_EQUAL_UINT8( 9, device.base );
+	TEST_ASSERT_EQUAL_UINT8( 3, device.channels );
+}
+
+
+void test_illuminatir_configTable_full( void )
+{
+	// The most keys a table holds, all similar.
+	static char names[ILLUMINATIR_CONFIGTABLE_SLOTS / 2][8];
+	static illuminatir_configKey_t many[ILLUMINATIR_CONFIGTABLE_SLOTS / 2];
+	for( unsigned i = 0; i < ILLUMINATIR_CONFIGTABLE_SLOTS / 2; i++ ) {
+		snprintf( names[i], sizeof(names[i]), "Key%u", i );
+		many[i] = (illuminatir_configKey_t){ names[i], ILLUMINATIR_CONFIGKEY_UINT8, { .uint8 = setBase } };
+	}
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_configTable_init( &table, many, ILLUMINATIR_CONFIGTABLE_SLOTS / 2, &device ) );
+	for( uint8_t i = 0; i < ILLUMINATIR_CONFIGTABLE_SLOTS / 2; i++ ) {
+		char upper[8];
+		strcpy( upper, names[i] );
+		upper[0] = 'k';
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_configTable_dispatch( &table, upper, (uint8_t)strlen( upper ), &i, 1 ) );
+		TEST_ASSERT_EQUAL_UINT8( i, device.base );
+	}
+}
+
+
+void test_illuminatir_configTable_caseOfSymbols( void )
+{
+	// Only letters have a case, these keys differ.
+	const illuminatir_configKey_t symbols[] = {
+		{ "Mode@", ILLUMINATIR_CONFIGKEY_UINT8, { .uint8 = setBase } },
+		{ "Mode`", ILLUMINATIR_CONFIGKEY_VOID,  { .none = makeDefault } },
+		{ "Mode[", ILLUMINATIR_CONFIGKEY_BYTES, { .bytes = setColor } },
+		{ "Mode{", ILLUMINATIR_CONFIGKEY_VOID,  { .none = makeDefault } },
+	};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_configTable_init( &table, symbols, sizeof(symbols) / sizeof(symbols[0]), &device ) );
+	const uint8_t base = 5;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_configTable_dispatch( &table, "MODE@", 5, &base, 1 ) );
+	TEST_ASSERT_EQUAL_UINT8( 5, device.base );
+	TEST_ASSERT_EQUAL_UINT8( 0, device.makeDefault );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_configTable_dispatch( &table, "mode`", 5, NULL, 0 ) );
+	TEST_ASSERT_EQUAL_UINT8( 1, device.makeDefault );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_configTable_dispatch( &table, "Mode[", 5, &base, 1 ) );
+	TEST_ASSERT_EQUAL_UINT8( 1, device.color_size );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_configTable_dispatch( &table, "Mode{", 5, NULL, 0 ) );
+	TEST_ASSERT_EQUAL_UINT8( 2, device.makeDefault );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_UNSUPPORTED_FORMAT, illuminatir_configTable_dispatch( &table, "Mode\\", 5, NULL, 0 ) );
+}
+
+
+void test_illuminatir_configTable_errors( void )
+{
+	const illuminatir_configKey_t duplicates[] = {
+		{ "Base", ILLUMINATIR_CONFIGKEY_UINT8, { .uint8 = setBase } },
+		{ "BASE", ILLUMINATIR_CONFIGKEY_UINT8, { .uint8 = setBase } },
+	};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_UNKNOWN, illuminatir_configTable_init( &table, duplicates, 2, NULL ) );
+	const illuminatir_configKey_t invalid[] = {
+		{ "",                   ILLUMINATIR_CONFIGKEY_VOID, { .none = makeDefault } },
+		{ "ThisKeyIsFarTooLong", ILLUMINATIR_CONFIGKEY_VOID, { .none = makeDefault } },
+	};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, illuminatir_configTable_init( &table, invalid, 1, NULL ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, illuminatir_configTable_init( &table, invalid + 1, 1, NULL ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, illuminatir_configTable_init( &table, keys, ILLUMINATIR_CONFIGTABLE_SLOTS / 2 + 1, NULL ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NULL_POINTER, illuminatir_configTable_init( &table, NULL, 1, NULL ) );
+
+	// An empty table knows no keys.
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_configTable_init( &table, NULL, 0, NULL ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_UNSUPPORTED_FORMAT, illuminatir_configTable_dispatch( &table, "Base", 4, NULL, 0 ) );
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_illuminatir_configTable_dispatch);
+	RUN_TEST(test_illuminatir_configTable_unknown);
+	RUN_TEST(test_illuminatir_configTable_handler);
+	RUN_TEST(test_illuminatir_configTable_full);
+	RUN_TEST(test_illuminatir_configTable_caseOfSymbols);
+	RUN_TEST(test_illuminatir_configTable_errors);
+	return UNITY_END();
+}
@@ -0,0 +1,104 @@
+#include <illuminatir.h>
+#include <unity.h>
+#include <string.h>
+#include "common.h"
+
+
+typedef uint8_t (*crc8_kernel_t)( const uint8_t * data, size_t data_size, uint8_t crc );
+
+static const crc8_kernel_t kernels[] = {
+	illuminatir_crc8,
+	illuminatir_crc8_bytewise,
+	illuminatir_crc8_slice4,
+	illuminatir_crc8_slice8,
+	illuminatir_crc8_clmul,
+};
+#define KERNELS_COUNT (sizeof(kernels)/sizeof(kernels[0]))
+
+static uint8_t data[4096 + 15];
+
+
+void setUp(void) {
+	// xorshift, so the data is the same on every run
+	uint32_t x = 0x2545f491;
+	for( size_t i = 0; i < sizeof(data); i++ ) {
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		data[i] = x;
+	}
+}
+
+
+void tearDown(void) {
+	// clean stuff up here
+}
+
+
+void test_illuminatir_crc8_check(void)
+{
+	static const uint8_t check[] = "123456789";
+	for( size_t k = 0; k < KERNELS_COUNT; k++ ) {
+		TEST_ASSERT_EQUAL_HEX8( 0xd8, kernels[k]( check, 9, ILLUMINATIR_CRC8_INITIAL_SEED ) );
+		TEST_ASSERT_EQUAL_HEX8( ILLUMINATIR_CRC8_INITIAL_SEED, kernels[k]( NULL, 9, 0x55 ) );
+		TEST_ASSERT_EQUAL_HEX8( 0x55, kernels[k]( check, 0, 0x55 ) );
+	}
+}
+
+
+void test_illuminatir_crc8_kernelsMatchBytewise(void)
+{
+	static const size_t sizes[] = { 1, 3, 4, 7, 8, 15, 16, 17, 19, 63, 64, 65, 127, 128, 129, 255, 256, 257, 1000, 4096 };
+	for( size_t s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++ ) {
+		for( size_t offset = 0; offset < 16; offset += 5 ) { // unaligned starts
+			for( unsigned seed = 0; seed < 256; seed += 51 ) {
+				uint8_t expected = illuminatir_crc8_bytewise( data + offset, sizes[s], seed );
+				for( size_t k = 0; k < KERNELS_COUNT; k++ ) {
+					TEST_ASSERT_EQUAL_HEX8( expected, kernels[k]( data + offset, sizes[s], seed ) );
+				}
+			}
+		}
+	}
+}
+
+
+void test_illuminatir_crc8_mixedChunks(void)
+{
+	uint8_t expected = illuminatir_crc8_bytewise( data, 4096, ILLUMINATIR_CRC8_INITIAL_SEED );
+	static const size_t chunks[] = { 1, 70, 9, 300, 16, 5, 1024, 64, 2 };
+	uint8_t crc = ILLUMINATIR_CRC8_INITIAL_SEED;
+	size_t pos = 0;
+	for( size_t i = 0; pos < 4096; i++ ) {
+		size_t chunk = chunks[i % (sizeof(chunks)/sizeof(chunks[0]))];
+		if( chunk > 4096 - pos ) {
+			chunk = 4096 - pos;
+		}
+		crc = kernels[i % KERNELS_COUNT]( data + pos, chunk, crc );
+		pos += chunk;
+	}
+	TEST_ASSERT_EQUAL_HEX8( expected, crc );
+}
+
+
+void test_illuminatir_crc8_packet(void)
+{
+	// the last byte of a packet is the CRC over everything before it
+	uint8_t packet[ILLUMINATIR_PACKET_MAXSIZE];
+	uint8_t packet_size = sizeof(packet);
+	static const uint8_t values[] = { 1, 2, 3, 4 };
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_build_offsetArray( packet, &packet_size, 10, values, sizeof(values) ) );
+	for( size_t k = 0; k < KERNELS_COUNT; k++ ) {
+		TEST_ASSERT_EQUAL_HEX8( packet[packet_size-1], kernels[k]( packet, packet_size-1, ILLUMINATIR_CRC8_INITIAL_SEED ) );
+	}
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_illuminatir_crc8_check);
+	RUN_TEST(test_illuminatir_crc8_kernelsMatchBytewise);
+	RUN_TEST(test_illuminatir_crc8_mixedChunks);
+	RUN_TEST(test_illuminatir_crc8_packet);
+	return UNITY_END();
+}
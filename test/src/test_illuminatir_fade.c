@@ -0,0 +1,129 @@
+#include <illuminatir.h>
+#include <unity.h>
+#include <string.h>
+#include "common.h"
+
+
+static illuminatir_fade_t fade;
+static uint8_t            start[ILLUMINATIR_CHANNELS];
+static uint8_t            target[ILLUMINATIR_CHANNELS];
+
+
+void setUp(void) {
+	memset( start, 0, sizeof(start) );
+	memset( target, 0, sizeof(target) );
+}
+
+
+void tearDown(void) {
+	// clean stuff up here
+}
+
+
+void test_illuminatir_fade_linear( void )
+{
+	target[0]   = 200;
+	target[1]   = 1;
+	start[2]    = 255;
+	start[255]  = 100;
+	target[255] = 100;
+	illuminatir_channelMask_t changed;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_fade_init( &fade, start, target, 1000, ILLUMINATIR_FADE_LINEAR, 0xfffffe00 ) );
+
+	illuminatir_channelMask_clear( &changed );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_fade_tick( &fade, 0xfffffe00, &changed ) );
+	TEST_ASSERT_EQUAL_UINT8_ARRAY( start, fade.values, ILLUMINATIR_CHANNELS );
+	for( unsigned i = 0; i < ILLUMINATIR_CHANNELS / 32; i++ ) {
+		TEST_ASSERT_EQUAL_UINT32( 0, changed.bits[i] );
+	}
+
+	// Half way, across a wrap around of the clock.
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_fade_tick( &fade, 0xfffffe00 + 500, &changed ) );
+	TEST_ASSERT_EQUAL_UINT8( 100, fade.values[0] );
+	TEST_ASSERT_EQUAL_UINT8( 1, fade.values[1] ); // rounded
+	TEST_ASSERT_EQUAL_UINT8( 128, fade.values[2] );
+	TEST_ASSERT_EQUAL_UINT8( 100, fade.values[255] );
+	TEST_ASSERT_EQUAL_UINT32( 0x7, changed.bits[0] );
+	TEST_ASSERT_EQUAL_UINT32( 0, changed.bits[7] );
+	TEST_ASSERT_FALSE( fade.done );
+
+	// Unchanged values are not marked again.
+	illuminatir_channelMask_clear( &changed );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_fade_tick( &fade, 0xfffffe00 + 501, &changed ) );
+	TEST_ASSERT_EQUAL_UINT32( 0, changed.bits[0] & 0x2 );
+
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_fade_tick( &fade, 0xfffffe00 + 1000, &changed ) );
+	TEST_ASSERT_EQUAL_UINT8_ARRAY( target, fade.values, ILLUMINATIR_CHANNELS );
+	TEST_ASSERT_TRUE( fade.done );
+}
+
+
+void test_illuminatir_fade_curves( void )
+{
+	memset( target, 255, sizeof(target) );
+	const illuminatir_fade_curve_t curves[] = { ILLUMINATIR_FADE_LINEAR, ILLUMINATIR_FADE_EASE_IN, ILLUMINATIR_FADE_EASE_OUT, ILLUMINATIR_FADE_SMOOTH };
+	uint8_t quarter[4];
+	for( unsigned c = 0; c < 4; c++ ) {
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_fade_init( &fade, start, target, 256, curves[c], 0 ) );
+		uint8_t previous = 0;
+		for( uint32_t now = 0; now <= 256; now++ ) {
+			TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_fade_tick( &fade, now, NULL ) );
+			TEST_ASSERT_TRUE( fade.values[17] >= previous ); // monotonic
+			previous = fade.values[17];
+			if( now == 64 ) {
+				quarter[c] = previous;
+			}
+		}
+		TEST_ASSERT_EQUAL_UINT8( 255, previous );
+		TEST_ASSERT_TRUE( fade.done );
+	}
+	TEST_ASSERT_EQUAL_UINT8( 64, quarter[0] );
+	TEST_ASSERT_TRUE( quarter[1] < quarter[0] );
+	TEST_ASSERT_TRUE( quarter[2] > quarter[0] );
+	TEST_ASSERT_TRUE( quarter[3] < quarter[0] );
+}
+
+
+void test_illuminatir_fade_retarget( void )
+{
+	memset( target, 200, sizeof(target) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_fade_init( &fade, start, target, 100, ILLUMINATIR_FADE_LINEAR, 0 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_fade_tick( &fade, 50, NULL ) );
+	TEST_ASSERT_EQUAL_UINT8( 100, fade.values[0] );
+
+	// Continues from the current values without a jump.
+	memset( target, 0, sizeof(target) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_fade_init( &fade, NULL, target, 0, ILLUMINATIR_FADE_LINEAR, 50 ) );
+	TEST_ASSERT_EQUAL_UINT8( 100, fade.values[0] );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_fade_tick( &fade, 50, NULL ) );
+	TEST_ASSERT_EQUAL_UINT8( 0, fade.values[0] );
+	TEST_ASSERT_TRUE( fade.done );
+
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NULL_POINTER, illuminatir_fade_init( &fade, start, NULL, 0, ILLUMINATIR_FADE_LINEAR, 0 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NULL_POINTER, illuminatir_fade_tick( NULL, 0, NULL ) );
+}
+
+
+void test_illuminatir_fade_long( void )
+{
+	// Longer than 2^31 us, past which the time since the start takes the top bit.
+	memset( target, 200, sizeof(target) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_fade_init( &fade, start, target, 4000000000u, ILLUMINATIR_FADE_LINEAR, 1000 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_fade_tick( &fade, 1000 + 3000000000u, NULL ) );
+	TEST_ASSERT_EQUAL_UINT8( 150, fade.values[0] );
+	TEST_ASSERT_FALSE( fade.done );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_fade_tick( &fade, 1000 + 4000000000u, NULL ) );
+	TEST_ASSERT_EQUAL_UINT8( 200, fade.values[0] );
+	TEST_ASSERT_TRUE( fade.done );
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_illuminatir_fade_linear);
+	RUN_TEST(test_illuminatir_fade_curves);
+	RUN_TEST(test_illuminatir_fade_retarget);
+	RUN_TEST(test_illuminatir_fade_long);
+	return UNITY_END();
+}
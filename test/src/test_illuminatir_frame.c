@@ -0,0 +1,196 @@
+#include <illuminatir.h>
+#include <unity.h>
+#include <string.h>
+#include "common.h"
+
+
+static uint8_t  channels[256] = {0};
+static unsigned setChannel_called = 0;
+
+static char     lastConfigKey[ILLUMINATIR_CONFIG_KEY_MAXLEN];
+static uint8_t  lastConfigKey_size = 0;
+static uint8_t  lastConfigValues[ILLUMINATIR_CONFIG_VALUES_MAXSIZE];
+static uint8_t  lastConfigValues_size = 0;
+static unsigned setConfig_called = 0;
+
+
+void setUp(void) {
+	memset( channels, 0, sizeof(channels) );
+	setChannel_called = 0;
+
+	memset( lastConfigKey, 0, sizeof(lastConfigKey) );
+	lastConfigKey_size    = 0;
+	memset( lastConfigValues, 0, sizeof(lastConfigValues) );
+	lastConfigValues_size = 0;
+	setConfig_called      = 0;
+}
+
+
+void tearDown(void) {
+	// clean stuff up here
+}
+
+
+void setChannel( uint8_t channel, uint8_t value )
+{
+	channels[channel] = value;
+	setChannel_called++;
+}
+
+
+void setConfig( const char * key, uint8_t key_size, const uint8_t * values, uint8_t values_size )
+{
+	memcpy( lastConfigKey, key, key_size );
+	lastConfigKey_size = key_size;
+	memcpy( lastConfigValues, values, values_size );
+	lastConfigValues_size = values_size;
+	setConfig_called++;
+}
+
+
+void test_illuminatir_frame_rand_cobs( void )
+{
+	uint8_t buffer[ILLUMINATIR_FRAME_BUFFER_SIZE(3 * ILLUMINATIR_PACKET_MAXSIZE)];
+	illuminatir_frame_t frame;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_init( &frame, buffer, sizeof(buffer) ) );
+
+	const uint8_t values[] = {1,2,3,4};
+	const uint8_t pairs[] = {200,5,100,6};
+	const char key[] = "Test";
+	const uint8_t configValues[] = {7,8};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_add_offsetArray( &frame, 10, values, sizeof(values) ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_add_channelValuePairs( &frame, pairs, sizeof(pairs) ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_add_config( &frame, key, sizeof(key)-1, configValues, sizeof(configValues) ) );
+
+	// The same packets built and encoded by hand
+	uint8_t packets[3 * ILLUMINATIR_PACKET_MAXSIZE];
+	uint8_t packet_size;
+	size_t packets_size = 0;
+	packet_size = ILLUMINATIR_PACKET_MAXSIZE;
+	illuminatir_build_offsetArray( packets + packets_size, &packet_size, 10, values, sizeof(values) );
+	packets_size += packet_size;
+	packet_size = ILLUMINATIR_PACKET_MAXSIZE;
+	illuminatir_build_channelValuePairs( packets + packets_size, &packet_size, pairs, sizeof(pairs) );
+	packets_size += packet_size;
+	packet_size = ILLUMINATIR_PACKET_MAXSIZE;
+	illuminatir_build_config( packets + packets_size, &packet_size, key, sizeof(key)-1, configValues, sizeof(configValues) );
+	packets_size += packet_size;
+	TEST_ASSERT_EQUAL_UINT( packets_size, frame.size );
+	illuminatir_rand( packets, packets_size );
+	uint8_t expected[ILLUMINATIR_FRAME_BUFFER_SIZE(sizeof(packets))];
+	size_t expected_size = illuminatir_cobs_encode( expected, sizeof(expected), packets, packets_size );
+	expected[expected_size++] = 0;
+
+	size_t frame_size;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_frame_finalize( &frame, &frame_size ) );
+	TEST_ASSERT_EQUAL_UINT( expected_size, frame_size );
+	TEST_ASSERT_EQUAL_HEX8_ARRAY( expected, buffer, frame_size );
+	TEST_ASSERT_EQUAL_UINT( 0, frame.size );
+
+	// A streaming decoder receives all three packets from the single frame
+	illuminatir_stream_t stream;
+	uint8_t streamFrame[sizeof(packets)];
+	illuminatir_rand_stream_init( &stream, streamFrame, sizeof(streamFrame), setChannel, setConfig );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_stream_feed( &stream, buffer, frame_size ) );
+	TEST_ASSERT_EQUAL_UINT( 6, setChannel_called );
+	TEST_ASSERT_EQUAL_UINT8( 4, channels[13] );
+	TEST_ASSERT_EQUAL_UINT8( 5, channels[200] );
+	TEST_ASSERT_EQUAL_UINT8( 6, channels[100] );
+	TEST_ASSERT_EQUAL_UINT( 1, setConfig_called );
+	TEST_ASSERT_EQUAL_STRING( key, lastConfigKey );
+	TEST_ASSERT_EQUAL_UINT( 2, lastConfigValues_size );
+}
+
+
+void test_illuminatir_frame_cobs_inPlace( void )
+{
+	// Large frames spanning several COBS blocks, filled up to the last byte
+	enum { PACKETS = 40 };
+	static uint8_t buffer[ILLUMINATIR_FRAME_BUFFER_SIZE(PACKETS * ILLUMINATIR_PACKET_MAXSIZE)];
+	static uint8_t packets[PACKETS * ILLUMINATIR_PACKET_MAXSIZE];
+	static uint8_t expected[sizeof(buffer)];
+	illuminatir_frame_t frame;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_init( &frame, buffer, sizeof(buffer) ) );
+
+	for( unsigned round = 0; round < 2; round++ ) {
+		size_t packets_size = 0;
+		for( unsigned i = 0; i < PACKETS; i++ ) {
+			uint8_t values[ILLUMINATIR_OFFSETARRAY_MAXVALUES];
+			for( unsigned v = 0; v < sizeof(values); v++ ) {
+				values[v] = (i * 7 + v + round) % 5 ? (uint8_t)(i + v) : 0;
+			}
+			TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_add_offsetArray( &frame, i * 16, values, sizeof(values) ) );
+			uint8_t packet_size = ILLUMINATIR_PACKET_MAXSIZE;
+			illuminatir_build_offsetArray( packets + packets_size, &packet_size, i * 16, values, sizeof(values) );
+			packets_size += packet_size;
+		}
+		const uint8_t values[] = {1};
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_BUFFER_OVERFLOW, illuminatir_frame_add_offsetArray( &frame, 0, values, sizeof(values) ) );
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_BUFFER_OVERFLOW, illuminatir_frame_add_packets( &frame, packets, 1 ) );
+		TEST_ASSERT_EQUAL_UINT( packets_size, frame.size );
+
+		size_t expected_size = illuminatir_cobs_encode( expected, sizeof(expected), packets, packets_size );
+		expected[expected_size++] = 0;
+		size_t frame_size;
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_frame_finalize( &frame, &frame_size ) );
+		TEST_ASSERT_EQUAL_UINT( expected_size, frame_size );
+		TEST_ASSERT_EQUAL_HEX8_ARRAY( expected, buffer, frame_size );
+	}
+}
+
+
+void test_illuminatir_frame_addPackets( void )
+{
+	uint8_t buffer[ILLUMINATIR_FRAME_BUFFER_SIZE(ILLUMINATIR_PLAN_MAXSIZE)];
+	illuminatir_frame_t frame;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_init( &frame, buffer, sizeof(buffer) ) );
+
+	uint8_t next[ILLUMINATIR_CHANNELS];
+	for( unsigned i = 0; i < sizeof(next); i++ ) {
+		next[i] = i;
+	}
+	uint8_t packets[ILLUMINATIR_PLAN_MAXSIZE];
+	size_t packets_size = sizeof(packets);
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_plan( packets, &packets_size, NULL, next, ILLUMINATIR_PLAN_OVERHEAD_RAW ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_add_packets( &frame, packets, packets_size ) );
+
+	size_t frame_size;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_frame_finalize( &frame, &frame_size ) );
+	illuminatir_stream_t stream;
+	uint8_t streamFrame[ILLUMINATIR_PLAN_MAXSIZE];
+	illuminatir_rand_stream_init( &stream, streamFrame, sizeof(streamFrame), setChannel, setConfig );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_stream_feed( &stream, buffer, frame_size ) );
+	TEST_ASSERT_EQUAL_HEX8_ARRAY( next, channels, sizeof(next) );
+}
+
+
+void test_illuminatir_frame_errors( void )
+{
+	uint8_t buffer[ILLUMINATIR_FRAME_BUFFER_SIZE(ILLUMINATIR_PACKET_MINSIZE)];
+	illuminatir_frame_t frame;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NULL_POINTER, illuminatir_frame_init( NULL, buffer, sizeof(buffer) ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NULL_POINTER, illuminatir_frame_init( &frame, NULL, sizeof(buffer) ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, illuminatir_frame_init( &frame, buffer, sizeof(buffer) - 1 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_init( &frame, buffer, sizeof(buffer) ) );
+
+	size_t frame_size = 1;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_frame_finalize( &frame, &frame_size ) );
+	TEST_ASSERT_EQUAL_UINT( 0, frame_size );
+
+	const uint8_t values[] = {1,2};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_BUFFER_OVERFLOW, illuminatir_frame_add_offsetArray( &frame, 0, values, 2 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_add_offsetArray( &frame, 0, values, 1 ) );
+	illuminatir_frame_reset( &frame );
+	TEST_ASSERT_EQUAL_UINT( 0, frame.size );
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_illuminatir_frame_rand_cobs);
+	RUN_TEST(test_illuminatir_frame_cobs_inPlace);
+	RUN_TEST(test_illuminatir_frame_addPackets);
+	RUN_TEST(test_illuminatir_frame_errors);
+	return UNITY_END();
+}
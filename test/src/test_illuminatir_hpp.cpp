@@ -0,0 +1,432 @@
+#include <illuminatir.hpp>
+#include <unity.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "common.h"
+
+
+// Every payload delivered to a handler is appended as a tag followed by its bytes, so C and C++ handlers can be compared.
+typedef std::vector<uint8_t> events_t;
+
+static uint32_t state;
+
+
+static uint8_t random8( void )
+{
+	state = state * 1103515245u + 12345u;
+	return (uint8_t)(state >> 16);
+}
+
+
+void setUp(void) {
+	state = 0x1badb002;
+}
+
+
+void tearDown(void) {
+	// clean stuff up here
+}
+
+
+static void logChannels( events_t & events, uint8_t first_channel, const uint8_t * values, size_t count )
+{
+	events.push_back( 'O' );
+	events.push_back( first_channel );
+	events.push_back( (uint8_t)count );
+	events.insert( events.end(), values, values + count );
+}
+
+
+static void logPairs( events_t & events, const uint8_t * pairs, size_t count )
+{
+	events.push_back( 'P' );
+	events.push_back( (uint8_t)count );
+	events.insert( events.end(), pairs, pairs + 2 * count );
+}
+
+
+static void logConfig( events_t & events, const char * key, size_t key_len, const uint8_t * values, size_t values_size )
+{
+	events.push_back( 'C' );
+	events.push_back( (uint8_t)key_len );
+	events.insert( events.end(), key, key + key_len );
+	events.push_back( (uint8_t)values_size );
+	events.insert( events.end(), values, values + values_size );
+}
+
+
+static void setChannels( void * ctx, uint8_t first_channel, const uint8_t * values, uint8_t count )
+{
+	logChannels( *(events_t *)ctx, first_channel, values, count );
+}
+
+
+static void setChannelValuePairs( void * ctx, const uint8_t * pairs, uint8_t count )
+{
+	logPairs( *(events_t *)ctx, pairs, count );
+}
+
+
+static void setConfig( void * ctx, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size )
+{
+	logConfig( *(events_t *)ctx, key, key_len, values, values_size );
+}
+
+
+// Appends a random valid packet of any format.
+static void addRandomPacket( uint8_t * packets, uint8_t * packets_size )
+{
+	uint8_t values[ILLUMINATIR_PACKET_MAXSIZE];
+	for( unsigned i = 0; i < sizeof(values); i++ ) {
+		values[i] = random8();
+	}
+	uint8_t size = ILLUMINATIR_PACKET_MAXSIZE;
+	switch( random8() % 3 ) {
+		case 0:
+			TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_build_offsetArray( packets + *packets_size, &size, random8(), values, 1 + random8() % 16 ) );
+			break;
+		case 1:
+			TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_build_channelValuePairs( packets + *packets_size, &size, values, 2 + random8() % 15 ) );
+			break;
+		default: {
+			uint8_t key_len = 1 + random8() % 8;
+			char key[8];
+			for( uint8_t i = 0; i < key_len; i++ ) {
+				key[i] = (char)('A' + random8() % 26);
+			}
+			TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_build_config( packets + *packets_size, &size, key, key_len, values, random8() % (17 - key_len) ) );
+			break;
+		}
+	}
+	*packets_size += size;
+}
+
+
+void test_illuminatir_hpp_parse( void )
+{
+	illuminatir_handler_t all = { nullptr, setChannels, setChannelValuePairs, setConfig };
+	illuminatir_handler_t channelsOnly = { nullptr, setChannels, nullptr, nullptr };
+	for( unsigned round = 0; round < 2000; round++ ) {
+		uint8_t packets[8 * ILLUMINATIR_PACKET_MAXSIZE];
+		uint8_t packets_size = 0;
+		for( unsigned count = 1 + random8() % 8; count; count-- ) {
+			addRandomPacket( packets, &packets_size );
+		}
+		if( round % 2 ) { // corrupt a byte, or cut the packets short
+			if( random8() % 4 ) {
+				packets[random8() % packets_size] ^= 1 << (random8() % 8);
+			} else {
+				packets_size -= 1 + random8() % 3;
+			}
+		}
+
+		events_t expected, actual;
+		all.ctx = &expected;
+		illuminatir_error_t err = illuminatir_parse_handler( packets, packets_size, &all );
+		TEST_ASSERT_ILLUMINATIR_ERROR( err, illuminatir::parse( std::span( packets, packets_size ), illuminatir::overloaded{
+			[&]( illuminatir::channels_t c ) { logChannels( actual, c.first_channel, c.values.data(), c.values.size() ); },
+			[&]( illuminatir::channelValuePairs_t p ) { logPairs( actual, p.pairs.data(), p.count() ); },
+			[&]( illuminatir::config_t c ) { logConfig( actual, c.key.data(), c.key.size(), c.values.data(), c.values.size() ); },
+		} ) );
+		TEST_ASSERT_EQUAL_UINT( expected.size(), actual.size() );
+		TEST_ASSERT_TRUE( expected == actual );
+
+		// ChannelValuePairs end up as single channels, Configs are ignored.
+		expected.clear();
+		actual.clear();
+		channelsOnly.ctx = &expected;
+		err = illuminatir_parse_handler( packets, packets_size, &channelsOnly );
+		TEST_ASSERT_ILLUMINATIR_ERROR( err, illuminatir::parse( std::span( packets, packets_size ), [&]( illuminatir::channels_t c ) {
+			logChannels( actual, c.first_channel, c.values.data(), c.values.size() );
+		} ) );
+		TEST_ASSERT_TRUE( expected == actual );
+	}
+}
+
+
+void test_illuminatir_hpp_cobs_parse( void )
+{
+	illuminatir_handler_t all = { nullptr, setChannels, setChannelValuePairs, setConfig };
+	illuminatir_stats_t stats_c, stats_cpp;
+	illuminatir_stats_clear( &stats_c );
+	illuminatir_stats_clear( &stats_cpp );
+	for( unsigned round = 0; round < 2000; round++ ) {
+		uint8_t packet[ILLUMINATIR_PACKET_MAXSIZE];
+		uint8_t packet_size = 0;
+		addRandomPacket( packet, &packet_size );
+		const bool randomized = round % 2;
+		if( randomized ) {
+			illuminatir_rand( packet, packet_size );
+		}
+		uint8_t cobsPacket[ILLUMINATIR_COBS_PACKET_MAXSIZE];
+		size_t cobsPacket_size = illuminatir_cobs_encode( cobsPacket, sizeof(cobsPacket), packet, packet_size );
+		if( round % 3 == 0 ) {
+			cobsPacket[random8() % cobsPacket_size] ^= 1 << (random8() % 8);
+		}
+
+		events_t expected, actual;
+		all.ctx = &expected;
+		auto handler = illuminatir::overloaded{
+			[&]( illuminatir::channels_t c ) { logChannels( actual, c.first_channel, c.values.data(), c.values.size() ); },
+			[&]( illuminatir::channelValuePairs_t p ) { logPairs( actual, p.pairs.data(), p.count() ); },
+			[&]( illuminatir::config_t c ) { logConfig( actual, c.key.data(), c.key.size(), c.values.data(), c.values.size() ); },
+		};
+		illuminatir_error_t err;
+		illuminatir_stats_select( &stats_c );
+		if( randomized ) {
+			err = illuminatir_rand_cobs_parse_handler( cobsPacket, (uint8_t)cobsPacket_size, &all );
+			illuminatir_stats_select( &stats_cpp );
+			TEST_ASSERT_ILLUMINATIR_ERROR( err, illuminatir::rand_cobs_parse( std::span( cobsPacket, cobsPacket_size ), handler ) );
+		} else {
+			err = illuminatir_cobs_parse_handler( cobsPacket, (uint8_t)cobsPacket_size, &all );
+			illuminatir_stats_select( &stats_cpp );
+			TEST_ASSERT_ILLUMINATIR_ERROR( err, illuminatir::cobs_parse( std::span( cobsPacket, cobsPacket_size ), handler ) );
+		}
+		TEST_ASSERT_TRUE( expected == actual );
+	}
+	illuminatir_stats_select( nullptr );
+#if ILLUMINATIR_STATS // counting is compiled out otherwise
+	TEST_ASSERT_EQUAL_MEMORY( &stats_c, &stats_cpp, sizeof(stats_c) );
+	TEST_ASSERT_TRUE( stats_c.cobs_errors > 0 );
+#endif
+}
+
+
+void test_illuminatir_hpp_wraparound( void )
+{
+	uint8_t universe[256] = {0};
+	uint8_t packet[ILLUMINATIR_PACKET_MAXSIZE];
+	const uint8_t values[] = {1,2,3,4};
+	auto built = illuminatir::build_offsetArray( packet, 254, values );
+	TEST_ASSERT_TRUE( built );
+	unsigned calls = 0;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir::parse( built.packet, [&]( illuminatir::channels_t c ) {
+		std::memcpy( universe + c.first_channel, c.values.data(), c.values.size() );
+		calls++;
+	} ) );
+	TEST_ASSERT_EQUAL_UINT( 2, calls );
+	TEST_ASSERT_EQUAL_UINT8( 1, universe[254] );
+	TEST_ASSERT_EQUAL_UINT8( 2, universe[255] );
+	TEST_ASSERT_EQUAL_UINT8( 3, universe[0] );
+	TEST_ASSERT_EQUAL_UINT8( 4, universe[1] );
+}
+
+
+void test_illuminatir_hpp_build( void )
+{
+	const uint8_t values[] = {7,6,5,4,3,2,1};
+	uint8_t expected[ILLUMINATIR_COBS_PACKET_MAXSIZE];
+	uint8_t expected_size;
+	uint8_t packet[ILLUMINATIR_COBS_PACKET_MAXSIZE];
+
+	expected_size = sizeof(expected);
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_build_offsetArray( expected, &expected_size, 3, values, sizeof(values) ) );
+	auto built = illuminatir::build_offsetArray( packet, 3, values );
+	TEST_ASSERT_EQUAL_UINT( expected_size, built.packet.size() );
+	TEST_ASSERT_EQUAL_UINT8_ARRAY( expected, built.packet.data(), expected_size );
+
+	expected_size = sizeof(expected);
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_build_channelValuePairs( expected, &expected_size, values, 6 ) );
+	built = illuminatir::cobs_build_channelValuePairs( packet, std::span( values, 6 ) );
+	TEST_ASSERT_EQUAL_UINT( expected_size, built.packet.size() );
+	TEST_ASSERT_EQUAL_UINT8_ARRAY( expected, built.packet.data(), expected_size );
+
+	expected_size = sizeof(expected);
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_build_config( expected, &expected_size, "Base", 4, values, 1 ) );
+	built = illuminatir::rand_cobs_build_config( packet, "Base", std::span( values, 1 ) );
+	TEST_ASSERT_EQUAL_UINT( expected_size, built.packet.size() );
+	TEST_ASSERT_EQUAL_UINT8_ARRAY( expected, built.packet.data(), expected_size );
+
+	// A Config without values round trips through the C++ parser.
+	built = illuminatir::cobs_build_config( packet, "MakeDefault" );
+	TEST_ASSERT_TRUE( built );
+	unsigned calls = 0;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir::cobs_parse( built.packet, [&]( illuminatir::config_t c ) {
+		TEST_ASSERT_TRUE( c.key == "MakeDefault" );
+		TEST_ASSERT_EQUAL_UINT( 0, c.values.size() );
+		calls++;
+	} ) );
+	TEST_ASSERT_EQUAL_UINT( 1, calls );
+}
+
+
+void test_illuminatir_hpp_errors( void )
+{
+	uint8_t packet[ILLUMINATIR_PACKET_MAXSIZE];
+	const uint8_t values[300] = {0};
+	auto built = illuminatir::build_offsetArray( packet, 0, values );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, built.error );
+	TEST_ASSERT_FALSE( built );
+	TEST_ASSERT_EQUAL_UINT( 0, built.packet.size() );
+
+	// Too small a span fails like the C builder.
+	uint8_t expected_size = 4;
+	illuminatir_error_t err = illuminatir_build_offsetArray( packet, &expected_size, 0, values, 8 );
+	TEST_ASSERT_ILLUMINATIR_ERROR( err, illuminatir::build_offsetArray( std::span( packet, 4 ), 0, std::span( values, 8 ) ).error );
+
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NULL_POINTER, illuminatir::parse( std::span<const uint8_t>(), []( illuminatir::channels_t ) {} ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, illuminatir::cobs_parse( std::span( values, 4 ), []( illuminatir::channels_t ) {} ) );
+}
+
+
+// The test vectors of test_illuminatir_crc8.c, test_illuminatir_cobs.c, test_illuminatir_build.c and the keystream table of rand.c, checked at compile time.
+template< size_t N, size_t M >
+constexpr bool equal( const std::array<uint8_t, N> & a, const uint8_t (&b)[M] )
+{
+	return N == M && std::equal( a.begin(), a.end(), b );
+}
+
+template< size_t N >
+constexpr bool cobsEncodes( std::array<uint8_t, N> decoded, std::initializer_list<uint8_t> encoded )
+{
+	std::array<uint8_t, ILLUMINATIR_COBS_ENCODE_DST_MAXSIZE(N)> dst{};
+	size_t size = illuminatir::cobs_encode( dst, decoded );
+	return size == encoded.size() && std::equal( encoded.begin(), encoded.end(), dst.begin() );
+}
+
+template< size_t N, uint8_t First >
+constexpr std::array<uint8_t, N> sequence()
+{
+	std::array<uint8_t, N> a{};
+	for( size_t i = 0; i < N; i++ ) {
+		a[i] = (uint8_t)(First + i);
+	}
+	return a;
+}
+
+static constexpr uint8_t check[] = {'1','2','3','4','5','6','7','8','9'};
+static_assert( illuminatir::crc8( check ) == 0xd8 );
+static_assert( illuminatir::crc8( std::span( check, 0 ), 0x55 ) == 0x55 );
+
+static_assert( cobsEncodes( std::array<uint8_t, 1>{0xa5}, {0x02,0xa5} ) );
+static_assert( cobsEncodes( std::array<uint8_t, 1>{0x00}, {0x01,0x01} ) );
+static_assert( cobsEncodes( std::array<uint8_t, 2>{0x00,0x00}, {0x01,0x01,0x01} ) );
+static_assert( cobsEncodes( std::array<uint8_t, 4>{0x11,0x22,0x00,0x33}, {0x03,0x11,0x22,0x02,0x33} ) );
+static_assert( cobsEncodes( std::array<uint8_t, 4>{0x11,0x22,0x33,0x44}, {0x05,0x11,0x22,0x33,0x44} ) );
+static_assert( cobsEncodes( std::array<uint8_t, 4>{0x11,0x00,0x00,0x00}, {0x02,0x11,0x01,0x01,0x01} ) );
+static_assert( []{ // 01 02 ... FE FF -> FF 01 02 ... FE 02 FF
+	auto decoded = sequence<255, 1>();
+	std::array<uint8_t, 257> encoded{};
+	return illuminatir::cobs_encode( encoded, decoded ) == 257 && encoded[0] == 0xff && encoded[254] == 0xfe && encoded[255] == 0x02 && encoded[256] == 0xff;
+}() );
+static_assert( []{ // 03 04 ... FF 00 01 -> FE 03 04 ... FF 02 01
+	auto decoded = sequence<255, 3>();
+	std::array<uint8_t, 257> encoded{};
+	return illuminatir::cobs_encode( encoded, decoded ) == 256 && encoded[0] == 0xfe && encoded[253] == 0xff && encoded[254] == 0x02 && encoded[255] == 0x01;
+}() );
+static_assert( []{
+	std::array<uint8_t, 1> decoded{1};
+	std::array<uint8_t, 1> encoded{};
+	return illuminatir::cobs_encode( encoded, decoded ) == 0 && illuminatir::cobs_encode( encoded, std::span( decoded ).first( 0 ) ) == 0;
+}() );
+
+// Randomizing zeros with the CRC 0 as seed gives the first row of the keystream, continued by the row of its next seed 0x30.
+static_assert( []{
+	std::array<uint8_t, 1 + 17 + 2 + 1> packet{};
+	illuminatir::rand( packet );
+	return equal( packet, {0x00, 0x02,0x0c,0x28,0xf2,0x2c,0xea,0x7d,0x0e,0x24,0xda,0xde,0xc6,0x97,0x73,0x2a,0xfe,0x04, 0x18,0x51, 0x00} );
+}() );
+
+static_assert( []{
+	constexpr auto packet = illuminatir::make_offsetArray( 0, {42} );
+	return equal( packet, {0x00,0x00,42,illuminatir::crc8( std::span( packet ).first( 3 ) )} );
+}() );
+static_assert( []{
+	constexpr auto packet = illuminatir::make_config( "Test", {1,2,3} );
+	return equal( packet, {0x26,'T','e','s','t',0,1,2,3,illuminatir::crc8( std::span( packet ).first( 9 ) )} );
+}() );
+static_assert( []{
+	constexpr auto packet = illuminatir::make_channelValuePairs( {10,1,200,2,7} );
+	return equal( packet, {0x13,10,1,200,2,7,illuminatir::crc8( std::span( packet ).first( 6 ) )} );
+}() );
+
+
+void test_illuminatir_hpp_constexpr_matchesC( void )
+{
+	uint8_t data[300] = {};
+	for( size_t size = 0; size <= sizeof(data); size++ ) {
+		for( size_t i = 0; i < size; i++ ) {
+			data[i] = (random8() % 4) ? random8() : 0;
+		}
+		TEST_ASSERT_EQUAL_HEX8( illuminatir_crc8( data, size, 0x5a ), illuminatir::crc8( std::span( data, size ), 0x5a ) );
+
+		uint8_t expected[sizeof(data)];
+		uint8_t actual[sizeof(data)];
+		std::memcpy( expected, data, size );
+		std::memcpy( actual, data, size );
+		illuminatir_rand( expected, size );
+		illuminatir::rand( std::span( actual, size ) );
+		TEST_ASSERT_EQUAL_UINT8_ARRAY( expected, actual, size );
+
+		uint8_t expected_cobs[ILLUMINATIR_COBS_ENCODE_DST_MAXSIZE(sizeof(data))];
+		uint8_t actual_cobs[ILLUMINATIR_COBS_ENCODE_DST_MAXSIZE(sizeof(data))];
+		size_t expected_size = illuminatir_cobs_encode( expected_cobs, sizeof(expected_cobs), data, size );
+		TEST_ASSERT_EQUAL_UINT( expected_size, illuminatir::cobs_encode( actual_cobs, std::span( data, size ) ) );
+		TEST_ASSERT_EQUAL_UINT8_ARRAY( expected_cobs, actual_cobs, expected_size );
+	}
+}
+
+
+void test_illuminatir_hpp_constexpr_frames( void )
+{
+	static constexpr auto makeDefault = illuminatir::make_rand_frame( illuminatir::make_config( "MakeDefault" ) );
+	static constexpr auto pattern = illuminatir::make_frame(
+		illuminatir::make_offsetArray( 250, {1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16} ),
+		illuminatir::make_channelValuePairs( {0,0,255,255,7} ),
+		illuminatir::make_config( "IlluminatIR", {0,42} )
+	);
+	static constexpr auto randomPattern = illuminatir::make_rand_frame(
+		illuminatir::make_offsetArray( 0, {0,0,0,0} ),
+		illuminatir::make_config( "W", {255,255,255} )
+	);
+
+	const uint8_t values[] = {1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16};
+	const uint8_t pairs[] = {0,0,255,255,7};
+	const uint8_t zeros[4] = {0};
+	const uint8_t config[] = {0,42};
+	const uint8_t white[] = {255,255,255};
+	uint8_t buffer[ILLUMINATIR_FRAME_BUFFER_SIZE(3 * ILLUMINATIR_PACKET_MAXSIZE)];
+	illuminatir_frame_t frame;
+	size_t frame_size;
+
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_init( &frame, buffer, sizeof(buffer) ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_add_config( &frame, "MakeDefault", 11, nullptr, 0 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_frame_finalize( &frame, &frame_size ) );
+	TEST_ASSERT_EQUAL_UINT( frame_size, makeDefault.size() );
+	TEST_ASSERT_EQUAL_HEX8_ARRAY( buffer, makeDefault.data(), frame_size );
+
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_add_offsetArray( &frame, 250, values, sizeof(values) ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_add_channelValuePairs( &frame, pairs, sizeof(pairs) ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_add_config( &frame, "IlluminatIR", 11, config, sizeof(config) ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_frame_finalize( &frame, &frame_size ) );
+	TEST_ASSERT_EQUAL_UINT( frame_size, pattern.size() );
+	TEST_ASSERT_EQUAL_HEX8_ARRAY( buffer, pattern.data(), frame_size );
+
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_add_offsetArray( &frame, 0, zeros, sizeof(zeros) ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_add_config( &frame, "W", 1, white, sizeof(white) ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_frame_finalize( &frame, &frame_size ) );
+	TEST_ASSERT_EQUAL_UINT( frame_size, randomPattern.size() );
+	TEST_ASSERT_EQUAL_HEX8_ARRAY( buffer, randomPattern.data(), frame_size );
+
+	// A single packet frame is what the C builders produce, plus the delimiter.
+	uint8_t cobsPacket[ILLUMINATIR_COBS_PACKET_MAXSIZE];
+	uint8_t cobsPacket_size = sizeof(cobsPacket);
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_build_config( cobsPacket, &cobsPacket_size, "MakeDefault", 11, nullptr, 0 ) );
+	TEST_ASSERT_EQUAL_UINT( cobsPacket_size + 1, makeDefault.size() );
+	TEST_ASSERT_EQUAL_HEX8_ARRAY( cobsPacket, makeDefault.data(), cobsPacket_size );
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_illuminatir_hpp_parse);
+	RUN_TEST(test_illuminatir_hpp_cobs_parse);
+	RUN_TEST(test_illuminatir_hpp_wraparound);
+	RUN_TEST(test_illuminatir_hpp_build);
+	RUN_TEST(test_illuminatir_hpp_errors);
+	RUN_TEST(test_illuminatir_hpp_constexpr_matchesC);
+	RUN_TEST(test_illuminatir_hpp_constexpr_frames);
+	return UNITY_END();
+}
@@ -50,9 +50,38 @@ void test_illuminatir_lfsr127_uint8( void )
 }
 
 
+void test_illuminatir_lfsr127_uint8_r( void )
+{
+	for( unsigned seed = 0; seed < 256; seed++ ) {
+		illuminatir_lfsr127_t a, b;
+		illuminatir_lfsr127_init_r( &a, seed );
+		illuminatir_lfsr127_init_r( &b, seed ^ 0x55 );
+		illuminatir_lfsr127_init( seed );
+		for( unsigned i = 0; i < 300; i++ ) {
+			illuminatir_lfsr127_uint8_r( &b ); // interleaved use of another state must not interfere
+			TEST_ASSERT_EQUAL_UINT8( illuminatir_lfsr127_uint8(), illuminatir_lfsr127_uint8_r( &a ) );
+		}
+	}
+}
+
+
+void test_illuminatir_rand_keepsGlobalState( void )
+{
+	illuminatir_lfsr127_t expected;
+	illuminatir_lfsr127_init_r( &expected, 42 );
+	illuminatir_lfsr127_init( 42 );
+	TEST_ASSERT_EQUAL_UINT8( illuminatir_lfsr127_uint8_r( &expected ), illuminatir_lfsr127_uint8() );
+	uint8_t packet[] = {0x00,0x00,42,0x17};
+	illuminatir_rand( packet, sizeof(packet) );
+	TEST_ASSERT_EQUAL_UINT8( illuminatir_lfsr127_uint8_r( &expected ), illuminatir_lfsr127_uint8() );
+}
+
+
 int main( void )
 {
 	UNITY_BEGIN();
 	RUN_TEST(test_illuminatir_lfsr127_uint8);
+	RUN_TEST(test_illuminatir_lfsr127_uint8_r);
+	RUN_TEST(test_illuminatir_rand_keepsGlobalState);
 	return UNITY_END();
 }
@@ -0,0 +1,155 @@
+#include <illuminatir_parallel.h>
+#include <unity.h>
+#include <string.h>
+#include "common.h"
+
+
+#define JOBS         200
+#define TRANSMITTERS 3
+
+
+static illuminatir_parallel_t        pool;
+static uint8_t                       previous[JOBS][ILLUMINATIR_CHANNELS];
+static uint8_t                       next[JOBS][ILLUMINATIR_CHANNELS];
+static illuminatir_parallel_job_t    jobs[JOBS];
+static uint8_t                       buffers[TRANSMITTERS][ILLUMINATIR_PARALLEL_BUFFER_SIZE(JOBS)];
+static illuminatir_parallel_output_t outputs[TRANSMITTERS];
+static uint8_t                       expected[TRANSMITTERS][ILLUMINATIR_PARALLEL_BUFFER_SIZE(JOBS)];
+static size_t                        expected_sizes[TRANSMITTERS];
+
+
+void setUp(void) {
+	// Universes with nothing, a few or all channels changed, unevenly spread over the transmitters.
+	uint32_t state = 0xdecafbad;
+	for( unsigned j = 0; j < JOBS; j++ ) {
+		unsigned changes = (j % 7 == 0) ? ILLUMINATIR_CHANNELS : (j % 5) * 3;
+		for( unsigned c = 0; c < ILLUMINATIR_CHANNELS; c++ ) {
+			state = state * 1103515245u + 12345u;
+			previous[j][c] = (uint8_t)(state >> 16);
+			next[j][c] = previous[j][c];
+		}
+		for( unsigned i = 0; i < changes; i++ ) {
+			state = state * 1103515245u + 12345u;
+			next[j][(state >> 8) & 0xff] ^= (uint8_t)((state >> 20) | 1);
+		}
+		jobs[j].previous    = (j % 11 == 0) ? NULL : previous[j];
+		jobs[j].next        = next[j];
+		jobs[j].transmitter = (uint16_t)((j * 5 + j / 4) % TRANSMITTERS);
+	}
+	for( unsigned t = 0; t < TRANSMITTERS; t++ ) {
+		outputs[t].buffer      = buffers[t];
+		outputs[t].buffer_size = sizeof(buffers[t]);
+	}
+}
+
+
+void tearDown(void) {
+	// clean stuff up here
+}
+
+
+// Encodes all jobs one by one on this thread.
+static void encodeExpected( int randomize )
+{
+	memset( expected_sizes, 0, sizeof(expected_sizes) );
+	for( unsigned j = 0; j < JOBS; j++ ) {
+		uint8_t packets[ILLUMINATIR_PLAN_MAXSIZE];
+		size_t packets_size = sizeof(packets);
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_plan( packets, &packets_size, jobs[j].previous, jobs[j].next, ILLUMINATIR_PLAN_OVERHEAD_RAW ) );
+		uint8_t buffer[ILLUMINATIR_PARALLEL_FRAME_MAXSIZE];
+		illuminatir_frame_t frame;
+		size_t frame_size;
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_init( &frame, buffer, sizeof(buffer) ) );
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_add_packets( &frame, packets, packets_size ) );
+		if( randomize ) {
+			TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_frame_finalize( &frame, &frame_size ) );
+		} else {
+			TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_frame_finalize( &frame, &frame_size ) );
+		}
+		uint16_t t = jobs[j].transmitter;
+		memcpy( expected[t] + expected_sizes[t], buffer, frame_size );
+		expected_sizes[t] += frame_size;
+	}
+}
+
+
+static void checkOutputs( void )
+{
+	for( unsigned t = 0; t < TRANSMITTERS; t++ ) {
+		TEST_ASSERT_EQUAL_UINT( expected_sizes[t], outputs[t].size );
+		TEST_ASSERT_EQUAL_UINT8_ARRAY( expected[t], buffers[t], expected_sizes[t] );
+	}
+	for( unsigned j = 0; j < JOBS; j++ ) {
+		if( jobs[j].frame_size ) {
+			TEST_ASSERT_EQUAL_UINT8( 0, buffers[jobs[j].transmitter][jobs[j].frame_offset + jobs[j].frame_size - 1] );
+		}
+	}
+}
+
+
+void test_illuminatir_parallel_deterministic( void )
+{
+	const uint8_t threads[] = { 0, 1, 4, ILLUMINATIR_PARALLEL_MAXTHREADS };
+	for( unsigned randomize = 0; randomize < 2; randomize++ ) {
+		encodeExpected( randomize );
+		for( unsigned i = 0; i < sizeof(threads); i++ ) {
+			TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_parallel_init( &pool, threads[i] ) );
+			for( unsigned repeat = 0; repeat < 5; repeat++ ) {
+				memset( buffers, 0xaa, sizeof(buffers) );
+				if( randomize ) {
+					TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_parallel_encode( &pool, jobs, JOBS, outputs, TRANSMITTERS ) );
+				} else {
+					TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_parallel_encode( &pool, jobs, JOBS, outputs, TRANSMITTERS ) );
+				}
+				checkOutputs();
+			}
+			illuminatir_parallel_destroy( &pool );
+		}
+	}
+}
+
+
+void test_illuminatir_parallel_few_jobs( void )
+{
+	// Fewer jobs than threads leaves some deques empty from the start.
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_parallel_init( &pool, 4 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_parallel_encode( &pool, jobs, 2, outputs, TRANSMITTERS ) );
+	TEST_ASSERT_EQUAL_UINT( jobs[0].frame_size, outputs[0].size );
+	TEST_ASSERT_EQUAL_UINT( 0, outputs[1].size );
+	TEST_ASSERT_EQUAL_UINT( jobs[1].frame_size, outputs[2].size );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_parallel_encode( &pool, jobs, 0, outputs, TRANSMITTERS ) );
+	TEST_ASSERT_EQUAL_UINT( 0, outputs[0].size );
+	illuminatir_parallel_destroy( &pool );
+}
+
+
+void test_illuminatir_parallel_errors( void )
+{
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, illuminatir_parallel_init( &pool, ILLUMINATIR_PARALLEL_MAXTHREADS + 1 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_parallel_init( &pool, 2 ) );
+
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, illuminatir_cobs_parallel_encode( &pool, jobs, JOBS, outputs, TRANSMITTERS - 1 ) );
+	outputs[1].buffer_size = ILLUMINATIR_PARALLEL_BUFFER_SIZE(3);
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_BUFFER_OVERFLOW, illuminatir_cobs_parallel_encode( &pool, jobs, JOBS, outputs, TRANSMITTERS ) );
+	jobs[5].next = NULL;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NULL_POINTER, illuminatir_cobs_parallel_encode( &pool, jobs, JOBS, outputs, TRANSMITTERS ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NULL_POINTER, illuminatir_cobs_parallel_encode( &pool, NULL, JOBS, outputs, TRANSMITTERS ) );
+
+	// The pool still works afterwards.
+	jobs[5].next = next[5];
+	outputs[1].buffer_size = sizeof(buffers[1]);
+	encodeExpected( 0 );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_parallel_encode( &pool, jobs, JOBS, outputs, TRANSMITTERS ) );
+	checkOutputs();
+	illuminatir_parallel_destroy( &pool );
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_illuminatir_parallel_deterministic);
+	RUN_TEST(test_illuminatir_parallel_few_jobs);
+	RUN_TEST(test_illuminatir_parallel_errors);
+	return UNITY_END();
+}
@@ -13,6 +13,17 @@ static const uint8_t * lastConfigValues = NULL;
 static uint8_t         lastConfigValues_size = 0;
 static unsigned        setConfig_called = 0;
 
+typedef struct {
+	uint8_t  channels[256];
+	unsigned setChannels_called;
+	unsigned setChannelValuePairs_called;
+	unsigned setConfig_called;
+	uint8_t  lastFirstChannel;
+	uint8_t  lastCount;
+} handlerContext_t;
+
+static handlerContext_t handlerContext;
+
 
 void setUp(void) {
 	memset( channels, 0, sizeof(channels) );
@@ -23,6 +34,8 @@ void setUp(void) {
 	lastConfigValues      = NULL;
 	lastConfigValues_size = 0;
 	setConfig_called      = 0;
+
+	memset( &handlerContext, 0, sizeof(handlerContext) );
 }
 
 
@@ -48,6 +61,44 @@ void setConfig( const char * key, uint8_t key_len, const uint8_t * values, uint8
 }
 
 
+void handler_setChannels( void * ctx, uint8_t first_channel, const uint8_t * values, uint8_t count )
+{
+	handlerContext_t * context = ctx;
+	TEST_ASSERT_LESS_OR_EQUAL_UINT( 256, first_channel + count );
+	memcpy( context->channels + first_channel, values, count );
+	context->lastFirstChannel = first_channel;
+	context->lastCount = count;
+	context->setChannels_called++;
+}
+
+
+void handler_setChannelValuePairs( void * ctx, const uint8_t * pairs, uint8_t count )
+{
+	handlerContext_t * context = ctx;
+	for( uint8_t i = 0; i < count; i++ ) {
+		context->channels[pairs[2*i]] = pairs[2*i+1];
+	}
+	context->lastCount = count;
+	context->setChannelValuePairs_called++;
+}
+
+
+void handler_setConfig( void * ctx, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size )
+{
+	handlerContext_t * context = ctx;
+	setConfig( key, key_len, values, values_size );
+	context->setConfig_called++;
+}
+
+
+static const illuminatir_handler_t handler = {
+	.ctx                  = &handlerContext,
+	.setChannels          = handler_setChannels,
+	.setChannelValuePairs = handler_setChannelValuePairs,
+	.setConfig            = handler_setConfig,
+};
+
+
 void test_illuminatir_parse_offsetArray_crcError( void )
 {
 	uint8_t packet[] = {0x00,0x00,0,0x00};
@@ -244,6 +295,163 @@ void test_illuminatir_parse_offsetArray_offset_multiple( void )
 }
 
 
+void test_illuminatir_parse_handler_offsetArray_range( void )
+{
+	uint8_t packet[] = {0x0f,0x04,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,0x00};
+	packet[sizeof(packet)-1] = illuminatir_crc8( packet, sizeof(packet)-1, ILLUMINATIR_CRC8_INITIAL_SEED );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_parse_handler( packet, sizeof(packet), &handler ) );
+	TEST_ASSERT_EQUAL_UINT( 1, handlerContext.setChannels_called );
+	TEST_ASSERT_EQUAL_UINT8( 4, handlerContext.lastFirstChannel );
+	TEST_ASSERT_EQUAL_UINT8( 16, handlerContext.lastCount );
+	TEST_ASSERT_EQUAL_HEX8_ARRAY( packet + 2, handlerContext.channels + 4, 16 );
+}
+
+
+void test_illuminatir_parse_handler_offsetArray_wraparound( void )
+{
+	uint8_t packet[] = {0x03,0xfe,1,2,3,4,0x00};
+	packet[sizeof(packet)-1] = illuminatir_crc8( packet, sizeof(packet)-1, ILLUMINATIR_CRC8_INITIAL_SEED );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_parse_handler( packet, sizeof(packet), &handler ) );
+	TEST_ASSERT_EQUAL_UINT( 2, handlerContext.setChannels_called );
+	TEST_ASSERT_EQUAL_UINT8( 1, handlerContext.channels[0xfe] );
+	TEST_ASSERT_EQUAL_UINT8( 2, handlerContext.channels[0xff] );
+	TEST_ASSERT_EQUAL_UINT8( 3, handlerContext.channels[0x00] );
+	TEST_ASSERT_EQUAL_UINT8( 4, handlerContext.channels[0x01] );
+
+	// same for the plain functions
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_parse( packet, sizeof(packet), setChannel, setConfig ) );
+	TEST_ASSERT_EQUAL_UINT( 4, setChannel_called );
+	TEST_ASSERT_EQUAL_UINT8( 2, channels[0xff] );
+	TEST_ASSERT_EQUAL_UINT8( 3, channels[0x00] );
+}
+
+
+void test_illuminatir_parse_handler_channelValuePairs_batch( void )
+{
+	handlerContext.channels[16] = 1; // should get reset to 0
+	uint8_t packet[] = {0x1f,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,0x00};
+	packet[sizeof(packet)-1] = illuminatir_crc8( packet, sizeof(packet)-1, ILLUMINATIR_CRC8_INITIAL_SEED );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_parse_handler( packet, sizeof(packet), &handler ) );
+	TEST_ASSERT_EQUAL_UINT( 1, handlerContext.setChannelValuePairs_called );
+	TEST_ASSERT_EQUAL_UINT( 0, handlerContext.setChannels_called );
+	TEST_ASSERT_EQUAL_UINT8( 9, handlerContext.lastCount );
+	TEST_ASSERT_EQUAL_UINT8(  1, handlerContext.channels[ 0] );
+	TEST_ASSERT_EQUAL_UINT8( 15, handlerContext.channels[14] );
+	TEST_ASSERT_EQUAL_UINT8(  0, handlerContext.channels[16] );
+}
+
+
+void test_illuminatir_parse_handler_channelValuePairs_fallback( void )
+{
+	illuminatir_handler_t channelsOnly = { .ctx = &handlerContext, .setChannels = handler_setChannels };
+	uint8_t packet[] = {0x12,7,21,9,42,0x00};
+	packet[sizeof(packet)-1] = illuminatir_crc8( packet, sizeof(packet)-1, ILLUMINATIR_CRC8_INITIAL_SEED );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_parse_handler( packet, sizeof(packet), &channelsOnly ) );
+	TEST_ASSERT_EQUAL_UINT( 2, handlerContext.setChannels_called );
+	TEST_ASSERT_EQUAL_UINT8( 21, handlerContext.channels[7] );
+	TEST_ASSERT_EQUAL_UINT8( 42, handlerContext.channels[9] );
+}
+
+
+void test_illuminatir_parse_handler_config( void )
+{
+	uint8_t packet[] = {0x2f,'I','l','l','u','m','i','n','a','t','I','R',0,1,2,3,4,5,0x00};
+	packet[sizeof(packet)-1] = illuminatir_crc8( packet, sizeof(packet)-1, ILLUMINATIR_CRC8_INITIAL_SEED );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_parse_handler( packet, sizeof(packet), &handler ) );
+	TEST_ASSERT_EQUAL_UINT( 1, handlerContext.setConfig_called );
+	TEST_ASSERT_EQUAL_UINT( 11, lastConfigKey_len );
+	TEST_ASSERT_EQUAL_STRING_LEN( "IlluminatIR", lastConfigKey, lastConfigKey_len );
+	TEST_ASSERT_EQUAL_UINT( 5, lastConfigValues_size );
+}
+
+
+void test_illuminatir_parse_handler_nullPointer( void )
+{
+	uint8_t packet[] = {0x00,0x00,42,0x00};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NULL_POINTER, illuminatir_parse_handler( packet, sizeof(packet), NULL ) );
+}
+
+
+void test_illuminatir_rand_cobs_parse_handler( void )
+{
+	uint8_t cobsPacket[ILLUMINATIR_COBS_PACKET_MAXSIZE];
+	uint8_t cobsPacket_size = sizeof(cobsPacket);
+	const uint8_t values[] = {1,2,3,4,5,6,7,8};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_build_offsetArray( cobsPacket, &cobsPacket_size, 0xfc, values, sizeof(values) ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_parse_handler( cobsPacket, cobsPacket_size, &handler ) );
+	TEST_ASSERT_EQUAL_UINT( 2, handlerContext.setChannels_called );
+	TEST_ASSERT_EQUAL_UINT8( 1, handlerContext.channels[0xfc] );
+	TEST_ASSERT_EQUAL_UINT8( 8, handlerContext.channels[0x03] );
+
+	cobsPacket_size = sizeof(cobsPacket);
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_build_offsetArray( cobsPacket, &cobsPacket_size, 0x10, values, sizeof(values) ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_parse_handler( cobsPacket, cobsPacket_size, &handler ) );
+	TEST_ASSERT_EQUAL_UINT( 3, handlerContext.setChannels_called );
+	TEST_ASSERT_EQUAL_HEX8_ARRAY( values, handlerContext.channels + 0x10, sizeof(values) );
+}
+
+
+void test_illuminatir_parse_into_offsetArray_wraparound( void )
+{
+	uint8_t universe[ILLUMINATIR_CHANNELS] = {0};
+	universe[0xff] = 2; // unchanged
+	illuminatir_channelMask_t dirty;
+	illuminatir_channelMask_clear( &dirty );
+	uint8_t packet[] = {0x03,0xfe,1,2,3,4,0x00};
+	packet[sizeof(packet)-1] = illuminatir_crc8( packet, sizeof(packet)-1, ILLUMINATIR_CRC8_INITIAL_SEED );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_parse_into( packet, sizeof(packet), universe, &dirty, setConfig ) );
+	TEST_ASSERT_EQUAL_UINT8( 1, universe[0xfe] );
+	TEST_ASSERT_EQUAL_UINT8( 2, universe[0xff] );
+	TEST_ASSERT_EQUAL_UINT8( 3, universe[0x00] );
+	TEST_ASSERT_EQUAL_UINT8( 4, universe[0x01] );
+	TEST_ASSERT_EQUAL_HEX32( 0x00000003, dirty.bits[0] );
+	TEST_ASSERT_EQUAL_HEX32( 0x40000000, dirty.bits[7] );
+	for( unsigned i = 1; i < 7; i++ ) {
+		TEST_ASSERT_EQUAL_HEX32( 0, dirty.bits[i] );
+	}
+}
+
+
+void test_illuminatir_parse_into_channelValuePairs( void )
+{
+	uint8_t universe[ILLUMINATIR_CHANNELS] = {0};
+	universe[16] = 1; // should get reset to 0
+	universe[4] = 5;  // unchanged
+	illuminatir_channelMask_t dirty;
+	illuminatir_channelMask_clear( &dirty );
+	uint8_t packet[] = {0x1f,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,0x00};
+	packet[sizeof(packet)-1] = illuminatir_crc8( packet, sizeof(packet)-1, ILLUMINATIR_CRC8_INITIAL_SEED );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_parse_into( packet, sizeof(packet), universe, &dirty, NULL ) );
+	TEST_ASSERT_EQUAL_UINT8(  1, universe[ 0] );
+	TEST_ASSERT_EQUAL_UINT8( 15, universe[14] );
+	TEST_ASSERT_EQUAL_UINT8(  0, universe[16] );
+	TEST_ASSERT_EQUAL_HEX32( 0x00015545, dirty.bits[0] );
+}
+
+
+void test_illuminatir_rand_cobs_parse_into( void )
+{
+	uint8_t universe[ILLUMINATIR_CHANNELS] = {0};
+	illuminatir_channelMask_t dirty;
+	illuminatir_channelMask_clear( &dirty );
+	uint8_t cobsPacket[ILLUMINATIR_COBS_PACKET_MAXSIZE];
+	uint8_t cobsPacket_size = sizeof(cobsPacket);
+	const uint8_t values[] = {1,2,3,4,5,6,7,8};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_build_offsetArray( cobsPacket, &cobsPacket_size, 100, values, sizeof(values) ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_parse_into( cobsPacket, cobsPacket_size, universe, &dirty, NULL ) );
+	TEST_ASSERT_EQUAL_HEX8_ARRAY( values, universe + 100, sizeof(values) );
+	TEST_ASSERT_EQUAL_HEX32( 0x00000ff0, dirty.bits[3] );
+	TEST_ASSERT_TRUE( illuminatir_channelMask_isSet( &dirty, 107 ) );
+	TEST_ASSERT_FALSE( illuminatir_channelMask_isSet( &dirty, 108 ) );
+
+	cobsPacket_size = sizeof(cobsPacket);
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_build_offsetArray( cobsPacket, &cobsPacket_size, 100, values, sizeof(values) ) );
+	illuminatir_channelMask_clear( &dirty );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_parse_into( cobsPacket, cobsPacket_size, universe, &dirty, NULL ) );
+	TEST_ASSERT_EQUAL_HEX32( 0, dirty.bits[3] ); // nothing changed
+}
+
+
 int main( void )
 {
 	UNITY_BEGIN();
@@ -260,5 +468,15 @@ int main( void )
 	RUN_TEST(test_illuminatir_parse_config_maximumSize);
 	RUN_TEST(test_illuminatir_parse_config_noKeyDelimiter_maximumSize);
 	RUN_TEST(test_illuminatir_parse_offsetArray_offset_multiple);
+	RUN_TEST(test_illuminatir_parse_handler_offsetArray_range);
+	RUN_TEST(test_illuminatir_parse_handler_offsetArray_wraparound);
+	RUN_TEST(test_illuminatir_parse_handler_channelValuePairs_batch);
+	RUN_TEST(test_illuminatir_parse_handler_channelValuePairs_fallback);
+	RUN_TEST(test_illuminatir_parse_handler_config);
+	RUN_TEST(test_illuminatir_parse_handler_nullPointer);
+	RUN_TEST(test_illuminatir_rand_cobs_parse_handler);
+	RUN_TEST(test_illuminatir_parse_into_offsetArray_wraparound);
+	RUN_TEST(test_illuminatir_parse_into_channelValuePairs);
+	RUN_TEST(test_illuminatir_rand_cobs_parse_into);
 	return UNITY_END();
 }
@@ -0,0 +1,304 @@
+#include <illuminatir.h>
+#include <unity.h>
+#include <limits.h>
+#include <string.h>
+#include "common.h"
+
+
+static uint8_t previous[ILLUMINATIR_CHANNELS];
+static uint8_t next[ILLUMINATIR_CHANNELS];
+static uint8_t packets[ILLUMINATIR_PLAN_MAXSIZE];
+static size_t  packets_size;
+static unsigned packets_count;
+
+
+void setUp(void) {
+	memset( previous, 0, sizeof(previous) );
+	memset( next, 0, sizeof(next) );
+	packets_size  = sizeof(packets);
+	packets_count = 0;
+}
+
+
+void tearDown(void) {
+	// clean stuff up here
+}
+
+
+// Parses the planned packets one by one into universe.
+static void apply( uint8_t * universe )
+{
+	size_t i = 0;
+	while( i < packets_size ) {
+		uint8_t packet_size = illuminatir_header_getPacketSize( packets[i] );
+		TEST_ASSERT_LESS_OR_EQUAL_UINT( packets_size, i + packet_size );
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_parse_into( packets + i, packet_size, universe, NULL, NULL ) );
+		i += packet_size;
+		packets_count++;
+	}
+}
+
+
+static void plan_and_check( uint8_t overhead )
+{
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_plan( packets, &packets_size, previous, next, overhead ) );
+	uint8_t universe[ILLUMINATIR_CHANNELS];
+	memcpy( universe, previous, sizeof(universe) );
+	apply( universe );
+	TEST_ASSERT_EQUAL_HEX8_ARRAY( next, universe, sizeof(universe) );
+}
+
+
+void test_illuminatir_plan_noChange( void )
+{
+	plan_and_check( ILLUMINATIR_PLAN_OVERHEAD_RAW );
+	TEST_ASSERT_EQUAL_UINT( 0, packets_size );
+}
+
+
+void test_illuminatir_plan_singleChange( void )
+{
+	next[42] = 7;
+	plan_and_check( ILLUMINATIR_PLAN_OVERHEAD_RAW );
+	TEST_ASSERT_EQUAL_UINT( 4, packets_size );
+}
+
+
+void test_illuminatir_plan_run( void )
+{
+	for( unsigned i = 100; i < 116; i++ ) {
+		next[i] = i;
+	}
+	next[108] = previous[108]; // unchanged channels within a run are cheaper to resend
+	plan_and_check( ILLUMINATIR_PLAN_OVERHEAD_RAW );
+	TEST_ASSERT_EQUAL_UINT( 1 + 1 + 16 + 1, packets_size );
+	TEST_ASSERT_EQUAL_UINT( 1, packets_count );
+}
+
+
+void test_illuminatir_plan_wraparound( void )
+{
+	next[254] = 1;
+	next[255] = 2;
+	next[0]   = 3;
+	next[1]   = 4;
+	plan_and_check( ILLUMINATIR_PLAN_OVERHEAD_RAW );
+	TEST_ASSERT_EQUAL_UINT( 1 + 1 + 4 + 1, packets_size );
+	TEST_ASSERT_EQUAL_HEX8( 254, packets[1] );
+}
+
+
+void test_illuminatir_plan_sparse( void )
+{
+	for( unsigned i = 0; i < 8; i++ ) {
+		next[i * 30] = i + 1;
+	}
+	plan_and_check( ILLUMINATIR_PLAN_OVERHEAD_COBS );
+	TEST_ASSERT_EQUAL_UINT( 1 + 16 + 1, packets_size );
+	TEST_ASSERT_EQUAL_UINT( 1, packets_count );
+}
+
+
+void test_illuminatir_plan_sparse_halfPair( void )
+{
+	for( unsigned i = 0; i < 9; i++ ) {
+		previous[i * 25] = 9;
+		next[i * 25] = i;
+	}
+	plan_and_check( ILLUMINATIR_PLAN_OVERHEAD_COBS );
+	TEST_ASSERT_EQUAL_UINT( 1 + 17 + 1, packets_size );
+	TEST_ASSERT_EQUAL_UINT( 1, packets_count );
+}
+
+
+void test_illuminatir_plan_overhead( void )
+{
+	// Two runs with a gap of 4 are sent as two packets without overhead, but as one with COBS.
+	for( unsigned i = 0; i < 3; i++ ) {
+		next[10 + i] = 1;
+		next[17 + i] = 1;
+	}
+	plan_and_check( ILLUMINATIR_PLAN_OVERHEAD_RAW );
+	TEST_ASSERT_EQUAL_UINT( 2, packets_count );
+	TEST_ASSERT_EQUAL_UINT( 2 * (3 + 3), packets_size );
+
+	packets_size  = sizeof(packets);
+	packets_count = 0;
+	plan_and_check( ILLUMINATIR_PLAN_OVERHEAD_COBS );
+	TEST_ASSERT_EQUAL_UINT( 1, packets_count );
+	TEST_ASSERT_EQUAL_UINT( 3 + 10, packets_size );
+}
+
+
+void test_illuminatir_plan_allChannels( void )
+{
+	for( unsigned i = 0; i < ILLUMINATIR_CHANNELS; i++ ) {
+		next[i] = i ^ 0x5a;
+	}
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_plan( packets, &packets_size, NULL, next, ILLUMINATIR_PLAN_OVERHEAD_RAW ) );
+	TEST_ASSERT_EQUAL_UINT( ILLUMINATIR_PLAN_MAXSIZE, packets_size );
+	uint8_t universe[ILLUMINATIR_CHANNELS] = { 0 };
+	apply( universe );
+	TEST_ASSERT_EQUAL_HEX8_ARRAY( next, universe, sizeof(universe) );
+}
+
+
+void test_illuminatir_plan_random( void )
+{
+	uint32_t x = 0x9e3779b9;
+	for( unsigned round = 0; round < 200; round++ ) {
+		unsigned density = 1 + round % 16; // about one in density channels changes
+		for( unsigned i = 0; i < ILLUMINATIR_CHANNELS; i++ ) {
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+			previous[i] = next[i];
+			if( x % density == 0 ) {
+				next[i] = (x >> 8) % 3 ? (uint8_t)(x >> 16) : 0;
+			}
+		}
+		packets_size  = sizeof(packets);
+		packets_count = 0;
+		uint8_t overhead = round & 1 ? ILLUMINATIR_PLAN_OVERHEAD_COBS : ILLUMINATIR_PLAN_OVERHEAD_RAW;
+		plan_and_check( overhead );
+
+		// Never worse than OffsetArrays over every changed range, or pairs for every changed channel.
+		size_t changed = 0, runs = 0;
+		for( unsigned i = 0; i < ILLUMINATIR_CHANNELS; i++ ) {
+			if( previous[i] != next[i] ) {
+				changed++;
+				if( i == 0 || previous[i-1] == next[i-1] || (changed - 1) % ILLUMINATIR_OFFSETARRAY_MAXVALUES == 0 ) {
+					runs++;
+				}
+			}
+		}
+		TEST_ASSERT_LESS_OR_EQUAL_UINT( changed + runs * (3 + overhead), packets_size + packets_count * overhead );
+		TEST_ASSERT_LESS_OR_EQUAL_UINT( 2 * changed + (changed + 7) / 8 * (2 + overhead), packets_size + packets_count * overhead );
+	}
+}
+
+
+// Returns the least bytes of sending count channels as ChannelValuePairs, of
+// which zeros change to 0, trying every number of packets and half pairs.
+static unsigned pairsCost( unsigned count, unsigned zeros, uint8_t overhead )
+{
+	unsigned best = count ? UINT_MAX : 0;
+	for( unsigned n = 1; n <= count; n++ ) {
+		for( unsigned h = 0; h <= zeros && h <= n && h < count - n + 1; h++ ) {
+			if( count - h <= 8 * n && 2 * count - h + n * (2 + overhead) < best ) {
+				best = 2 * count - h + n * (2 + overhead);
+			}
+		}
+	}
+	return best;
+}
+
+
+#define OPTIMUM_POOL_MAX 33 // changed channels of the exhaustive search
+
+// Returns the least bytes of a change within channels 16 to 239, searching
+// every choice of OffsetArray runs with the number of remaining channels and
+// how many of those change to 0.
+static unsigned optimum( uint8_t overhead )
+{
+	static unsigned cost[ILLUMINATIR_CHANNELS + 1][OPTIMUM_POOL_MAX][OPTIMUM_POOL_MAX];
+	memset( cost, 0xff, sizeof(cost) );
+	cost[0][0][0] = 0;
+	for( unsigned j = 0; j < ILLUMINATIR_CHANNELS; j++ ) {
+		for( unsigned c = 0; c < OPTIMUM_POOL_MAX; c++ ) {
+			for( unsigned z = 0; z <= c; z++ ) {
+				unsigned v = cost[j][c][z];
+				if( v == UINT_MAX ) {
+					continue;
+				}
+				if( previous[j] == next[j] ) {
+					cost[j + 1][c][z] = v < cost[j + 1][c][z] ? v : cost[j + 1][c][z];
+					continue;
+				}
+				if( c + 1 < OPTIMUM_POOL_MAX ) {
+					unsigned * pooled = &cost[j + 1][c + 1][z + !next[j]];
+					*pooled = v < *pooled ? v : *pooled;
+				}
+				for( unsigned length = 1; length <= ILLUMINATIR_OFFSETARRAY_MAXVALUES && j + length <= ILLUMINATIR_CHANNELS; length++ ) {
+					unsigned * run = &cost[j + length][c][z];
+					*run = v + length + 3 + overhead < *run ? v + length + 3 + overhead : *run;
+				}
+			}
+		}
+	}
+	unsigned best = UINT_MAX;
+	for( unsigned c = 0; c < OPTIMUM_POOL_MAX; c++ ) {
+		for( unsigned z = 0; z <= c; z++ ) {
+			if( cost[ILLUMINATIR_CHANNELS][c][z] != UINT_MAX && cost[ILLUMINATIR_CHANNELS][c][z] + pairsCost( c, z, overhead ) < best ) {
+				best = cost[ILLUMINATIR_CHANNELS][c][z] + pairsCost( c, z, overhead );
+			}
+		}
+	}
+	return best;
+}
+
+
+void test_illuminatir_plan_nearOptimal( void )
+{
+	uint32_t x = 0x2545f491;
+	for( unsigned round = 0; round < 40; round++ ) {
+		int zeros = round & 2; // whether channels may change to 0
+		unsigned density = 2 + round % 12;
+		unsigned changed = 0;
+		for( unsigned i = 0; i < ILLUMINATIR_CHANNELS; i++ ) {
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+			previous[i] = 1 + x % 200;
+			next[i] = previous[i];
+			if( i >= 16 && i < 240 && changed < OPTIMUM_POOL_MAX - 1 && (x >> 8) % density == 0 ) {
+				next[i] = zeros && (x >> 16) % 2 ? 0 : previous[i] + 1;
+				changed++;
+			}
+		}
+		packets_size  = sizeof(packets);
+		packets_count = 0;
+		uint8_t overhead = round & 1 ? ILLUMINATIR_PLAN_OVERHEAD_COBS : ILLUMINATIR_PLAN_OVERHEAD_RAW;
+		plan_and_check( overhead );
+
+		// The search is exact with full pairs. Half pairs are only added afterwards,
+		// which may miss the least bytes by a few.
+		unsigned size = packets_size + packets_count * overhead;
+		unsigned best = optimum( overhead );
+		if( !zeros ) {
+			TEST_ASSERT_EQUAL_UINT( best, size );
+		} else {
+			TEST_ASSERT_LESS_OR_EQUAL_UINT( size, best );
+			TEST_ASSERT_LESS_OR_EQUAL_UINT( best + 3, size );
+		}
+	}
+}
+
+
+void test_illuminatir_plan_errors( void )
+{
+	next[0] = 1;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NULL_POINTER, illuminatir_plan( NULL, &packets_size, previous, next, 0 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NULL_POINTER, illuminatir_plan( packets, NULL, previous, next, 0 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NULL_POINTER, illuminatir_plan( packets, &packets_size, previous, NULL, 0 ) );
+	packets_size = 3;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_BUFFER_OVERFLOW, illuminatir_plan( packets, &packets_size, previous, next, 0 ) );
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_illuminatir_plan_noChange);
+	RUN_TEST(test_illuminatir_plan_singleChange);
+	RUN_TEST(test_illuminatir_plan_run);
+	RUN_TEST(test_illuminatir_plan_wraparound);
+	RUN_TEST(test_illuminatir_plan_sparse);
+	RUN_TEST(test_illuminatir_plan_sparse_halfPair);
+	RUN_TEST(test_illuminatir_plan_overhead);
+	RUN_TEST(test_illuminatir_plan_allChannels);
+	RUN_TEST(test_illuminatir_plan_random);
+	RUN_TEST(test_illuminatir_plan_nearOptimal);
+	RUN_TEST(test_illuminatir_plan_errors);
+	return UNITY_END();
+}
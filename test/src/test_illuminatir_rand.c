@@ -69,6 +69,24 @@ void test_illuminatir_rand_cobs_build_parse_offsetValues( void )
 }
 
 
+void test_illuminatir_rand_cobs_build_parse_channelValuePairs( void )
+{
+	uint8_t cobsPacket[ILLUMINATIR_COBS_PACKET_MAXSIZE];
+	uint8_t cobsPacket_size = sizeof(cobsPacket);
+	const uint8_t pairs[] = {4,1,0,2,255,3,9};
+	channels[9] = 0x55;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_build_channelValuePairs( cobsPacket, &cobsPacket_size, pairs, sizeof(pairs) ) );
+	TEST_ASSERT_LESS_OR_EQUAL_UINT( sizeof(cobsPacket), cobsPacket_size );
+
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_parse( cobsPacket, cobsPacket_size, setChannel, setConfig ) );
+	TEST_ASSERT_EQUAL_UINT( 4, setChannel_called );
+	TEST_ASSERT_EQUAL_UINT8( 1, channels[  4] );
+	TEST_ASSERT_EQUAL_UINT8( 2, channels[  0] );
+	TEST_ASSERT_EQUAL_UINT8( 3, channels[255] );
+	TEST_ASSERT_EQUAL_UINT8( 0, channels[  9] );
+}
+
+
 void test_illuminatir_rand_cobs_build_parse_config( void )
 {
 	uint8_t cobsPacket[ILLUMINATIR_COBS_PACKET_MAXSIZE];
@@ -89,6 +107,23 @@ void test_illuminatir_rand_cobs_build_parse_config( void )
 }
 
 
+void test_illuminatir_rand_cobs_build_parse_config_noValues( void )
+{
+	uint8_t cobsPacket[ILLUMINATIR_COBS_PACKET_MAXSIZE];
+	uint8_t cobsPacket_size = sizeof(cobsPacket);
+	const char key[] = "Base";
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_build_config( cobsPacket, &cobsPacket_size, key, sizeof(key)-1, NULL, 0 ) );
+	TEST_ASSERT_LESS_OR_EQUAL_UINT( sizeof(cobsPacket), cobsPacket_size );
+
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_parse( cobsPacket, cobsPacket_size, setChannel, setConfig ) );
+	TEST_ASSERT_EQUAL_UINT( 1, setConfig_called );
+	TEST_ASSERT_NOT_NULL( lastConfigKey );
+	TEST_ASSERT_EQUAL_UINT( sizeof(key)-1, lastConfigKey_size );
+	TEST_ASSERT_EQUAL_STRING( key, lastConfigKey );
+	TEST_ASSERT_EQUAL_UINT( 0, lastConfigValues_size );
+}
+
+
 void test_illuminatir_rand_cobs_build_parse_offsetValues_maximumSize( void )
 {
 	uint8_t cobsPacket[ILLUMINATIR_COBS_PACKET_MAXSIZE];
@@ -182,13 +217,98 @@ void test_illuminatir_rand_cobs_build_parse_offsetValues_multiple( void )
 }
 
 
+void test_illuminatir_rand_matchesLfsr( void )
+{
+	uint8_t packets[ILLUMINATIR_PACKET_MAXSIZE*4];
+	uint8_t expected[sizeof(packets)];
+	for( unsigned seed = 0; seed < 256; seed++ ) {
+		for( size_t size = 3; size <= sizeof(packets); size++ ) {
+			for( size_t i = 0; i < size; i++ ) {
+				packets[i] = expected[i] = i * 7;
+			}
+			packets[size-1] = expected[size-1] = seed;
+			illuminatir_lfsr127_t lfsr;
+			illuminatir_lfsr127_init_r( &lfsr, seed );
+			for( size_t i = 1; i < size-1; i++ ) {
+				expected[i] ^= illuminatir_lfsr127_uint8_r( &lfsr );
+			}
+			illuminatir_rand( packets, size );
+			TEST_ASSERT_EQUAL_HEX8_ARRAY( expected, packets, size );
+		}
+	}
+}
+
+
+// Builds the reference wire bytes the way the fused encoder must match: build, randomize, COBS encode.
+static uint8_t reference_encode( uint8_t * randCobsPacket, uint8_t * packet, uint8_t packet_size )
+{
+	illuminatir_rand( packet, packet_size );
+	return (uint8_t)illuminatir_cobs_encode( randCobsPacket, ILLUMINATIR_COBS_PACKET_MAXSIZE, packet, packet_size );
+}
+
+
+void test_illuminatir_rand_cobs_build_matchesReference( void )
+{
+	uint8_t packet[ILLUMINATIR_PACKET_MAXSIZE];
+	uint8_t packet_size;
+	uint8_t expected[ILLUMINATIR_COBS_PACKET_MAXSIZE];
+	uint8_t actual[ILLUMINATIR_COBS_PACKET_MAXSIZE];
+	uint8_t actual_size;
+	uint8_t values[ILLUMINATIR_PACKET_MAXSIZE];
+	char    key[ILLUMINATIR_CONFIG_KEY_MAXLEN];
+	for( unsigned round = 0; round < 2048; round++ ) {
+		for( uint8_t i = 0; i < sizeof(values); i++ ) {
+			values[i] = (uint8_t)(round * 31 + i * i * 13); // includes zeros
+			key[i % sizeof(key)] = (char)('A' + (round + i) % 26);
+		}
+		uint8_t size = (uint8_t)(round % ILLUMINATIR_OFFSETARRAY_MAXVALUES + 1);
+
+		packet_size = sizeof(packet);
+		actual_size = sizeof(actual);
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_build_offsetArray( packet, &packet_size, (uint8_t)round, values, size ) );
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_build_offsetArray( actual, &actual_size, (uint8_t)round, values, size ) );
+		TEST_ASSERT_EQUAL_UINT8( reference_encode( expected, packet, packet_size ), actual_size );
+		TEST_ASSERT_EQUAL_HEX8_ARRAY( expected, actual, actual_size );
+
+		size = (uint8_t)(round % (ILLUMINATIR_CHANNELVALUEPAIRS_MAXSIZE - 1) + 2);
+		packet_size = sizeof(packet);
+		actual_size = sizeof(actual);
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_build_channelValuePairs( packet, &packet_size, values, size ) );
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_build_channelValuePairs( actual, &actual_size, values, size ) );
+		TEST_ASSERT_EQUAL_UINT8( reference_encode( expected, packet, packet_size ), actual_size );
+		TEST_ASSERT_EQUAL_HEX8_ARRAY( expected, actual, actual_size );
+
+		uint8_t key_len = (uint8_t)(round % ILLUMINATIR_CONFIG_KEY_MAXLEN); // plus delimiter
+		uint8_t values_size = (uint8_t)((round / 32) % (ILLUMINATIR_CONFIG_KEY_MAXLEN - key_len));
+		if( key_len + values_size == 0 ) {
+			continue;
+		}
+		packet_size = sizeof(packet);
+		actual_size = sizeof(actual);
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_build_config( packet, &packet_size, key, key_len, values, values_size ) );
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_build_config( actual, &actual_size, key, key_len, values, values_size ) );
+		TEST_ASSERT_EQUAL_UINT8( reference_encode( expected, packet, packet_size ), actual_size );
+		TEST_ASSERT_EQUAL_HEX8_ARRAY( expected, actual, actual_size );
+	}
+
+	// Too small buffers fail as before.
+	actual_size = ILLUMINATIR_COBS_PACKET_MINSIZE - 1;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_UNKNOWN, illuminatir_rand_cobs_build_offsetArray( actual, &actual_size, 0, values, 1 ) );
+	TEST_ASSERT_EQUAL_UINT8( 0, actual_size );
+}
+
+
 int main( void )
 {
 	UNITY_BEGIN();
 	RUN_TEST(test_illuminatir_rand_cobs_build_parse_offsetValues);
+	RUN_TEST(test_illuminatir_rand_cobs_build_parse_channelValuePairs);
 	RUN_TEST(test_illuminatir_rand_cobs_build_parse_config);
+	RUN_TEST(test_illuminatir_rand_cobs_build_parse_config_noValues);
 	RUN_TEST(test_illuminatir_rand_cobs_build_parse_offsetValues_maximumSize);
 	RUN_TEST(test_illuminatir_rand_cobs_build_parse_config_maximumSize);
 	RUN_TEST(test_illuminatir_rand_cobs_build_parse_offsetValues_multiple);
+	RUN_TEST(test_illuminatir_rand_matchesLfsr);
+	RUN_TEST(test_illuminatir_rand_cobs_build_matchesReference);
 	return UNITY_END();
 }
@@ -0,0 +1,243 @@
+#define _GNU_SOURCE
+
+#include <illuminatir.h>
+#include <illuminatir_capture.h>
+#include <replay.h>
+#include <unity.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "common.h"
+
+
+#define CAPTURE       "test_illuminatir_replay.cap"
+#define CAPTURE_INDEX CAPTURE ILLUMINATIR_CAPTURE_INDEX_SUFFIX
+#define OUTPUTS       2
+#define BAUD          1000000u
+#define BYTE_NS       (10u * 1000000000u / BAUD) // 8N1
+
+static const char * const outputs[OUTPUTS] = { "test_illuminatir_replay.0", "test_illuminatir_replay.1" };
+
+static replay_t * replay;
+static uint8_t    file[OUTPUTS][65536];
+static size_t     file_size[OUTPUTS];
+static uint8_t    universe[ILLUMINATIR_CHANNELS];
+
+
+void setUp(void) {
+	replay = NULL;
+}
+
+
+void tearDown(void) {
+	replay_destroy( replay );
+	unlink( CAPTURE );
+	unlink( CAPTURE_INDEX );
+	for( unsigned i = 0; i < OUTPUTS; i++ ) {
+		unlink( outputs[i] );
+	}
+}
+
+
+static void openOutputs( unsigned count )
+{
+	for( unsigned i = 0; i < count; i++ ) {
+		TEST_ASSERT_EQUAL_INT( (int)i, replay_openOutput( replay, outputs[i], 0 ) );
+	}
+}
+
+
+static void setChannel( uint8_t channel, uint8_t value )
+{
+	universe[channel] = value;
+}
+
+
+static void readOutputs( unsigned count )
+{
+	for( unsigned i = 0; i < count; i++ ) {
+		int fd = open( outputs[i], O_RDONLY );
+		TEST_ASSERT_TRUE( fd >= 0 );
+		ssize_t size = read( fd, file[i], sizeof(file[i]) );
+		close( fd );
+		TEST_ASSERT_TRUE( size >= 0 );
+		file_size[i] = (size_t)size;
+	}
+}
+
+
+// Writes records of 1 to 3 bytes on ports 0 to 2, 10 ms apart.
+static void writeCapture( unsigned records )
+{
+	illuminatir_capture_writer_t writer;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_writer_open( &writer, CAPTURE ) );
+	for( unsigned i = 0; i < records; i++ ) {
+		uint8_t data[3] = { (uint8_t)i, (uint8_t)(i + 1), (uint8_t)(i + 2) };
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_write( &writer, 5000000000u + i * 10000000ull, (uint16_t)(i % 3), data, 1 + i % 3 ) );
+	}
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_writer_close( &writer ) );
+}
+
+
+void test_illuminatir_replay_parseFormat(void)
+{
+	TEST_ASSERT_EQUAL_INT( 10, replay_parseFormat( "8N1" ) );
+	TEST_ASSERT_EQUAL_INT( 11, replay_parseFormat( "8E1" ) );
+	TEST_ASSERT_EQUAL_INT( 12, replay_parseFormat( "8O2" ) );
+	TEST_ASSERT_EQUAL_INT( 7, replay_parseFormat( "5N1" ) );
+	TEST_ASSERT_EQUAL_INT( -1, replay_parseFormat( "9N1" ) );
+	TEST_ASSERT_EQUAL_INT( -1, replay_parseFormat( "8X1" ) );
+	TEST_ASSERT_EQUAL_INT( -1, replay_parseFormat( "8N3" ) );
+	TEST_ASSERT_EQUAL_INT( -1, replay_parseFormat( "8N1x" ) );
+	TEST_ASSERT_EQUAL_INT( -1, replay_parseFormat( NULL ) );
+}
+
+
+void test_illuminatir_replay_capture(void)
+{
+	writeCapture( 30 );
+	replay = replay_create( 0, 10 );
+	TEST_ASSERT_NOT_NULL( replay );
+	openOutputs( OUTPUTS );
+
+	illuminatir_capture_reader_t reader;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_reader_open( &reader, CAPTURE ) );
+	TEST_ASSERT_EQUAL_INT( 0, replay_capture( replay, &reader, 1, NULL ) );
+	illuminatir_capture_reader_close( &reader );
+
+	// As fast as possible ignores the 290 ms of timestamps.
+	replay_stats_t stats;
+	replay_getStats( replay, &stats );
+	TEST_ASSERT_EQUAL_UINT64( 30, stats.frames );
+	TEST_ASSERT_EQUAL_UINT64( 60, stats.bytes );
+	TEST_ASSERT_TRUE( stats.elapsed_ns < 100000000u );
+
+	readOutputs( OUTPUTS );
+	uint8_t expected[OUTPUTS][60];
+	size_t expected_size[OUTPUTS] = { 0, 0 };
+	for( unsigned i = 0; i < 30; i++ ) {
+		unsigned output = (i % 3) % OUTPUTS;
+		for( unsigned j = 0; j < 1 + i % 3; j++ ) {
+			expected[output][expected_size[output]++] = (uint8_t)(i + j);
+		}
+	}
+	for( unsigned i = 0; i < OUTPUTS; i++ ) {
+		TEST_ASSERT_EQUAL_size_t( expected_size[i], file_size[i] );
+		TEST_ASSERT_EQUAL_UINT8_ARRAY( expected[i], file[i], expected_size[i] );
+	}
+}
+
+
+void test_illuminatir_replay_timed(void)
+{
+	writeCapture( 5 );
+	illuminatir_capture_reader_t reader;
+
+	// Records are written at their timestamps.
+	replay = replay_create( BAUD, 10 );
+	TEST_ASSERT_NOT_NULL( replay );
+	openOutputs( 1 );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_capture_reader_open( &reader, CAPTURE ) );
+	TEST_ASSERT_EQUAL_INT( 0, replay_capture( replay, &reader, 1, NULL ) );
+	replay_stats_t stats;
+	replay_getStats( replay, &stats );
+	TEST_ASSERT_EQUAL_UINT64( 5, stats.frames );
+	TEST_ASSERT_TRUE( stats.elapsed_ns >= 40000000u );
+	replay_destroy( replay );
+
+	// Back to back only waits for the line.
+	replay = replay_create( BAUD, 10 );
+	TEST_ASSERT_NOT_NULL( replay );
+	openOutputs( 1 );
+	illuminatir_capture_seek( &reader, 0 );
+	TEST_ASSERT_EQUAL_INT( 0, replay_capture( replay, &reader, 0, NULL ) );
+	illuminatir_capture_reader_close( &reader );
+	replay_getStats( replay, &stats );
+	TEST_ASSERT_EQUAL_UINT64( 5, stats.frames );
+	TEST_ASSERT_TRUE( stats.elapsed_ns < 40000000u );
+}
+
+
+void test_illuminatir_replay_generate(void)
+{
+	replay = replay_create( BAUD, 10 );
+	TEST_ASSERT_NOT_NULL( replay );
+	openOutputs( OUTPUTS );
+	TEST_ASSERT_EQUAL_INT( 0, replay_generate( replay, 40, 2, NULL ) );
+
+	// Every frame but the last on each line waited for the previous one to leave.
+	replay_stats_t stats;
+	replay_getStats( replay, &stats );
+	TEST_ASSERT_EQUAL_UINT64( 40, stats.frames );
+	size_t frame_maxsize = ILLUMINATIR_FRAME_BUFFER_SIZE(2 * ILLUMINATIR_PACKET_MAXSIZE);
+	TEST_ASSERT_TRUE( stats.elapsed_ns >= (stats.bytes / OUTPUTS - frame_maxsize) * BYTE_NS );
+	TEST_ASSERT_TRUE( stats.late_ns_max >= (uint64_t)stats.late_ns_mean );
+
+	// The outputs took turns, and their frames decode to consecutive blocks of the generator's values.
+	readOutputs( OUTPUTS );
+	TEST_ASSERT_EQUAL_UINT64( stats.bytes, file_size[0] + file_size[1] );
+	illuminatir_lfsr127_t lfsr;
+	illuminatir_lfsr127_init_r( &lfsr, 1 );
+	uint8_t expected[ILLUMINATIR_CHANNELS];
+	size_t offset[OUTPUTS] = { 0, 0 };
+	for( unsigned n = 0; n < 40; n++ ) {
+		unsigned output = n % OUTPUTS;
+		memset( universe, 0, sizeof(universe) );
+		memset( expected, 0, sizeof(expected) );
+		for( unsigned p = 0; p < 2; p++ ) {
+			unsigned block = (n * 2 + p) % (ILLUMINATIR_CHANNELS / ILLUMINATIR_OFFSETARRAY_MAXVALUES);
+			for( unsigned i = 0; i < ILLUMINATIR_OFFSETARRAY_MAXVALUES; i++ ) {
+				expected[block * ILLUMINATIR_OFFSETARRAY_MAXVALUES + i] = illuminatir_lfsr127_uint8_r( &lfsr );
+			}
+		}
+		const uint8_t * frame = file[output] + offset[output];
+		const uint8_t * end = memchr( frame, 0, file_size[output] - offset[output] );
+		TEST_ASSERT_NOT_NULL( end );
+		uint8_t buffer[256];
+		illuminatir_stream_t stream;
+		illuminatir_rand_stream_init( &stream, buffer, sizeof(buffer), setChannel, NULL );
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_stream_feed( &stream, frame, (size_t)(end - frame) + 1 ) );
+		TEST_ASSERT_EQUAL_UINT8_ARRAY( expected, universe, ILLUMINATIR_CHANNELS );
+		offset[output] += (size_t)(end - frame) + 1;
+	}
+	TEST_ASSERT_EQUAL_size_t( file_size[0], offset[0] );
+	TEST_ASSERT_EQUAL_size_t( file_size[1], offset[1] );
+}
+
+
+void test_illuminatir_replay_errors(void)
+{
+	TEST_ASSERT_NULL( replay_create( BAUD, 0 ) );
+	replay = replay_create( BAUD, 10 );
+	TEST_ASSERT_NOT_NULL( replay );
+	uint8_t data[1] = { 0 };
+	TEST_ASSERT_EQUAL_INT( -1, replay_send( replay, 0, data, 1, 0 ) );
+	TEST_ASSERT_EQUAL_INT( EINVAL, errno );
+	TEST_ASSERT_EQUAL_INT( -1, replay_generate( replay, 1, 1, NULL ) );
+	openOutputs( 1 );
+	TEST_ASSERT_EQUAL_INT( -1, replay_generate( replay, 1, 0, NULL ) );
+	TEST_ASSERT_EQUAL_INT( -1, replay_generate( replay, 1, REPLAY_FRAME_PACKETS_MAX + 1, NULL ) );
+	TEST_ASSERT_EQUAL_INT( -1, replay_send( replay, 0, data, 0, 0 ) );
+	TEST_ASSERT_EQUAL_INT( -1, replay_openOutput( replay, "/nonexistent/output", 0 ) );
+	TEST_ASSERT_EQUAL_INT( ENOENT, errno );
+
+	// Nothing was written.
+	replay_stats_t stats;
+	replay_getStats( replay, &stats );
+	TEST_ASSERT_EQUAL_UINT64( 0, stats.frames );
+	TEST_ASSERT_EQUAL_UINT64( 0, stats.elapsed_ns );
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_illuminatir_replay_parseFormat);
+	RUN_TEST(test_illuminatir_replay_capture);
+	RUN_TEST(test_illuminatir_replay_timed);
+	RUN_TEST(test_illuminatir_replay_generate);
+	RUN_TEST(test_illuminatir_replay_errors);
+	return UNITY_END();
+}
@@ -0,0 +1,210 @@
+#define _GNU_SOURCE
+
+#include <illuminatir.h>
+#include <illuminatir_universe.h>
+#include <rxd.h>
+#include <unity.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "common.h"
+
+
+#define PORTS 6
+
+
+static int masters[PORTS];
+static rxd_t * rxd;
+
+static _Atomic unsigned setConfig_called;
+static _Atomic unsigned hangups;
+
+
+void setUp(void) {
+	for( unsigned i = 0; i < PORTS; i++ ) {
+		masters[i] = -1;
+	}
+	rxd = NULL;
+	atomic_store( &setConfig_called, 0 );
+	atomic_store( &hangups, 0 );
+}
+
+
+void tearDown(void) {
+	rxd_destroy( rxd );
+	for( unsigned i = 0; i < PORTS; i++ ) {
+		if( masters[i] >= 0 ) {
+			close( masters[i] );
+		}
+	}
+}
+
+
+static void onConfig( void * ctx, unsigned port, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size )
+{
+	(void)ctx;
+	(void)values;
+	if( port == 1 && key_len == 4 && !memcmp( key, "mode", 4 ) && values_size == 1 ) {
+		atomic_fetch_add( &setConfig_called, 1 );
+	}
+}
+
+
+static void onError( void * ctx, unsigned port, illuminatir_error_t err )
+{
+	(void)ctx;
+	(void)port;
+	if( err == ILLUMINATIR_ERROR_NONE ) {
+		atomic_fetch_add( &hangups, 1 );
+	}
+}
+
+
+// Opens a pseudo terminal and adds its slave side as a port.
+static int openPty( int * master )
+{
+	*master = posix_openpt( O_RDWR | O_NOCTTY );
+	TEST_ASSERT_TRUE( *master >= 0 );
+	TEST_ASSERT_EQUAL_INT( 0, grantpt( *master ) );
+	TEST_ASSERT_EQUAL_INT( 0, unlockpt( *master ) );
+	return rxd_openPort( rxd, ptsname( *master ), 115200 );
+}
+
+
+static void sendFrame( int master, const uint8_t * values, uint8_t offset )
+{
+	uint8_t buffer[ILLUMINATIR_FRAME_BUFFER_SIZE(64)];
+	illuminatir_frame_t frame;
+	size_t frame_size;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_init( &frame, buffer, sizeof(buffer) ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_frame_add_offsetArray( &frame, offset, values, ILLUMINATIR_OFFSETARRAY_MAXVALUES ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_frame_finalize( &frame, &frame_size ) );
+	TEST_ASSERT_EQUAL_INT( (int)frame_size, (int)write( master, buffer, frame_size ) );
+}
+
+
+// Polls cond for up to two seconds.
+#define WAIT_FOR(cond) do { \
+	for( unsigned wait = 0; wait < 2000 && !(cond); wait++ ) { \
+		nanosleep( &(struct timespec){ 0, 1000000 }, NULL ); \
+	} \
+} while(0)
+
+
+void test_illuminatir_rxd_ports(void)
+{
+	rxd_config_t config = { .workers = 2, .pin = 1, .randomized = 1, .setConfig = onConfig, .error = onError };
+	rxd = rxd_create( &config );
+	TEST_ASSERT_NOT_NULL( rxd );
+	for( unsigned i = 0; i < PORTS; i++ ) {
+		TEST_ASSERT_EQUAL_INT( (int)i, openPty( &masters[i] ) );
+	}
+	TEST_ASSERT_EQUAL_INT( 0, rxd_start( rxd ) );
+
+	uint8_t values[ILLUMINATIR_OFFSETARRAY_MAXVALUES];
+	for( unsigned i = 0; i < PORTS; i++ ) {
+		memset( values, (int)(i + 1), sizeof(values) );
+		sendFrame( masters[i], values, (uint8_t)(i * 16) );
+	}
+	for( unsigned i = 0; i < PORTS; i++ ) {
+		const illuminatir_universe_t * universe = rxd_getUniverse( rxd, i );
+		WAIT_FOR( illuminatir_universe_getGeneration( universe ) > 0 );
+		uint8_t channels[ILLUMINATIR_CHANNELS];
+		TEST_ASSERT_EQUAL_UINT32( 1, illuminatir_universe_read( universe, channels ) );
+		TEST_ASSERT_EQUAL_UINT8( i + 1, channels[i * 16] );
+		TEST_ASSERT_EQUAL_UINT8( i + 1, channels[i * 16 + 15] );
+		TEST_ASSERT_EQUAL_UINT8( 0, channels[(i * 16 + 16) & 0xff] );
+	}
+
+	// A Config packet split over two writes.
+	uint8_t packet[ILLUMINATIR_COBS_PACKET_MAXSIZE + 1];
+	uint8_t packet_size = ILLUMINATIR_COBS_PACKET_MAXSIZE;
+	const uint8_t mode = 3;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_build_config( packet, &packet_size, "mode", 4, &mode, 1 ) );
+	packet[packet_size++] = 0;
+	TEST_ASSERT_EQUAL_INT( 3, (int)write( masters[1], packet, 3 ) );
+	nanosleep( &(struct timespec){ 0, 5000000 }, NULL );
+	TEST_ASSERT_EQUAL_INT( packet_size - 3, (int)write( masters[1], packet + 3, packet_size - 3 ) );
+	WAIT_FOR( atomic_load( &setConfig_called ) > 0 );
+	TEST_ASSERT_EQUAL_UINT( 1, atomic_load( &setConfig_called ) );
+
+	// Garbage is counted and the port recovers at the next delimiter.
+	const uint8_t garbage[] = {0x05,0x11,0x22,0x33,0x44,0x00};
+	TEST_ASSERT_EQUAL_INT( sizeof(garbage), (int)write( masters[2], garbage, sizeof(garbage) ) );
+	memset( values, 0x77, sizeof(values) );
+	sendFrame( masters[2], values, 0 );
+	WAIT_FOR( illuminatir_universe_getChannel( rxd_getUniverse( rxd, 2 ), 0 ) == 0x77 );
+	rxd_stats_t stats;
+	rxd_getStats( rxd, 2, &stats );
+	TEST_ASSERT_EQUAL_UINT( 1, (unsigned)stats.errors );
+	TEST_ASSERT_EQUAL_UINT( 2, (unsigned)stats.payloads );
+	TEST_ASSERT_TRUE( stats.open );
+
+	// Closing the master side hangs up the port.
+	close( masters[3] );
+	masters[3] = -1;
+	WAIT_FOR( atomic_load( &hangups ) > 0 );
+	rxd_getStats( rxd, 3, &stats );
+	TEST_ASSERT_FALSE( stats.open );
+	rxd_getStats( rxd, 4, &stats );
+	TEST_ASSERT_TRUE( stats.open );
+}
+
+
+void test_illuminatir_rxd_errors(void)
+{
+	rxd_config_t config = { .workers = 0 };
+	TEST_ASSERT_NULL( rxd_create( &config ) );
+	config.workers = 1;
+	rxd = rxd_create( &config );
+	TEST_ASSERT_NOT_NULL( rxd );
+	TEST_ASSERT_EQUAL_INT( -1, rxd_openPort( rxd, "/nonexistent/tty", 0 ) );
+	TEST_ASSERT_EQUAL_INT( -1, rxd_openPort( rxd, "/dev/null", 12345 ) ); // unsupported baud rate
+	TEST_ASSERT_EQUAL_INT( 0, rxd_start( rxd ) );
+	TEST_ASSERT_EQUAL_INT( -1, rxd_openPort( rxd, "/dev/null", 0 ) ); // already started
+	TEST_ASSERT_EQUAL_UINT( 0, rxd_getPorts( rxd ) );
+	TEST_ASSERT_NULL( rxd_getUniverse( rxd, 0 ) );
+}
+
+
+void test_illuminatir_rxd_restart(void)
+{
+	rxd_config_t config = { .workers = 1, .randomized = 1 };
+	rxd = rxd_create( &config );
+	TEST_ASSERT_NOT_NULL( rxd );
+	TEST_ASSERT_EQUAL_INT( 0, openPty( &masters[0] ) );
+	TEST_ASSERT_EQUAL_INT( 0, rxd_start( rxd ) );
+	uint8_t values[ILLUMINATIR_OFFSETARRAY_MAXVALUES];
+	memset( values, 0x11, sizeof(values) );
+	sendFrame( masters[0], values, 0 );
+	WAIT_FOR( illuminatir_universe_getChannel( rxd_getUniverse( rxd, 0 ), 0 ) == 0x11 );
+	TEST_ASSERT_EQUAL_HEX8( 0x11, illuminatir_universe_getChannel( rxd_getUniverse( rxd, 0 ), 0 ) );
+	rxd_stop( rxd );
+
+	// Ports can be added while stopped, and the workers run again after another start.
+	TEST_ASSERT_EQUAL_INT( 1, openPty( &masters[1] ) );
+	TEST_ASSERT_EQUAL_INT( 0, rxd_start( rxd ) );
+	TEST_ASSERT_EQUAL_INT( -1, rxd_start( rxd ) );
+	memset( values, 0x22, sizeof(values) );
+	sendFrame( masters[0], values, 0 );
+	sendFrame( masters[1], values, 0 );
+	WAIT_FOR( illuminatir_universe_getChannel( rxd_getUniverse( rxd, 0 ), 0 ) == 0x22 );
+	TEST_ASSERT_EQUAL_HEX8( 0x22, illuminatir_universe_getChannel( rxd_getUniverse( rxd, 0 ), 0 ) );
+	WAIT_FOR( illuminatir_universe_getChannel( rxd_getUniverse( rxd, 1 ), 0 ) == 0x22 );
+	TEST_ASSERT_EQUAL_HEX8( 0x22, illuminatir_universe_getChannel( rxd_getUniverse( rxd, 1 ), 0 ) );
+	rxd_stop( rxd );
+	rxd_stop( rxd );
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_illuminatir_rxd_ports);
+	RUN_TEST(test_illuminatir_rxd_errors);
+	RUN_TEST(test_illuminatir_rxd_restart);
+	return UNITY_END();
+}
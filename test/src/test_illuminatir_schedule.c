@@ -0,0 +1,176 @@
+#include <illuminatir.h>
+#include <unity.h>
+#include <string.h>
+#include "common.h"
+
+
+#define BITRATE 9600
+#define PACKET_BITS ((ILLUMINATIR_PACKET_MAXSIZE + ILLUMINATIR_PLAN_OVERHEAD_COBS) * 10)
+
+static uint8_t universe[ILLUMINATIR_CHANNELS];
+static illuminatir_schedule_t sched;
+static uint8_t packet[ILLUMINATIR_PACKET_MAXSIZE];
+static uint8_t packet_size;
+
+
+void setUp(void) {
+	memset( universe, 0, sizeof(universe) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_schedule_init( &sched, universe, BITRATE, 1000 ) );
+}
+
+
+void tearDown(void) {
+	// clean stuff up here
+}
+
+
+static void next( uint32_t now_us )
+{
+	packet_size = sizeof(packet);
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_schedule_next( &sched, now_us, packet, &packet_size ) );
+	if( packet_size ) {
+		TEST_ASSERT_EQUAL_HEX8( packet[packet_size-1], illuminatir_crc8( packet, packet_size-1, ILLUMINATIR_CRC8_INITIAL_SEED ) );
+	}
+}
+
+
+// Returns the time the next packet is sent, stepping in milliseconds.
+static uint32_t next_sent( uint32_t now_us )
+{
+	for( ;; now_us += 1000 ) {
+		next( now_us );
+		if( packet_size ) {
+			return now_us;
+		}
+	}
+}
+
+
+void test_illuminatir_schedule_initialRound( void )
+{
+	uint32_t now_us = 1000;
+	for( unsigned block = 0; block < ILLUMINATIR_SCHEDULE_BLOCKS; block++ ) {
+		now_us = next_sent( now_us );
+		TEST_ASSERT_EQUAL_UINT( 19, packet_size );
+		TEST_ASSERT_EQUAL_HEX8( 0x0f, packet[0] );
+		TEST_ASSERT_EQUAL_UINT8( block * 16, packet[1] );
+	}
+	// paced to the bit rate, after the first packet from the initial burst
+	TEST_ASSERT_GREATER_OR_EQUAL_UINT32( 1000 + 15 * (PACKET_BITS * 1000000ULL / BITRATE), now_us );
+	TEST_ASSERT_LESS_OR_EQUAL_UINT32( 1000 + 15 * (PACKET_BITS * 1000000ULL / BITRATE + 1000), now_us );
+}
+
+
+void test_illuminatir_schedule_changeBeforeRefresh( void )
+{
+	uint32_t now_us = 1000;
+	for( unsigned block = 0; block < ILLUMINATIR_SCHEDULE_BLOCKS; block++ ) {
+		now_us = next_sent( now_us );
+	}
+	// idle link refreshes round-robin
+	now_us = next_sent( now_us );
+	TEST_ASSERT_EQUAL_UINT8( 0, packet[1] );
+	universe[200] = 42;
+	now_us = next_sent( now_us );
+	TEST_ASSERT_EQUAL_UINT8( 192, packet[1] );
+	TEST_ASSERT_EQUAL_UINT8( 42, packet[2 + 8] );
+	now_us = next_sent( now_us );
+	TEST_ASSERT_EQUAL_UINT8( 16, packet[1] );
+}
+
+
+void test_illuminatir_schedule_config( void )
+{
+	const uint8_t values[] = {1,2,3};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_schedule_config( &sched, "W", 1, values, sizeof(values), 3, 100000, 1000 ) );
+	unsigned configs = 0, blocks = 0;
+	uint32_t last_us = 0;
+	for( uint32_t now_us = 1000; now_us < 2000000; now_us += 1000 ) {
+		next( now_us );
+		if( !packet_size ) {
+			continue;
+		}
+		if( ((packet[0] >> 4) & 0b11) == 0b10 ) {
+			TEST_ASSERT_EQUAL_UINT8( 'W', packet[1] );
+			if( configs ) {
+				TEST_ASSERT_GREATER_OR_EQUAL_UINT32( last_us + 100000, now_us );
+			}
+			last_us = now_us;
+			configs++;
+		} else {
+			blocks++;
+		}
+	}
+	TEST_ASSERT_EQUAL_UINT( 3, configs );
+	TEST_ASSERT_GREATER_THAN_UINT( 16, blocks );
+}
+
+
+void test_illuminatir_schedule_staleness( void )
+{
+	const uint8_t values[] = {9};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_schedule_config( &sched, "B", 1, values, sizeof(values), 0, 200000, 1000 ) );
+	uint32_t bound = illuminatir_schedule_getStaleness( &sched );
+	TEST_ASSERT_LESS_THAN_UINT32( UINT32_MAX, bound );
+	TEST_ASSERT_GREATER_OR_EQUAL_UINT32( 17 * (PACKET_BITS * 1000000ULL / BITRATE), bound );
+
+	// Every block changes all the time.
+	uint32_t changed_us[ILLUMINATIR_SCHEDULE_BLOCKS] = {0};
+	uint8_t  pending[ILLUMINATIR_SCHEDULE_BLOCKS] = {0};
+	uint32_t bits = 0;
+	uint32_t x = 0x1234567;
+	for( uint32_t now_us = 1000; now_us < 20000000; now_us += 1000 ) {
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		uint8_t channel = x;
+		universe[channel]++;
+		if( !pending[channel / 16] ) {
+			pending[channel / 16] = 1;
+			changed_us[channel / 16] = now_us;
+		}
+		next( now_us );
+		if( !packet_size ) {
+			continue;
+		}
+		bits += (packet_size + ILLUMINATIR_PLAN_OVERHEAD_COBS) * 10;
+		if( ((packet[0] >> 4) & 0b11) == 0 ) {
+			uint8_t block = packet[1] / 16;
+			if( pending[block] ) {
+				TEST_ASSERT_LESS_OR_EQUAL_UINT32( bound, now_us - changed_us[block] );
+				pending[block] = 0;
+			}
+		}
+	}
+	TEST_ASSERT_LESS_OR_EQUAL_UINT32( 20UL * BITRATE + PACKET_BITS, bits );
+	TEST_ASSERT_GREATER_OR_EQUAL_UINT32( 19UL * BITRATE, bits );
+}
+
+
+void test_illuminatir_schedule_errors( void )
+{
+	const uint8_t values[] = {1};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NULL_POINTER, illuminatir_schedule_init( &sched, NULL, BITRATE, 0 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_schedule_init( &sched, universe, BITRATE, 0 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, illuminatir_schedule_config( &sched, "A", 1, values, 1, 0, 0, 0 ) );
+	char key[] = "K0";
+	for( unsigned i = 0; i < ILLUMINATIR_SCHEDULE_CONFIGS; i++ ) {
+		key[1] = '0' + i;
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_schedule_config( &sched, key, 2, values, 1, 1, 0, 0 ) );
+	}
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_schedule_config( &sched, "K0", 2, values, 1, 1, 0, 0 ) ); // replaces
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_schedule_config( &sched, "k1", 2, values, 1, 1, 0, 0 ) ); // replaces, keys are case-insensitive
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_BUFFER_OVERFLOW, illuminatir_schedule_config( &sched, "K9", 2, values, 1, 1, 0, 0 ) );
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_illuminatir_schedule_initialRound);
+	RUN_TEST(test_illuminatir_schedule_changeBeforeRefresh);
+	RUN_TEST(test_illuminatir_schedule_config);
+	RUN_TEST(test_illuminatir_schedule_staleness);
+	RUN_TEST(test_illuminatir_schedule_errors);
+	return UNITY_END();
+}
@@ -0,0 +1,138 @@
+#include <illuminatir.h>
+#include <unity.h>
+#include <string.h>
+#include "common.h"
+
+
+static illuminatir_stats_t stats;
+
+
+void setUp(void) {
+	illuminatir_stats_clear( &stats );
+	illuminatir_stats_select( &stats );
+}
+
+
+void tearDown(void) {
+	illuminatir_stats_select( NULL );
+}
+
+
+void test_illuminatir_stats_select( void )
+{
+	illuminatir_stats_t other;
+#if ILLUMINATIR_STATS
+	TEST_ASSERT_EQUAL_PTR( &stats, illuminatir_stats_select( &other ) );
+	TEST_ASSERT_EQUAL_PTR( &other, illuminatir_stats_select( NULL ) );
+#else
+	TEST_ASSERT_NULL( illuminatir_stats_select( &other ) );
+	TEST_ASSERT_NULL( illuminatir_stats_select( NULL ) );
+#endif
+}
+
+
+#if ILLUMINATIR_STATS
+void test_illuminatir_stats_parse( void )
+{
+	uint8_t packet[ILLUMINATIR_PACKET_MAXSIZE];
+	uint8_t packet_size = sizeof(packet);
+	const uint8_t values[] = {1,2,3,4};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_build_offsetArray( packet, &packet_size, 0, values, sizeof(values) ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_parse( packet, packet_size, NULL, NULL ) );
+	TEST_ASSERT_EQUAL_UINT32( 1, stats.packets[0] );
+	TEST_ASSERT_EQUAL_UINT32( packet_size, stats.bytes );
+
+	packet[packet_size - 1] ^= 0xff;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_CRC, illuminatir_parse( packet, packet_size, NULL, NULL ) );
+	TEST_ASSERT_EQUAL_UINT32( 1, stats.packets[0] );
+	TEST_ASSERT_EQUAL_UINT32( 1, stats.errors[ILLUMINATIR_ERROR_INVALID_CRC] );
+
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_PACKET_TOO_SHORT, illuminatir_parse( packet, 1, NULL, NULL ) );
+	TEST_ASSERT_EQUAL_UINT32( 1, stats.errors[ILLUMINATIR_ERROR_PACKET_TOO_SHORT] );
+
+	// Nothing is counted without selected counters.
+	illuminatir_stats_select( NULL );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_CRC, illuminatir_parse( packet, packet_size, NULL, NULL ) );
+	TEST_ASSERT_EQUAL_UINT32( 1, stats.errors[ILLUMINATIR_ERROR_INVALID_CRC] );
+}
+
+
+void test_illuminatir_stats_cobs( void )
+{
+	const uint8_t invalid[] = {0x00,0x11}; // starts with a delimiter
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, illuminatir_cobs_parse( invalid, sizeof(invalid), NULL, NULL ) );
+	TEST_ASSERT_EQUAL_UINT32( 1, stats.cobs_errors );
+	TEST_ASSERT_EQUAL_UINT32( 1, stats.errors[ILLUMINATIR_ERROR_INVALID_SIZE] );
+}
+
+
+void test_illuminatir_stats_stream( void )
+{
+	uint8_t data[4 + ILLUMINATIR_COBS_PACKET_MAXSIZE + 1] = {0x05,0x11,0x22,0x00};
+	uint8_t cobsPacket_size = ILLUMINATIR_COBS_PACKET_MAXSIZE;
+	const uint8_t values[] = {1,2,3,4};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_build_offsetArray( data + 4, &cobsPacket_size, 0, values, sizeof(values) ) );
+	data[4 + cobsPacket_size] = 0;
+
+	illuminatir_stream_t stream;
+	illuminatir_stream_init( &stream, NULL, NULL );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_stream_feed( &stream, data + 3, 1 ) ); // start synchronized
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, illuminatir_stream_feed( &stream, data, 4 ) );
+	TEST_ASSERT_EQUAL_UINT32( 1, stats.cobs_errors );
+	TEST_ASSERT_EQUAL_UINT32( 1, stats.errors[ILLUMINATIR_ERROR_INVALID_SIZE] );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_stream_feed( &stream, data + 4, cobsPacket_size + 1 ) );
+	TEST_ASSERT_EQUAL_UINT32( 1, stats.packets[0] );
+}
+
+#endif
+
+
+void test_illuminatir_histogram_record( void )
+{
+	illuminatir_histogram_t histogram;
+	illuminatir_histogram_clear( &histogram );
+	TEST_ASSERT_EQUAL_UINT32( 0, illuminatir_histogram_getPercentile( &histogram, 50 ) );
+
+	illuminatir_histogram_record( &histogram, 0 );
+	illuminatir_histogram_record( &histogram, 1 );
+	illuminatir_histogram_record( &histogram, 5 );
+	illuminatir_histogram_record( &histogram, 0xffffffff );
+	TEST_ASSERT_EQUAL_UINT32( 1, histogram.buckets[0] );
+	TEST_ASSERT_EQUAL_UINT32( 1, histogram.buckets[1] );
+	TEST_ASSERT_EQUAL_UINT32( 1, histogram.buckets[3] );
+	TEST_ASSERT_EQUAL_UINT32( 1, histogram.buckets[ILLUMINATIR_HISTOGRAM_BUCKETS - 1] );
+	TEST_ASSERT_EQUAL_UINT32( 4, histogram.count );
+	TEST_ASSERT_EQUAL_UINT32( 0xffffffff, histogram.max );
+	TEST_ASSERT_TRUE( histogram.sum == 0xffffffffull + 6 );
+}
+
+
+void test_illuminatir_histogram_getPercentile( void )
+{
+	illuminatir_histogram_t histogram;
+	illuminatir_histogram_clear( &histogram );
+	for( uint32_t i = 1; i <= 100; i++ ) {
+		illuminatir_histogram_record( &histogram, i );
+	}
+	TEST_ASSERT_EQUAL_UINT32( 1, illuminatir_histogram_getPercentile( &histogram, 0 ) );
+	TEST_ASSERT_EQUAL_UINT32( 63, illuminatir_histogram_getPercentile( &histogram, 50 ) );
+	TEST_ASSERT_EQUAL_UINT32( 63, illuminatir_histogram_getPercentile( &histogram, 63 ) );
+	TEST_ASSERT_EQUAL_UINT32( 100, illuminatir_histogram_getPercentile( &histogram, 64 ) ); // limited to the maximum
+	TEST_ASSERT_EQUAL_UINT32( 100, illuminatir_histogram_getPercentile( &histogram, 100 ) );
+	TEST_ASSERT_EQUAL_UINT32( 100, illuminatir_histogram_getPercentile( &histogram, 255 ) );
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_illuminatir_stats_select);
+#if ILLUMINATIR_STATS // counting is compiled out otherwise
+	RUN_TEST(test_illuminatir_stats_parse);
+	RUN_TEST(test_illuminatir_stats_cobs);
+	RUN_TEST(test_illuminatir_stats_stream);
+#endif
+	RUN_TEST(test_illuminatir_histogram_record);
+	RUN_TEST(test_illuminatir_histogram_getPercentile);
+	return UNITY_END();
+}
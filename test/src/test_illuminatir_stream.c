@@ -0,0 +1,254 @@
+#include <illuminatir.h>
+#include <unity.h>
+#include <string.h>
+#include "common.h"
+
+
+static uint8_t  channels[256] = {0};
+static unsigned setChannel_called = 0;
+
+static char     lastConfigKey[ILLUMINATIR_CONFIG_KEY_MAXLEN];
+static uint8_t  lastConfigKey_size = 0;
+static uint8_t  lastConfigValues[ILLUMINATIR_CONFIG_VALUES_MAXSIZE];
+static uint8_t  lastConfigValues_size = 0;
+static unsigned setConfig_called = 0;
+
+static illuminatir_stream_t stream;
+static uint8_t              frame[ILLUMINATIR_PACKET_MAXSIZE*2];
+
+
+void setUp(void) {
+	memset( channels, 0, sizeof(channels) );
+	setChannel_called = 0;
+
+	memset( lastConfigKey, 0, sizeof(lastConfigKey) );
+	lastConfigKey_size    = 0;
+	memset( lastConfigValues, 0, sizeof(lastConfigValues) );
+	lastConfigValues_size = 0;
+	setConfig_called      = 0;
+}
+
+
+void tearDown(void) {
+	// clean stuff up here
+}
+
+
+void setChannel( uint8_t channel, uint8_t value )
+{
+	channels[channel] = value;
+	setChannel_called++;
+}
+
+
+void setConfig( const char * key, uint8_t key_size, const uint8_t * values, uint8_t values_size )
+{
+	memcpy( lastConfigKey, key, key_size );
+	lastConfigKey_size = key_size;
+	memcpy( lastConfigValues, values, values_size );
+	lastConfigValues_size = values_size;
+	setConfig_called++;
+}
+
+
+void test_illuminatir_stream_offsetArray_byteByByte( void )
+{
+	uint8_t cobsPacket[ILLUMINATIR_COBS_PACKET_MAXSIZE];
+	uint8_t cobsPacket_size = sizeof(cobsPacket);
+	const uint8_t values[] = {1,2,3,4,5,6,7,8};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_build_offsetArray( cobsPacket, &cobsPacket_size, 4, values, sizeof(values) ) );
+
+	illuminatir_stream_init( &stream, setChannel, setConfig );
+	for( unsigned i = 0; i < cobsPacket_size; i++ ) {
+		TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_stream_feedByte( &stream, cobsPacket[i] ) );
+	}
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_stream_feedByte( &stream, 0x00 ) );
+	TEST_ASSERT_EQUAL_UINT( 8, setChannel_called );
+	TEST_ASSERT_EQUAL_UINT8( 1, channels[ 4] );
+	TEST_ASSERT_EQUAL_UINT8( 8, channels[11] );
+}
+
+
+void test_illuminatir_stream_multipleFrames_oneChunk( void )
+{
+	uint8_t chunk[1 + ILLUMINATIR_COBS_PACKET_MAXSIZE*2 + 2];
+	size_t chunk_size = 0;
+	chunk[chunk_size++] = 0x00; // leading delimiter
+	uint8_t cobsPacket_size = ILLUMINATIR_COBS_PACKET_MAXSIZE;
+	const uint8_t values[] = {0,0,3,0}; // lots of zeros to stuff
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_build_offsetArray( chunk + chunk_size, &cobsPacket_size, 0xfe, values, sizeof(values) ) );
+	chunk_size += cobsPacket_size;
+	chunk[chunk_size++] = 0x00;
+	cobsPacket_size = ILLUMINATIR_COBS_PACKET_MAXSIZE;
+	const char key[] = "Base";
+	const uint8_t key_values[] = {0};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_build_config( chunk + chunk_size, &cobsPacket_size, key, sizeof(key)-1, key_values, sizeof(key_values) ) );
+	chunk_size += cobsPacket_size;
+	chunk[chunk_size++] = 0x00;
+
+	channels[0xfe] = channels[0xff] = channels[0x00] = channels[0x01] = 0xaa;
+	illuminatir_stream_init( &stream, setChannel, setConfig );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_stream_feed( &stream, chunk, chunk_size ) );
+	TEST_ASSERT_EQUAL_UINT( 4, setChannel_called );
+	TEST_ASSERT_EQUAL_UINT8( 0, channels[0xfe] );
+	TEST_ASSERT_EQUAL_UINT8( 0, channels[0xff] );
+	TEST_ASSERT_EQUAL_UINT8( 3, channels[0x00] );
+	TEST_ASSERT_EQUAL_UINT8( 0, channels[0x01] );
+	TEST_ASSERT_EQUAL_UINT( 1, setConfig_called );
+	TEST_ASSERT_EQUAL_UINT( sizeof(key)-1, lastConfigKey_size );
+	TEST_ASSERT_EQUAL_STRING_LEN( key, lastConfigKey, lastConfigKey_size );
+	TEST_ASSERT_EQUAL_UINT( 1, lastConfigValues_size );
+	TEST_ASSERT_EQUAL_UINT8( 0, lastConfigValues[0] );
+}
+
+
+void test_illuminatir_stream_concatenatedPackets( void )
+{
+	uint8_t packets[] = {0x00,0x03,42,0x00,0x00,0x04,21,0x00};
+	packets[3] = illuminatir_crc8( packets, 3, ILLUMINATIR_CRC8_INITIAL_SEED );
+	packets[7] = illuminatir_crc8( packets + 4, 3, ILLUMINATIR_CRC8_INITIAL_SEED );
+	uint8_t cobsPackets[ILLUMINATIR_COBS_ENCODE_DST_MAXSIZE(sizeof(packets))];
+	size_t cobsPackets_size = illuminatir_cobs_encode( cobsPackets, sizeof(cobsPackets), packets, sizeof(packets) );
+
+	illuminatir_stream_init( &stream, setChannel, setConfig );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_stream_feed( &stream, cobsPackets, cobsPackets_size ) );
+	TEST_ASSERT_EQUAL_UINT( 2, setChannel_called ); // dispatched before the delimiter arrived
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_stream_feedByte( &stream, 0x00 ) );
+	TEST_ASSERT_EQUAL_UINT8( 42, channels[3] );
+	TEST_ASSERT_EQUAL_UINT8( 21, channels[4] );
+}
+
+
+void test_illuminatir_stream_crcError_resync( void )
+{
+	uint8_t cobsPacket[ILLUMINATIR_COBS_PACKET_MAXSIZE + 1];
+	uint8_t cobsPacket_size = ILLUMINATIR_COBS_PACKET_MAXSIZE;
+	const uint8_t values[] = {1,2,3};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_build_offsetArray( cobsPacket, &cobsPacket_size, 8, values, sizeof(values) ) );
+	cobsPacket[cobsPacket_size++] = 0x00;
+
+	illuminatir_stream_init( &stream, setChannel, setConfig );
+	cobsPacket[2] ^= 0x80; // corrupt the offset
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_CRC, illuminatir_stream_feed( &stream, cobsPacket, cobsPacket_size ) );
+	TEST_ASSERT_EQUAL_UINT( 0, setChannel_called );
+	cobsPacket[2] ^= 0x80;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_stream_feed( &stream, cobsPacket, cobsPacket_size ) );
+	TEST_ASSERT_EQUAL_UINT( 3, setChannel_called );
+	TEST_ASSERT_EQUAL_UINT8( 1, channels[ 8] );
+	TEST_ASSERT_EQUAL_UINT8( 3, channels[10] );
+}
+
+
+void test_illuminatir_stream_truncatedFrame( void )
+{
+	uint8_t cobsPacket[ILLUMINATIR_COBS_PACKET_MAXSIZE];
+	uint8_t cobsPacket_size = sizeof(cobsPacket);
+	const uint8_t values[] = {1,2,3,4,5,6,7,8};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_cobs_build_offsetArray( cobsPacket, &cobsPacket_size, 4, values, sizeof(values) ) );
+
+	illuminatir_stream_init( &stream, setChannel, setConfig );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_stream_feed( &stream, cobsPacket, 5 ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_INVALID_SIZE, illuminatir_stream_feedByte( &stream, 0x00 ) );
+	TEST_ASSERT_EQUAL_UINT( 0, setChannel_called );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_stream_feed( &stream, cobsPacket, cobsPacket_size ) );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_stream_feedByte( &stream, 0x00 ) );
+	TEST_ASSERT_EQUAL_UINT( 8, setChannel_called );
+}
+
+
+void test_illuminatir_stream_unsupportedVersion( void )
+{
+	const uint8_t garbage[] = {0x03,0xc0,0x01,0x02,0x00};
+	illuminatir_stream_init( &stream, setChannel, setConfig );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_UNSUPPORTED_VERSION, illuminatir_stream_feed( &stream, garbage, sizeof(garbage) ) );
+	TEST_ASSERT_EQUAL_UINT( 0, setChannel_called );
+}
+
+
+void test_illuminatir_rand_stream_config( void )
+{
+	uint8_t randCobsPacket[ILLUMINATIR_COBS_PACKET_MAXSIZE];
+	uint8_t randCobsPacket_size = sizeof(randCobsPacket);
+	const char key[] = "IlluminatIR";
+	const uint8_t values[] = {1,2,3,4,5};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_build_config( randCobsPacket, &randCobsPacket_size, key, sizeof(key)-1, values, sizeof(values) ) );
+
+	illuminatir_rand_stream_init( &stream, frame, sizeof(frame), setChannel, setConfig );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_stream_feed( &stream, randCobsPacket, randCobsPacket_size ) );
+	TEST_ASSERT_EQUAL_UINT( 0, setConfig_called ); // randomized frames are dispatched at the delimiter
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_stream_feedByte( &stream, 0x00 ) );
+	TEST_ASSERT_EQUAL_UINT( 1, setConfig_called );
+	TEST_ASSERT_EQUAL_UINT( sizeof(key)-1, lastConfigKey_size );
+	TEST_ASSERT_EQUAL_STRING_LEN( key, lastConfigKey, lastConfigKey_size );
+	TEST_ASSERT_EQUAL_UINT( 5, lastConfigValues_size );
+	TEST_ASSERT_EQUAL_UINT8( 5, lastConfigValues[4] );
+}
+
+
+void test_illuminatir_rand_stream_multiple_overflow( void )
+{
+	uint8_t packets[ILLUMINATIR_PACKET_MAXSIZE*2];
+	uint8_t packet1_size = ILLUMINATIR_PACKET_MAXSIZE;
+	const uint8_t values1[] = {1,2,3,4,5,6};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_build_offsetArray( packets, &packet1_size, 4, values1, sizeof(values1) ) );
+	uint8_t packet2_size = ILLUMINATIR_PACKET_MAXSIZE;
+	const uint8_t values2[] = {11,12,13,14};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_build_offsetArray( packets + packet1_size, &packet2_size, 20, values2, sizeof(values2) ) );
+	size_t packets_size = packet1_size + packet2_size;
+	illuminatir_rand( packets, packets_size );
+	uint8_t cobsPackets[ILLUMINATIR_COBS_ENCODE_DST_MAXSIZE(sizeof(packets)) + 1];
+	size_t cobsPackets_size = illuminatir_cobs_encode( cobsPackets, sizeof(cobsPackets), packets, packets_size );
+	cobsPackets[cobsPackets_size++] = 0x00;
+
+	illuminatir_rand_stream_init( &stream, frame, packets_size - 1, setChannel, setConfig );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_BUFFER_OVERFLOW, illuminatir_stream_feed( &stream, cobsPackets, cobsPackets_size ) );
+	TEST_ASSERT_EQUAL_UINT( 0, setChannel_called );
+
+	illuminatir_rand_stream_init( &stream, frame, sizeof(frame), setChannel, setConfig );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_stream_feed( &stream, cobsPackets, cobsPackets_size ) );
+	TEST_ASSERT_EQUAL_UINT( 10, setChannel_called );
+	TEST_ASSERT_EQUAL_UINT8(  1, channels[ 4] );
+	TEST_ASSERT_EQUAL_UINT8(  6, channels[ 9] );
+	TEST_ASSERT_EQUAL_UINT8( 11, channels[20] );
+	TEST_ASSERT_EQUAL_UINT8( 14, channels[23] );
+}
+
+
+void handler_setChannels( void * ctx, uint8_t first_channel, const uint8_t * values, uint8_t count )
+{
+	uint8_t * universe = ctx;
+	memcpy( universe + first_channel, values, count );
+	setChannel_called++;
+}
+
+
+void test_illuminatir_rand_stream_handler( void )
+{
+	uint8_t randCobsPacket[ILLUMINATIR_COBS_PACKET_MAXSIZE + 1];
+	uint8_t randCobsPacket_size = ILLUMINATIR_COBS_PACKET_MAXSIZE;
+	const uint8_t values[] = {1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16};
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_rand_cobs_build_offsetArray( randCobsPacket, &randCobsPacket_size, 32, values, sizeof(values) ) );
+	randCobsPacket[randCobsPacket_size++] = 0x00;
+
+	illuminatir_handler_t handler = { .ctx = channels, .setChannels = handler_setChannels };
+	illuminatir_rand_stream_init_handler( &stream, frame, sizeof(frame), &handler );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_stream_feed( &stream, randCobsPacket, randCobsPacket_size ) );
+	TEST_ASSERT_EQUAL_UINT( 1, setChannel_called );
+	TEST_ASSERT_EQUAL_HEX8_ARRAY( values, channels + 32, sizeof(values) );
+}
+
+
+int main( void )
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_illuminatir_stream_offsetArray_byteByByte);
+	RUN_TEST(test_illuminatir_stream_multipleFrames_oneChunk);
+	RUN_TEST(test_illuminatir_stream_concatenatedPackets);
+	RUN_TEST(test_illuminatir_stream_crcError_resync);
+	RUN_TEST(test_illuminatir_stream_truncatedFrame);
+	RUN_TEST(test_illuminatir_stream_unsupportedVersion);
+	RUN_TEST(test_illuminatir_rand_stream_config);
+	RUN_TEST(test_illuminatir_rand_stream_multiple_overflow);
+	RUN_TEST(test_illuminatir_rand_stream_handler);
+	return UNITY_END();
+}
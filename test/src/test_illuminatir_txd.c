@@ -0,0 +1,245 @@
+#define _GNU_SOURCE
+
+#include <illuminatir.h>
+#include <txd.h>
+#include <unity.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "common.h"
+
+
+#define OUTPUTS 2
+
+
+static txd_t * txd;
+static int masters[OUTPUTS];
+static int client;
+
+static uint8_t  channels[ILLUMINATIR_CHANNELS];
+static char     lastConfigKey[ILLUMINATIR_CONFIG_KEY_MAXLEN];
+static uint8_t  lastConfigKey_size;
+static unsigned setConfig_called;
+
+
+void setUp(void) {
+	txd = NULL;
+	client = -1;
+	for( unsigned i = 0; i < OUTPUTS; i++ ) {
+		masters[i] = -1;
+	}
+	memset( channels, 0, sizeof(channels) );
+	lastConfigKey_size = 0;
+	setConfig_called = 0;
+}
+
+
+void tearDown(void) {
+	txd_destroy( txd );
+	if( client >= 0 ) {
+		close( client );
+	}
+	for( unsigned i = 0; i < OUTPUTS; i++ ) {
+		if( masters[i] >= 0 ) {
+			close( masters[i] );
+		}
+	}
+}
+
+
+static void setChannel( uint8_t channel, uint8_t value )
+{
+	channels[channel] = value;
+}
+
+
+static void setConfig( const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size )
+{
+	(void)values;
+	(void)values_size;
+	memcpy( lastConfigKey, key, key_len );
+	lastConfigKey_size = key_len;
+	setConfig_called++;
+}
+
+
+static void openOutputs( void )
+{
+	for( unsigned i = 0; i < OUTPUTS; i++ ) {
+		masters[i] = posix_openpt( O_RDWR | O_NOCTTY | O_NONBLOCK );
+		TEST_ASSERT_TRUE( masters[i] >= 0 );
+		TEST_ASSERT_EQUAL_INT( 0, grantpt( masters[i] ) );
+		TEST_ASSERT_EQUAL_INT( 0, unlockpt( masters[i] ) );
+		TEST_ASSERT_EQUAL_INT( (int)i, txd_openOutput( txd, ptsname( masters[i] ), 0 ) );
+	}
+}
+
+
+// Polls until the next tick wrote frames.
+static void waitForFrames( void )
+{
+	txd_stats_t before, after;
+	txd_getStats( txd, 0, &before );
+	for( unsigned i = 0; i < 100; i++ ) {
+		TEST_ASSERT_EQUAL_INT( 0, txd_poll( txd, 10 ) );
+		txd_getStats( txd, 0, &after );
+		if( after.bytes > before.bytes ) {
+			return;
+		}
+	}
+	TEST_FAIL_MESSAGE( "No frames written" );
+}
+
+
+// Reads everything a master received.
+static size_t receive( int master, uint8_t * data, size_t data_size )
+{
+	size_t size = 0;
+	for( unsigned i = 0; i < 100 && size < data_size; i++ ) {
+		ssize_t received = read( master, data + size, data_size - size );
+		if( received > 0 ) {
+			size += (size_t)received;
+		} else if( size ) {
+			break;
+		} else {
+			TEST_ASSERT_EQUAL_INT( EAGAIN, errno );
+			usleep( 1000 );
+		}
+	}
+	return size;
+}
+
+
+static void decode( const uint8_t * data, size_t data_size )
+{
+	uint8_t frame[256];
+	illuminatir_stream_t stream;
+	illuminatir_rand_stream_init( &stream, frame, sizeof(frame), setChannel, setConfig );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_stream_feed( &stream, data, data_size ) );
+}
+
+
+void test_illuminatir_txd_batch(void)
+{
+	txd = txd_create( 5000, 0 );
+	TEST_ASSERT_NOT_NULL( txd );
+	openOutputs();
+	int sockets[2];
+	TEST_ASSERT_EQUAL_INT( 0, socketpair( AF_UNIX, SOCK_STREAM, 0, sockets ) );
+	client = sockets[1];
+	TEST_ASSERT_EQUAL_INT( 0, txd_addClient( txd, sockets[0] ) );
+
+	const uint8_t messages[] = {
+		TXD_MSG_SET_RANGE, 4, 10, 1, 2, 3,
+		TXD_MSG_SET_CHANNELS, 4, 200, 9, 255, 8,
+		TXD_MSG_CONFIG, 6, 4, 'm', 'o', 'd', 'e', 1,
+	};
+	TEST_ASSERT_EQUAL_INT( sizeof(messages), (int)write( client, messages, sizeof(messages) ) );
+
+	uint8_t data[OUTPUTS][4096];
+	waitForFrames();
+	size_t data_size = receive( masters[0], data[0], sizeof(data[0]) );
+	TEST_ASSERT_EQUAL_UINT( data_size, receive( masters[1], data[1], sizeof(data[1]) ) );
+	TEST_ASSERT_EQUAL_UINT8_ARRAY( data[0], data[1], data_size ); // encoded once for both
+	decode( data[0], data_size );
+	TEST_ASSERT_EQUAL_UINT8( 1, channels[10] );
+	TEST_ASSERT_EQUAL_UINT8( 3, channels[12] );
+	TEST_ASSERT_EQUAL_UINT8( 9, channels[200] );
+	TEST_ASSERT_EQUAL_UINT8( 8, channels[255] );
+	TEST_ASSERT_EQUAL_UINT( 1, setConfig_called );
+	TEST_ASSERT_EQUAL_UINT8( 4, lastConfigKey_size );
+	TEST_ASSERT_EQUAL_MEMORY( "mode", lastConfigKey, 4 );
+
+	// Later ticks only carry the changes.
+	const uint8_t change[] = { TXD_MSG_SET_CHANNELS, 2, 11, 42 };
+	TEST_ASSERT_EQUAL_INT( sizeof(change), (int)write( client, change, sizeof(change) ) );
+	memset( channels, 0, sizeof(channels) );
+	waitForFrames();
+	data_size = receive( masters[0], data[0], sizeof(data[0]) );
+	TEST_ASSERT_TRUE( data_size > 0 && data_size < 16 );
+	decode( data[0], data_size );
+	TEST_ASSERT_EQUAL_UINT8( 42, channels[11] );
+	TEST_ASSERT_EQUAL_UINT8( 0, channels[10] );
+
+	// A malformed message closes the connection.
+	const uint8_t malformed[] = { TXD_MSG_SET_CHANNELS, 3, 1, 2, 3 };
+	TEST_ASSERT_EQUAL_INT( sizeof(malformed), (int)write( client, malformed, sizeof(malformed) ) );
+	for( unsigned i = 0; i < 10; i++ ) {
+		TEST_ASSERT_EQUAL_INT( 0, txd_poll( txd, 5 ) );
+	}
+	uint8_t byte;
+	TEST_ASSERT_EQUAL_INT( 0, (int)read( client, &byte, 1 ) );
+}
+
+
+void test_illuminatir_txd_refresh(void)
+{
+	txd = txd_create( 2000, 4 );
+	TEST_ASSERT_NOT_NULL( txd );
+	openOutputs();
+	uint8_t data[4096];
+	waitForFrames();
+	receive( masters[0], data, sizeof(data) ); // everything
+	memset( channels, 0xaa, sizeof(channels) );
+	waitForFrames();
+	size_t data_size = receive( masters[0], data, sizeof(data) );
+	decode( data, data_size );
+	unsigned refreshed = 0;
+	for( unsigned i = 0; i < ILLUMINATIR_CHANNELS; i++ ) {
+		refreshed += channels[i] == 0;
+	}
+	TEST_ASSERT_TRUE( refreshed >= 4 * ILLUMINATIR_OFFSETARRAY_MAXVALUES );
+}
+
+
+void test_illuminatir_txd_listen(void)
+{
+	txd = txd_create( 5000, 0 );
+	TEST_ASSERT_NOT_NULL( txd );
+	char path[64];
+	snprintf( path, sizeof(path), "/tmp/test_illuminatir_txd_%d.sock", (int)getpid() );
+	struct sockaddr_un address = { .sun_family = AF_UNIX };
+	strcpy( address.sun_path, path );
+
+	// A socket file nobody listens on is replaced.
+	int stale = socket( AF_UNIX, SOCK_STREAM, 0 );
+	TEST_ASSERT_EQUAL_INT( 0, bind( stale, (const struct sockaddr *)&address, sizeof(address) ) );
+	close( stale );
+	TEST_ASSERT_EQUAL_INT( 0, txd_listen( txd, path ) );
+
+	// A live one is not taken over.
+	txd_t * second = txd_create( 5000, 0 );
+	TEST_ASSERT_NOT_NULL( second );
+	TEST_ASSERT_EQUAL_INT( -1, txd_listen( second, path ) );
+	TEST_ASSERT_EQUAL_INT( EADDRINUSE, errno );
+	txd_destroy( second );
+	TEST_ASSERT_EQUAL_INT( 0, access( path, F_OK ) );
+
+
+	client = socket( AF_UNIX, SOCK_STREAM, 0 );
+	TEST_ASSERT_EQUAL_INT( 0, connect( client, (const struct sockaddr *)&address, sizeof(address) ) );
+	const uint8_t message[] = { TXD_MSG_SET_CHANNELS, 2, 77, 7 };
+	TEST_ASSERT_EQUAL_INT( sizeof(message), (int)write( client, message, sizeof(message) ) );
+	for( unsigned i = 0; i < 100 && txd_getUniverse( txd )[77] != 7; i++ ) {
+		TEST_ASSERT_EQUAL_INT( 0, txd_poll( txd, 5 ) );
+	}
+	TEST_ASSERT_EQUAL_UINT8( 7, txd_getUniverse( txd )[77] );
+	txd_destroy( txd );
+	txd = NULL;
+	TEST_ASSERT_EQUAL_INT( -1, access( path, F_OK ) ); // removed
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_illuminatir_txd_batch);
+	RUN_TEST(test_illuminatir_txd_refresh);
+	RUN_TEST(test_illuminatir_txd_listen);
+	return UNITY_END();
+}
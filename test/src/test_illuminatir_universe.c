@@ -0,0 +1,133 @@
+#include <illuminatir.h>
+#include <illuminatir_universe.h>
+#include <unity.h>
+#include <pthread.h>
+#include <string.h>
+#include "common.h"
+
+
+static illuminatir_universe_t universe;
+
+
+void setUp(void) {
+	illuminatir_universe_init( &universe, NULL );
+}
+
+
+void tearDown(void) {
+	// clean stuff up here
+}
+
+
+void test_illuminatir_universe_init(void)
+{
+	uint8_t initial[ILLUMINATIR_CHANNELS], values[ILLUMINATIR_CHANNELS];
+	for( unsigned i = 0; i < ILLUMINATIR_CHANNELS; i++ ) {
+		initial[i] = (uint8_t)(i * 7);
+	}
+	illuminatir_universe_init( &universe, initial );
+	TEST_ASSERT_EQUAL_UINT32( 0, illuminatir_universe_read( &universe, values ) );
+	TEST_ASSERT_EQUAL_UINT8_ARRAY( initial, values, ILLUMINATIR_CHANNELS );
+	TEST_ASSERT_EQUAL_UINT8( 7 * 5, illuminatir_universe_getChannel( &universe, 5 ) );
+}
+
+
+void test_illuminatir_universe_changed(void)
+{
+	uint8_t values[ILLUMINATIR_CHANNELS];
+	illuminatir_channelMask_t changed;
+
+	const uint8_t block[] = {1,2,3};
+	illuminatir_universe_setChannels( &universe, 254, block, sizeof(block) ); // wraps around
+	TEST_ASSERT_EQUAL_UINT32( 1, illuminatir_universe_getGeneration( &universe ) );
+	const uint8_t pairs[] = {10,100, 20,0, 30,200};
+	illuminatir_universe_setChannelValuePairs( &universe, pairs, 3 ); // channel 20 is unchanged
+	TEST_ASSERT_EQUAL_UINT32( 2, illuminatir_universe_readChanged( &universe, values, 1, &changed ) );
+	TEST_ASSERT_EQUAL_UINT8( 1, values[254] );
+	TEST_ASSERT_EQUAL_UINT8( 2, values[255] );
+	TEST_ASSERT_EQUAL_UINT8( 3, values[0] );
+	TEST_ASSERT_EQUAL_UINT8( 100, values[10] );
+	TEST_ASSERT_EQUAL_UINT8( 200, values[30] );
+	TEST_ASSERT_EQUAL_HEX32( (1u << 10) | (1u << 30), changed.bits[0] );
+	TEST_ASSERT_EQUAL_HEX32( 0, changed.bits[7] );
+
+	TEST_ASSERT_EQUAL_UINT32( 2, illuminatir_universe_readChanged( &universe, NULL, 0, &changed ) );
+	TEST_ASSERT_EQUAL_HEX32( (1u << 0) | (1u << 10) | (1u << 30), changed.bits[0] );
+	TEST_ASSERT_EQUAL_HEX32( 3u << 30, changed.bits[7] );
+
+	// Writing the same values again is not an update.
+	illuminatir_universe_setChannels( &universe, 254, block, sizeof(block) );
+	TEST_ASSERT_EQUAL_UINT32( 2, illuminatir_universe_readChanged( &universe, NULL, 2, &changed ) );
+	for( unsigned i = 0; i < ILLUMINATIR_CHANNELS / 32; i++ ) {
+		TEST_ASSERT_EQUAL_HEX32( 0, changed.bits[i] );
+	}
+}
+
+
+void test_illuminatir_universe_handler(void)
+{
+	const uint8_t values[] = {11,22,33,44};
+	uint8_t packets[2 * ILLUMINATIR_PACKET_MAXSIZE];
+	uint8_t packet_size = ILLUMINATIR_PACKET_MAXSIZE;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_build_offsetArray( packets, &packet_size, 100, values, sizeof(values) ) );
+	uint8_t packets_size = packet_size;
+	const uint8_t pairs[] = {5,55, 6,66};
+	packet_size = ILLUMINATIR_PACKET_MAXSIZE;
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_build_channelValuePairs( packets + packets_size, &packet_size, pairs, sizeof(pairs) ) );
+	packets_size += packet_size;
+
+	illuminatir_handler_t handler = illuminatir_universe_handler( &universe );
+	TEST_ASSERT_ILLUMINATIR_ERROR( ILLUMINATIR_ERROR_NONE, illuminatir_parse_handler( packets, packets_size, &handler ) );
+	TEST_ASSERT_EQUAL_UINT32( 2, illuminatir_universe_getGeneration( &universe ) ); // one update per payload
+	TEST_ASSERT_EQUAL_UINT8( 33, illuminatir_universe_getChannel( &universe, 102 ) );
+	TEST_ASSERT_EQUAL_UINT8( 66, illuminatir_universe_getChannel( &universe, 6 ) );
+}
+
+
+#define CONCURRENT_UPDATES 50000
+
+static void * concurrent_writer( void * arg )
+{
+	(void)arg;
+	uint8_t values[ILLUMINATIR_CHANNELS];
+	for( unsigned update = 1; update <= CONCURRENT_UPDATES; update++ ) {
+		memset( values, (uint8_t)update, sizeof(values) );
+		illuminatir_universe_setChannels( &universe, 0, values, ILLUMINATIR_CHANNELS );
+	}
+	return NULL;
+}
+
+
+void test_illuminatir_universe_concurrent(void)
+{
+	pthread_t writer;
+	TEST_ASSERT_EQUAL_INT( 0, pthread_create( &writer, NULL, concurrent_writer, NULL ) );
+	uint8_t values[ILLUMINATIR_CHANNELS];
+	uint32_t generation = 0;
+	unsigned torn = 0;
+	while( generation < CONCURRENT_UPDATES ) {
+		illuminatir_channelMask_t changed;
+		uint32_t next = illuminatir_universe_readChanged( &universe, values, generation, &changed );
+		// Every update sets all channels to the same value.
+		for( unsigned i = 1; i < ILLUMINATIR_CHANNELS; i++ ) {
+			torn += values[i] != values[0];
+		}
+		torn += values[0] != (uint8_t)next;
+		torn += next < generation;
+		torn += (next != generation) != (changed.bits[0] == 0xffffffff);
+		generation = next;
+	}
+	pthread_join( writer, NULL );
+	TEST_ASSERT_EQUAL_UINT( 0, torn );
+}
+
+
+int main(void)
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_illuminatir_universe_init);
+	RUN_TEST(test_illuminatir_universe_changed);
+	RUN_TEST(test_illuminatir_universe_handler);
+	RUN_TEST(test_illuminatir_universe_concurrent);
+	return UNITY_END();
+}
@@ -0,0 +1,64 @@
+#define _GNU_SOURCE
+
+#include "serial.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <termios.h>
+#include <unistd.h>
+
+
+static int serial_speed( unsigned baud, speed_t * speed )
+{
+	static const struct { unsigned baud; speed_t speed; } speeds[] = {
+		{ 1200, B1200 }, { 2400, B2400 }, { 4800, B4800 }, { 9600, B9600 }, { 19200, B19200 },
+		{ 38400, B38400 }, { 57600, B57600 }, { 115200, B115200 }, { 230400, B230400 },
+		{ 460800, B460800 }, { 500000, B500000 }, { 921600, B921600 }, { 1000000, B1000000 },
+	};
+	for( size_t i = 0; i < sizeof(speeds) / sizeof(speeds[0]); i++ ) {
+		if( speeds[i].baud == baud ) {
+			*speed = speeds[i].speed;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+
+int serial_open( const char * path, unsigned baud )
+{
+	speed_t speed = 0;
+	if( !path || (baud && serial_speed( baud, &speed )) ) {
+		errno = EINVAL;
+		return -1;
+	}
+	int fd = open( path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC );
+	if( fd < 0 || !isatty( fd ) ) {
+		return fd;
+	}
+	struct termios tio;
+	if( tcgetattr( fd, &tio ) ) {
+		goto fail;
+	}
+	cfmakeraw( &tio );
+	tio.c_cflag |= CLOCAL | CREAD;
+	tio.c_cc[VMIN]  = 1;
+	tio.c_cc[VTIME] = 0;
+	if( baud && cfsetspeed( &tio, speed ) ) {
+		goto fail;
+	}
+	if( tcsetattr( fd, TCSANOW, &tio ) ) {
+		goto fail;
+	}
+	tcflush( fd, TCIOFLUSH );
+	return fd;
+
+fail:
+	{
+		int err = errno;
+		close( fd );
+		errno = err;
+	}
+	return -1;
+}
@@ -0,0 +1,11 @@
+#ifndef ILLUMINATIR_TOOLS_SERIAL_INCLUDED
+#define ILLUMINATIR_TOOLS_SERIAL_INCLUDED
+
+
+// Opens a serial device or pty non-blocking and in raw mode with the given
+// baud rate (0 keeps the current one). Other files are opened as they are.
+// Returns the file descriptor or -1 with errno set.
+int serial_open( const char * path, unsigned baud );
+
+
+#endif
@@ -0,0 +1,125 @@
+#define _GNU_SOURCE
+
+#include "replay.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+static volatile sig_atomic_t quit = 0;
+
+
+static void onSignal( int signal )
+{
+	(void)signal;
+	quit = 1;
+}
+
+
+static void usage( const char * program )
+{
+	fprintf( stderr,
+		"Usage: %s [options] (-c CAPTURE | -g FRAMES) output...\n"
+		"Writes a capture or generated frames to serial devices, ptys or files, paced like a serial line.\n"
+		"  -c CAPTURE  Capture to replay. Port N goes to output N modulo the number of outputs.\n"
+		"  -g FRAMES   Generate FRAMES frames of random channel values instead. (0: until interrupted)\n"
+		"  -p PACKETS  OffsetArray packets per generated frame. (default 4, at most %u)\n"
+		"  -b BAUD     Line rate to pace at. (default 115200)\n"
+		"  -f FORMAT   Character format on the line, for the bits per byte. (default 8N1)\n"
+		"  -a          Write as fast as possible instead of pacing.\n"
+		"  -x          Ignore the timestamps of the capture, writing records back to back.\n"
+		"  -s          Configure serial devices to BAUD. (default: keep)\n",
+		program, REPLAY_FRAME_PACKETS_MAX );
+}
+
+
+int main( int argc, char ** argv )
+{
+	const char * capture_path = NULL, * format = "8N1";
+	unsigned long long frames = 0;
+	unsigned baud = 115200, packets = 4;
+	int generate = 0, fast = 0, timed = 1, configure = 0;
+	int opt;
+	while( (opt = getopt( argc, argv, "c:g:p:b:f:axsh" )) != -1 ) {
+		switch( opt ) {
+			case 'c': capture_path = optarg; break;
+			case 'g': generate     = 1; frames = strtoull( optarg, NULL, 0 ); break;
+			case 'p': packets      = (unsigned)strtoul( optarg, NULL, 0 ); break;
+			case 'b': baud         = (unsigned)strtoul( optarg, NULL, 0 ); break;
+			case 'f': format       = optarg; break;
+			case 'a': fast         = 1; break;
+			case 'x': timed        = 0; break;
+			case 's': configure    = 1; break;
+			default:
+				usage( argv[0] );
+				return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+	int bits_per_byte = replay_parseFormat( format );
+	if( !capture_path == !generate || optind >= argc || !baud || bits_per_byte < 0 || !packets || packets > REPLAY_FRAME_PACKETS_MAX ) {
+		usage( argv[0] );
+		return EXIT_FAILURE;
+	}
+
+	replay_t * replay = replay_create( fast ? 0 : baud, (unsigned)bits_per_byte );
+	if( !replay ) {
+		perror( "replay_create" );
+		return EXIT_FAILURE;
+	}
+	for( int i = optind; i < argc; i++ ) {
+		if( replay_openOutput( replay, argv[i], configure ? baud : 0 ) < 0 ) {
+			fprintf( stderr, "%s: %s\n", argv[i], strerror( errno ) );
+			replay_destroy( replay );
+			return EXIT_FAILURE;
+		}
+	}
+	illuminatir_capture_reader_t reader;
+	if( capture_path ) {
+		illuminatir_error_t error = illuminatir_capture_reader_open( &reader, capture_path );
+		if( error ) {
+			fprintf( stderr, "%s: %s\n", capture_path, error == ILLUMINATIR_ERROR_UNKNOWN ? strerror( errno ) : illuminatir_error_toString( error ) );
+			replay_destroy( replay );
+			return EXIT_FAILURE;
+		}
+	}
+
+	struct sigaction action;
+	memset( &action, 0, sizeof(action) );
+	action.sa_handler = onSignal;
+	sigaction( SIGINT, &action, NULL );
+	sigaction( SIGTERM, &action, NULL );
+	signal( SIGPIPE, SIG_IGN );
+
+	int status = EXIT_SUCCESS;
+	if( capture_path ) {
+		if( replay_capture( replay, &reader, timed, &quit ) ) {
+			perror( "replay_capture" );
+			status = EXIT_FAILURE;
+		}
+		illuminatir_capture_reader_close( &reader );
+	} else if( replay_generate( replay, frames, (uint8_t)packets, &quit ) ) {
+		perror( "replay_generate" );
+		status = EXIT_FAILURE;
+	}
+
+	replay_stats_t stats;
+	replay_getStats( replay, &stats );
+	double seconds = (double)stats.elapsed_ns / 1e9;
+	printf( "%llu frames, %llu bytes in %.3f s", (unsigned long long)stats.frames, (unsigned long long)stats.bytes, seconds );
+	if( seconds > 0 ) {
+		printf( ": %.1f frames/s, %.0f bytes/s, %.1f%% of the line rate per output",
+			(double)stats.frames / seconds, (double)stats.bytes / seconds,
+			100.0 * (double)stats.bytes * bits_per_byte / baud / (argc - optind) / seconds );
+	}
+	printf( "\n" );
+	if( !fast ) {
+		printf( "pacing jitter: mean %.1f us, stddev %.1f us, max %.1f us\n",
+			stats.late_ns_mean / 1e3, stats.late_ns_stddev / 1e3, (double)stats.late_ns_max / 1e3 );
+	}
+	replay_destroy( replay );
+	return status;
+}
@@ -0,0 +1,291 @@
+#define _GNU_SOURCE
+
+#include "replay.h"
+#include "serial.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+
+#define REPLAY_FRAME_BUFFER_SIZE ILLUMINATIR_FRAME_BUFFER_SIZE(REPLAY_FRAME_PACKETS_MAX * ILLUMINATIR_PACKET_MAXSIZE)
+
+#define REPLAY_BLOCKS (ILLUMINATIR_CHANNELS / ILLUMINATIR_OFFSETARRAY_MAXVALUES)
+
+
+typedef struct {
+	int      fd;
+	uint64_t free_ns; // when the line is done with the last frame, relative to start_ns
+} replay_output_t;
+
+
+struct replay {
+	unsigned              baud;
+	unsigned              bits_per_byte;
+	int                   started;
+	uint64_t              start_ns;  // monotonic time of the first write
+	uint64_t              end_ns;    // end of the last frame, relative to start_ns
+	replay_output_t *     outputs;
+	unsigned              outputs_count;
+	uint64_t              frames;
+	uint64_t              bytes;
+	uint64_t              paced;     // writes counted in the jitter statistics
+	uint64_t              late_max;
+	double                late_mean; // running mean and sum of squared deviations (Welford)
+	double                late_m2;
+	illuminatir_lfsr127_t lfsr;      // channel values of generated frames
+	uint8_t               block;     // next block of generated frames
+};
+
+
+static uint64_t replay_now( void )
+{
+	struct timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+
+// Sleeps until a monotonic time. Returns 0 or -1 with errno set, EINTR for signals.
+static int replay_sleepUntil( uint64_t ns )
+{
+	struct timespec deadline = { .tv_sec = (time_t)(ns / 1000000000u), .tv_nsec = (long)(ns % 1000000000u) };
+	int err = clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL );
+	if( err ) {
+		errno = err;
+		return -1;
+	}
+	return 0;
+}
+
+
+// Writes all bytes, waiting for non-blocking outputs to accept them.
+static int replay_write( int fd, const uint8_t * data, size_t size )
+{
+	while( size ) {
+		ssize_t written = write( fd, data, size );
+		if( written < 0 ) {
+			if( errno != EAGAIN ) {
+				return -1;
+			}
+			struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+			if( poll( &pfd, 1, -1 ) < 0 ) {
+				return -1;
+			}
+			continue;
+		}
+		data += written;
+		size -= (size_t)written;
+	}
+	return 0;
+}
+
+
+replay_t * replay_create( unsigned baud, unsigned bits_per_byte )
+{
+	if( !bits_per_byte ) {
+		errno = EINVAL;
+		return NULL;
+	}
+	replay_t * replay = calloc( 1, sizeof(*replay) );
+	if( !replay ) {
+		return NULL;
+	}
+	replay->baud          = baud;
+	replay->bits_per_byte = bits_per_byte;
+	illuminatir_lfsr127_init_r( &replay->lfsr, 1 );
+	return replay;
+}
+
+
+void replay_destroy( replay_t * replay )
+{
+	if( !replay ) {
+		return;
+	}
+	for( unsigned i = 0; i < replay->outputs_count; i++ ) {
+		close( replay->outputs[i].fd );
+	}
+	free( replay->outputs );
+	free( replay );
+}
+
+
+int replay_parseFormat( const char * format )
+{
+	if( !format || strlen( format ) != 3 || format[0] < '5' || format[0] > '8' || !strchr( "NEOMS", format[1] ) || (format[2] != '1' && format[2] != '2') ) {
+		return -1;
+	}
+	return 1 + (format[0] - '0') + (format[1] != 'N') + (format[2] - '0');
+}
+
+
+int replay_addOutput( replay_t * replay, int fd )
+{
+	if( !replay || fd < 0 ) {
+		errno = EINVAL;
+		return -1;
+	}
+	replay_output_t * outputs = realloc( replay->outputs, (replay->outputs_count + 1) * sizeof(*outputs) );
+	if( !outputs ) {
+		return -1;
+	}
+	replay->outputs = outputs;
+	outputs[replay->outputs_count] = (replay_output_t){ .fd = fd, .free_ns = replay->end_ns };
+	return (int)replay->outputs_count++;
+}
+
+
+int replay_openOutput( replay_t * replay, const char * path, unsigned baud )
+{
+	if( !replay || !path ) {
+		errno = EINVAL;
+		return -1;
+	}
+	struct stat st;
+	int fd;
+	if( !stat( path, &st ) && S_ISCHR( st.st_mode ) ) {
+		fd = serial_open( path, baud );
+	} else {
+		fd = open( path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666 );
+	}
+	if( fd < 0 ) {
+		return -1;
+	}
+	int output = replay_addOutput( replay, fd );
+	if( output < 0 ) {
+		int err = errno;
+		close( fd );
+		errno = err;
+	}
+	return output;
+}
+
+
+int replay_send( replay_t * replay, unsigned output, const uint8_t * data, size_t size, uint64_t at_ns )
+{
+	if( !replay || output >= replay->outputs_count || !data || !size ) {
+		errno = EINVAL;
+		return -1;
+	}
+	replay_output_t * out = &replay->outputs[output];
+	if( !replay->started ) {
+		replay->start_ns = replay_now();
+		replay->started  = 1;
+	}
+
+	uint64_t now;
+	if( replay->baud ) {
+		// Scheduled on the line rather than on when the write actually
+		// happened, so late writes catch up and the average rate stays exact.
+		uint64_t due = at_ns > out->free_ns ? at_ns : out->free_ns;
+		if( replay_sleepUntil( replay->start_ns + due ) ) {
+			return -1;
+		}
+		now = replay_now() - replay->start_ns;
+		uint64_t late = now > due ? now - due : 0;
+		replay->paced++;
+		double delta = (double)late - replay->late_mean;
+		replay->late_mean += delta / (double)replay->paced;
+		replay->late_m2   += delta * ((double)late - replay->late_mean);
+		if( late > replay->late_max ) {
+			replay->late_max = late;
+		}
+		out->free_ns = due + (uint64_t)size * replay->bits_per_byte * 1000000000u / replay->baud;
+	}
+
+	if( replay_write( out->fd, data, size ) ) {
+		return -1;
+	}
+	replay->end_ns = replay_now() - replay->start_ns;
+	if( replay->baud && out->free_ns > replay->end_ns ) {
+		replay->end_ns = out->free_ns;
+	}
+	replay->frames++;
+	replay->bytes += size;
+	return 0;
+}
+
+
+int replay_capture( replay_t * replay, illuminatir_capture_reader_t * reader, int timed, volatile sig_atomic_t * quit )
+{
+	if( !replay || !replay->outputs_count || !reader ) {
+		errno = EINVAL;
+		return -1;
+	}
+	illuminatir_capture_record_t record;
+	uint64_t first = 0;
+	int have_first = 0;
+	while( !(quit && *quit) && illuminatir_capture_next( reader, &record ) ) {
+		if( !have_first ) {
+			first      = record.timestamp;
+			have_first = 1;
+		}
+		uint64_t at = timed ? record.timestamp - first : 0;
+		if( replay_send( replay, record.port % replay->outputs_count, record.data, record.size, at ) ) {
+			return errno == EINTR ? 0 : -1;
+		}
+	}
+	return 0;
+}
+
+
+int replay_generate( replay_t * replay, uint64_t frames, uint8_t packets, volatile sig_atomic_t * quit )
+{
+	if( !replay || !replay->outputs_count || !packets || packets > REPLAY_FRAME_PACKETS_MAX ) {
+		errno = EINVAL;
+		return -1;
+	}
+	uint8_t buffer[REPLAY_FRAME_BUFFER_SIZE];
+	illuminatir_frame_t frame;
+	illuminatir_frame_init( &frame, buffer, sizeof(buffer) );
+	for( uint64_t n = 0; (!frames || n < frames) && !(quit && *quit); n++ ) {
+		for( uint8_t p = 0; p < packets; p++ ) {
+			uint8_t values[ILLUMINATIR_OFFSETARRAY_MAXVALUES];
+			for( uint8_t i = 0; i < ILLUMINATIR_OFFSETARRAY_MAXVALUES; i++ ) {
+				values[i] = illuminatir_lfsr127_uint8_r( &replay->lfsr );
+			}
+			illuminatir_frame_add_offsetArray( &frame, (uint8_t)(replay->block * ILLUMINATIR_OFFSETARRAY_MAXVALUES), values, ILLUMINATIR_OFFSETARRAY_MAXVALUES );
+			replay->block = (uint8_t)((replay->block + 1) % REPLAY_BLOCKS);
+		}
+		size_t size;
+		illuminatir_rand_cobs_frame_finalize( &frame, &size );
+
+		// Paced outputs take turns by which line gets free first.
+		unsigned output = (unsigned)(n % replay->outputs_count);
+		if( replay->baud ) {
+			for( unsigned i = 0; i < replay->outputs_count; i++ ) {
+				if( replay->outputs[i].free_ns < replay->outputs[output].free_ns ) {
+					output = i;
+				}
+			}
+		}
+		if( replay_send( replay, output, buffer, size, 0 ) ) {
+			return errno == EINTR ? 0 : -1;
+		}
+	}
+	return 0;
+}
+
+
+void replay_getStats( const replay_t * replay, replay_stats_t * stats )
+{
+	memset( stats, 0, sizeof(*stats) );
+	if( !replay ) {
+		return;
+	}
+	stats->frames      = replay->frames;
+	stats->bytes       = replay->bytes;
+	stats->elapsed_ns  = replay->end_ns;
+	stats->late_ns_max = replay->late_max;
+	if( replay->paced ) {
+		stats->late_ns_mean   = replay->late_mean;
+		stats->late_ns_stddev = sqrt( replay->late_m2 / (double)replay->paced );
+	}
+}
@@ -0,0 +1,79 @@
+#ifndef ILLUMINATIR_REPLAY_INCLUDED
+#define ILLUMINATIR_REPLAY_INCLUDED
+
+#include <illuminatir.h>
+#include <illuminatir_capture.h>
+
+#include <signal.h>
+#include <stddef.h>
+#include <stdint.h>
+
+
+// Replay engine of illuminatir-replay: frames from a capture or a generator
+// are written to outputs, each paced like a serial line of the given baud
+// rate. A frame is written once the previous one on its output would have
+// left the line, so a receiver sees the same load as from real hardware.
+// Writes block until they are done, one output at a time.
+//
+// Pacing jitter is how late writes started against their schedule, caused
+// by the sleep granularity and outputs not accepting the bytes in time.
+
+
+#define REPLAY_FRAME_PACKETS_MAX 8 // OffsetArray packets per generated frame.
+
+
+typedef struct replay replay_t;
+
+
+typedef struct {
+	uint64_t frames;      // Frames written.
+	uint64_t bytes;       // Bytes written, including delimiters.
+	uint64_t elapsed_ns;  // From the first write until the last frame left the line, or was written if not paced.
+	uint64_t late_ns_max; // Latest start of a paced write.
+	double   late_ns_mean;
+	double   late_ns_stddev;
+} replay_stats_t;
+
+
+// Creates an engine pacing at baud (0 writes as fast as possible) with
+// bits_per_byte bits on the line per byte. Returns NULL on failure with
+// errno set.
+replay_t * replay_create( unsigned baud, unsigned bits_per_byte );
+
+// Closes all outputs.
+void replay_destroy( replay_t * replay );
+
+// Returns the bits per byte of a character format like "8N1": 5 to 8 data
+// bits, parity N, E, O, M or S and 1 or 2 stop bits, plus the start bit.
+// Returns -1 for invalid formats.
+int replay_parseFormat( const char * format );
+
+// Adds a file descriptor as output, which is closed by the engine. Returns its number or -1 with errno set.
+int replay_addOutput( replay_t * replay, int fd );
+
+// Opens a serial device or pty in raw mode with the given baud rate (0 keeps
+// the current one) and adds it. Paths that are no character devices are
+// created or truncated as regular files. Returns its number or -1 with
+// errno set.
+int replay_openOutput( replay_t * replay, const char * path, unsigned baud );
+
+// Writes a frame to an output once its line is free, but not before at_ns
+// after the first write. Returns 0 or -1 with errno set.
+int replay_send( replay_t * replay, unsigned output, const uint8_t * data, size_t size, uint64_t at_ns );
+
+// Writes the records of a capture, those of port N to output N modulo the
+// number of outputs. If timed, records are written no earlier than their
+// timestamps relative to the first record, otherwise back to back. Stops at
+// the end of the capture or once *quit is set. Returns 0 or -1 with errno set.
+int replay_capture( replay_t * replay, illuminatir_capture_reader_t * reader, int timed, volatile sig_atomic_t * quit );
+
+// Writes frames of packets random OffsetArray packets, randomized and COBS
+// encoded, to the outputs in turn, the next one going to the output whose
+// line gets free first. Stops after frames frames (0 for no limit) or once
+// *quit is set. Returns 0 or -1 with errno set.
+int replay_generate( replay_t * replay, uint64_t frames, uint8_t packets, volatile sig_atomic_t * quit );
+
+void replay_getStats( const replay_t * replay, replay_stats_t * stats );
+
+
+#endif
@@ -0,0 +1,152 @@
+#define _GNU_SOURCE
+
+#include "rxd.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+static volatile sig_atomic_t quit = 0;
+
+
+static void onSignal( int signal )
+{
+	(void)signal;
+	quit = 1;
+}
+
+
+static void printChannels( void * ctx, unsigned port, uint8_t first_channel, const uint8_t * values, uint8_t count )
+{
+	(void)ctx;
+	char line[32 + 4 * 256];
+	int len = snprintf( line, sizeof(line), "%u channels %u", port, first_channel );
+	for( uint8_t i = 0; i < count; i++ ) {
+		len += snprintf( line + len, sizeof(line) - (size_t)len, " %u", values[i] );
+	}
+	line[len++] = '\n';
+	fwrite( line, 1, (size_t)len, stdout ); // one call per line, so lines of different workers do not mix
+}
+
+
+static void printConfig( void * ctx, unsigned port, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size )
+{
+	(void)ctx;
+	char line[64 + 3 * ILLUMINATIR_CONFIG_VALUES_MAXSIZE];
+	int len = snprintf( line, sizeof(line), "%u config %.*s", port, (int)key_len, key );
+	for( uint8_t i = 0; i < values_size; i++ ) {
+		len += snprintf( line + len, sizeof(line) - (size_t)len, " %02x", values[i] );
+	}
+	line[len++] = '\n';
+	fwrite( line, 1, (size_t)len, stdout );
+}
+
+
+static void printError( void * ctx, unsigned port, illuminatir_error_t err )
+{
+	const char * const * devices = ctx;
+	if( err == ILLUMINATIR_ERROR_NONE ) {
+		fprintf( stderr, "%u: %s hung up\n", port, devices[port] );
+	}
+}
+
+
+static void usage( const char * program )
+{
+	fprintf( stderr,
+		"Usage: %s [options] device...\n"
+		"Receives IlluminatIR packets from many serial devices and prints Config payloads.\n"
+		"  -w WORKERS  Number of worker threads. (default: online CPUs, at most 4)\n"
+		"  -b BAUD     Baud rate to configure. (default: keep)\n"
+		"  -p          Packets are plain COBS encoded, not randomized.\n"
+		"  -n          Do not pin workers to CPUs.\n"
+		"  -v          Also print channel updates.\n"
+		"  -s SECONDS  Print per-port statistics to stderr periodically.\n",
+		program );
+}
+
+
+int main( int argc, char ** argv )
+{
+	long cpus = sysconf( _SC_NPROCESSORS_ONLN );
+	rxd_config_t config = {
+		.workers    = cpus < 1 ? 1 : cpus > 4 ? 4 : (unsigned)cpus,
+		.pin        = 1,
+		.randomized = 1,
+		.setConfig  = printConfig,
+		.error      = printError,
+	};
+	unsigned baud = 0, stats_interval = 0;
+	int opt;
+	while( (opt = getopt( argc, argv, "w:b:pnvs:h" )) != -1 ) {
+		switch( opt ) {
+			case 'w': config.workers  = (unsigned)strtoul( optarg, NULL, 0 ); break;
+			case 'b': baud            = (unsigned)strtoul( optarg, NULL, 0 ); break;
+			case 'p': config.randomized = 0; break;
+			case 'n': config.pin      = 0; break;
+			case 'v': config.setChannels = printChannels; break;
+			case 's': stats_interval  = (unsigned)strtoul( optarg, NULL, 0 ); break;
+			default:
+				usage( argv[0] );
+				return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+	if( optind >= argc || !config.workers ) {
+		usage( argv[0] );
+		return EXIT_FAILURE;
+	}
+	const char * const * devices = (const char * const *)argv + optind;
+	config.ctx = (void *)devices;
+
+	rxd_t * rxd = rxd_create( &config );
+	if( !rxd ) {
+		perror( "rxd_create" );
+		return EXIT_FAILURE;
+	}
+	for( int i = optind; i < argc; i++ ) {
+		if( rxd_openPort( rxd, argv[i], baud ) < 0 ) {
+			fprintf( stderr, "%s: %s\n", argv[i], strerror( errno ) );
+			rxd_destroy( rxd );
+			return EXIT_FAILURE;
+		}
+	}
+
+	struct sigaction action;
+	memset( &action, 0, sizeof(action) );
+	action.sa_handler = onSignal;
+	sigaction( SIGINT, &action, NULL );
+	sigaction( SIGTERM, &action, NULL );
+	setvbuf( stdout, NULL, _IOLBF, 0 );
+
+	if( rxd_start( rxd ) ) {
+		perror( "rxd_start" );
+		rxd_destroy( rxd );
+		return EXIT_FAILURE;
+	}
+
+	unsigned seconds = 0;
+	while( !quit ) {
+		sleep( 1 );
+		unsigned open = 0;
+		for( unsigned port = 0; port < rxd_getPorts( rxd ); port++ ) {
+			rxd_stats_t stats;
+			rxd_getStats( rxd, port, &stats );
+			open += stats.open != 0;
+			if( stats_interval && (seconds + 1) % stats_interval == 0 ) {
+				fprintf( stderr, "%u %s: %llu bytes, %llu payloads, %llu errors%s\n", port, devices[port],
+					(unsigned long long)stats.bytes, (unsigned long long)stats.payloads, (unsigned long long)stats.errors, stats.open ? "" : ", closed" );
+			}
+		}
+		seconds++;
+		if( !open ) {
+			break;
+		}
+	}
+
+	rxd_destroy( rxd );
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,386 @@
+#define _GNU_SOURCE
+
+#include "rxd.h"
+#include "serial.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+
+#define RXD_EVENTS 64 // Ready ports handled per epoll_wait
+
+
+typedef struct rxd_worker rxd_worker_t;
+
+
+typedef struct {
+	rxd_t *                rxd;
+	unsigned               index;
+	int                    fd;
+	illuminatir_stream_t   stream;
+	illuminatir_universe_t universe;
+	// Only written by the port's worker, but read by anyone.
+	_Atomic uint64_t       bytes;
+	_Atomic uint64_t       payloads;
+	_Atomic uint64_t       errors;
+	_Atomic int            open;
+	uint8_t                frame[RXD_FRAME_MAXSIZE];
+} rxd_port_t;
+
+
+struct rxd_worker {
+	rxd_t *   rxd;
+	int       epoll_fd;
+	int       stop_fd;
+	unsigned  ports;
+	int       running;
+	pthread_t thread;
+};
+
+
+struct rxd {
+	rxd_config_t   config;
+	rxd_worker_t * workers;
+	rxd_port_t **  ports;
+	unsigned       ports_count;
+	unsigned       ports_capacity;
+	int            started;
+};
+
+
+// Counters have a single writer, so a plain load and store is enough.
+static inline void rxd_count( _Atomic uint64_t * counter, uint64_t n )
+{
+	atomic_store_explicit( counter, atomic_load_explicit( counter, memory_order_relaxed ) + n, memory_order_relaxed );
+}
+
+
+static void rxd_port_setChannels( void * ctx, uint8_t first_channel, const uint8_t * values, uint8_t count )
+{
+	rxd_port_t * port = ctx;
+	illuminatir_universe_setChannels( &port->universe, first_channel, values, count );
+	rxd_count( &port->payloads, 1 );
+	if( port->rxd->config.setChannels ) {
+		port->rxd->config.setChannels( port->rxd->config.ctx, port->index, first_channel, values, count );
+	}
+}
+
+
+static void rxd_port_setChannelValuePairs( void * ctx, const uint8_t * pairs, uint8_t count )
+{
+	rxd_port_t * port = ctx;
+	illuminatir_universe_setChannelValuePairs( &port->universe, pairs, count );
+	rxd_count( &port->payloads, 1 );
+	if( port->rxd->config.setChannels ) {
+		for( uint8_t i = 0; i < count; i++ ) {
+			port->rxd->config.setChannels( port->rxd->config.ctx, port->index, pairs[i * 2], &pairs[i * 2 + 1], 1 );
+		}
+	}
+}
+
+
+static void rxd_port_setConfig( void * ctx, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size )
+{
+	rxd_port_t * port = ctx;
+	rxd_count( &port->payloads, 1 );
+	if( port->rxd->config.setConfig ) {
+		port->rxd->config.setConfig( port->rxd->config.ctx, port->index, key, key_len, values, values_size );
+	}
+}
+
+
+static void rxd_port_close( rxd_worker_t * worker, rxd_port_t * port )
+{
+	epoll_ctl( worker->epoll_fd, EPOLL_CTL_DEL, port->fd, NULL );
+	close( port->fd );
+	port->fd = -1;
+	atomic_store_explicit( &port->open, 0, memory_order_relaxed );
+	if( port->rxd->config.error ) {
+		port->rxd->config.error( port->rxd->config.ctx, port->index, ILLUMINATIR_ERROR_NONE );
+	}
+}
+
+
+// Reads at most RXD_READ_SIZE bytes, so a busy port cannot delay the others
+// for long. Level triggering brings the worker back for the rest.
+static void rxd_port_read( rxd_worker_t * worker, rxd_port_t * port, uint32_t events )
+{
+	if( events & EPOLLIN ) {
+		uint8_t buffer[RXD_READ_SIZE];
+		ssize_t received = read( port->fd, buffer, sizeof(buffer) );
+		if( received > 0 ) {
+			rxd_count( &port->bytes, (uint64_t)received );
+			for( ssize_t i = 0; i < received; i++ ) {
+				illuminatir_error_t err = illuminatir_stream_feedByte( &port->stream, buffer[i] );
+				if( err != ILLUMINATIR_ERROR_NONE ) {
+					rxd_count( &port->errors, 1 );
+					if( port->rxd->config.error ) {
+						port->rxd->config.error( port->rxd->config.ctx, port->index, err );
+					}
+				}
+			}
+			return;
+		}
+		if( received < 0 && (errno == EAGAIN || errno == EINTR) ) {
+			return;
+		}
+		rxd_port_close( worker, port ); // end of file or read error, e.g. EIO of a hung up tty
+		return;
+	}
+	if( events & (EPOLLHUP | EPOLLERR) ) {
+		rxd_port_close( worker, port );
+	}
+}
+
+
+static void * rxd_worker_run( void * arg )
+{
+	rxd_worker_t * worker = arg;
+	struct epoll_event events[RXD_EVENTS];
+	for( ;; ) {
+		int ready = epoll_wait( worker->epoll_fd, events, RXD_EVENTS, -1 );
+		if( ready < 0 ) {
+			if( errno == EINTR ) {
+				continue;
+			}
+			return NULL;
+		}
+		for( int i = 0; i < ready; i++ ) {
+			if( !events[i].data.ptr ) { // stop_fd
+				return NULL;
+			}
+			rxd_port_read( worker, events[i].data.ptr, events[i].events );
+		}
+	}
+}
+
+
+rxd_t * rxd_create( const rxd_config_t * config )
+{
+	if( !config || !config->workers ) {
+		errno = EINVAL;
+		return NULL;
+	}
+	rxd_t * rxd = calloc( 1, sizeof(*rxd) );
+	if( !rxd ) {
+		return NULL;
+	}
+	rxd->config = *config;
+	rxd->workers = calloc( config->workers, sizeof(*rxd->workers) );
+	if( !rxd->workers ) {
+		free( rxd );
+		return NULL;
+	}
+	for( unsigned i = 0; i < config->workers; i++ ) {
+		rxd->workers[i].epoll_fd = -1;
+		rxd->workers[i].stop_fd  = -1;
+	}
+	for( unsigned i = 0; i < config->workers; i++ ) {
+		rxd_worker_t * worker = &rxd->workers[i];
+		worker->rxd      = rxd;
+		worker->epoll_fd = epoll_create1( EPOLL_CLOEXEC );
+		worker->stop_fd  = eventfd( 0, EFD_CLOEXEC | EFD_NONBLOCK );
+		struct epoll_event event = { .events = EPOLLIN, .data.ptr = NULL };
+		if( worker->epoll_fd < 0 || worker->stop_fd < 0 || epoll_ctl( worker->epoll_fd, EPOLL_CTL_ADD, worker->stop_fd, &event ) ) {
+			int err = errno;
+			rxd_destroy( rxd );
+			errno = err;
+			return NULL;
+		}
+	}
+	return rxd;
+}
+
+
+void rxd_destroy( rxd_t * rxd )
+{
+	if( !rxd ) {
+		return;
+	}
+	rxd_stop( rxd );
+	for( unsigned i = 0; i < rxd->ports_count; i++ ) {
+		if( rxd->ports[i]->fd >= 0 ) {
+			close( rxd->ports[i]->fd );
+		}
+		free( rxd->ports[i] );
+	}
+	free( rxd->ports );
+	for( unsigned i = 0; i < rxd->config.workers; i++ ) {
+		if( rxd->workers[i].epoll_fd >= 0 ) {
+			close( rxd->workers[i].epoll_fd );
+		}
+		if( rxd->workers[i].stop_fd >= 0 ) {
+			close( rxd->workers[i].stop_fd );
+		}
+	}
+	free( rxd->workers );
+	free( rxd );
+}
+
+
+int rxd_addPort( rxd_t * rxd, int fd )
+{
+	if( !rxd || fd < 0 || rxd->started ) {
+		errno = EINVAL;
+		return -1;
+	}
+	int flags = fcntl( fd, F_GETFL );
+	if( flags < 0 || fcntl( fd, F_SETFL, flags | O_NONBLOCK ) ) {
+		return -1;
+	}
+	if( rxd->ports_count == rxd->ports_capacity ) {
+		unsigned capacity = rxd->ports_capacity ? rxd->ports_capacity * 2 : 16;
+		rxd_port_t ** ports = realloc( rxd->ports, capacity * sizeof(*ports) );
+		if( !ports ) {
+			return -1;
+		}
+		rxd->ports = ports;
+		rxd->ports_capacity = capacity;
+	}
+	rxd_port_t * port = calloc( 1, sizeof(*port) );
+	if( !port ) {
+		return -1;
+	}
+	port->rxd   = rxd;
+	port->index = rxd->ports_count;
+	port->fd    = fd;
+	atomic_init( &port->bytes, 0 );
+	atomic_init( &port->payloads, 0 );
+	atomic_init( &port->errors, 0 );
+	atomic_init( &port->open, 1 );
+	illuminatir_universe_init( &port->universe, NULL );
+	illuminatir_handler_t handler = { port, rxd_port_setChannels, rxd_port_setChannelValuePairs, rxd_port_setConfig };
+	if( rxd->config.randomized ) {
+		illuminatir_rand_stream_init_handler( &port->stream, port->frame, sizeof(port->frame), &handler );
+	} else {
+		illuminatir_stream_init_handler( &port->stream, &handler );
+	}
+
+	rxd_worker_t * worker = &rxd->workers[0];
+	for( unsigned i = 1; i < rxd->config.workers; i++ ) {
+		if( rxd->workers[i].ports < worker->ports ) {
+			worker = &rxd->workers[i];
+		}
+	}
+	struct epoll_event event = { .events = EPOLLIN, .data.ptr = port };
+	if( epoll_ctl( worker->epoll_fd, EPOLL_CTL_ADD, fd, &event ) ) {
+		free( port );
+		return -1;
+	}
+	worker->ports++;
+	rxd->ports[rxd->ports_count++] = port;
+	return (int)port->index;
+}
+
+
+int rxd_openPort( rxd_t * rxd, const char * path, unsigned baud )
+{
+	if( !rxd ) {
+		errno = EINVAL;
+		return -1;
+	}
+	int fd = serial_open( path, baud );
+	if( fd < 0 ) {
+		return -1;
+	}
+	int port = rxd_addPort( rxd, fd );
+	if( port < 0 ) {
+		int err = errno;
+		close( fd );
+		errno = err;
+	}
+	return port;
+}
+
+
+int rxd_start( rxd_t * rxd )
+{
+	if( !rxd || rxd->started ) {
+		errno = EINVAL;
+		return -1;
+	}
+	cpu_set_t allowed;
+	int pin = rxd->config.pin && !sched_getaffinity( 0, sizeof(allowed), &allowed ) && CPU_COUNT( &allowed ) > 0;
+	int cpu = -1;
+	rxd->started = 1;
+	for( unsigned i = 0; i < rxd->config.workers; i++ ) {
+		rxd_worker_t * worker = &rxd->workers[i];
+		int err = pthread_create( &worker->thread, NULL, rxd_worker_run, worker );
+		if( err ) {
+			rxd_stop( rxd );
+			errno = err;
+			return -1;
+		}
+		worker->running = 1;
+		if( pin ) { // round-robin over the CPUs this process may use
+			do {
+				cpu = (cpu + 1) % CPU_SETSIZE;
+			} while( !CPU_ISSET( cpu, &allowed ) );
+			cpu_set_t set;
+			CPU_ZERO( &set );
+			CPU_SET( cpu, &set );
+			pthread_setaffinity_np( worker->thread, sizeof(set), &set );
+		}
+	}
+	return 0;
+}
+
+
+void rxd_stop( rxd_t * rxd )
+{
+	if( !rxd ) {
+		return;
+	}
+	for( unsigned i = 0; i < rxd->config.workers; i++ ) {
+		rxd_worker_t * worker = &rxd->workers[i];
+		if( !worker->running ) {
+			continue;
+		}
+		uint64_t one = 1;
+		if( write( worker->stop_fd, &one, sizeof(one) ) != sizeof(one) ) {
+			pthread_cancel( worker->thread );
+		}
+		pthread_join( worker->thread, NULL );
+		worker->running = 0;
+		// Drained so a later rxd_start does not stop the worker right away.
+		uint64_t value;
+		(void)!read( worker->stop_fd, &value, sizeof(value) );
+	}
+	rxd->started = 0;
+}
+
+
+unsigned rxd_getPorts( const rxd_t * rxd )
+{
+	return rxd ? rxd->ports_count : 0;
+}
+
+
+const illuminatir_universe_t * rxd_getUniverse( const rxd_t * rxd, unsigned port )
+{
+	if( !rxd || port >= rxd->ports_count ) {
+		return NULL;
+	}
+	return &rxd->ports[port]->universe;
+}
+
+
+void rxd_getStats( const rxd_t * rxd, unsigned port, rxd_stats_t * stats )
+{
+	if( !rxd || !stats || port >= rxd->ports_count ) {
+		return;
+	}
+	const rxd_port_t * p = rxd->ports[port];
+	stats->bytes    = atomic_load_explicit( &p->bytes, memory_order_relaxed );
+	stats->payloads = atomic_load_explicit( &p->payloads, memory_order_relaxed );
+	stats->errors   = atomic_load_explicit( &p->errors, memory_order_relaxed );
+	stats->open     = atomic_load_explicit( &p->open, memory_order_relaxed );
+}
@@ -0,0 +1,76 @@
+#ifndef ILLUMINATIR_RXD_INCLUDED
+#define ILLUMINATIR_RXD_INCLUDED
+
+#include <illuminatir.h>
+#include <illuminatir_universe.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+// Receiver engine of illuminatir-rxd: ports are spread over a few worker
+// threads, each waiting on its own epoll instance and running the streaming
+// decoders of its ports. Every port decodes into its own universe.
+
+
+#define RXD_FRAME_MAXSIZE 256 // Largest decoded randomized frame per port.
+#define RXD_READ_SIZE     256 // Bytes read per port and wakeup, bounding the time other ports wait.
+
+
+typedef struct rxd rxd_t;
+
+
+typedef struct {
+	unsigned workers;    // Number of worker threads, at least 1.
+	int      pin;        // Pin worker i to CPU (i % online CPUs).
+	int      randomized; // Ports receive randomized packets.
+	void *   ctx;        // Passed to the functions below.
+	// Called from the port's worker after a payload was written into the port's universe. May be NULL.
+	void   (*setChannels)( void * ctx, unsigned port, uint8_t first_channel, const uint8_t * values, uint8_t count );
+	// Called from the port's worker for each Config payload. May be NULL.
+	void   (*setConfig)( void * ctx, unsigned port, const char * key, uint8_t key_len, const uint8_t * values, uint8_t values_size );
+	// Called from the port's worker for invalid packets or frames, and with ILLUMINATIR_ERROR_NONE once a port hung up. May be NULL.
+	void   (*error)( void * ctx, unsigned port, illuminatir_error_t err );
+} rxd_config_t;
+
+
+typedef struct {
+	uint64_t bytes;    // Bytes received.
+	uint64_t payloads; // Payloads dispatched.
+	uint64_t errors;   // Invalid packets or frames.
+	int      open;     // Zero once the port hung up or failed.
+} rxd_stats_t;
+
+
+// Returns NULL on failure with errno set.
+rxd_t * rxd_create( const rxd_config_t * config );
+
+// Stops the workers and closes all ports.
+void rxd_destroy( rxd_t * rxd );
+
+// Adds a non-blocking file descriptor, which is closed by the engine, and
+// returns its port number or -1 with errno set. Ports are assigned to the
+// worker with the fewest ports. Must be called while the workers are stopped.
+int rxd_addPort( rxd_t * rxd, int fd );
+
+// Opens a serial device in raw mode with the given baud rate (0 keeps the
+// current one) and adds it. Returns the port number or -1 with errno set.
+int rxd_openPort( rxd_t * rxd, const char * path, unsigned baud );
+
+// Starts the workers. Returns 0 or -1 with errno set.
+int rxd_start( rxd_t * rxd );
+
+// Stops the workers, keeping the ports open until rxd_destroy. The workers
+// can be started again with rxd_start.
+void rxd_stop( rxd_t * rxd );
+
+unsigned rxd_getPorts( const rxd_t * rxd );
+
+// The channels received on a port. Safe to read from any thread.
+const illuminatir_universe_t * rxd_getUniverse( const rxd_t * rxd, unsigned port );
+
+// Counters of a port. Safe to call from any thread, but not a consistent snapshot.
+void rxd_getStats( const rxd_t * rxd, unsigned port, rxd_stats_t * stats );
+
+
+#endif
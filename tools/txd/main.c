@@ -0,0 +1,92 @@
+#define _GNU_SOURCE
+
+#include "txd.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+static volatile sig_atomic_t quit = 0;
+
+
+static void onSignal( int signal )
+{
+	(void)signal;
+	quit = 1;
+}
+
+
+static void usage( const char * program )
+{
+	fprintf( stderr,
+		"Usage: %s [options] -s SOCKET output...\n"
+		"Sends the channels set by clients of a Unix socket to serial devices.\n"
+		"  -s SOCKET   Path of the Unix socket to listen on.\n"
+		"  -t MS       Tick interval in milliseconds. (default 20)\n"
+		"  -r BLOCKS   OffsetArray blocks of unchanged channels to refresh per tick. (default 1)\n"
+		"  -b BAUD     Baud rate to configure. (default: keep)\n",
+		program );
+}
+
+
+int main( int argc, char ** argv )
+{
+	const char * socket_path = NULL;
+	unsigned tick_ms = 20, refresh_blocks = 1, baud = 0;
+	int opt;
+	while( (opt = getopt( argc, argv, "s:t:r:b:h" )) != -1 ) {
+		switch( opt ) {
+			case 's': socket_path    = optarg; break;
+			case 't': tick_ms        = (unsigned)strtoul( optarg, NULL, 0 ); break;
+			case 'r': refresh_blocks = (unsigned)strtoul( optarg, NULL, 0 ); break;
+			case 'b': baud           = (unsigned)strtoul( optarg, NULL, 0 ); break;
+			default:
+				usage( argv[0] );
+				return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+	if( !socket_path || optind >= argc || !tick_ms || refresh_blocks > 255 ) {
+		usage( argv[0] );
+		return EXIT_FAILURE;
+	}
+
+	txd_t * txd = txd_create( tick_ms * 1000, (uint8_t)refresh_blocks );
+	if( !txd ) {
+		perror( "txd_create" );
+		return EXIT_FAILURE;
+	}
+	for( int i = optind; i < argc; i++ ) {
+		if( txd_openOutput( txd, argv[i], baud ) < 0 ) {
+			fprintf( stderr, "%s: %s\n", argv[i], strerror( errno ) );
+			txd_destroy( txd );
+			return EXIT_FAILURE;
+		}
+	}
+	if( txd_listen( txd, socket_path ) ) {
+		fprintf( stderr, "%s: %s\n", socket_path, strerror( errno ) );
+		txd_destroy( txd );
+		return EXIT_FAILURE;
+	}
+
+	struct sigaction action;
+	memset( &action, 0, sizeof(action) );
+	action.sa_handler = onSignal;
+	sigaction( SIGINT, &action, NULL );
+	sigaction( SIGTERM, &action, NULL );
+	signal( SIGPIPE, SIG_IGN );
+
+	int status = EXIT_SUCCESS;
+	while( !quit ) {
+		if( txd_poll( txd, 1000 ) ) {
+			perror( "txd_poll" );
+			status = EXIT_FAILURE;
+			break;
+		}
+	}
+	txd_destroy( txd );
+	return status;
+}
@@ -0,0 +1,614 @@
+#define _GNU_SOURCE
+
+#include "txd.h"
+#include "serial.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+
+#define TXD_EVENTS 64
+
+// Raw packets of one tick: the planned changes, refreshed blocks and Config packets.
+#define TXD_PACKETS_MAXSIZE (ILLUMINATIR_PLAN_MAXSIZE + (ILLUMINATIR_CHANNELS / ILLUMINATIR_OFFSETARRAY_MAXVALUES + TXD_CONFIGS) * ILLUMINATIR_PACKET_MAXSIZE)
+// Encoded frames of one tick, each holding at most TXD_FRAME_PACKETS_MAX bytes of packets.
+#define TXD_PENDING_MAXSIZE ((TXD_PACKETS_MAXSIZE / TXD_FRAME_PACKETS_MAX + 1) * ILLUMINATIR_FRAME_BUFFER_SIZE(TXD_FRAME_PACKETS_MAX))
+
+#define TXD_BLOCKS (ILLUMINATIR_CHANNELS / ILLUMINATIR_OFFSETARRAY_MAXVALUES)
+
+
+// Every object registered with epoll starts with its kind.
+typedef enum {
+	TXD_KIND_TIMER,
+	TXD_KIND_LISTENER,
+	TXD_KIND_CLIENT,
+	TXD_KIND_OUTPUT,
+} txd_kind_t;
+
+
+typedef struct {
+	txd_kind_t kind;
+	int        fd;
+	uint16_t   received_len;
+	uint8_t    received[2 + 255]; // one message at most
+} txd_client_t;
+
+
+typedef struct {
+	txd_kind_t  kind;
+	int         fd;
+	int         sent_valid;                 // sent holds what the receivers know
+	uint8_t     sent[ILLUMINATIR_CHANNELS];
+	uint8_t     refresh;                    // next block to refresh
+	uint8_t     configs_count;
+	uint8_t     configs_size[TXD_CONFIGS];
+	uint8_t     configs[TXD_CONFIGS][ILLUMINATIR_PACKET_MAXSIZE];
+	int         waiting;                    // registered for EPOLLOUT
+	size_t      pending_offset;
+	size_t      pending_size;
+	uint8_t     pending[TXD_PENDING_MAXSIZE];
+	txd_stats_t stats;
+} txd_output_t;
+
+
+struct txd {
+	int             epoll_fd;
+	txd_kind_t      timer;    // epoll tag of timer_fd
+	int             timer_fd;
+	txd_kind_t      listener; // epoll tag of listen_fd
+	int             listen_fd;
+	char            listen_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+	uint8_t         refresh_blocks;
+	uint8_t         universe[ILLUMINATIR_CHANNELS];
+	txd_client_t ** clients;
+	unsigned        clients_count;
+	txd_output_t ** outputs;
+	unsigned        outputs_count;
+};
+
+
+static void * txd_append( void * array, unsigned count, size_t element_size )
+{
+	if( count & (count - 1) ) { // grown at powers of two
+		return array;
+	}
+	return realloc( array, (count ? count * 2 : 1) * element_size );
+}
+
+
+// Clients are only freed by txd_client_sweep, as epoll may still report them within the same batch.
+static void txd_client_close( txd_t * txd, txd_client_t * client )
+{
+	if( client->fd < 0 ) {
+		return;
+	}
+	epoll_ctl( txd->epoll_fd, EPOLL_CTL_DEL, client->fd, NULL );
+	close( client->fd );
+	client->fd = -1;
+}
+
+
+static void txd_client_sweep( txd_t * txd )
+{
+	unsigned kept = 0;
+	for( unsigned i = 0; i < txd->clients_count; i++ ) {
+		if( txd->clients[i]->fd < 0 ) {
+			free( txd->clients[i] );
+		} else {
+			txd->clients[kept++] = txd->clients[i];
+		}
+	}
+	txd->clients_count = kept;
+}
+
+
+static void txd_output_close( txd_t * txd, txd_output_t * output )
+{
+	if( output->fd < 0 ) {
+		return;
+	}
+	epoll_ctl( txd->epoll_fd, EPOLL_CTL_DEL, output->fd, NULL );
+	close( output->fd );
+	output->fd = -1;
+	output->stats.open = 0;
+}
+
+
+// Queues a Config packet for every output.
+static void txd_queueConfig( txd_t * txd, const uint8_t * packet, uint8_t packet_size )
+{
+	for( unsigned i = 0; i < txd->outputs_count; i++ ) {
+		txd_output_t * output = txd->outputs[i];
+		if( output->configs_count == TXD_CONFIGS ) {
+			output->stats.configs_dropped++;
+			continue;
+		}
+		memcpy( output->configs[output->configs_count], packet, packet_size );
+		output->configs_size[output->configs_count++] = packet_size;
+	}
+}
+
+
+// Applies one message, returning 0 if it is malformed.
+static int txd_client_message( txd_t * txd, uint8_t type, const uint8_t * body, uint8_t body_size )
+{
+	switch( type ) {
+		case TXD_MSG_SET_CHANNELS:
+			if( body_size & 1 ) {
+				return 0;
+			}
+			for( uint8_t i = 0; i < body_size; i += 2 ) {
+				txd->universe[body[i]] = body[i + 1];
+			}
+			return 1;
+		case TXD_MSG_SET_RANGE:
+			if( !body_size ) {
+				return 0;
+			}
+			for( uint8_t i = 1; i < body_size; i++ ) {
+				txd->universe[(uint8_t)(body[0] + i - 1)] = body[i];
+			}
+			return 1;
+		case TXD_MSG_CONFIG: {
+			if( !body_size || body[0] > body_size - 1 ) {
+				return 0;
+			}
+			uint8_t key_len = body[0];
+			uint8_t packet[ILLUMINATIR_PACKET_MAXSIZE];
+			uint8_t packet_size = sizeof(packet);
+			if( illuminatir_build_config( packet, &packet_size, (const char *)body + 1, key_len, body + 1 + key_len, body_size - 1 - key_len ) != ILLUMINATIR_ERROR_NONE ) {
+				return 0;
+			}
+			txd_queueConfig( txd, packet, packet_size );
+			return 1;
+		}
+		default:
+			return 0;
+	}
+}
+
+
+static void txd_client_read( txd_t * txd, txd_client_t * client )
+{
+	ssize_t received = read( client->fd, client->received + client->received_len, sizeof(client->received) - client->received_len );
+	if( received < 0 && (errno == EAGAIN || errno == EINTR) ) {
+		return;
+	}
+	if( received <= 0 ) {
+		txd_client_close( txd, client );
+		return;
+	}
+	client->received_len += (uint16_t)received;
+	uint16_t offset = 0;
+	while( client->received_len - offset >= 2 && client->received_len - offset >= 2 + client->received[offset + 1] ) {
+		const uint8_t * message = client->received + offset;
+		if( !txd_client_message( txd, message[0], message + 2, message[1] ) ) {
+			txd_client_close( txd, client );
+			return;
+		}
+		offset += 2 + message[1];
+	}
+	client->received_len -= offset;
+	memmove( client->received, client->received + offset, client->received_len );
+}
+
+
+static void txd_accept( txd_t * txd )
+{
+	int fd = accept4( txd->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC );
+	if( fd >= 0 && txd_addClient( txd, fd ) ) {
+		close( fd );
+	}
+}
+
+
+static void txd_output_write( txd_t * txd, txd_output_t * output )
+{
+	while( output->pending_offset < output->pending_size ) {
+		ssize_t written = write( output->fd, output->pending + output->pending_offset, output->pending_size - output->pending_offset );
+		if( written < 0 ) {
+			if( errno == EINTR ) {
+				continue;
+			}
+			if( errno != EAGAIN ) {
+				txd_output_close( txd, output );
+				return;
+			}
+			break;
+		}
+		output->pending_offset += (size_t)written;
+		output->stats.bytes += (uint64_t)written;
+	}
+	int waiting = output->pending_offset < output->pending_size;
+	if( waiting != output->waiting ) {
+		struct epoll_event event = { .events = waiting ? EPOLLOUT : 0, .data.ptr = output };
+		epoll_ctl( txd->epoll_fd, EPOLL_CTL_MOD, output->fd, &event );
+		output->waiting = waiting;
+	}
+	if( !waiting ) {
+		output->pending_offset = 0;
+		output->pending_size = 0;
+	}
+}
+
+
+// Outputs in the same state get the same frames.
+static int txd_output_sameState( const txd_output_t * a, const txd_output_t * b )
+{
+	if( a->sent_valid != b->sent_valid || a->refresh != b->refresh || a->configs_count != b->configs_count ) {
+		return 0;
+	}
+	if( a->sent_valid && memcmp( a->sent, b->sent, sizeof(a->sent) ) ) {
+		return 0;
+	}
+	for( uint8_t i = 0; i < a->configs_count; i++ ) {
+		if( a->configs_size[i] != b->configs_size[i] || memcmp( a->configs[i], b->configs[i], a->configs_size[i] ) ) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+
+// Plans and encodes the frames of this tick into the output's empty pending
+// buffer, returning the number of frames.
+static unsigned txd_output_encode( txd_t * txd, txd_output_t * output )
+{
+	uint8_t packets[TXD_PACKETS_MAXSIZE];
+	size_t packets_size = ILLUMINATIR_PLAN_MAXSIZE;
+	if( illuminatir_plan( packets, &packets_size, output->sent_valid ? output->sent : NULL, txd->universe, ILLUMINATIR_PLAN_OVERHEAD_RAW ) != ILLUMINATIR_ERROR_NONE ) {
+		packets_size = 0;
+	}
+	if( output->sent_valid ) { // otherwise everything is sent already
+		for( uint8_t i = 0; i < txd->refresh_blocks && i < TXD_BLOCKS; i++ ) {
+			uint8_t offset = output->refresh * ILLUMINATIR_OFFSETARRAY_MAXVALUES;
+			uint8_t packet_size = ILLUMINATIR_PACKET_MAXSIZE;
+			if( illuminatir_build_offsetArray( packets + packets_size, &packet_size, offset, txd->universe + offset, ILLUMINATIR_OFFSETARRAY_MAXVALUES ) == ILLUMINATIR_ERROR_NONE ) {
+				packets_size += packet_size;
+			}
+			output->refresh = (output->refresh + 1) % TXD_BLOCKS;
+		}
+	}
+	for( uint8_t i = 0; i < output->configs_count; i++ ) {
+		memcpy( packets + packets_size, output->configs[i], output->configs_size[i] );
+		packets_size += output->configs_size[i];
+	}
+
+	// Split at packet boundaries into frames of at most TXD_FRAME_PACKETS_MAX bytes.
+	unsigned frames = 0;
+	size_t first = 0;
+	while( first < packets_size ) {
+		size_t last = first;
+		while( last < packets_size && last - first + illuminatir_header_getPacketSize( packets[last] ) <= TXD_FRAME_PACKETS_MAX ) {
+			last += illuminatir_header_getPacketSize( packets[last] );
+		}
+		illuminatir_frame_t frame;
+		size_t frame_size = 0;
+		if( illuminatir_frame_init( &frame, output->pending + output->pending_size, sizeof(output->pending) - output->pending_size ) != ILLUMINATIR_ERROR_NONE
+		 || illuminatir_frame_add_packets( &frame, packets + first, last - first ) != ILLUMINATIR_ERROR_NONE
+		 || illuminatir_rand_cobs_frame_finalize( &frame, &frame_size ) != ILLUMINATIR_ERROR_NONE ) {
+			break;
+		}
+		output->pending_size += frame_size;
+		frames++;
+		first = last;
+	}
+	return frames;
+}
+
+
+// Advances the output's state as if the frames of this tick were received.
+static void txd_output_sent( txd_t * txd, txd_output_t * output )
+{
+	memcpy( output->sent, txd->universe, sizeof(output->sent) );
+	output->sent_valid = 1;
+	output->configs_count = 0;
+}
+
+
+static void txd_tick( txd_t * txd )
+{
+	// Find the outputs ready for new frames, and for each one an earlier output in the same state.
+	txd_output_t * leaders[txd->outputs_count ? txd->outputs_count : 1];
+	unsigned frames[txd->outputs_count ? txd->outputs_count : 1];
+	for( unsigned i = 0; i < txd->outputs_count; i++ ) {
+		txd_output_t * output = txd->outputs[i];
+		leaders[i] = NULL;
+		if( output->fd < 0 ) {
+			continue;
+		}
+		if( output->pending_size ) {
+			output->stats.ticks_skipped++;
+			continue;
+		}
+		leaders[i] = output;
+		for( unsigned j = 0; j < i; j++ ) {
+			if( leaders[j] == txd->outputs[j] && txd_output_sameState( txd->outputs[j], output ) ) {
+				leaders[i] = txd->outputs[j];
+				break;
+			}
+		}
+	}
+	for( unsigned i = 0; i < txd->outputs_count; i++ ) {
+		txd_output_t * output = txd->outputs[i];
+		frames[i] = 0;
+		if( leaders[i] == output ) {
+			frames[i] = txd_output_encode( txd, output );
+		} else if( leaders[i] ) { // leaders come first and are encoded already
+			unsigned leader = 0;
+			while( txd->outputs[leader] != leaders[i] ) {
+				leader++;
+			}
+			memcpy( output->pending, leaders[i]->pending, leaders[i]->pending_size );
+			output->pending_size = leaders[i]->pending_size;
+			output->refresh = leaders[i]->refresh;
+			frames[i] = frames[leader];
+		}
+		output->stats.frames += frames[i];
+	}
+	for( unsigned i = 0; i < txd->outputs_count; i++ ) {
+		txd_output_t * output = txd->outputs[i];
+		if( leaders[i] ) {
+			txd_output_sent( txd, output );
+			txd_output_write( txd, output );
+		}
+	}
+}
+
+
+txd_t * txd_create( uint32_t tick_us, uint8_t refresh_blocks )
+{
+	if( !tick_us ) {
+		errno = EINVAL;
+		return NULL;
+	}
+	txd_t * txd = calloc( 1, sizeof(*txd) );
+	if( !txd ) {
+		return NULL;
+	}
+	txd->timer          = TXD_KIND_TIMER;
+	txd->listener       = TXD_KIND_LISTENER;
+	txd->listen_fd      = -1;
+	txd->refresh_blocks = refresh_blocks;
+	txd->epoll_fd       = epoll_create1( EPOLL_CLOEXEC );
+	txd->timer_fd       = timerfd_create( CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC );
+	struct itimerspec period = {
+		.it_interval = { tick_us / 1000000, (tick_us % 1000000) * 1000 },
+		.it_value    = { tick_us / 1000000, (tick_us % 1000000) * 1000 },
+	};
+	struct epoll_event event = { .events = EPOLLIN, .data.ptr = &txd->timer };
+	if( txd->epoll_fd < 0 || txd->timer_fd < 0
+	 || timerfd_settime( txd->timer_fd, 0, &period, NULL )
+	 || epoll_ctl( txd->epoll_fd, EPOLL_CTL_ADD, txd->timer_fd, &event ) ) {
+		int err = errno;
+		txd_destroy( txd );
+		errno = err;
+		return NULL;
+	}
+	return txd;
+}
+
+
+void txd_destroy( txd_t * txd )
+{
+	if( !txd ) {
+		return;
+	}
+	for( unsigned i = 0; i < txd->clients_count; i++ ) {
+		txd_client_close( txd, txd->clients[i] );
+	}
+	txd_client_sweep( txd );
+	free( txd->clients );
+	for( unsigned i = 0; i < txd->outputs_count; i++ ) {
+		txd_output_close( txd, txd->outputs[i] );
+		free( txd->outputs[i] );
+	}
+	free( txd->outputs );
+	if( txd->listen_fd >= 0 ) {
+		close( txd->listen_fd );
+		unlink( txd->listen_path );
+	}
+	if( txd->timer_fd >= 0 ) {
+		close( txd->timer_fd );
+	}
+	if( txd->epoll_fd >= 0 ) {
+		close( txd->epoll_fd );
+	}
+	free( txd );
+}
+
+
+int txd_listen( txd_t * txd, const char * path )
+{
+	struct sockaddr_un address = { .sun_family = AF_UNIX };
+	if( !txd || !path || txd->listen_fd >= 0 || strlen( path ) >= sizeof(address.sun_path) ) {
+		errno = EINVAL;
+		return -1;
+	}
+	strcpy( address.sun_path, path );
+	int fd = socket( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0 );
+	if( fd < 0 ) {
+		return -1;
+	}
+	struct stat st;
+	if( !stat( path, &st ) && S_ISSOCK( st.st_mode ) ) {
+		// Only a socket nobody listens on any more is left behind by a previous instance.
+		int probe = socket( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0 );
+		int refused = probe >= 0 && connect( probe, (const struct sockaddr *)&address, sizeof(address) ) && errno == ECONNREFUSED;
+		if( probe >= 0 ) {
+			close( probe );
+		}
+		if( !refused ) {
+			close( fd );
+			errno = EADDRINUSE;
+			return -1;
+		}
+		unlink( path );
+	}
+	struct epoll_event event = { .events = EPOLLIN, .data.ptr = &txd->listener };
+	if( bind( fd, (const struct sockaddr *)&address, sizeof(address) ) || listen( fd, 16 ) || epoll_ctl( txd->epoll_fd, EPOLL_CTL_ADD, fd, &event ) ) {
+		int err = errno;
+		close( fd );
+		errno = err;
+		return -1;
+	}
+	txd->listen_fd = fd;
+	strcpy( txd->listen_path, path );
+	return 0;
+}
+
+
+int txd_addClient( txd_t * txd, int fd )
+{
+	if( !txd || fd < 0 ) {
+		errno = EINVAL;
+		return -1;
+	}
+	int flags = fcntl( fd, F_GETFL );
+	if( flags < 0 || fcntl( fd, F_SETFL, flags | O_NONBLOCK ) ) {
+		return -1;
+	}
+	txd_client_t ** clients = txd_append( txd->clients, txd->clients_count, sizeof(*clients) );
+	if( !clients ) {
+		return -1;
+	}
+	txd->clients = clients;
+	txd_client_t * client = calloc( 1, sizeof(*client) );
+	if( !client ) {
+		return -1;
+	}
+	client->kind = TXD_KIND_CLIENT;
+	client->fd   = fd;
+	struct epoll_event event = { .events = EPOLLIN, .data.ptr = client };
+	if( epoll_ctl( txd->epoll_fd, EPOLL_CTL_ADD, fd, &event ) ) {
+		free( client );
+		return -1;
+	}
+	txd->clients[txd->clients_count++] = client;
+	return 0;
+}
+
+
+int txd_addOutput( txd_t * txd, int fd )
+{
+	if( !txd || fd < 0 ) {
+		errno = EINVAL;
+		return -1;
+	}
+	int flags = fcntl( fd, F_GETFL );
+	if( flags < 0 || fcntl( fd, F_SETFL, flags | O_NONBLOCK ) ) {
+		return -1;
+	}
+	txd_output_t ** outputs = txd_append( txd->outputs, txd->outputs_count, sizeof(*outputs) );
+	if( !outputs ) {
+		return -1;
+	}
+	txd->outputs = outputs;
+	txd_output_t * output = calloc( 1, sizeof(*output) );
+	if( !output ) {
+		return -1;
+	}
+	output->kind       = TXD_KIND_OUTPUT;
+	output->fd         = fd;
+	output->stats.open = 1;
+	struct epoll_event event = { .events = 0, .data.ptr = output }; // EPOLLOUT only while frames are pending
+	if( epoll_ctl( txd->epoll_fd, EPOLL_CTL_ADD, fd, &event ) ) {
+		free( output );
+		return -1;
+	}
+	txd->outputs[txd->outputs_count] = output;
+	return (int)txd->outputs_count++;
+}
+
+
+int txd_openOutput( txd_t * txd, const char * path, unsigned baud )
+{
+	if( !txd ) {
+		errno = EINVAL;
+		return -1;
+	}
+	int fd = serial_open( path, baud );
+	if( fd < 0 ) {
+		return -1;
+	}
+	int output = txd_addOutput( txd, fd );
+	if( output < 0 ) {
+		int err = errno;
+		close( fd );
+		errno = err;
+	}
+	return output;
+}
+
+
+int txd_poll( txd_t * txd, int timeout_ms )
+{
+	if( !txd ) {
+		errno = EINVAL;
+		return -1;
+	}
+	struct epoll_event events[TXD_EVENTS];
+	int ready = epoll_wait( txd->epoll_fd, events, TXD_EVENTS, timeout_ms );
+	if( ready < 0 ) {
+		return errno == EINTR ? 0 : -1;
+	}
+	// Clients first, so updates arriving together with the tick make it into its frames.
+	int tick = 0;
+	for( int i = 0; i < ready; i++ ) {
+		txd_kind_t * kind = events[i].data.ptr;
+		switch( *kind ) {
+			case TXD_KIND_TIMER: {
+				uint64_t expirations;
+				tick = read( txd->timer_fd, &expirations, sizeof(expirations) ) == sizeof(expirations);
+				break;
+			}
+			case TXD_KIND_LISTENER:
+				txd_accept( txd );
+				break;
+			case TXD_KIND_CLIENT: {
+				txd_client_t * client = (txd_client_t *)kind;
+				if( client->fd >= 0 ) {
+					txd_client_read( txd, client );
+				}
+				break;
+			}
+			case TXD_KIND_OUTPUT: {
+				txd_output_t * output = (txd_output_t *)kind;
+				if( events[i].events & (EPOLLERR | EPOLLHUP) ) {
+					txd_output_close( txd, output );
+				} else {
+					txd_output_write( txd, output );
+				}
+				break;
+			}
+		}
+	}
+	txd_client_sweep( txd );
+	if( tick ) {
+		txd_tick( txd );
+	}
+	return 0;
+}
+
+
+const uint8_t * txd_getUniverse( const txd_t * txd )
+{
+	return txd ? txd->universe : NULL;
+}
+
+
+void txd_getStats( const txd_t * txd, unsigned output, txd_stats_t * stats )
+{
+	if( !txd || !stats || output >= txd->outputs_count ) {
+		return;
+	}
+	*stats = txd->outputs[output]->stats;
+}
@@ -0,0 +1,73 @@
+#ifndef ILLUMINATIR_TXD_INCLUDED
+#define ILLUMINATIR_TXD_INCLUDED
+
+#include <illuminatir.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+// Transmitter engine of illuminatir-txd: clients send updates over stream
+// sockets, which are merged into one universe. Every tick the changes since
+// the last frame of each output are planned into packets, randomized, COBS
+// encoded and written to the output. Outputs that are still busy skip the
+// tick and catch up with the merged changes on the next one.
+//
+// Client protocol: a stream of messages, each a type byte, a length byte and
+// that many body bytes. There are no replies. A malformed message closes the
+// client's connection.
+
+
+#define TXD_MSG_SET_CHANNELS 0x01 // body: channel, value, channel, value, ...
+#define TXD_MSG_SET_RANGE    0x02 // body: first channel, values... (wraps after channel 255)
+#define TXD_MSG_CONFIG       0x03 // body: key length, key, values...
+
+#define TXD_CONFIGS           16  // Config packets pending per output.
+#define TXD_FRAME_PACKETS_MAX 128 // Bytes of raw packets per frame, keeping lost frames short.
+
+
+typedef struct txd txd_t;
+
+
+typedef struct {
+	uint64_t frames;         // Frames written.
+	uint64_t bytes;          // Encoded bytes written, including delimiters.
+	uint64_t ticks_skipped;  // Ticks the output was still busy writing.
+	uint64_t configs_dropped; // Config packets dropped because the output's queue was full.
+	int      open;           // Zero once writing failed.
+} txd_stats_t;
+
+
+// Creates an engine sending every tick_us microseconds and refreshing
+// refresh_blocks OffsetArray blocks of unchanged channels per tick, so
+// receivers joining late converge. Returns NULL on failure with errno set.
+txd_t * txd_create( uint32_t tick_us, uint8_t refresh_blocks );
+
+// Closes all sockets and outputs.
+void txd_destroy( txd_t * txd );
+
+// Listens on a Unix stream socket, replacing a stale socket file. Returns 0 or
+// -1 with errno set, EADDRINUSE if another process listens on the path.
+int txd_listen( txd_t * txd, const char * path );
+
+// Adds a connected stream socket as a client, which is closed by the engine. Returns 0 or -1 with errno set.
+int txd_addClient( txd_t * txd, int fd );
+
+// Adds a file descriptor as output, which is closed by the engine. Returns its number or -1 with errno set.
+int txd_addOutput( txd_t * txd, int fd );
+
+// Opens a serial device or pty in raw mode with the given baud rate (0 keeps
+// the current one) and adds it. Returns its number or -1 with errno set.
+int txd_openOutput( txd_t * txd, const char * path, unsigned baud );
+
+// Waits up to timeout_ms for clients, outputs and the tick timer and handles
+// them. Returns 0 or -1 with errno set.
+int txd_poll( txd_t * txd, int timeout_ms );
+
+// The merged channel values of all clients.
+const uint8_t * txd_getUniverse( const txd_t * txd );
+
+void txd_getStats( const txd_t * txd, unsigned output, txd_stats_t * stats );
+
+
+#endif